@@ -0,0 +1,111 @@
+// Headless benchmark of the CPU meshlet culling stage
+// Builds meshlets for a dense sphere and culls them from cameras placed around it, then reports the culling throughput
+// Usage: vgl_cluster_cull_bench [camera count]
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+
+#include "utilities/geometry.hpp"
+
+namespace
+{
+	constexpr float FOV = 45.0f;
+	constexpr float ASPECT_RATIO = 16.0f / 9.0f;
+	constexpr float NEAR = 0.01f;
+	constexpr float FAR = 125.0f;
+
+	/// <summary>
+	/// Builds the inward facing frustum planes of a camera, the same way the Frustum struct does
+	/// </summary>
+	void getFrustumPlanes(const glm::vec3& position, const glm::vec3& forward, Plane* planes)
+	{
+		float halfVSide = FAR * std::tan(FOV * glm::pi<float>() / 180.0f * 0.5f);
+		float halfHSide = halfVSide * ASPECT_RATIO;
+		glm::vec3 frontMultFar = FAR * forward;
+
+		glm::vec3 right = glm::normalize(glm::cross(forward, glm::vec3(0.0f, 1.0f, 0.0f)));
+		glm::vec3 up = glm::normalize(glm::cross(right, forward));
+
+		planes[0] = Plane(position, glm::cross(right, frontMultFar - up * halfVSide));
+		planes[1] = Plane(position, glm::cross(frontMultFar + up * halfVSide, right));
+		planes[2] = Plane(position, glm::cross(frontMultFar - right * halfHSide, up));
+		planes[3] = Plane(position, glm::cross(up, frontMultFar + right * halfHSide));
+		planes[4] = Plane(position + frontMultFar, -forward);
+		planes[5] = Plane(position + NEAR * forward, forward);
+	}
+}
+
+int main(int argc, char** argv)
+{
+	int cameraCount = argc > 1 ? std::atoi(argv[1]) : 10000;
+	if (cameraCount <= 0)
+		cameraCount = 10000;
+
+	// A dense sphere stands in for a large imported mesh
+	VertexDataIndices mesh = Geometry::getIndexedSphere(512, 256);
+	mesh.indices = Geometry::optimizeVertexCache(mesh.indices, mesh.vertices.size() / 3);
+
+	auto buildStart = std::chrono::steady_clock::now();
+
+	std::vector<Meshlet> meshlets;
+	Geometry::buildMeshlets(mesh.indices, 0, mesh.indices.size(), mesh.vertices, meshlets);
+
+	double buildTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - buildStart).count();
+
+	std::printf("Mesh: %zu vertices, %zu triangles, %zu meshlets (built in %.2f ms)\n", mesh.vertices.size() / 3, mesh.indices.size() / 3, meshlets.size(), buildTime);
+
+	// Cameras close to the surface looking in random directions, so both frustum and cone culling matter
+	std::mt19937 random(42);
+	std::uniform_real_distribution<float> distribution(-1.0f, 1.0f);
+
+	auto randomDirection = [&]() {
+		glm::vec3 direction;
+		do
+			direction = glm::vec3(distribution(random), distribution(random), distribution(random));
+		while (glm::length(direction) < 0.1f || glm::length(direction) > 1.0f);
+		return glm::normalize(direction);
+	};
+
+	std::vector<Plane> planes(cameraCount * 6);
+	std::vector<glm::vec3> positions(cameraCount);
+
+	for (int i = 0; i < cameraCount; i++)
+	{
+		positions[i] = randomDirection() * (1.2f + 2.0f * (distribution(random) * 0.5f + 0.5f));
+		glm::vec3 forward = glm::normalize(randomDirection() * 0.5f - positions[i]);
+		getFrustumPlanes(positions[i], forward, &planes[i * 6]);
+	}
+
+	glm::mat4 modelMatrix = glm::mat4(1.0f);
+	std::vector<IndexRange> visibleRanges;
+
+	size_t visibleMeshlets = 0;
+	size_t visibleIndices = 0;
+	size_t drawRanges = 0;
+
+	auto cullStart = std::chrono::steady_clock::now();
+
+	for (int i = 0; i < cameraCount; i++)
+	{
+		visibleMeshlets += Geometry::cullMeshlets(meshlets, 0, meshlets.size(), &planes[i * 6], modelMatrix, positions[i], visibleRanges);
+		drawRanges += visibleRanges.size();
+
+		for (const IndexRange& range : visibleRanges)
+			visibleIndices += range.count;
+	}
+
+	double cullTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - cullStart).count();
+	double culledMeshlets = static_cast<double>(meshlets.size()) * cameraCount;
+
+	std::printf("Culled %d views in %.2f ms (%.3f ms per view)\n", cameraCount, cullTime * 1000.0, cullTime * 1000.0 / cameraCount);
+	std::printf("Throughput: %.1f M meshlets/s\n", culledMeshlets / cullTime / 1.0e6);
+	std::printf("Visible: %.1f%% of meshlets, %.1f%% of triangles, %.1f draw ranges per view\n",
+		100.0 * static_cast<double>(visibleMeshlets) / culledMeshlets,
+		100.0 * static_cast<double>(visibleIndices) / (static_cast<double>(mesh.indices.size()) * cameraCount),
+		static_cast<double>(drawRanges) / cameraCount);
+
+	return 0;
+}
@@ -0,0 +1,439 @@
+// Headless benchmark of the model import stages
+// Imports the models through the same processing steps as the ResourceLoader with its default settings, but without an OpenGL context:
+// the upload stage copies the vertex data, indices and pixels to staging memory in place of glBufferData and glTexImage2D
+// It measures a cold import, texture compression and the model and texture caches are left out
+// Reports the wall time and the peak resident memory of each stage as JSON on the standard output
+// Usage: vgl_import_bench [iterations] [models directory]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+#include <assimp/Importer.hpp>
+#include <assimp/scene.h>
+
+#include "utilities/geometry.hpp"
+#include "utilities/mappedFile.hpp"
+#include "utilities/meshImport.hpp"
+#include "utilities/parallel.hpp"
+#include "utilities/stb_image.h"
+#include "utilities/vertexFormat.hpp"
+
+namespace
+{
+	/// <summary>
+	/// The models of the repository, each in its own folder as scene.gltf
+	/// </summary>
+	const char* MODELS[] = { "boat", "tank", "ftm", "sea_keep" };
+
+	/// <summary>
+	/// The texture types the ResourceLoader loads from the materials
+	/// </summary>
+	const aiTextureType TEXTURE_TYPES[] = {
+		aiTextureType_DIFFUSE, aiTextureType_SPECULAR, aiTextureType_NORMALS, aiTextureType_HEIGHT, aiTextureType_METALNESS,
+		aiTextureType_DIFFUSE_ROUGHNESS, aiTextureType_LIGHTMAP, aiTextureType_OPACITY, aiTextureType_EMISSIVE,
+	};
+
+	/// <summary>
+	/// The default mesh processing settings of the ResourceLoader
+	/// </summary>
+	constexpr float WELD_EPSILON = 1.0e-5f;
+	constexpr unsigned int LOD_COUNT = 3;
+	constexpr bool QUANTIZE_VERTICES = true;
+
+	enum Stage
+	{
+		PARSE, // Assimp reading and post processing the file
+		EXTRACTION, // Copying the vertex attributes and indices out of the Assimp meshes
+		WELD, // Merging the vertices within the weld epsilon of each other
+		OPTIMIZE, // Reordering the triangles and vertices for the vertex cache, overdraw and vertex fetch
+		NORMALS, // Generating the normals and tangents the file doesn't provide
+		LODS, // Simplifying the levels of detail
+		MESHLETS, // Splitting the levels of detail in meshlets
+		VERTEX_DATA, // Interleaving and quantizing the vertices
+		TEXTURE_DECODE, // Decoding the images of the materials
+		UPLOAD, // Copying the vertex data, indices and pixels to staging memory, in place of the OpenGL upload
+		STAGE_COUNT,
+	};
+
+	const char* STAGE_NAMES[STAGE_COUNT] = { "parse", "extraction", "weld", "optimize", "normals", "lods", "meshlets", "vertexData", "textureDecode", "upload" };
+
+	struct StageResult
+	{
+		std::vector<double> times;
+
+		/// <summary>
+		/// The highest resident memory of the process while the stage ran, across all the iterations
+		/// </summary>
+		size_t peakRssKb = 0;
+	};
+
+	struct ExtractedMesh
+	{
+		std::vector<float> vertices;
+		std::vector<float> texCoords;
+		std::vector<float> normals;
+		std::vector<float> tangents;
+		std::vector<float> bitangents;
+		std::vector<unsigned int> indices;
+		std::vector<unsigned int> weldRemap;
+		std::vector<MeshLod> lods;
+		std::vector<Meshlet> meshlets;
+		MeshVertexData vertexData;
+		bool hasNormalMap = false;
+		bool hasTexCoords = false;
+	};
+
+	struct ImageDeleter
+	{
+		void operator()(unsigned char* pixels) const { stbi_image_free(pixels); }
+	};
+
+	struct DecodedImage
+	{
+		int width = 0;
+		int height = 0;
+		int channels = 0;
+		std::unique_ptr<unsigned char, ImageDeleter> pixels = nullptr;
+	};
+
+	/// <summary>
+	/// A texture to decode, either a file or an embedded compressed image
+	/// </summary>
+	struct TextureSource
+	{
+		std::string path;
+		const unsigned char* encodedData = nullptr;
+		size_t encodedSize = 0;
+	};
+
+	/// <summary>
+	/// Resets the peak resident memory of the process, so the next reading only covers what ran since
+	/// </summary>
+	void resetPeakRss()
+	{
+#ifdef __linux__
+		std::ofstream clearRefs("/proc/self/clear_refs");
+		clearRefs << "5";
+#endif
+	}
+
+	/// <summary>
+	/// Returns the peak resident memory of the process in kilobytes since the last reset, or since the start where it can't be reset
+	/// </summary>
+	size_t getPeakRssKb()
+	{
+#ifdef __linux__
+		std::ifstream status("/proc/self/status");
+		std::string line;
+
+		while (std::getline(status, line))
+		{
+			if (line.compare(0, 6, "VmHWM:") == 0)
+				return std::strtoull(line.c_str() + 6, nullptr, 10);
+		}
+#endif
+
+#ifdef _WIN32
+		PROCESS_MEMORY_COUNTERS counters = {};
+
+		if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+			return 0;
+
+		return static_cast<size_t>(counters.PeakWorkingSetSize / 1024);
+#else
+		// The maximum resident size is in kilobytes on Linux but in bytes on macOS
+		rusage usage = {};
+		getrusage(RUSAGE_SELF, &usage);
+
+#ifdef __APPLE__
+		return static_cast<size_t>(usage.ru_maxrss) / 1024;
+#else
+		return static_cast<size_t>(usage.ru_maxrss);
+#endif
+#endif
+	}
+
+	/// <summary>
+	/// Returns the textures of the materials of a model, once each, skipping the embedded raw pixels that don't need decoding
+	/// </summary>
+	std::vector<TextureSource> gatherTextures(const aiScene* scene, const std::string& directory)
+	{
+		std::vector<TextureSource> sources;
+		std::set<std::string> gatheredPaths;
+
+		for (unsigned int i = 0; i < scene->mNumMaterials; i++)
+		{
+			const aiMaterial* material = scene->mMaterials[i];
+
+			for (aiTextureType type : TEXTURE_TYPES)
+			{
+				for (unsigned int j = 0; j < material->GetTextureCount(type); j++)
+				{
+					aiString str;
+					material->GetTexture(type, j, &str);
+					std::string path = directory + '/' + std::string(str.C_Str());
+
+					if (!gatheredPaths.insert(path).second)
+						continue;
+
+					const aiTexture* embeddedTexture = scene->GetEmbeddedTexture(str.C_Str());
+
+					if (embeddedTexture != nullptr && embeddedTexture->mHeight != 0)
+						continue;
+
+					if (embeddedTexture != nullptr)
+						sources.push_back(TextureSource{ path, reinterpret_cast<const unsigned char*>(embeddedTexture->pcData), embeddedTexture->mWidth });
+					else
+						sources.push_back(TextureSource{ path, nullptr, 0 });
+				}
+			}
+		}
+
+		return sources;
+	}
+
+	template<typename Function>
+	void runStage(StageResult& result, const Function& function)
+	{
+		resetPeakRss();
+		auto stageStart = std::chrono::steady_clock::now();
+
+		function();
+
+		result.times.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - stageStart).count());
+		result.peakRssKb = std::max(result.peakRssKb, getPeakRssKb());
+	}
+}
+
+int main(int argc, char** argv)
+{
+	int iterations = argc > 1 ? std::atoi(argv[1]) : 5;
+	if (iterations <= 0)
+		iterations = 5;
+
+	std::string modelsDirectory = argc > 2 ? argv[2] : "models";
+
+	// The stb_image flip setting is global, the ResourceLoader decodes without flipping
+	stbi_set_flip_vertically_on_load(false);
+
+	std::printf("{\n\t\"iterations\": %d,\n\t\"models\": [", iterations);
+
+	bool isFirstModel = true;
+
+	for (const char* model : MODELS)
+	{
+		std::string directory = modelsDirectory + '/' + model;
+		std::string path = directory + "/scene.gltf";
+
+		StageResult results[STAGE_COUNT];
+		size_t meshCount = 0;
+		size_t vertexCount = 0;
+		size_t triangleCount = 0;
+		size_t textureCount = 0;
+		size_t textureBytes = 0;
+		bool hasFailed = false;
+
+		for (int iteration = 0; iteration < iterations && !hasFailed; iteration++)
+		{
+			Assimp::Importer import;
+			const aiScene* scene = nullptr;
+
+			runStage(results[PARSE], [&]()
+			{
+				scene = import.ReadFile(path, MeshImport::getImportFlags(false));
+			});
+
+			if (scene == nullptr || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || scene->mRootNode == nullptr)
+			{
+				std::fprintf(stderr, "Couldn't import %s - %s\n", path.c_str(), import.GetErrorString());
+				hasFailed = true;
+				break;
+			}
+
+			std::vector<ExtractedMesh> meshes(scene->mNumMeshes);
+
+			runStage(results[EXTRACTION], [&]()
+			{
+				for (unsigned int i = 0; i < scene->mNumMeshes; i++)
+				{
+					const aiMesh* mesh = scene->mMeshes[i];
+					ExtractedMesh& extractedMesh = meshes[i];
+
+					MeshImport::extractVertices(mesh, extractedMesh.vertices, extractedMesh.texCoords, extractedMesh.normals, extractedMesh.tangents, extractedMesh.bitangents, extractedMesh.indices);
+
+					extractedMesh.hasTexCoords = mesh->HasTextureCoords(0);
+					extractedMesh.hasNormalMap = scene->mMaterials[mesh->mMaterialIndex]->GetTextureCount(aiTextureType_NORMALS) > 0;
+				}
+			});
+
+			// Like the ResourceLoader, the weld only remaps the positions and the optimization remaps the other attributes once with both remaps
+			runStage(results[WELD], [&]()
+			{
+				for (ExtractedMesh& mesh : meshes)
+					MeshImport::weldMesh(mesh.vertices, mesh.texCoords, mesh.normals, mesh.indices, mesh.tangents, mesh.bitangents, WELD_EPSILON, &mesh.weldRemap);
+			});
+
+			runStage(results[OPTIMIZE], [&]()
+			{
+				for (ExtractedMesh& mesh : meshes)
+					MeshImport::optimizeMesh(mesh.vertices, mesh.texCoords, mesh.normals, mesh.indices, mesh.tangents, mesh.bitangents, nullptr, nullptr, &mesh.weldRemap);
+			});
+
+			// Only what the file doesn't provide is generated, like the ResourceLoader does
+			runStage(results[NORMALS], [&]()
+			{
+				for (ExtractedMesh& mesh : meshes)
+				{
+					if (mesh.normals.empty())
+						mesh.normals = Geometry::calculateVerticesNormals(mesh.vertices, mesh.indices);
+
+					if (mesh.tangents.empty() && mesh.hasNormalMap && mesh.hasTexCoords)
+						Geometry::calculateVerticesTangents(mesh.vertices, mesh.texCoords, mesh.normals, mesh.indices, mesh.tangents, mesh.bitangents);
+				}
+			});
+
+			runStage(results[LODS], [&]()
+			{
+				for (ExtractedMesh& mesh : meshes)
+					mesh.lods = MeshImport::generateLods(mesh.vertices, mesh.indices, LOD_COUNT, true);
+			});
+
+			runStage(results[MESHLETS], [&]()
+			{
+				for (ExtractedMesh& mesh : meshes)
+					MeshImport::buildMeshlets(mesh.vertices, mesh.indices, mesh.lods, mesh.meshlets);
+			});
+
+			runStage(results[VERTEX_DATA], [&]()
+			{
+				for (ExtractedMesh& mesh : meshes)
+					mesh.vertexData = VertexFormat::buildVertexData(mesh.vertices, mesh.texCoords, mesh.normals, mesh.tangents, mesh.bitangents, mesh.indices, mesh.lods, QUANTIZE_VERTICES);
+			});
+
+			std::vector<TextureSource> sources = gatherTextures(scene, directory);
+			std::vector<DecodedImage> images(sources.size());
+
+			runStage(results[TEXTURE_DECODE], [&]()
+			{
+				Parallel::forChunks(sources.size(), 1, [&](size_t begin, size_t end)
+				{
+					for (size_t i = begin; i < end; i++)
+					{
+						const TextureSource& source = sources[i];
+						DecodedImage& image = images[i];
+
+						if (source.encodedData != nullptr)
+						{
+							image.pixels.reset(stbi_load_from_memory(source.encodedData, static_cast<int>(source.encodedSize), &image.width, &image.height, &image.channels, 0));
+							continue;
+						}
+
+						MappedFile file(source.path);
+
+						if (file.isOpen())
+							image.pixels.reset(stbi_load_from_memory(file.getData(), static_cast<int>(file.getSize()), &image.width, &image.height, &image.channels, 0));
+					}
+				});
+			});
+
+			// Stands in for glBufferData and glTexImage2D, the driver copies the data to its own memory the same way
+			runStage(results[UPLOAD], [&]()
+			{
+				std::vector<unsigned char> staging;
+
+				for (const ExtractedMesh& mesh : meshes)
+				{
+					staging.resize(mesh.vertexData.bytes.size());
+					std::memcpy(staging.data(), mesh.vertexData.bytes.data(), staging.size());
+
+					staging.resize(mesh.indices.size() * sizeof(unsigned int));
+					std::memcpy(staging.data(), mesh.indices.data(), staging.size());
+				}
+
+				for (const DecodedImage& image : images)
+				{
+					if (image.pixels == nullptr)
+						continue;
+
+					staging.resize(static_cast<size_t>(image.width) * image.height * image.channels);
+					std::memcpy(staging.data(), image.pixels.get(), staging.size());
+				}
+			});
+
+			meshCount = meshes.size();
+			vertexCount = 0;
+			triangleCount = 0;
+
+			// The indices of the levels of detail are appended after the full mesh, only the full mesh is counted
+			for (const ExtractedMesh& mesh : meshes)
+			{
+				vertexCount += mesh.vertices.size() / 3;
+				triangleCount += (mesh.lods.empty() ? mesh.indices.size() : mesh.lods[0].indexCount) / 3;
+			}
+
+			textureCount = 0;
+			textureBytes = 0;
+
+			for (const DecodedImage& image : images)
+			{
+				if (image.pixels == nullptr)
+					continue;
+
+				textureCount++;
+				textureBytes += static_cast<size_t>(image.width) * image.height * image.channels;
+			}
+		}
+
+		std::printf("%s\n\t\t{\n\t\t\t\"name\": \"%s\",\n", isFirstModel ? "" : ",", model);
+		isFirstModel = false;
+
+		if (hasFailed)
+		{
+			std::printf("\t\t\t\"error\": \"import failed\"\n\t\t}");
+			continue;
+		}
+
+		std::printf("\t\t\t\"meshes\": %zu,\n\t\t\t\"vertices\": %zu,\n\t\t\t\"triangles\": %zu,\n\t\t\t\"textures\": %zu,\n\t\t\t\"textureBytes\": %zu,\n\t\t\t\"stages\": {",
+			meshCount, vertexCount, triangleCount, textureCount, textureBytes);
+
+		double totalTime = 0.0;
+
+		for (int stage = 0; stage < STAGE_COUNT; stage++)
+		{
+			const std::vector<double>& times = results[stage].times;
+
+			double sum = 0.0;
+			for (double time : times)
+				sum += time;
+
+			double meanTime = sum / static_cast<double>(times.size());
+			totalTime += meanTime;
+
+			std::printf("%s\n\t\t\t\t\"%s\": { \"meanMs\": %.3f, \"minMs\": %.3f, \"maxMs\": %.3f, \"peakRssKb\": %zu }",
+				stage == 0 ? "" : ",", STAGE_NAMES[stage], meanTime, *std::min_element(times.begin(), times.end()), *std::max_element(times.begin(), times.end()), results[stage].peakRssKb);
+		}
+
+		std::printf("\n\t\t\t},\n\t\t\t\"totalMeanMs\": %.3f\n\t\t}", totalTime);
+	}
+
+	std::printf("\n\t]\n}\n");
+
+	return 0;
+}
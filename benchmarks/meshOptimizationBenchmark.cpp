@@ -0,0 +1,107 @@
+// Headless check of the mesh optimization passes
+// Runs the vertex cache and overdraw passes the ResourceLoader applies on fixture meshes and reports the ACMR before and after,
+// it exits with a failure when the optimized order is worse than the input for any of them
+// Usage: vgl_mesh_optimization_bench
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+
+#include "utilities/geometry.hpp"
+
+namespace
+{
+	/// <summary>
+	/// A flat grid of quads, the triangles are listed row by row like most exporters do
+	/// </summary>
+	VertexDataIndices getGrid(unsigned int size)
+	{
+		VertexDataIndices grid;
+		unsigned int rowSize = size + 1;
+
+		for (unsigned int i = 0; i <= size; i++)
+		{
+			for (unsigned int j = 0; j <= size; j++)
+				grid.vertices.insert(grid.vertices.end(), { static_cast<float>(j), 0.0f, static_cast<float>(i) });
+		}
+
+		for (unsigned int i = 0; i < size; i++)
+		{
+			for (unsigned int j = 0; j < size; j++)
+			{
+				unsigned int corner = i * rowSize + j;
+				grid.indices.insert(grid.indices.end(), { corner, corner + rowSize, corner + 1, corner + 1, corner + rowSize, corner + rowSize + 1 });
+			}
+		}
+
+		return grid;
+	}
+
+	/// <summary>
+	/// Shuffles the triangles of a mesh, the worst case input for the vertex cache
+	/// </summary>
+	VertexDataIndices shuffleTriangles(VertexDataIndices mesh)
+	{
+		size_t triangleCount = mesh.indices.size() / 3;
+		std::vector<size_t> order(triangleCount);
+
+		for (size_t i = 0; i < triangleCount; i++)
+			order[i] = i;
+
+		std::shuffle(order.begin(), order.end(), std::mt19937(42));
+
+		std::vector<unsigned int> shuffled;
+		shuffled.reserve(mesh.indices.size());
+
+		for (size_t triangle : order)
+			shuffled.insert(shuffled.end(), mesh.indices.begin() + triangle * 3, mesh.indices.begin() + triangle * 3 + 3);
+
+		mesh.indices = std::move(shuffled);
+		return mesh;
+	}
+
+	/// <summary>
+	/// Optimizes a fixture mesh, prints its statistics and returns whether the ACMR didn't get worse
+	/// </summary>
+	bool checkMesh(const char* name, const VertexDataIndices& mesh)
+	{
+		size_t vertexCount = mesh.vertices.size() / 3;
+		VertexCacheStatistics before = Geometry::analyzeVertexCache(mesh.indices, vertexCount);
+
+		auto start = std::chrono::steady_clock::now();
+
+		std::vector<unsigned int> indices = Geometry::optimizeVertexCache(mesh.indices, vertexCount);
+		VertexCacheStatistics vertexCache = Geometry::analyzeVertexCache(indices, vertexCount);
+
+		indices = Geometry::optimizeOverdraw(indices, mesh.vertices);
+		VertexCacheStatistics overdraw = Geometry::analyzeVertexCache(indices, vertexCount);
+
+		double time = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+		// The vertex cache pass alone must never be worse than the input, the ResourceLoader keeps the input order when both passes are
+		bool passed = vertexCache.cacheMisses <= before.cacheMisses;
+
+		std::printf("%-16s %8zu triangles  ACMR %.3f -> %.3f (vertex cache) -> %.3f (overdraw)  %8.2f ms  %s\n",
+			name, before.triangleCount, before.getACMR(), vertexCache.getACMR(), overdraw.getACMR(), time, passed ? "ok" : "REGRESSION");
+
+		return passed;
+	}
+}
+
+int main()
+{
+	VertexDataIndices sphere = Geometry::getIndexedSphere(256, 128);
+	VertexDataIndices grid = getGrid(256);
+	VertexDataIndices cube = Geometry::getIndexedCube();
+
+	bool passed = true;
+	passed &= checkMesh("cube", cube);
+	passed &= checkMesh("sphere", sphere);
+	passed &= checkMesh("shuffled sphere", shuffleTriangles(sphere));
+	passed &= checkMesh("grid", grid);
+	passed &= checkMesh("shuffled grid", shuffleTriangles(grid));
+
+	return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
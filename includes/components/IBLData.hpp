@@ -1,6 +1,8 @@
 #pragma once
 
+#include <cstdint>
 #include <memory>
+#include <string>
 
 #include "cubemap.hpp"
 #include "texture.hpp"
@@ -11,26 +13,46 @@
 /// </summary>
 struct IBLData
 {
+	/// <summary>
+	/// Identifies the cache files and their version, the version must change whenever their layout or the convolutions do
+	/// </summary>
+	static constexpr char MAGIC[4] = { 'V', 'G', 'L', 'I' };
+	static constexpr uint32_t VERSION = 2;
+
+	/// <summary>
+	/// The number of levels of the prefiltered map that are rendered, one per roughness step sampled by the shaders
+	/// </summary>
+	static constexpr int PREFILTER_LEVELS = 5;
+
+	/// <summary>
+	/// The size in pixels of the faces of each map, and of the BRDF lookup texture
+	/// An environment map created from the images of a skybox keeps their size instead
+	/// </summary>
+	static constexpr int ENVIRONMENT_SIZE = 512;
+	static constexpr int IRRADIANCE_SIZE = 32;
+	static constexpr int PREFILTER_SIZE = 1024;
+	static constexpr int BRDF_LUT_SIZE = 512;
+
 	/// <summary>
 	/// The environment map (skybox)
 	/// </summary>
-	std::unique_ptr<Cubemap> const environmentMap = std::make_unique<Cubemap>(GL_RGB16F, 512, 512);
+	std::shared_ptr<Cubemap> const environmentMap = std::make_shared<Cubemap>(GL_RGB16F, ENVIRONMENT_SIZE, ENVIRONMENT_SIZE);
 
 	/// <summary>
 	/// The irradiance map for diffuse lighting
 	/// </summary>
-	std::unique_ptr<Cubemap> const irradianceMap = std::make_unique<Cubemap>(GL_RGB16F, 32, 32);
+	std::shared_ptr<Cubemap> const irradianceMap = std::make_shared<Cubemap>(GL_RGB16F, IRRADIANCE_SIZE, IRRADIANCE_SIZE);
 
 	/// <summary>
 	/// The prefiltered map for specular lighting
 	/// </summary>
-	std::unique_ptr<Cubemap> const prefilterMap = std::make_unique<Cubemap>(GL_RGB16F, 1024, 1024, true);
+	std::shared_ptr<Cubemap> const prefilterMap = std::make_shared<Cubemap>(GL_RGB16F, PREFILTER_SIZE, PREFILTER_SIZE, true);
 
 	// TODO : Make this const
 	/// <summary>
 	/// The BRDF lookup texture for specular lighting
 	/// </summary>
-	std::unique_ptr<Texture> brdfLut = nullptr;
+	std::shared_ptr<Texture> brdfLut = nullptr;
 
 	/// <summary>
 	/// Generates an environment map and IBL data from a 2D HDR map
@@ -47,4 +69,38 @@ struct IBLData
 	IBLData(Renderer& renderer, std::unique_ptr<Cubemap> cubemap);
 
 	~IBLData() = default;
+
+	/// <summary>
+	/// Loads the maps of a sky from a cache file written by save, without convolving them again
+	/// </summary>
+	/// <param name="path">The path of the cache file</param>
+	/// <param name="sourceHash">The hash of the images of the sky</param>
+	/// <returns>The IBL data, null if the file doesn't exist or doesn't match the source</returns>
+	static std::shared_ptr<IBLData> load(const std::string& path, uint64_t sourceHash);
+
+	/// <summary>
+	/// Saves the maps to a cache file as half floats with their mip levels, through a temporary file
+	/// </summary>
+	/// <param name="path">The path of the cache file</param>
+	/// <param name="sourceHash">The hash of the images of the sky</param>
+	/// <returns>True if the file was written</returns>
+	bool save(const std::string& path, uint64_t sourceHash) const;
+
+	/// <summary>
+	/// Returns how many bytes the maps use on the GPU
+	/// </summary>
+	[[nodiscard]] size_t getByteSize() const;
+
+private:
+	static constexpr Uniform EQUIRECTANGULAR_MAP = Uniform("equirectangularMap");
+	static constexpr Uniform ENVIRONMENT_MAP = Uniform("environmentMap");
+	static constexpr Uniform PROJECTION = Uniform("projection");
+	static constexpr Uniform VIEW = Uniform("view");
+	static constexpr Uniform ROUGHNESS = Uniform("roughness");
+
+	/// <summary>
+	/// Creates the maps without drawing into them, for IBL data loaded from a cache file
+	/// </summary>
+	/// <param name="environmentSize">The size of the faces of the environment map, which keeps the size of the images of the sky it was created from</param>
+	explicit IBLData(int environmentSize);
 };
\ No newline at end of file
@@ -10,5 +10,10 @@ public:
 
 	explicit DirectionalLightComponent(Entity* parent);
 
+	/// <summary>
+	/// The handle of the directional lights array in the shaders
+	/// </summary>
+	static constexpr Uniform DIR_LIGHTS = Uniform("dirLights");
+
 	void sendToShader(Shader* shaderProgram, unsigned int index) override;
 };
@@ -12,5 +12,10 @@ public:
 
 	explicit PointLightComponent(Entity* parent);
 
+	/// <summary>
+	/// The handle of the point lights array in the shaders
+	/// </summary>
+	static constexpr Uniform POINT_LIGHTS = Uniform("pointLights");
+
 	void sendToShader(Shader* shaderProgram, unsigned int index) override;
 };
@@ -18,5 +18,10 @@ public:
 
 	explicit SpotLightComponent(Entity* parent);
 
+	/// <summary>
+	/// The handle of the spot lights array in the shaders
+	/// </summary>
+	static constexpr Uniform SPOT_LIGHTS = Uniform("spotLights");
+
 	void sendToShader(Shader* shaderProgram, unsigned int index) override;
 };
@@ -11,13 +11,77 @@
 #include "component.hpp"
 #include "texture.hpp"
 #include "physics/boundingBox.hpp"
+#include "physics/meshBvh.hpp"
 #include "shader.hpp"
+#include "utilities/vertexFormat.hpp"
+#include "utilities/geometry.hpp"
+
+struct Frustum;
+
+/// <summary>
+/// The OpenGL buffers of a mesh and the ranges of its index buffer that are drawn, shared by the meshes drawn with the same geometry
+/// </summary>
+struct MeshBuffers
+{
+	/// <summary>
+	/// A OpenGL handle for the vertex array object
+	/// </summary>
+	GLuint VAO = 0;
+
+	/// <summary>
+	/// A OpenGL handle for the buffer object containing the interleaved vertex attributes
+	/// </summary>
+	GLuint VBO = 0;
+
+	/// <summary>
+	/// A OpenGL handle for the buffer object containing the indices
+	/// </summary>
+	GLuint indicesBO = 0;
+
+	/// <summary>
+	/// The number of bytes of the buffers, counted by the ResourceManager
+	/// </summary>
+	size_t byteSize = 0;
+
+	/// <summary>
+	/// The levels of detail in the index buffer, empty if the whole index buffer is drawn
+	/// </summary>
+	std::vector<MeshLod> lods;
+
+	/// <summary>
+	/// The clusters of triangles in the index buffer, with their bounds for culling
+	/// </summary>
+	std::vector<Meshlet> meshlets;
+
+	MeshBuffers() = default;
+	~MeshBuffers();
+	MeshBuffers(MeshBuffers const&) = delete;
+	MeshBuffers& operator=(MeshBuffers const&) = delete;
+};
 
 class MeshComponent : public virtual Component
 {
 public:
-	static const std::string MODEL;
-	static const std::string NORMAL_MATRIX;
+	static constexpr Uniform MODEL = Uniform("model");
+	static constexpr Uniform NORMAL_MATRIX = Uniform("normalMatrix");
+	static constexpr Uniform POSITION_OFFSET = Uniform("positionOffset");
+	static constexpr Uniform POSITION_SCALE = Uniform("positionScale");
+
+	/// <summary>
+	/// Above this texture coordinates error, quantizing a mesh logs a warning
+	/// </summary>
+	static constexpr float MAX_TEXCOORD_QUANTIZATION_ERROR = 1.0f / 2048.0f;
+
+	/// <summary>
+	/// The largest simplification error in pixels a level of detail can show on screen
+	/// </summary>
+	static constexpr float LOD_PIXEL_ERROR = 1.0f;
+
+	/// <summary>
+	/// A coarser level of detail is only picked once its error falls under this fraction of LOD_PIXEL_ERROR,
+	/// which keeps meshes near a threshold distance from switching back and forth every frame
+	/// </summary>
+	static constexpr float LOD_HYSTERESIS = 0.75f;
 
 	explicit MeshComponent(Entity* parent);
 	~MeshComponent() override;
@@ -29,13 +93,26 @@ public:
 	/// Unlike the update method, this is a much simpler method that only sends model & normal matrices to the shader before drawing
 	/// Much faster to run, used for passes that only need to draw the geometry of the mesh
 	/// </summary>
-	void drawGeometry(Shader* shaderProgram) const;
+	/// <param name="shaderProgram">The shader to send the matrices to</param>
+	/// <param name="visibleMeshletsOnly">Whether to only draw the meshlets that passed the last cullMeshlets call, for passes rendered from the camera</param>
+	void drawGeometry(Shader* shaderProgram, bool visibleMeshletsOnly = false) const;
+
+	/// <summary>
+	/// Draws the geometry of the mesh with a custom model matrix, only the model matrix is sent to the shader
+	/// Used for passes that draw a modified version of the mesh, like outlines
+	/// </summary>
+	void drawGeometry(Shader* shaderProgram, const glm::mat4& modelMatrix) const;
 
 	/// <summary>
 	/// Adds vertices to the mesh
 	/// </summary>
 	MeshComponent& addVertices(const std::vector<float> &vertices);
 
+	/// <summary>
+	/// Adds vertices to the mesh, the vector is moved rather than copied
+	/// </summary>
+	MeshComponent& addVertices(std::vector<float>&& vertices);
+
 	/// <summary>
 	/// Adds vertices to the mesh
 	/// </summary>
@@ -46,6 +123,11 @@ public:
 	/// </summary>
 	MeshComponent& addTexCoords(const std::vector<float> &texCoords);
 
+	/// <summary>
+	/// Adds texture coordinates to the mesh, the vector is moved rather than copied
+	/// </summary>
+	MeshComponent& addTexCoords(std::vector<float>&& texCoords);
+
 	/// <summary>
 	/// Adds texture coordinates to the mesh
 	/// </summary>
@@ -56,6 +138,11 @@ public:
 	/// </summary>
 	MeshComponent& addNormals(const std::vector<float> &normals);
 
+	/// <summary>
+	/// Adds normals to the mesh for lighting calculations, the vector is moved rather than copied
+	/// </summary>
+	MeshComponent& addNormals(std::vector<float>&& normals);
+
 	/// <summary>
 	/// Adds normals to the mesh for lighting calculations
 	/// </summary>
@@ -66,6 +153,11 @@ public:
 	/// </summary>
 	MeshComponent& addIndices(const std::vector<unsigned int> &indices);
 
+	/// <summary>
+	/// Adds indices to the mesh, the vector is moved rather than copied
+	/// </summary>
+	MeshComponent& addIndices(std::vector<unsigned int>&& indices);
+
 	/// <summary>
 	/// Adds indices to the mesh
 	/// </summary>
@@ -76,11 +168,98 @@ public:
 	/// </summary>
 	MeshComponent& addTangents(const std::vector<float> &tangents);
 
+	/// <summary>
+	/// Adds tangents to the mesh for normal mapping, the vector is moved rather than copied
+	/// </summary>
+	MeshComponent& addTangents(std::vector<float>&& tangents);
+
 	/// <summary>
 	/// Adds bitangents to the mesh for normal mapping
+	/// These are only used to find the handedness of the tangent space, the bitangent itself is rebuilt in the shader
 	/// </summary>
 	MeshComponent& addBitangents(const std::vector<float> &bitangents);
 
+	/// <summary>
+	/// Takes the bitangents of the mesh, the vector is moved rather than copied
+	/// </summary>
+	MeshComponent& addBitangents(std::vector<float>&& bitangents);
+
+	/// <summary>
+	/// Sets the vertices already built from the attribute streams with VertexFormat::buildVertexData, they are uploaded as is when the mesh is started
+	/// The mesh still needs its positions and indices for its bounds and BVH, the other streams aren't used
+	/// </summary>
+	MeshComponent& addVertexData(MeshVertexData&& vertexData);
+
+	/// <summary>
+	/// Sets the levels of detail of the mesh, from the most to the least detailed
+	/// The indices of every level must have been added to the index buffer, the first level is usually the full mesh
+	/// </summary>
+	MeshComponent& addLods(const std::vector<MeshLod>& lods);
+
+	/// <summary>
+	/// Picks the level of detail to draw from how large its simplification error appears on screen
+	/// </summary>
+	/// <param name="cameraPosition">The position of the camera in world space</param>
+	/// <param name="projectionScale">How many pixels a unit length covers at a unit distance from the camera</param>
+	void selectLod(const glm::vec3& cameraPosition, float projectionScale);
+
+	/// <summary>
+	/// Requests the mip levels of the streamed textures of the mesh from how many texels of them a pixel covers on screen
+	/// </summary>
+	/// <param name="cameraPosition">The position of the camera in world space</param>
+	/// <param name="projectionScale">How many pixels a unit length covers at a unit distance from the camera</param>
+	void requestTextureLevels(const glm::vec3& cameraPosition, float projectionScale);
+
+	/// <summary>
+	/// Sets the meshlets of the mesh, their index ranges must be in the index buffer
+	/// When there are levels of detail, each level references its own meshlets
+	/// </summary>
+	MeshComponent& addMeshlets(const std::vector<Meshlet>& meshlets);
+
+	/// <summary>
+	/// Takes the meshlets of the mesh, the vector is moved rather than copied
+	/// </summary>
+	MeshComponent& addMeshlets(std::vector<Meshlet>&& meshlets);
+
+	/// <summary>
+	/// Culls the meshlets of the current level of detail against the camera frustum and their normal cones
+	/// The update method then only draws the visible meshlets
+	/// </summary>
+	/// <param name="frustum">The camera frustum</param>
+	void cullMeshlets(const Frustum& frustum);
+
+	/// <summary>
+	/// Sets whether the vertices are quantized when the mesh is uploaded to the GPU
+	/// Quantized meshes use 16 bit positions and half float texture coordinates, this must be set before the mesh is started
+	/// </summary>
+	MeshComponent& setVertexQuantization(bool enabled);
+
+	/// <summary>
+	/// Sets whether the triangles of the most detailed level are kept on the CPU in a BVH once the mesh is started,
+	/// so the mesh can be hit by ray queries (picking, line of sight checks, decal placement) without a physics body
+	/// </summary>
+	MeshComponent& setRaycastable(bool enabled);
+
+	/// <summary>
+	/// Shares an already built BVH with the mesh, for meshes that are instances of the same asset
+	/// The BVH must have been built from the vertices of the mesh, it is used as is when the mesh is started
+	/// </summary>
+	MeshComponent& setRaycastBvh(std::shared_ptr<const MeshBvh> bvh);
+
+	/// <summary>
+	/// Draws the mesh with the buffers of another mesh instead of its own vertices, for meshes that are instances of the same geometry
+	/// The other mesh must be started first, the mesh then shares its buffers, levels of detail, meshlets and BVH when it is started
+	/// </summary>
+	MeshComponent& shareGeometry(const MeshComponent* source);
+
+	/// <summary>
+	/// Finds the closest hit of a ray on the mesh
+	/// </summary>
+	/// <param name="ray">The ray in world space</param>
+	/// <param name="hit">The closest hit in world space, only overwritten by hits closer than its current distance</param>
+	/// <returns>True if the mesh was hit closer than the previous hit</returns>
+	bool raycast(const Ray& ray, RayHit& hit) const;
+
 	/// <summary>
 	/// Adds a texture to the mesh
 	/// </summary>
@@ -106,6 +285,36 @@ public:
 	/// </summary>
 	[[nodiscard]] unsigned long getIndicesCount() const;
 
+	/// <summary>
+	/// Returns the levels of detail of the mesh
+	/// </summary>
+	[[nodiscard]] const std::vector<MeshLod>& getLods() const;
+
+	/// <summary>
+	/// Returns the index of the level of detail currently drawn
+	/// </summary>
+	[[nodiscard]] unsigned int getCurrentLod() const;
+
+	/// <summary>
+	/// Returns the number of meshlets of the mesh, across all levels of detail
+	/// </summary>
+	[[nodiscard]] size_t getMeshletCount() const;
+
+	/// <summary>
+	/// Returns how many meshlets of the current level of detail passed the last culling
+	/// </summary>
+	[[nodiscard]] size_t getVisibleMeshletCount() const;
+
+	/// <summary>
+	/// Returns the BVH used for ray queries on the mesh, null if the mesh isn't raycastable
+	/// </summary>
+	[[nodiscard]] const std::shared_ptr<const MeshBvh>& getRaycastBvh() const;
+
+	/// <summary>
+	/// Returns the error introduced by encoding the vertices of the mesh
+	/// </summary>
+	[[nodiscard]] QuantizationError getQuantizationError() const;
+
 	/// <summary>
 	/// Returns the bounding box of the object in local space
 	/// </summary>
@@ -173,44 +382,93 @@ protected:
 	bool hasIndices = false;
 
 	/// <summary>
-	/// The list of textures that the mesh contains
+	/// Whether the vertices are quantized when uploaded to the GPU
 	/// </summary>
-	std::vector<std::shared_ptr<Texture>> textures;
+	bool quantizeVertices = false;
 
 	/// <summary>
-	/// A OpenGL handle for the vertex array object
+	/// The vertices as they are uploaded, built from the streams when the mesh is started unless they were given already built
 	/// </summary>
-	GLuint VAO = 0;
+	MeshVertexData vertexData;
 
 	/// <summary>
-	/// A OpenGL handle for the buffer object containing the vertices
+	/// The levels of detail of the mesh, empty if the whole index buffer is drawn
+	/// Moved to the buffers when the mesh is started, so the instances don't copy them
 	/// </summary>
-	GLuint VBO = 0;
+	std::vector<MeshLod> lods;
 
 	/// <summary>
-	/// A OpenGL handle for the buffer object containing the texture coordinates
+	/// The index of the level of detail currently drawn
 	/// </summary>
-	GLuint texCoordBO = 0;
+	unsigned int currentLod = 0;
 
 	/// <summary>
-	/// A OpenGL handle for the buffer object containing the normals
+	/// The clusters of triangles of the mesh, with their bounds for culling
+	/// Moved to the buffers when the mesh is started, like the levels of detail
 	/// </summary>
-	GLuint normalBO = 0;
+	std::vector<Meshlet> meshlets;
 
 	/// <summary>
-	/// A OpenGL handle for the buffer object containing the indices
+	/// Whether the meshlets were culled, otherwise the whole level of detail is drawn
 	/// </summary>
-	GLuint indicesBO = 0;
+	bool meshletsCulled = false;
 
 	/// <summary>
-	/// A OpenGL handle for the buffer object containing the tangents
+	/// The number of meshlets that passed the last culling
 	/// </summary>
-	GLuint tangentsBO = 0;
+	size_t visibleMeshletCount = 0;
 
 	/// <summary>
-	/// A OpenGL handle for the buffer object containing the bitangents
+	/// The index ranges of the visible meshlets, as counts and byte offsets for glMultiDrawElements
 	/// </summary>
-	GLuint bitangentsBO = 0;
+	std::vector<IndexRange> visibleRanges;
+	std::vector<GLsizei> visibleIndexCounts;
+	std::vector<const void*> visibleIndexOffsets;
+
+	/// <summary>
+	/// Whether a BVH of the triangles is built when the mesh is started
+	/// </summary>
+	bool raycastable = false;
+
+	/// <summary>
+	/// The BVH of the triangles of the most detailed level, in object space
+	/// </summary>
+	std::shared_ptr<const MeshBvh> raycastBvh;
+
+	/// <summary>
+	/// The transform from the quantized positions to object space
+	/// </summary>
+	VertexDequantization dequantization;
+
+	/// <summary>
+	/// The error introduced by encoding the vertices
+	/// </summary>
+	QuantizationError quantizationError;
+
+	/// <summary>
+	/// The list of textures that the mesh contains
+	/// </summary>
+	std::vector<std::shared_ptr<Texture>> textures;
+
+	/// <summary>
+	/// The vertex and index buffers of the mesh, shared with the meshes that are instances of it
+	/// </summary>
+	std::shared_ptr<MeshBuffers> buffers;
+
+	/// <summary>
+	/// The mesh whose geometry is shared when the mesh is started, null if the mesh uploads its own vertices
+	/// </summary>
+	const MeshComponent* geometrySource = nullptr;
+
+	/// <summary>
+	/// A OpenGL handle for the vertex array object of the buffers
+	/// </summary>
+	GLuint VAO = 0;
+
+	/// <summary>
+	/// How many texture coordinates units a unit length of the mesh covers in local space, 0 if the mesh has no texture coordinates
+	/// </summary>
+	float texCoordDensity = 0.0f;
 
 	/// <summary>
 	/// The axis aligned bounding box of the mesh in local space
@@ -226,4 +484,20 @@ protected:
 	/// The last global model matrix that was used for calculating the world space AABB
 	/// </summary>
 	glm::mat4 lastModelMatrix = glm::mat4(0.0f);
+
+	/// <summary>
+	/// Issues the draw call for the geometry of the current level of detail
+	/// </summary>
+	/// <param name="visibleMeshletsOnly">Whether to only draw the meshlets that passed the last culling</param>
+	void draw(bool visibleMeshletsOnly) const;
+
+	/// <summary>
+	/// Takes the buffers and the draw data of the started mesh the geometry is shared with
+	/// </summary>
+	void adoptGeometry(const MeshComponent& source);
+
+	/// <summary>
+	/// Returns the meshlets of the mesh, which are held by the buffers once it is started
+	/// </summary>
+	[[nodiscard]] const std::vector<Meshlet>& getMeshlets() const;
 };
@@ -3,6 +3,8 @@
 #include "components/component.hpp"
 #include "physics/collider.hpp"
 
+class PhysicsWorld;
+
 class PhysicsComponent : public virtual Component
 {
 public:
@@ -16,11 +18,22 @@ public:
 	/// Sets a collider for the component
 	/// </summary>
 	/// <param name="collider">The collider to associate to the component</param>
-	void setCollider(Collider* collider);
+	/// <param name="physicsWorld">The physics world owning the collider, it is removed from it when the component is destroyed</param>
+	void setCollider(Collider* collider, PhysicsWorld* physicsWorld);
+
+	/// <summary>
+	/// Returns the collider of the component, null if it has none
+	/// </summary>
+	[[nodiscard]] const Collider* getCollider() const;
 
 private:
 	/// <summary>
 	/// The collider of the component
 	/// </summary>
 	Collider* collider = nullptr;
+
+	/// <summary>
+	/// The physics world owning the collider, null if the component has none or the world was destroyed first
+	/// </summary>
+	PhysicsWorld* physicsWorld = nullptr;
 };
@@ -6,6 +6,7 @@
 #include "cubemap.hpp"
 #include "shader.hpp"
 #include "components/IBLData.hpp"
+#include "utilities/resourceManager.hpp"
 
 enum class SkyboxType
 {
@@ -18,6 +19,11 @@ class SkyboxComponent : public MeshComponent
 {
 public:
 	static constexpr SkyboxType DEFAULT_SKY = SkyboxType::SKY;
+
+	/// <summary>
+	/// The directory where the IBL data of the skies is cached, named after the hash of their images
+	/// </summary>
+	static constexpr const char* IBL_CACHE_DIRECTORY = "cache/ibl";
 	
 	explicit SkyboxComponent(Entity* parent);
 	~SkyboxComponent() override;
@@ -27,13 +33,15 @@ public:
 
 	/// <summary>
 	/// Sets up the component before it can be used
+	/// The IBL data of a sky is only created when the sky is first shown, it is loaded from the disk cache when possible
+	/// and shared through the ResourceManager, so a state that sets up the skybox again reuses it while it stays cached
 	/// </summary>
 	/// <param name="shaderProgram">Assigns the shader the component should use to be drawn</param>
 	/// <param name="renderer">A reference to the renderer that will use the skybox</param>
 	void setupSkybox(Shader* shaderProgram, Renderer& renderer);
 
 	/// <summary>
-	/// Changes the skybox cubemap using a SkyboxType
+	/// Changes the skybox cubemap using a SkyboxType, before the component is started this only chooses the sky it starts with
 	/// </summary>
 	/// <param name="sky">A value of the SkyboxType enum</param>
 	void changeSkybox(SkyboxType sky);
@@ -45,10 +53,23 @@ public:
 	void setCubemap(Cubemap* cubemap);
 
 private:
-	std::map<SkyboxType, std::unique_ptr<IBLData>> skyboxes;
+	std::map<SkyboxType, ResourceHandle<IBLData>> skyboxes;
 	bool useIBL = true;
+	bool isStarted = false;
 
 	Shader* shaderProgram = nullptr;
+	Renderer* renderer = nullptr;
 	Cubemap* currentCubemap = nullptr;
 	IBLData* currentSky = nullptr;
+	SkyboxType currentSkyType = SkyboxComponent::DEFAULT_SKY;
+
+	/// <summary>
+	/// Returns the IBL data of a sky, which is loaded from the cache or created the first time
+	/// </summary>
+	IBLData* getSky(SkyboxType sky);
+
+	/// <summary>
+	/// Returns the directory of the faces of a sky
+	/// </summary>
+	static std::string getSkyPath(SkyboxType sky);
 };
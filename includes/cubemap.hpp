@@ -51,12 +51,28 @@ public:
 	/// </summary>
 	void bind() const;
 
+	/// <summary>
+	/// Returns the paths of the 6 faces of a cubemap stored as PNG files named: right left top bottom front back .png
+	/// </summary>
+	/// <param name="facesPath">The path to the PNG files</param>
+	static std::vector<std::string> getFacePaths(const std::string& facesPath);
+
 	/// <summary>
 	/// Generates mip levels for the cubemap
 	/// </summary>
 	static void generateMipMaps();
 
+	/// <summary>
+	/// Returns how many bytes the faces of the cubemap use on the GPU, 0 for cubemaps created from an existing OpenGL handle
+	/// </summary>
+	[[nodiscard]] size_t getByteSize() const;
+
 private:
+	/// <summary>
+	/// The number of bytes of the faces, with their mip levels if the cubemap uses mipmap filtering
+	/// </summary>
+	size_t byteSize = 0;
+
 	void createCubemapFromFaces();
 };
 
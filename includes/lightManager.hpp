@@ -24,6 +24,10 @@ public:
 	void sendToShader() const;
 
 private:
+	static constexpr Uniform NR_DIR_LIGHTS = Uniform("nrDirLights");
+	static constexpr Uniform NR_POINT_LIGHTS = Uniform("nrPointLights");
+	static constexpr Uniform NR_SPOT_LIGHTS = Uniform("nrSpotLights");
+
 	static LightManager instance;
 
 	LightManager();
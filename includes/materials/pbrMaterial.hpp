@@ -10,33 +10,33 @@
 struct PBRMaterial : public virtual Material
 {
 public:
-	static const std::string USED_MAPS;
-
-	static const std::string TEXTURE_ALBEDO;
-	static const std::string TEXTURE_NORMAL;
-	static const std::string TEXTURE_METALLIC;
-	static const std::string TEXTURE_ROUGHNESS;
-	static const std::string TEXTURE_AO;
-	static const std::string TEXTURE_OPACITY;
-	static const std::string TEXTURE_EMISSIVE;
-
-	static const std::string ALBEDO;
-	static const std::string METALLIC;
-	static const std::string ROUGHNESS;
-	static const std::string AO;
-	static const std::string OPACITY;
-
-	static const std::string IRRADIANCE_MAP;
-	static const std::string PREFILTER_MAP;
-	static const std::string BRDF_LUT;
-
-	static const std::string SHADOW_MAP;
-	static const std::string LIGHT_SPACE_MATRICES[4];
-	static const std::string CASCADE_PLANE_DISTANCES[3];
-	static const std::string CASCADE_COUNT;
-	static const std::string FAR_PLANE;
-
-	static const std::string SSAO_MAP;
+	static constexpr Uniform USED_MAPS = Uniform("material.used_maps");
+
+	static constexpr Uniform TEXTURE_ALBEDO = Uniform("material.texture_albedo");
+	static constexpr Uniform TEXTURE_NORMAL = Uniform("material.texture_normal");
+	static constexpr Uniform TEXTURE_METALLIC = Uniform("material.texture_metallic");
+	static constexpr Uniform TEXTURE_ROUGHNESS = Uniform("material.texture_roughness");
+	static constexpr Uniform TEXTURE_AO = Uniform("material.texture_ao");
+	static constexpr Uniform TEXTURE_OPACITY = Uniform("material.texture_opacity");
+	static constexpr Uniform TEXTURE_EMISSIVE = Uniform("material.texture_emissive");
+
+	static constexpr Uniform ALBEDO = Uniform("material.albedo");
+	static constexpr Uniform METALLIC = Uniform("material.metallic");
+	static constexpr Uniform ROUGHNESS = Uniform("material.roughness");
+	static constexpr Uniform AO = Uniform("material.ao");
+	static constexpr Uniform OPACITY = Uniform("material.opacity");
+
+	static constexpr Uniform IRRADIANCE_MAP = Uniform("irradianceMap");
+	static constexpr Uniform PREFILTER_MAP = Uniform("prefilterMap");
+	static constexpr Uniform BRDF_LUT = Uniform("brdfLUT");
+
+	static constexpr Uniform SHADOW_MAP = Uniform("shadowMap");
+	static constexpr Uniform LIGHT_SPACE_MATRICES = Uniform("lightSpaceMatrices");
+	static constexpr Uniform CASCADE_PLANE_DISTANCES = Uniform("cascadePlaneDistances");
+	static constexpr Uniform CASCADE_COUNT = Uniform("cascadeCount");
+	static constexpr Uniform FAR_PLANE = Uniform("farPlane");
+
+	static constexpr Uniform SSAO_MAP = Uniform("ssaoMap");
 
 	enum UsedMaps
 	{
@@ -52,17 +52,17 @@ public:
 	/// <summary>
 	/// The irradiance texture of the sky for diffuse IBL
 	/// </summary>
-	static Cubemap* irradianceMap;
+	static std::shared_ptr<Cubemap> irradianceMap;
 
 	/// <summary>
 	/// The prefiltered map of the sky for specular IBL
 	/// </summary>
-	static Cubemap* prefilterMap;
+	static std::shared_ptr<Cubemap> prefilterMap;
 
 	/// <summary>
 	/// The BRDF look up table for specular IBL
 	/// </summary>
-	static Texture* brdfLut;
+	static std::shared_ptr<Texture> brdfLut;
 
 	/// <summary>
 	/// The shadow map for shadow calculations
@@ -13,22 +13,22 @@
 struct PhongMaterial : public virtual Material
 {
 public:
-	static const std::string AMBIENT_COLOR;
-	static const std::string DIFFUSE_COLOR;
-	static const std::string SPECULAR_COLOR;
-	static const std::string SHININESS;
-
-	static const std::string USE_DIFFUSE_MAP;
-	static const std::string USE_SPECULAR_MAP;
-	static const std::string USE_NORMAL_MAP;
-	static const std::string USE_HEIGHT_MAP;
-	static const std::string USE_EMISSIVE_MAP;
-
-	static const std::string TEXTURE_DIFFUSE;
-	static const std::string TEXTURE_SPECULAR;
-	static const std::string TEXTURE_NORMAL;
-	static const std::string TEXTURE_HEIGHT;
-	static const std::string TEXTURE_EMISSIVE;
+	static constexpr Uniform AMBIENT_COLOR = Uniform("material.ambient");
+	static constexpr Uniform DIFFUSE_COLOR = Uniform("material.diffuse");
+	static constexpr Uniform SPECULAR_COLOR = Uniform("material.specular");
+	static constexpr Uniform SHININESS = Uniform("material.shininess");
+
+	static constexpr Uniform USE_DIFFUSE_MAP = Uniform("material.use_diffuse_map");
+	static constexpr Uniform USE_SPECULAR_MAP = Uniform("material.use_specular_map");
+	static constexpr Uniform USE_NORMAL_MAP = Uniform("material.use_normal_map");
+	static constexpr Uniform USE_HEIGHT_MAP = Uniform("material.use_height_map");
+	static constexpr Uniform USE_EMISSIVE_MAP = Uniform("material.use_emissive_map");
+
+	static constexpr Uniform TEXTURE_DIFFUSE = Uniform("material.texture_diffuse");
+	static constexpr Uniform TEXTURE_SPECULAR = Uniform("material.texture_specular");
+	static constexpr Uniform TEXTURE_NORMAL = Uniform("material.texture_normal");
+	static constexpr Uniform TEXTURE_HEIGHT = Uniform("material.texture_height");
+	static constexpr Uniform TEXTURE_EMISSIVE = Uniform("material.texture_emissive");
 
 	explicit PhongMaterial(Shader* shaderProgram);
 	PhongMaterial(Shader* shaderProgram, const std::shared_ptr<Texture>& texture);
@@ -1,8 +1,66 @@
 #pragma once
 
 #include <memory>
+#include <vector>
 
 #include <btBulletDynamicsCommon.h>
+#include <glm/glm.hpp>
+
+/// <summary>
+/// Frees a BVH that was deserialized in place in an aligned buffer
+/// </summary>
+struct BvhBufferDeleter
+{
+	void operator()(btOptimizedBvh* bvh) const
+	{
+		bvh->~btOptimizedBvh();
+		btAlignedFree(bvh);
+	}
+};
+
+/// <summary>
+/// The triangles of a triangle mesh collider, Bullet references them without copying them so they live as long as the collider
+/// </summary>
+struct ColliderMesh
+{
+	std::vector<btScalar> vertices;
+	std::vector<int> indices;
+	std::unique_ptr<btTriangleIndexVertexArray> meshInterface = nullptr;
+
+	/// <summary>
+	/// The BVH of the mesh when it was loaded from the cache, null when the shape built (and owns) its own BVH
+	/// </summary>
+	std::unique_ptr<btOptimizedBvh, BvhBufferDeleter> cachedBvh = nullptr;
+};
+
+/// <summary>
+/// The shape of a mesh collider, built once per mesh and shared by the colliders of all its instances
+/// The shape is unscaled, the colliders of scaled instances wrap it or build their own from the hulls
+/// </summary>
+struct ColliderShape
+{
+	/// <summary>
+	/// The triangles of triangle mesh shapes, declared before the shapes so they outlive them
+	/// </summary>
+	std::unique_ptr<ColliderMesh> mesh = nullptr;
+
+	/// <summary>
+	/// The hulls of convex shapes, moved for their center of mass to be at the origin of the shape
+	/// </summary>
+	std::vector<std::vector<glm::vec3>> hulls;
+
+	/// <summary>
+	/// Where the origin of the shape is in the mesh, the body is placed there relative to the mesh
+	/// </summary>
+	glm::vec3 centerOfMass = glm::vec3(0.0f);
+
+	/// <summary>
+	/// The children of compound shapes, Bullet doesn't own them so they are also declared before the shape
+	/// </summary>
+	std::vector<std::unique_ptr<btCollisionShape>> childShapes;
+
+	std::unique_ptr<btCollisionShape> shape = nullptr;
+};
 
 /// <summary>
 /// A wrapper struct that holds all the Bullet objects that need to be managed for a collider
@@ -10,7 +68,17 @@
 struct Collider
 {
 	btDiscreteDynamicsWorld* world = nullptr;
+
+	/// <summary>
+	/// The shape of mesh colliders, shared with the other instances of the mesh and declared before the shape so it outlives it
+	/// </summary>
+	std::shared_ptr<ColliderShape> meshShape = nullptr;
+
+	/// <summary>
+	/// The shape owned by the collider, null when it uses the shape of its mesh as is
+	/// </summary>
 	std::unique_ptr<btCollisionShape> collisionShape = nullptr;
+
 	std::unique_ptr<btDefaultMotionState> motionState = nullptr;
 	std::unique_ptr<btRigidBody> rigidBody = nullptr;
 
@@ -21,4 +89,4 @@ struct Collider
 		this->motionState = std::move(motionState);
 		this->rigidBody = std::move(rigidBody);
 	}
-};
+};
\ No newline at end of file
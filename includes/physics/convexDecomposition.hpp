@@ -0,0 +1,115 @@
+#pragma once
+
+#include <vector>
+
+#include <glm/glm.hpp>
+
+/// <summary>
+/// The settings of an approximate convex decomposition
+/// </summary>
+struct ConvexDecompositionSettings
+{
+	/// <summary>
+	/// The largest number of hulls a mesh is split in
+	/// </summary>
+	unsigned int maxHulls = 16;
+
+	/// <summary>
+	/// The largest number of vertices kept in each hull, the narrow phase cost of a hull grows with its vertex count
+	/// </summary>
+	unsigned int maxHullVertices = 32;
+
+	/// <summary>
+	/// A part of the mesh is split while its surface goes deeper than this inside its hull, relative to the size of the mesh
+	/// </summary>
+	float maxConcavity = 0.02f;
+};
+
+/// <summary>
+/// A utility class to generate convex colliders from render meshes
+/// </summary>
+class ConvexDecomposition
+{
+public:
+	/// <summary>
+	/// The number of split planes tried on each axis when splitting a part of a mesh
+	/// </summary>
+	static constexpr int SPLIT_CANDIDATES_PER_AXIS = 3;
+
+	/// <summary>
+	/// Parts with fewer triangles than this are never split
+	/// </summary>
+	static constexpr size_t MIN_PART_TRIANGLES = 4;
+
+	/// <summary>
+	/// Returns the vertices of the convex hull of a set of points, reduced to at most maxVertices
+	/// The kept vertices are the extreme points in evenly spread directions, so their hull fits inside the full one
+	/// </summary>
+	/// <param name="vertices">The positions of the points</param>
+	/// <param name="maxVertices">The largest number of vertices to keep</param>
+	static std::vector<glm::vec3> computeHull(const std::vector<float>& vertices, unsigned int maxVertices);
+
+	/// <summary>
+	/// Splits a mesh in parts that are close to convex and returns the reduced hull of each part
+	/// Parts are split in two with the plane that minimizes the volume of their hulls, the most concave part first,
+	/// until every part is convex enough or the hull budget is spent
+	/// </summary>
+	/// <param name="vertices">The positions of the mesh</param>
+	/// <param name="indices">The indices of the triangles of the mesh</param>
+	/// <param name="settings">The limits of the decomposition</param>
+	/// <returns>The vertices of each hull</returns>
+	static std::vector<std::vector<glm::vec3>> decompose(const std::vector<float>& vertices, const std::vector<unsigned int>& indices, const ConvexDecompositionSettings& settings);
+
+	/// <summary>
+	/// Returns the center of mass of a set of convex hulls of uniform density, the average of their points if they are all flat
+	/// </summary>
+	/// <param name="hulls">The vertices of each hull</param>
+	static glm::vec3 computeCenterOfMass(const std::vector<std::vector<glm::vec3>>& hulls);
+
+private:
+	/// <summary>
+	/// The convex hull of a part of a mesh, as the planes of its faces with their normals facing out
+	/// </summary>
+	struct HullData
+	{
+		std::vector<glm::vec3> vertices;
+		std::vector<glm::vec4> planes;
+		float volume = 0.0f;
+		glm::vec3 centroid = glm::vec3(0.0f);
+	};
+
+	/// <summary>
+	/// A set of triangles of the mesh being decomposed, with the reduced hull that becomes its collider
+	/// </summary>
+	struct Part
+	{
+		std::vector<unsigned int> triangles;
+		HullData hull;
+
+		/// <summary>
+		/// How deep the surface of the part goes inside its reduced hull, and the deepest vertex
+		/// </summary>
+		float concavity = 0.0f;
+		glm::vec3 deepestPoint = glm::vec3(0.0f);
+	};
+
+	/// <summary>
+	/// Computes the full convex hull of a set of points, empty if the points are all on a plane
+	/// </summary>
+	static HullData computeHullData(const std::vector<glm::vec3>& points);
+
+	/// <summary>
+	/// Returns the unique vertices used by a set of triangles
+	/// </summary>
+	static std::vector<glm::vec3> getPartPoints(const std::vector<float>& vertices, const std::vector<unsigned int>& indices, const std::vector<unsigned int>& triangles);
+
+	/// <summary>
+	/// Computes the reduced hull of a part and how concave it is
+	/// </summary>
+	static void evaluatePart(const std::vector<float>& vertices, const std::vector<unsigned int>& indices, unsigned int maxHullVertices, Part& part);
+
+	/// <summary>
+	/// Selects at most maxVertices extreme points of a point set
+	/// </summary>
+	static std::vector<glm::vec3> reduceHull(const std::vector<glm::vec3>& points, unsigned int maxVertices);
+};
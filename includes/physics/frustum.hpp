@@ -1,5 +1,7 @@
 #pragma once
 
+#include <array>
+
 #include "physics/plane.hpp"
 #include "components/cameraComponent.hpp"
 
@@ -17,6 +19,16 @@ struct Frustum
 	Plane farFace;
 	Plane nearFace;
 
+	/// <summary>
+	/// The position of the camera the frustum was built from
+	/// </summary>
+	glm::vec3 cameraPosition;
+
+	/// <summary>
+	/// How many pixels a unit length covers at a unit distance from the camera
+	/// </summary>
+	float projectionScale;
+
 	Frustum(CameraComponent* camera, glm::vec2 screenSize)
 	{
 		float halfVSide = CameraComponent::FAR * tanf(glm::radians(camera->getZoom()) * 0.5f);
@@ -35,6 +47,9 @@ struct Frustum
 		this->leftFace = { camPos, glm::cross(camUp, frontMultFar + camRight * halfHSide) };
 		this->topFace = { camPos, glm::cross(camRight, frontMultFar - camUp * halfVSide) };
 		this->bottomFace = { camPos, glm::cross(frontMultFar + camUp * halfVSide, camRight) };
+
+		this->cameraPosition = camPos;
+		this->projectionScale = screenSize.y / (2.0f * tanf(glm::radians(camera->getZoom()) * 0.5f));
 	}
 
 	bool isOnFrustum(BoundingBox element)
@@ -68,6 +83,14 @@ struct Frustum
 			this->farFace.isOnOrForwardPlane(newExtents, bbCenter));
 	}
 
+	/// <summary>
+	/// Returns the six planes of the frustum, facing inwards
+	/// </summary>
+	[[nodiscard]] std::array<Plane, 6> getPlanes() const
+	{
+		return { this->topFace, this->bottomFace, this->rightFace, this->leftFace, this->farFace, this->nearFace };
+	}
+
 	static std::vector<glm::vec4> getFrustumCornersWorldSpace(const glm::mat4& proj, const glm::mat4& view)
 	{
 		const auto inv = glm::inverse(proj * view);
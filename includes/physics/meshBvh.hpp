@@ -0,0 +1,227 @@
+#pragma once
+
+#include <cfloat>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "physics/boundingBox.hpp"
+
+/// <summary>
+/// A ray with a direction that doesn't need to be normalized, hits are reported as a distance along the direction
+/// </summary>
+struct Ray
+{
+	glm::vec3 origin = glm::vec3(0.0f);
+	glm::vec3 direction = glm::vec3(0.0f, 0.0f, -1.0f);
+
+	/// <summary>
+	/// The largest distance along the direction at which a hit is reported
+	/// </summary>
+	float maxDistance = FLT_MAX;
+};
+
+/// <summary>
+/// The closest intersection found along a ray
+/// </summary>
+struct RayHit
+{
+	static constexpr unsigned int NO_HIT = 0xFFFFFFFF;
+
+	/// <summary>
+	/// The distance of the hit along the ray direction
+	/// </summary>
+	float distance = FLT_MAX;
+
+	/// <summary>
+	/// The index of the triangle that was hit in the index buffer the BVH was built from, NO_HIT if nothing was hit
+	/// </summary>
+	unsigned int triangle = NO_HIT;
+
+	/// <summary>
+	/// The barycentric coordinates of the hit on the triangle, relative to its second and third vertices
+	/// </summary>
+	float u = 0.0f;
+	float v = 0.0f;
+
+	/// <summary>
+	/// The position of the hit
+	/// </summary>
+	glm::vec3 position = glm::vec3(0.0f);
+
+	/// <summary>
+	/// The normalized geometric normal of the triangle, following its counter clockwise winding
+	/// </summary>
+	glm::vec3 normal = glm::vec3(0.0f);
+
+	[[nodiscard]] bool hasHit() const { return this->triangle != NO_HIT; }
+};
+
+/// <summary>
+/// A group of rays traced together, rays with similar origins and directions (camera rays, decal projections) share most of their traversal
+/// </summary>
+struct RayPacket
+{
+	static constexpr unsigned int SIZE = 4;
+
+	Ray rays[SIZE];
+
+	/// <summary>
+	/// How many of the rays are used
+	/// </summary>
+	unsigned int count = SIZE;
+};
+
+/// <summary>
+/// A node of the BVH, interior nodes store their first child (the second one follows it), leaves their first triangle block
+/// </summary>
+struct BvhNode
+{
+	glm::vec3 minPosition = glm::vec3(0.0f);
+	unsigned int leftOrFirst = 0;
+	glm::vec3 maxPosition = glm::vec3(0.0f);
+
+	/// <summary>
+	/// The number of triangle blocks of a leaf, 0 for interior nodes
+	/// </summary>
+	unsigned int blockCount = 0;
+};
+
+/// <summary>
+/// Up to 4 triangles of a leaf stored in lanes (first vertex and two edges), so one ray is tested against all of them at once
+/// Unused lanes have null edges and never report hits
+/// </summary>
+struct TriangleBlock
+{
+	static constexpr unsigned int WIDTH = 4;
+
+	float v0x[WIDTH], v0y[WIDTH], v0z[WIDTH];
+	float e1x[WIDTH], e1y[WIDTH], e1z[WIDTH];
+	float e2x[WIDTH], e2y[WIDTH], e2z[WIDTH];
+
+	/// <summary>
+	/// The indices of the triangles in the source index buffer
+	/// </summary>
+	unsigned int triangles[WIDTH];
+};
+
+/// <summary>
+/// A bounding volume hierarchy over the triangles of a mesh, built with the surface area heuristic
+/// It keeps its own copy of the triangles so it can be shared by every instance of a mesh once the GPU buffers are uploaded
+/// </summary>
+class MeshBvh
+{
+public:
+	/// <summary>
+	/// The largest number of triangles kept in a leaf when splitting it isn't worth it
+	/// </summary>
+	static constexpr unsigned int MAX_LEAF_TRIANGLES = 8;
+
+	/// <summary>
+	/// The number of bins the centroids are sorted in when looking for the best split
+	/// </summary>
+	static constexpr unsigned int SAH_BIN_COUNT = 12;
+
+	/// <summary>
+	/// Builds the BVH of an indexed triangle mesh
+	/// </summary>
+	/// <param name="vertices">The positions of the mesh</param>
+	/// <param name="indices">The indices of the triangles</param>
+	MeshBvh(const std::vector<float>& vertices, const std::vector<unsigned int>& indices);
+
+	/// <summary>
+	/// Builds the BVH of a range of the index buffer of a mesh, like one of its levels of detail
+	/// </summary>
+	/// <param name="vertices">The positions of the mesh</param>
+	/// <param name="indices">The index buffer of the mesh</param>
+	/// <param name="indexOffset">The first index of the range</param>
+	/// <param name="indexCount">The number of indices in the range</param>
+	MeshBvh(const std::vector<float>& vertices, const std::vector<unsigned int>& indices, size_t indexOffset, size_t indexCount);
+
+	/// <summary>
+	/// Finds the closest triangle hit by a ray
+	/// </summary>
+	/// <param name="ray">The ray, in the space of the mesh</param>
+	/// <param name="hit">The closest hit, only overwritten by hits closer than its current distance</param>
+	/// <returns>True if a hit closer than the previous one was found</returns>
+	bool intersect(const Ray& ray, RayHit& hit) const;
+
+	/// <summary>
+	/// Finds the closest triangle hit by each ray of a packet, the nodes are traversed once for the whole packet
+	/// </summary>
+	/// <param name="packet">The rays, in the space of the mesh</param>
+	/// <param name="hits">The closest hit of each ray, only overwritten by closer hits</param>
+	void intersect(const RayPacket& packet, RayHit hits[RayPacket::SIZE]) const;
+
+	/// <summary>
+	/// Finds the closest triangle hit by each ray, the rays are traced in packets in the order they are given
+	/// </summary>
+	/// <param name="rays">The rays, in the space of the mesh</param>
+	/// <param name="hits">The closest hit of each ray, resized to the number of rays</param>
+	void intersect(const std::vector<Ray>& rays, std::vector<RayHit>& hits) const;
+
+	/// <summary>
+	/// Returns whether anything is hit by a ray, stopping at the first hit found (line of sight checks)
+	/// </summary>
+	/// <param name="ray">The ray, in the space of the mesh</param>
+	bool isOccluded(const Ray& ray) const;
+
+	/// <summary>
+	/// Returns the bounding box of all the triangles
+	/// </summary>
+	[[nodiscard]] BoundingBox getBoundingBox() const;
+
+	/// <summary>
+	/// Returns the number of triangles in the BVH
+	/// </summary>
+	[[nodiscard]] size_t getTriangleCount() const;
+
+	/// <summary>
+	/// Returns the number of nodes in the BVH
+	/// </summary>
+	[[nodiscard]] size_t getNodeCount() const;
+
+	/// <summary>
+	/// Returns the memory used by the nodes and triangles in bytes
+	/// </summary>
+	[[nodiscard]] size_t getMemoryUsage() const;
+
+private:
+	/// <summary>
+	/// The nodes, the root is the first one
+	/// </summary>
+	std::vector<BvhNode> nodes;
+
+	/// <summary>
+	/// The triangles, ordered so that each leaf references a contiguous range of blocks
+	/// </summary>
+	std::vector<TriangleBlock> blocks;
+
+	size_t triangleCount = 0;
+
+	void build(const std::vector<float>& vertices, const std::vector<unsigned int>& indices, size_t indexOffset, size_t indexCount);
+
+	/// <summary>
+	/// Below this depth nodes are split with the surface area heuristic, deeper nodes are split in halves
+	/// This bounds the depth of the tree, and so the size of the traversal stacks
+	/// </summary>
+	static constexpr unsigned int MAX_SAH_DEPTH = 32;
+	static constexpr unsigned int MAX_DEPTH = 64;
+
+	/// <summary>
+	/// Tests a ray against the 4 lanes of a block, updating the hit if one is closer than both its current distance and maxDistance
+	/// The normal of the hit is left unnormalized
+	/// </summary>
+	/// <returns>True if the hit was updated</returns>
+	static bool intersectBlock(const TriangleBlock& block, const glm::vec3& origin, const glm::vec3& direction, float maxDistance, RayHit& hit);
+
+	/// <summary>
+	/// Returns the distance at which a ray enters a node, or FLT_MAX if it misses it or enters it beyond maxDistance
+	/// </summary>
+	static float intersectNode(const BvhNode& node, const glm::vec3& origin, const glm::vec3& inverseDirection, float maxDistance);
+
+	/// <summary>
+	/// Fills the position and normalizes the normal of a hit once the closest triangle is known
+	/// </summary>
+	static void finalizeHit(const Ray& ray, RayHit& hit);
+};
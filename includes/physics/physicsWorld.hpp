@@ -1,31 +1,35 @@
 #pragma once
 
+#include <cstdint>
+#include <fstream>
+#include <functional>
 #include <vector>
 #include <map>
 #include <memory>
+#include <string>
 
 #include <btBulletDynamicsCommon.h>
 #include <BulletCollision/CollisionDispatch/btGhostObject.h>
 #include <glm/glm.hpp>
 
 #include <components/physicsComponent.hpp>
+#include "physics/convexDecomposition.hpp"
 
 // TODO : Make this cleaner
 class DebugDrawer : public btIDebugDraw
 {
 public:
-	std::vector<float> debugLines;
+	/// <summary>
+	/// The vertices of the debug lines drawn since the last clear, two per line
+	/// </summary>
+	std::vector<glm::vec3> debugLines;
 
 	DebugDrawer() : m_debugMode(DBG_DrawWireframe) {}
 
 	void drawLine(const btVector3& from, const btVector3& to, const btVector3& color) override
 	{
-		this->debugLines.push_back(from.x());
-		this->debugLines.push_back(from.y());
-		this->debugLines.push_back(from.z());
-		this->debugLines.push_back(to.x());
-		this->debugLines.push_back(to.y());
-		this->debugLines.push_back(to.z());
+		this->debugLines.emplace_back(from.x(), from.y(), from.z());
+		this->debugLines.emplace_back(to.x(), to.y(), to.z());
 	}
 
 	void drawContactPoint(const btVector3& PointOnB, const btVector3& normalOnB, btScalar distance, int lifeTime, const btVector3& color) override
@@ -75,6 +79,16 @@ public:
 	/// </summary>
 	bool enableDebugDraw = false;
 
+	/// <summary>
+	/// Whether the BVHs of triangle mesh colliders and the hulls of convex decompositions are saved to and loaded from the collision cache
+	/// </summary>
+	bool useCollisionCache = true;
+
+	/// <summary>
+	/// The directory where the collision data of meshes is cached, one file per mesh named after its hash
+	/// </summary>
+	std::string collisionCacheDirectory = "cache/collision";
+
 	PhysicsWorld();
 	~PhysicsWorld();
 
@@ -95,8 +109,19 @@ public:
 	/// <summary>
 	/// Returns the debug drawer lines
 	/// </summary>
-	/// <returns>A vector containing the float for the vertices of the debug lines</returns>
-	std::vector<float> getDebugLines() const;
+	/// <returns>A vector containing the vertices of the debug lines, two per line</returns>
+	[[nodiscard]] const std::vector<glm::vec3>& getDebugLines() const;
+
+	/// <summary>
+	/// Clears the debug drawer lines, this should be called once they have been drawn
+	/// </summary>
+	void clearDebugLines();
+
+	/// <summary>
+	/// Removes the colliders of a physics component from the simulation and destroys them
+	/// </summary>
+	/// <param name="component">The physics component whose colliders are removed</param>
+	void removeColliders(PhysicsComponent* component);
 
 	/// <summary>
 	/// Creates a new plane collider
@@ -136,7 +161,134 @@ public:
 	/// <param name="disableCollision">Whether collision testing should be disabled (if colliders are for raycasts only for example)</param>
 	void addCapsule(PhysicsComponent* component, float radius, float height, glm::vec3 position, float mass = 1.0f, bool disableCollision = false);
 
+	/// <summary>
+	/// Creates a new static triangle mesh collider, for exact collisions with level geometry
+	/// Its BVH is loaded from the collision cache if the same mesh was seen before, otherwise it is built and cached
+	/// </summary>
+	/// <param name="component">The physics component of the entity for which the collider is added</param>
+	/// <param name="vertices">The positions of the mesh</param>
+	/// <param name="indices">The indices of the triangles of the mesh</param>
+	/// <param name="transform">The transform of the mesh in the world, its scale is applied to the shape</param>
+	void addTriangleMesh(PhysicsComponent* component, const std::vector<float>& vertices, const std::vector<unsigned int>& indices, const glm::mat4& transform);
+
+	/// <summary>
+	/// Creates a new convex hull collider around the vertices of a mesh, for dynamic objects
+	/// The body rotates around the center of mass of the hull, the transform of the mesh is kept by the motion state
+	/// </summary>
+	/// <param name="component">The physics component of the entity for which the collider is added</param>
+	/// <param name="vertices">The positions of the mesh</param>
+	/// <param name="transform">The transform of the mesh in the world, its scale is applied to the shape</param>
+	/// <param name="mass">The mass of the object</param>
+	/// <param name="maxVertices">The largest number of vertices of the hull, fewer vertices make collisions cheaper</param>
+	void addConvexHull(PhysicsComponent* component, const std::vector<float>& vertices, const glm::mat4& transform, float mass = 1.0f, unsigned int maxVertices = 32);
+
+	/// <summary>
+	/// Creates a new collider made of the convex hulls of an approximate convex decomposition of a mesh, for dynamic concave objects
+	/// The hulls are loaded from the collision cache if the same mesh was decomposed with the same settings before, otherwise they are computed and cached
+	/// </summary>
+	/// <param name="component">The physics component of the entity for which the collider is added</param>
+	/// <param name="vertices">The positions of the mesh</param>
+	/// <param name="indices">The indices of the triangles of the mesh</param>
+	/// <param name="transform">The transform of the mesh in the world, its scale is applied to the shape</param>
+	/// <param name="mass">The mass of the object</param>
+	/// <param name="settings">The limits of the decomposition</param>
+	void addConvexDecomposition(PhysicsComponent* component, const std::vector<float>& vertices, const std::vector<unsigned int>& indices, const glm::mat4& transform, float mass = 1.0f, const ConvexDecompositionSettings& settings = ConvexDecompositionSettings());
+
+	/// <summary>
+	/// Creates a new collider for an instance of a mesh, sharing the shape of the mesh collider of another component
+	/// Only the body is created, at the transform of the instance, so a mesh referenced many times is only built and cached once
+	/// </summary>
+	/// <param name="component">The physics component of the instance</param>
+	/// <param name="source">The physics component whose mesh collider is shared</param>
+	/// <param name="transform">The transform of the instance in the world, its scale is applied to the shape</param>
+	/// <param name="mass">The mass of the object, ignored for triangle meshes which are always static</param>
+	void addColliderInstance(PhysicsComponent* component, const PhysicsComponent* source, const glm::mat4& transform, float mass = 1.0f);
+
 private:
+	/// <summary>
+	/// Identifies the files of the collision cache and their version, the version must change whenever their layout does
+	/// </summary>
+	static constexpr char COLLISION_CACHE_MAGIC[4] = { 'V', 'G', 'L', 'C' };
+	static constexpr uint32_t COLLISION_CACHE_VERSION = 1;
+	static constexpr char HULL_CACHE_MAGIC[4] = { 'V', 'G', 'L', 'H' };
+	static constexpr uint32_t HULL_CACHE_VERSION = 1;
+
+	/// <summary>
+	/// The largest number of points accepted for a hull read from the cache, larger counts mean the file is corrupted
+	/// </summary>
+	static constexpr uint32_t MAX_CACHED_HULL_POINTS = 65536;
+
+	/// <summary>
+	/// Creates the shape of a triangle mesh collider, its BVH is loaded from the collision cache or built and cached
+	/// </summary>
+	/// <returns>The shape, or null if the mesh has no triangles</returns>
+	std::shared_ptr<ColliderShape> createTriangleMeshShape(const std::vector<float>& vertices, const std::vector<unsigned int>& indices) const;
+
+	/// <summary>
+	/// Creates the shape of convex hulls, a single hull shape for one hull and a compound shape otherwise
+	/// The hulls are moved for their center of mass to be at the origin, so the body rotates around it and its inertia is computed about it
+	/// </summary>
+	static std::shared_ptr<ColliderShape> createConvexShape(const std::vector<std::vector<glm::vec3>>& hulls);
+
+	/// <summary>
+	/// Builds the Bullet shapes of the centered hulls of a shape
+	/// </summary>
+	static void buildConvexShape(ColliderShape& meshShape);
+
+	/// <summary>
+	/// Creates the rigid body of a mesh collider at a transform, the shape is used as is unless the transform is scaled
+	/// </summary>
+	void addMeshBody(PhysicsComponent* component, std::shared_ptr<ColliderShape> meshShape, const glm::mat4& transform, float mass);
+
+	/// <summary>
+	/// Splits a transform in the rotation and translation of a rigid body and the scale left to the shape
+	/// Mirroring is kept as a negative scale on x, shearing can't be represented and is dropped
+	/// </summary>
+	/// <param name="transform">The transform to split</param>
+	/// <param name="scale">Receives the scale on each axis</param>
+	/// <returns>The transform without its scale</returns>
+	static btTransform getRigidTransform(const glm::mat4& transform, btVector3& scale);
+
+	/// <summary>
+	/// Loads the BVH of a mesh from the collision cache
+	/// </summary>
+	/// <param name="meshHash">The hash of the mesh</param>
+	/// <param name="mesh">The mesh the BVH was built for</param>
+	/// <returns>The BVH, or null if it isn't cached or the cache file doesn't match the mesh</returns>
+	std::unique_ptr<btOptimizedBvh, BvhBufferDeleter> loadCachedBvh(uint64_t meshHash, const ColliderMesh& mesh) const;
+
+	/// <summary>
+	/// Saves the BVH of a mesh to the collision cache
+	/// </summary>
+	void saveCachedBvh(uint64_t meshHash, const ColliderMesh& mesh, btOptimizedBvh* bvh) const;
+
+	/// <summary>
+	/// Loads the hulls of a convex decomposition from the collision cache
+	/// </summary>
+	/// <param name="meshHash">The hash of the mesh and of the decomposition settings</param>
+	/// <param name="hulls">The vertices of each hull, filled if the hulls were found</param>
+	/// <returns>True if the hulls were loaded</returns>
+	bool loadCachedHulls(uint64_t meshHash, std::vector<std::vector<glm::vec3>>& hulls) const;
+
+	/// <summary>
+	/// Saves the hulls of a convex decomposition to the collision cache
+	/// </summary>
+	void saveCachedHulls(uint64_t meshHash, const std::vector<std::vector<glm::vec3>>& hulls) const;
+
+	/// <summary>
+	/// Writes a collision cache file, logging a warning when it fails
+	/// </summary>
+	/// <param name="path">The path of the cache file</param>
+	/// <param name="write">Writes the content of the file to the stream</param>
+	void writeCacheFile(const std::string& path, const std::function<void(std::ofstream&)>& write) const;
+
+	/// <summary>
+	/// Returns the path of the cache file of a mesh
+	/// </summary>
+	/// <param name="meshHash">The hash of the mesh</param>
+	/// <param name="extension">The extension of the file, which tells the kind of collision data it holds</param>
+	[[nodiscard]] std::string getCachePath(uint64_t meshHash, const std::string& extension) const;
+
 	/// <summary>
 	/// The Bullet collision configuration
 	/// </summary>
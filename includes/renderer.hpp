@@ -7,6 +7,7 @@
 #include "entity.hpp"
 #include "shaderManager.hpp"
 #include "renderTarget.hpp"
+#include "transientBuffer.hpp"
 #include "components/meshComponent.hpp"
 #include "physics/physicsWorld.hpp"
 #include "scene.hpp"
@@ -85,6 +86,17 @@ public:
 	void resizeFramebuffers(glm::vec2 newSize) const;
 
 private:
+	static constexpr Uniform VIEW_POS = Uniform("viewPos");
+	static constexpr Uniform CAM_POS = Uniform("camPos");
+	static constexpr Uniform WINDOW_SIZE = Uniform("windowSize");
+	static constexpr Uniform LIGHT_SPACE_MATRICES = Uniform("lightSpaceMatrices");
+	static constexpr Uniform G_POSITION = Uniform("gPosition");
+	static constexpr Uniform G_NORMAL = Uniform("gNormal");
+	static constexpr Uniform TEX_NOISE = Uniform("texNoise");
+	static constexpr Uniform NOISE_SCALE = Uniform("noiseScale");
+	static constexpr Uniform SAMPLES = Uniform("samples");
+	static constexpr Uniform SSAO_INPUT = Uniform("ssaoInput");
+
 	/// <summary>
 	/// The width in pixels of the shadow map
 	/// </summary>
@@ -100,6 +112,16 @@ private:
 	/// </summary>
 	static constexpr float SSAO_SCALE_FACTOR = 0.75;
 
+	/// <summary>
+	/// How many debug line vertices fit in a segment of the debug lines buffer before it grows
+	/// </summary>
+	static constexpr size_t DEBUG_LINES_INITIAL_CAPACITY = 65536;
+
+	/// <summary>
+	/// How much bigger the outline of a selected object is drawn compared to the object
+	/// </summary>
+	static constexpr float OUTLINE_SCALE = 1.1f;
+
 	/// <summary>
 	/// The render target in which everything is rendered
 	/// </summary>
@@ -161,14 +183,19 @@ private:
 	std::unique_ptr<Entity> ssaoBlurQuad;
 
 	/// <summary>
-	/// Debug lines vertices
+	/// Debug lines vertices, cleared every frame
+	/// </summary>
+	std::vector<glm::vec3> lineVerts;
+
+	/// <summary>
+	/// Debug lines vertices that persist between frames
 	/// </summary>
-	std::vector<float> lineVerts;
+	std::vector<glm::vec3> storedLineVerts;
 
 	/// <summary>
-	/// Debug lines vertices
+	/// The ring buffer that debug lines and bounding boxes are streamed into every frame
 	/// </summary>
-	std::vector<float> storedLineVerts;
+	std::unique_ptr<TransientBuffer> debugLinesBuffer;
 
 	// Creates a framebuffer with the size specified
 	void createFramebuffers(glm::vec2 lastWindowSize);
@@ -203,8 +230,8 @@ private:
 	/// <summary>
 	/// The outline pass, responsible for rendering the outline of selected objects
 	/// </summary>
-	/// <param name="outlineRenderables"></param>
-	void outlinePass(const std::vector<Entity*>& outlineRenderables);
+	/// <param name="outlineRenderList">The meshes that should have an outline, they must already be drawn to the stencil buffer</param>
+	void outlinePass(const std::vector<MeshComponent*>& outlineRenderList);
 
 	/// <summary>
 	/// The final pass, reponsible for resolving the multisampled framebuffer texture to the final texture for display
@@ -17,8 +17,8 @@ struct SortedSceneData
 	// Transparent entities that are rendered to the screen
 	// We use a double map that groups them by shader for performance, then by distance for correct rendering
 	std::map<Shader*, std::map<float, Entity*>> transparentRenderList;
-	// Entities that should have an outline
-	std::vector<Entity*> outlineRenderList;
+	// Meshes that should have an outline
+	std::vector<MeshComponent*> outlineRenderList;
 	// Entities that aren't rendered to the screen but need to be updated
 	std::vector<Entity*> logicEntities;
 	// The list of all meshes in the scene, for drawing geometry in the shadow or SSAO render passes
@@ -111,6 +111,14 @@ public:
 	/// <param name="entities">The entities to be recursed upon</param>
 	void getMeshesRecursively(Frustum& cameraFrustum, const std::vector<Entity*>& entities);
 
+	/// <summary>
+	/// Finds the closest raycastable mesh hit by a ray, among the meshes found by the last sort of the scene
+	/// </summary>
+	/// <param name="ray">The ray in world space</param>
+	/// <param name="hit">The closest hit in world space</param>
+	/// <returns>The entity of the mesh that was hit, or nullptr if nothing was hit</returns>
+	Entity* raycast(const Ray& ray, RayHit& hit) const;
+
 private:
 	/// <summary>
 	/// The list of entities contained in the scene
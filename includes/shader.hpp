@@ -2,11 +2,94 @@
 #define SHADER_HPP
 
 #include <string>
-#include <map>
+#include <cstdint>
+#include <unordered_map>
 
 #include <utilities/glad.h>
 #include <glm/glm.hpp>
 
+/// <summary>
+/// A handle to a shader uniform, identified by a FNV-1a hash of its name
+/// Handles built from string literals are hashed at compile time, and shaders resolve the location of each handle once when
+/// the program is linked, so setting a uniform never needs to build strings or query OpenGL
+/// </summary>
+struct Uniform
+{
+	/// <summary>
+	/// The hash of the full uniform name, as it would be passed to glGetUniformLocation
+	/// </summary>
+	uint32_t hash = Uniform::FNV_OFFSET_BASIS;
+
+	constexpr Uniform() = default;
+
+	/// <summary>
+	/// Creates a handle from the name of a uniform
+	/// </summary>
+	/// <param name="name">The name of the uniform in the shader</param>
+	constexpr Uniform(const char* name) : hash(Uniform::hashString(Uniform::FNV_OFFSET_BASIS, name)) {}
+
+	/// <summary>
+	/// Creates a handle from the name of a uniform
+	/// </summary>
+	/// <param name="name">The name of the uniform in the shader</param>
+	Uniform(const std::string& name) : Uniform(name.c_str()) {}
+
+	/// <summary>
+	/// Returns the handle for an element of an array uniform, this is the same as hashing "name[index]"
+	/// </summary>
+	/// <param name="index">The index of the element in the array</param>
+	constexpr Uniform at(unsigned int index) const
+	{
+		Uniform element;
+		element.hash = Uniform::hashChar(Uniform::hashIndex(Uniform::hashChar(this->hash, '['), index), ']');
+		return element;
+	}
+
+	/// <summary>
+	/// Returns the handle for a member of a struct uniform, this is the same as hashing "name.member"
+	/// </summary>
+	/// <param name="member">The name of the member in the struct</param>
+	constexpr Uniform member(const char* member) const
+	{
+		Uniform structMember;
+		structMember.hash = Uniform::hashString(Uniform::hashChar(this->hash, '.'), member);
+		return structMember;
+	}
+
+	constexpr bool operator==(const Uniform& other) const { return this->hash == other.hash; }
+	constexpr bool operator!=(const Uniform& other) const { return this->hash != other.hash; }
+
+private:
+	static constexpr uint32_t FNV_OFFSET_BASIS = 2166136261u;
+	static constexpr uint32_t FNV_PRIME = 16777619u;
+
+	static constexpr uint32_t hashChar(uint32_t hash, char c)
+	{
+		return (hash ^ static_cast<uint8_t>(c)) * Uniform::FNV_PRIME;
+	}
+
+	static constexpr uint32_t hashString(uint32_t hash, const char* str)
+	{
+		while (*str != '\0')
+			hash = Uniform::hashChar(hash, *str++);
+
+		return hash;
+	}
+
+	// Hashes the decimal digits of an index without building a string
+	static constexpr uint32_t hashIndex(uint32_t hash, unsigned int index)
+	{
+		unsigned int divisor = 1;
+		while (index / divisor >= 10)
+			divisor *= 10;
+
+		for (; divisor > 0; divisor /= 10)
+			hash = Uniform::hashChar(hash, static_cast<char>('0' + (index / divisor) % 10));
+
+		return hash;
+	}
+};
+
 // A class used to easily compile shaders from a given source and setup their data to be used by OpenGL
 // Also contains helper methods to easily modify the shader's uniforms
 class Shader
@@ -65,19 +148,27 @@ public:
 	bool compileShader();
 
 	GLuint getID() const;
+
+	/// <summary>
+	/// Returns the size of the linked program as reported by the driver, 0 if it isn't linked
+	/// </summary>
+	[[nodiscard]] size_t getByteSize() const;
 	
-	Shader* setBool(const std::string& name, bool value);
-	Shader* setInt(const std::string& name, int value);
-	Shader* setFloat(const std::string& name, float value);
-	Shader* setVec2(const std::string& name, const glm::vec2& value);
-	Shader* setVec2(const std::string& name, float x, float y);
-	Shader* setVec3(const std::string& name, const glm::vec3& value);
-	Shader* setVec3(const std::string& name, float x, float y, float z);
-	Shader* setVec4(const std::string& name, const glm::vec4& value);
-	Shader* setVec4(const std::string& name, float x, float y, float z, float w);
-	Shader* setMat2(const std::string& name, const glm::mat2& value);
-	Shader* setMat3(const std::string& name, const glm::mat3& value);
-	Shader* setMat4(const std::string& name, const glm::mat4& value);
+	Shader* setBool(Uniform uniform, bool value);
+	Shader* setInt(Uniform uniform, int value);
+	Shader* setFloat(Uniform uniform, float value);
+	Shader* setFloatArray(Uniform uniform, const float* values, int count);
+	Shader* setVec2(Uniform uniform, const glm::vec2& value);
+	Shader* setVec2(Uniform uniform, float x, float y);
+	Shader* setVec3(Uniform uniform, const glm::vec3& value);
+	Shader* setVec3(Uniform uniform, float x, float y, float z);
+	Shader* setVec3Array(Uniform uniform, const glm::vec3* values, int count);
+	Shader* setVec4(Uniform uniform, const glm::vec4& value);
+	Shader* setVec4(Uniform uniform, float x, float y, float z, float w);
+	Shader* setMat2(Uniform uniform, const glm::mat2& value);
+	Shader* setMat3(Uniform uniform, const glm::mat3& value);
+	Shader* setMat4(Uniform uniform, const glm::mat4& value);
+	Shader* setMat4Array(Uniform uniform, const glm::mat4* values, int count);
 
 private:
 	/// <summary>
@@ -86,11 +177,25 @@ private:
 	GLuint ID = 0;
 
 	/// <summary>
-	/// The shader keeps a cache of the uniform locations to improve runtime performance
+	/// The locations of all the active uniforms of the program, keyed by the hash of their name
+	/// This is filled once every time the program is linked
 	/// </summary>
-	std::map<std::string, GLuint> locationCache;
+	std::unordered_map<uint32_t, GLint> uniformLocations;
 
-	GLuint getUniformLocation(const std::string& uniformName);
+	/// <summary>
+	/// Queries the locations of all the active uniforms of the program, including every element of the arrays
+	/// </summary>
+	void resolveUniformLocations();
+
+	/// <summary>
+	/// Adds a uniform location to the lookup table
+	/// </summary>
+	void addUniformLocation(const std::string& uniformName, GLint location);
+
+	/// <summary>
+	/// Returns the location of a uniform, or -1 if the program has no such uniform (OpenGL silently ignores it)
+	/// </summary>
+	GLint getUniformLocation(Uniform uniform) const;
 };
 
 #endif
\ No newline at end of file
@@ -5,6 +5,7 @@
 #include "glm/glm.hpp"
 
 #include "shader.hpp"
+#include "utilities/resourceManager.hpp"
 
 enum class ShaderType
 {
@@ -34,9 +35,9 @@ class ShaderManager
 {
 public:
 	/// <summary>
-	/// Contains all currently loaded shaders
+	/// Contains all currently loaded shaders, the programs are owned by the ResourceManager
 	/// </summary>
-	std::map<ShaderType, Shader*> enumToShader;
+	std::map<ShaderType, ResourceHandle<Shader>> enumToShader;
 
 	ShaderManager();
 	~ShaderManager();
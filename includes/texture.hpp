@@ -1,10 +1,15 @@
 #ifndef TEXTURE_HPP
 #define TEXTURE_HPP
 
+#include <cstdint>
+#include <memory>
 #include <string>
 
 #include "utilities/glad.h"
 
+struct CompressedImage;
+struct MappedImage;
+
 enum class TextureType
 {
 	TEXTURE_DIFFUSE = 0, // Diffuse texture (Phong)
@@ -60,6 +65,27 @@ public:
 	/// </summary>
 	float height = 0;
 
+	/// <summary>
+	/// The compressed levels of a streamed texture, read from its mapped cache file whenever they are uploaded again after they are evicted, null for other textures
+	/// </summary>
+	std::shared_ptr<const MappedImage> streamedImage;
+
+	/// <summary>
+	/// The finest level of a streamed texture that is on the GPU
+	/// </summary>
+	int residentLevel = 0;
+
+	/// <summary>
+	/// The finest level of a streamed texture that is never evicted
+	/// </summary>
+	int floorLevel = 0;
+
+	/// <summary>
+	/// The finest level of a streamed texture requested during the frame lastRequestFrame
+	/// </summary>
+	int requestedLevel = 0;
+	uint64_t lastRequestFrame = 0;
+
 	Texture();
 
 	/// <summary>
@@ -88,11 +114,66 @@ public:
 	/// <param name="textureType">The type of texture to create</param>
 	Texture(GLuint texture, TextureType textureType);
 
+	/// <summary>
+	/// Creates a new texture from a block compressed image and its precomputed mip levels
+	/// </summary>
+	/// <param name="textureType">The type of texture to create</param>
+	/// <param name="image">The compressed image</param>
+	Texture(TextureType textureType, const CompressedImage& image);
+
 	~Texture();
 
 	void bindTexture() const;
 
+	/// <summary>
+	/// Creates the OpenGL texture from a data buffer, this lets textures be decoded on another thread and uploaded later on the main thread
+	/// </summary>
+	/// <param name="width">The width of the texture</param>
+	/// <param name="height">The height of the texture</param>
+	/// <param name="format">The format of the texture</param>
+	/// <param name="textureData">A pointer to the texture data, which must correspond in size to the width/height/format specified</param>
+	void upload(int width, int height, GLenum format, const void* textureData);
+
+	/// <summary>
+	/// Creates the OpenGL texture from a block compressed image, format is set to the uncompressed format with the same channels
+	/// </summary>
+	/// <param name="image">The compressed image with all its mip levels</param>
+	void uploadCompressed(const CompressedImage& image);
+
+	/// <summary>
+	/// Creates the OpenGL texture from a block compressed image with only its small levels, the finer levels are uploaded by the TextureStreamer when they are requested
+	/// </summary>
+	/// <param name="image">The compressed image mapped from its cache file, the mapping is kept by the texture</param>
+	void uploadStreamed(std::shared_ptr<const MappedImage> image);
+
+	/// <summary>
+	/// Uploads or frees the levels of a streamed texture so the given level is the finest one on the GPU
+	/// </summary>
+	/// <param name="level">The level, clamped between the full size level and the floor level</param>
+	void setResidentLevel(int level);
+
+	/// <summary>
+	/// Requests a level of a streamed texture for the current frame, the finest level requested during a frame is the one kept
+	/// </summary>
+	/// <param name="level">The level the texture is sampled at on screen</param>
+	void requestLevel(int level);
+
+	/// <summary>
+	/// Returns how many bytes the levels of a streamed texture use on the GPU, 0 for other textures
+	/// </summary>
+	[[nodiscard]] size_t getResidentByteSize() const;
+
+	/// <summary>
+	/// Returns how many bytes the texture uses on the GPU with its mip levels, 0 for textures created from an existing OpenGL handle
+	/// </summary>
+	[[nodiscard]] size_t getByteSize() const;
+
 private:
+	/// <summary>
+	/// The number of bytes of the levels uploaded when the texture was created, streamed textures compute theirs from their resident levels
+	/// </summary>
+	size_t byteSize = 0;
+
 	void createTexture(const std::string& filename, TextureType textureType, bool stbiFlipOnLoad = false);
 	void createHDRTexture(const std::string& filename, TextureType textureType, bool stbiFlipOnLoad = false);
 };
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <cstddef>
+
+#include <utilities/glad.h>
+#include <glm/glm.hpp>
+
+/// <summary>
+/// A ring buffer for geometry that is rebuilt every frame (debug lines, bounding boxes, gizmos)
+/// The buffer is split in segments: the CPU writes into one segment while the GPU may still be reading the previous ones,
+/// and a fence placed after each draw tells when a segment can be written to again
+/// Vertices are positions only, to be drawn with the solid shader
+/// </summary>
+class TransientBuffer
+{
+public:
+	/// <summary>
+	/// The number of segments in the ring
+	/// </summary>
+	static constexpr int SEGMENT_COUNT = 3;
+
+	/// <summary>
+	/// Creates a new transient buffer
+	/// </summary>
+	/// <param name="vertexCapacity">How many vertices each segment can hold, the buffer grows if a frame needs more</param>
+	explicit TransientBuffer(size_t vertexCapacity);
+	~TransientBuffer();
+
+	TransientBuffer(const TransientBuffer&) = delete;
+	TransientBuffer& operator=(const TransientBuffer&) = delete;
+
+	/// <summary>
+	/// Maps the next segment of the ring for writing, this waits for the GPU if it is still using that segment
+	/// </summary>
+	void begin();
+
+	/// <summary>
+	/// Reserves space for vertices in the current segment
+	/// </summary>
+	/// <param name="vertexCount">The number of vertices to reserve</param>
+	/// <returns>A pointer to write the vertices to, or nullptr if the segment is full</returns>
+	glm::vec3* allocate(size_t vertexCount);
+
+	/// <summary>
+	/// Copies vertices into the current segment, vertices that don't fit are dropped for this frame
+	/// </summary>
+	/// <param name="vertices">The vertices to copy</param>
+	/// <param name="vertexCount">The number of vertices</param>
+	void write(const glm::vec3* vertices, size_t vertexCount);
+
+	/// <summary>
+	/// Unmaps the current segment and draws the vertices that were written since begin()
+	/// </summary>
+	/// <param name="mode">The primitive type to draw</param>
+	void draw(GLenum mode);
+
+	/// <summary>
+	/// Returns how many vertices each segment can hold
+	/// </summary>
+	[[nodiscard]] size_t getVertexCapacity() const;
+
+private:
+	/// <summary>
+	/// A OpenGL handle for the vertex array object
+	/// </summary>
+	GLuint VAO = 0;
+
+	/// <summary>
+	/// A OpenGL handle for the buffer object containing all the segments
+	/// </summary>
+	GLuint VBO = 0;
+
+	/// <summary>
+	/// The fences placed after drawing each segment, null when the segment is free
+	/// </summary>
+	GLsync fences[SEGMENT_COUNT] = {};
+
+	/// <summary>
+	/// How many vertices each segment can hold
+	/// </summary>
+	size_t vertexCapacity = 0;
+
+	/// <summary>
+	/// The index of the segment being written
+	/// </summary>
+	int currentSegment = 0;
+
+	/// <summary>
+	/// A pointer to the mapped memory of the current segment, null when nothing is mapped
+	/// </summary>
+	glm::vec3* mappedVertices = nullptr;
+
+	/// <summary>
+	/// How many vertices were written to the current segment
+	/// </summary>
+	size_t writtenVertices = 0;
+
+	/// <summary>
+	/// How many vertices were asked for since begin(), including the ones that didn't fit
+	/// </summary>
+	size_t requestedVertices = 0;
+
+	/// <summary>
+	/// Reallocates the buffer with a new capacity per segment
+	/// </summary>
+	void resize(size_t newVertexCapacity);
+
+	/// <summary>
+	/// Waits until the GPU is done reading a segment
+	/// </summary>
+	void waitForSegment(int segment);
+};
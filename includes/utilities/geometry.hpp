@@ -1,14 +1,19 @@
 #pragma once
 
+#include <cassert>
+#include <cfloat>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
 #include <vector>
-#include <unordered_set>
-#include <unordered_map>
+#include <algorithm>
+#include <iterator>
 
 #include <glm/glm/ext/scalar_constants.hpp>
-#define GLM_ENABLE_EXPERIMENTAL
-#include <glm/gtx/hash.hpp>
 
 #include <physics/boundingBox.hpp>
+#include <physics/plane.hpp>
+#include <utilities/parallel.hpp>
 
 struct VertexData
 {
@@ -21,6 +26,183 @@ struct VertexDataIndices
 	std::vector<float> vertices;
 	std::vector<unsigned int> indices;
 	std::vector<float> normals;
+	std::vector<float> texCoords;
+};
+
+/// <summary>
+/// The result of simulating a FIFO post-transform vertex cache on an index buffer
+/// </summary>
+struct VertexCacheStatistics
+{
+	size_t cacheMisses = 0;
+	size_t triangleCount = 0;
+	size_t vertexCount = 0;
+
+	/// <summary>
+	/// Average cache miss ratio, the number of transformed vertices per triangle (0.5 is optimal for large meshes, 3 is the worst)
+	/// </summary>
+	float getACMR() const
+	{
+		return this->triangleCount == 0 ? 0.0f : static_cast<float>(this->cacheMisses) / static_cast<float>(this->triangleCount);
+	}
+
+	/// <summary>
+	/// Average transform to vertex ratio, the number of times each vertex is transformed (1 is optimal)
+	/// </summary>
+	float getATVR() const
+	{
+		return this->vertexCount == 0 ? 0.0f : static_cast<float>(this->cacheMisses) / static_cast<float>(this->vertexCount);
+	}
+
+	VertexCacheStatistics& operator+=(const VertexCacheStatistics& other)
+	{
+		this->cacheMisses += other.cacheMisses;
+		this->triangleCount += other.triangleCount;
+		this->vertexCount += other.vertexCount;
+		return *this;
+	}
+};
+
+/// <summary>
+/// A vertex attribute that is compared when welding vertices
+/// </summary>
+struct WeldAttribute
+{
+	/// <summary>
+	/// The attribute values, componentCount values per vertex
+	/// </summary>
+	const std::vector<float>* values = nullptr;
+
+	/// <summary>
+	/// The number of values per vertex
+	/// </summary>
+	unsigned int componentCount = 3;
+
+	/// <summary>
+	/// Values at most epsilon apart are considered equal, 0 only merges identical values
+	/// </summary>
+	float epsilon = 0.0f;
+};
+
+/// <summary>
+/// A symmetric 4x4 matrix summing the squared distances of a point to a set of planes, used to measure the error of simplifying a mesh
+/// </summary>
+struct Quadric
+{
+	double a2 = 0.0, ab = 0.0, ac = 0.0, ad = 0.0;
+	double b2 = 0.0, bc = 0.0, bd = 0.0;
+	double c2 = 0.0, cd = 0.0;
+	double d2 = 0.0;
+
+	/// <summary>
+	/// The sum of the weights of the planes
+	/// </summary>
+	double weight = 0.0;
+
+	/// <summary>
+	/// Creates the quadric of the plane ax + by + cz + d = 0, the normal (a, b, c) must be normalized
+	/// </summary>
+	static Quadric fromPlane(double a, double b, double c, double d, double weight)
+	{
+		Quadric quadric;
+		quadric.a2 = a * a * weight; quadric.ab = a * b * weight; quadric.ac = a * c * weight; quadric.ad = a * d * weight;
+		quadric.b2 = b * b * weight; quadric.bc = b * c * weight; quadric.bd = b * d * weight;
+		quadric.c2 = c * c * weight; quadric.cd = c * d * weight;
+		quadric.d2 = d * d * weight;
+		quadric.weight = weight;
+		return quadric;
+	}
+
+	/// <summary>
+	/// Returns the weighted average of the squared distances of a point to the planes
+	/// </summary>
+	double getError(const glm::vec3& point) const
+	{
+		double x = point.x, y = point.y, z = point.z;
+
+		double error = this->a2 * x * x + 2.0 * this->ab * x * y + 2.0 * this->ac * x * z + 2.0 * this->ad * x
+			+ this->b2 * y * y + 2.0 * this->bc * y * z + 2.0 * this->bd * y
+			+ this->c2 * z * z + 2.0 * this->cd * z
+			+ this->d2;
+
+		return this->weight > 0.0 ? std::max(error, 0.0) / this->weight : 0.0;
+	}
+
+	Quadric& operator+=(const Quadric& other)
+	{
+		this->a2 += other.a2; this->ab += other.ab; this->ac += other.ac; this->ad += other.ad;
+		this->b2 += other.b2; this->bc += other.bc; this->bd += other.bd;
+		this->c2 += other.c2; this->cd += other.cd;
+		this->d2 += other.d2;
+		this->weight += other.weight;
+		return *this;
+	}
+};
+
+/// <summary>
+/// A contiguous range of an index buffer
+/// </summary>
+struct IndexRange
+{
+	unsigned int offset = 0;
+	unsigned int count = 0;
+};
+
+/// <summary>
+/// A small cluster of neighboring triangles of a mesh, with the bounds used to cull it
+/// </summary>
+struct Meshlet
+{
+	/// <summary>
+	/// The first index of the cluster in the index buffer
+	/// </summary>
+	unsigned int indexOffset = 0;
+
+	/// <summary>
+	/// The number of indices of the cluster
+	/// </summary>
+	unsigned int indexCount = 0;
+
+	/// <summary>
+	/// The bounding sphere of the cluster in object space
+	/// </summary>
+	glm::vec3 center = glm::vec3(0.0f);
+	float radius = 0.0f;
+
+	/// <summary>
+	/// The normal cone of the cluster, it faces away from any viewer for which dot(normalize(coneApex - viewer), coneAxis) >= coneCutoff
+	/// A cluster whose normals are too spread out has a null axis and is never backface culled
+	/// </summary>
+	glm::vec3 coneApex = glm::vec3(0.0f);
+	glm::vec3 coneAxis = glm::vec3(0.0f);
+	float coneCutoff = 1.0f;
+};
+
+/// <summary>
+/// A level of detail of a mesh, a range of its index buffer drawn with the same vertices
+/// </summary>
+struct MeshLod
+{
+	/// <summary>
+	/// The first index of the level in the index buffer
+	/// </summary>
+	unsigned int indexOffset = 0;
+
+	/// <summary>
+	/// The number of indices of the level
+	/// </summary>
+	unsigned int indexCount = 0;
+
+	/// <summary>
+	/// The simplification error of the level relative to the size of the mesh
+	/// </summary>
+	float error = 0.0f;
+
+	/// <summary>
+	/// The meshlets covering the indices of the level, a level without meshlets is always drawn whole
+	/// </summary>
+	unsigned int meshletOffset = 0;
+	unsigned int meshletCount = 0;
 };
 
 /// <summary>
@@ -30,61 +212,197 @@ class Geometry
 {
 public:
 	/// <summary>
-	/// Returns a vector containing the vertices for a cube
+	/// The size of the FIFO vertex cache that index buffers are optimized for
 	/// </summary>
-	/// <returns>A vector of floats</returns>
-	static std::vector<float> getCubeVertices()
-	{
-		std::vector<float> cubeVertices = {
-			-1.0f, -1.0f, -1.0f,
-			-1.0f, -1.0f, 1.0f,
-			-1.0f, 1.0f, 1.0f,
+	static constexpr unsigned int VERTEX_CACHE_SIZE = 16;
+
+	/// <summary>
+	/// The maximum number of vertices and triangles of a meshlet
+	/// </summary>
+	static constexpr unsigned int MESHLET_MAX_VERTICES = 64;
+	static constexpr unsigned int MESHLET_MAX_TRIANGLES = 124;
 
-			1.0f, 1.0f, -1.0f,
-			-1.0f, -1.0f, -1.0f,
-			-1.0f, 1.0f, -1.0f,
+	/// <summary>
+	/// The vertices of a cube
+	/// </summary>
+	static constexpr float CUBE_VERTICES[] = {
+		-1.0f, -1.0f, -1.0f,
+		-1.0f, -1.0f, 1.0f,
+		-1.0f, 1.0f, 1.0f,
 
-			1.0f, -1.0f, 1.0f,
-			-1.0f, -1.0f, -1.0f,
-			1.0f, -1.0f, -1.0f,
+		1.0f, 1.0f, -1.0f,
+		-1.0f, -1.0f, -1.0f,
+		-1.0f, 1.0f, -1.0f,
 
-			1.0f, 1.0f, -1.0f,
-			1.0f, -1.0f, -1.0f,
-			-1.0f, -1.0f, -1.0f,
+		1.0f, -1.0f, 1.0f,
+		-1.0f, -1.0f, -1.0f,
+		1.0f, -1.0f, -1.0f,
 
-			-1.0f, -1.0f, -1.0f,
-			-1.0f, 1.0f, 1.0f,
-			-1.0f, 1.0f, -1.0f,
+		1.0f, 1.0f, -1.0f,
+		1.0f, -1.0f, -1.0f,
+		-1.0f, -1.0f, -1.0f,
 
-			1.0f, -1.0f, 1.0f,
-			-1.0f, -1.0f, 1.0f,
-			-1.0f, -1.0f, -1.0f,
+		-1.0f, -1.0f, -1.0f,
+		-1.0f, 1.0f, 1.0f,
+		-1.0f, 1.0f, -1.0f,
 
-			-1.0f, 1.0f, 1.0f,
-			-1.0f, -1.0f, 1.0f,
-			1.0f, -1.0f, 1.0f,
+		1.0f, -1.0f, 1.0f,
+		-1.0f, -1.0f, 1.0f,
+		-1.0f, -1.0f, -1.0f,
 
-			1.0f, 1.0f, 1.0f,
-			1.0f, -1.0f, -1.0f,
-			1.0f, 1.0f, -1.0f,
+		-1.0f, 1.0f, 1.0f,
+		-1.0f, -1.0f, 1.0f,
+		1.0f, -1.0f, 1.0f,
 
-			1.0f, -1.0f, -1.0f,
-			1.0f, 1.0f, 1.0f,
-			1.0f, -1.0f, 1.0f,
+		1.0f, 1.0f, 1.0f,
+		1.0f, -1.0f, -1.0f,
+		1.0f, 1.0f, -1.0f,
 
-			1.0f, 1.0f, 1.0f,
-			1.0f, 1.0f, -1.0f,
-			-1.0f, 1.0f, -1.0f,
+		1.0f, -1.0f, -1.0f,
+		1.0f, 1.0f, 1.0f,
+		1.0f, -1.0f, 1.0f,
 
-			1.0f, 1.0f, 1.0f,
-			-1.0f, 1.0f, -1.0f,
-			-1.0f, 1.0f, 1.0f,
+		1.0f, 1.0f, 1.0f,
+		1.0f, 1.0f, -1.0f,
+		-1.0f, 1.0f, -1.0f,
 
-			1.0f, 1.0f, 1.0f,
-			-1.0f, 1.0f, 1.0f,
-			1.0f, -1.0f, 1.0f
-		};
+		1.0f, 1.0f, 1.0f,
+		-1.0f, 1.0f, -1.0f,
+		-1.0f, 1.0f, 1.0f,
+
+		1.0f, 1.0f, 1.0f,
+		-1.0f, 1.0f, 1.0f,
+		1.0f, -1.0f, 1.0f
+	};
+
+	/// <summary>
+	/// The vertices of a cube arranged in clockwise order
+	/// </summary>
+	static constexpr float CLOCKWISE_CUBE_VERTICES[] = {
+		-1.0f, 1.0f, -1.0f,
+		-1.0f, -1.0f, -1.0f,
+		1.0f, -1.0f, -1.0f,
+		1.0f, -1.0f, -1.0f,
+		1.0f, 1.0f, -1.0f,
+		-1.0f, 1.0f, -1.0f,
+
+		-1.0f, -1.0f, 1.0f,
+		-1.0f, -1.0f, -1.0f,
+		-1.0f, 1.0f, -1.0f,
+		-1.0f, 1.0f, -1.0f,
+		-1.0f, 1.0f, 1.0f,
+		-1.0f, -1.0f, 1.0f,
+
+		1.0f, -1.0f, -1.0f,
+		1.0f, -1.0f, 1.0f,
+		1.0f, 1.0f, 1.0f,
+		1.0f, 1.0f, 1.0f,
+		1.0f, 1.0f, -1.0f,
+		1.0f, -1.0f, -1.0f,
+
+		-1.0f, -1.0f, 1.0f,
+		-1.0f, 1.0f, 1.0f,
+		1.0f, 1.0f, 1.0f,
+		1.0f, 1.0f, 1.0f,
+		1.0f, -1.0f, 1.0f,
+		-1.0f, -1.0f, 1.0f,
+
+		-1.0f, 1.0f, -1.0f,
+		1.0f, 1.0f, -1.0f,
+		1.0f, 1.0f, 1.0f,
+		1.0f, 1.0f, 1.0f,
+		-1.0f, 1.0f, 1.0f,
+		-1.0f, 1.0f, -1.0f,
+
+		-1.0f, -1.0f, -1.0f,
+		-1.0f, -1.0f, 1.0f,
+		1.0f, -1.0f, -1.0f,
+		1.0f, -1.0f, -1.0f,
+		-1.0f, -1.0f, 1.0f,
+		1.0f, -1.0f, 1.0f,
+	};
+
+	/// <summary>
+	/// The vertices of a quad
+	/// </summary>
+	static constexpr float QUAD_VERTICES[] = {
+		-1.0f, 1.0f, 0.0f, // Top left
+		-1.0f, -1.0f, 0.0f, // Bottom left
+		1.0f, 1.0f, 0.0f, // Top right
+
+		1.0f, 1.0f, 0.0f, // Top right
+		-1.0f, -1.0f, 0.0f, // Bottom left
+		1.0f, -1.0f, 0.0f, // Bottom right
+	};
+
+	/// <summary>
+	/// The texture coordinates of a quad
+	/// </summary>
+	static constexpr float QUAD_TEX_COORDS[] = {
+		0.0f, 1.0f, // Top left
+		0.0f, 0.0f, // Bottom left
+		1.0f, 1.0f, // Top right
+
+		1.0f, 1.0f, // Top right
+		0.0f, 0.0f, // Bottom left
+		1.0f, 0.0f, // Bottom right
+	};
+
+	/// <summary>
+	/// The vertices of an indexed cube, each face has its own 4 vertices so it can have its own normal and texture coordinates
+	/// </summary>
+	static constexpr float INDEXED_CUBE_VERTICES[] = {
+		1.0f, -1.0f, 1.0f, 1.0f, -1.0f, -1.0f, 1.0f, 1.0f, -1.0f, 1.0f, 1.0f, 1.0f, // +X
+		-1.0f, -1.0f, -1.0f, -1.0f, -1.0f, 1.0f, -1.0f, 1.0f, 1.0f, -1.0f, 1.0f, -1.0f, // -X
+		-1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, -1.0f, -1.0f, 1.0f, -1.0f, // +Y
+		-1.0f, -1.0f, -1.0f, 1.0f, -1.0f, -1.0f, 1.0f, -1.0f, 1.0f, -1.0f, -1.0f, 1.0f, // -Y
+		-1.0f, -1.0f, 1.0f, 1.0f, -1.0f, 1.0f, 1.0f, 1.0f, 1.0f, -1.0f, 1.0f, 1.0f, // +Z
+		1.0f, -1.0f, -1.0f, -1.0f, -1.0f, -1.0f, -1.0f, 1.0f, -1.0f, 1.0f, 1.0f, -1.0f, // -Z
+	};
+
+	/// <summary>
+	/// The normals of an indexed cube
+	/// </summary>
+	static constexpr float INDEXED_CUBE_NORMALS[] = {
+		1.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f,
+		-1.0f, 0.0f, 0.0f, -1.0f, 0.0f, 0.0f, -1.0f, 0.0f, 0.0f, -1.0f, 0.0f, 0.0f,
+		0.0f, 1.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 1.0f, 0.0f,
+		0.0f, -1.0f, 0.0f, 0.0f, -1.0f, 0.0f, 0.0f, -1.0f, 0.0f, 0.0f, -1.0f, 0.0f,
+		0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 1.0f,
+		0.0f, 0.0f, -1.0f, 0.0f, 0.0f, -1.0f, 0.0f, 0.0f, -1.0f, 0.0f, 0.0f, -1.0f,
+	};
+
+	/// <summary>
+	/// The texture coordinates of an indexed cube, the same for every face
+	/// </summary>
+	static constexpr float INDEXED_CUBE_TEX_COORDS[] = {
+		0.0f, 0.0f, 1.0f, 0.0f, 1.0f, 1.0f, 0.0f, 1.0f,
+		0.0f, 0.0f, 1.0f, 0.0f, 1.0f, 1.0f, 0.0f, 1.0f,
+		0.0f, 0.0f, 1.0f, 0.0f, 1.0f, 1.0f, 0.0f, 1.0f,
+		0.0f, 0.0f, 1.0f, 0.0f, 1.0f, 1.0f, 0.0f, 1.0f,
+		0.0f, 0.0f, 1.0f, 0.0f, 1.0f, 1.0f, 0.0f, 1.0f,
+		0.0f, 0.0f, 1.0f, 0.0f, 1.0f, 1.0f, 0.0f, 1.0f,
+	};
 
+	/// <summary>
+	/// The indices of an indexed cube, two counter clockwise triangles per face
+	/// </summary>
+	static constexpr unsigned int INDEXED_CUBE_INDICES[] = {
+		0, 1, 2, 0, 2, 3,
+		4, 5, 6, 4, 6, 7,
+		8, 9, 10, 8, 10, 11,
+		12, 13, 14, 12, 14, 15,
+		16, 17, 18, 16, 18, 19,
+		20, 21, 22, 20, 22, 23,
+	};
+
+	/// <summary>
+	/// Returns a vector containing the vertices for a cube, the vector is only built once
+	/// </summary>
+	/// <returns>A vector of floats</returns>
+	static const std::vector<float>& getCubeVertices()
+	{
+		static const std::vector<float> cubeVertices(std::begin(CUBE_VERTICES), std::end(CUBE_VERTICES));
 		return cubeVertices;
 	}
 
@@ -92,10 +410,9 @@ public:
 	/// Returns a vector containing the vertices for a cube arranged in clockwise order (face culling only shows the interior faces, used for skyboxes for example)
 	/// </summary>
 	/// <returns>A vector of floats</returns>
-	static std::vector<float> getClockwiseCubeVertices()
+	static const std::vector<float>& getClockwiseCubeVertices()
 	{
-		std::vector<float> cubeVertices = { -1.0f,  1.0f, -1.0f, -1.0f, -1.0f, -1.0f, 1.0f, -1.0f, -1.0f, 1.0f, -1.0f, -1.0f, 1.0f,  1.0f, -1.0f, -1.0f,  1.0f, -1.0f, -1.0f, -1.0f,  1.0f, -1.0f, -1.0f, -1.0f, -1.0f,  1.0f, -1.0f, -1.0f,  1.0f, -1.0f, -1.0f,  1.0f,  1.0f, -1.0f, -1.0f,  1.0f, 1.0f, -1.0f, -1.0f, 1.0f, -1.0f,  1.0f, 1.0f,  1.0f,  1.0f, 1.0f,  1.0f,  1.0f, 1.0f,  1.0f, -1.0f, 1.0f, -1.0f, -1.0f, -1.0f, -1.0f,  1.0f, -1.0f,  1.0f,  1.0f, 1.0f,  1.0f,  1.0f, 1.0f,  1.0f,  1.0f, 1.0f, -1.0f,  1.0f, -1.0f, -1.0f,  1.0f, -1.0f,  1.0f, -1.0f, 1.0f,  1.0f, -1.0f, 1.0f,  1.0f,  1.0f, 1.0f,  1.0f,  1.0f, -1.0f,  1.0f,  1.0f, -1.0f,  1.0f, -1.0f, -1.0f, -1.0f, -1.0f, -1.0f, -1.0f,  1.0f, 1.0f, -1.0f, -1.0f, 1.0f, -1.0f, -1.0f, -1.0f, -1.0f,  1.0f, 1.0f, -1.0f,  1.0f };
-
+		static const std::vector<float> cubeVertices(std::begin(CLOCKWISE_CUBE_VERTICES), std::end(CLOCKWISE_CUBE_VERTICES));
 		return cubeVertices;
 	}
 
@@ -103,17 +420,9 @@ public:
 	/// Returns a vector containing the vertices for a quad
 	/// </summary>
 	/// <returns>A vector of floats</returns>
-	static std::vector<float> getQuadVertices()
+	static const std::vector<float>& getQuadVertices()
 	{
-		std::vector<float> quadVertices = {
-			-1.0f, 1.0f, 0.0f, // Top left
-			-1.0f, -1.0f, 0.0f, // Bottom left
-			1.0f, 1.0f, 0.0f, // Top right
-
-			1.0f, 1.0f, 0.0f, // Top right
-			-1.0f, -1.0f, 0.0f, // Bottom left
-			1.0f, -1.0f, 0.0f, // Bottom right
-		};
+		static const std::vector<float> quadVertices(std::begin(QUAD_VERTICES), std::end(QUAD_VERTICES));
 		return quadVertices;
 	}
 
@@ -121,20 +430,92 @@ public:
 	/// Returns a vector containing the texture coordinates for a quad
 	/// </summary>
 	/// <returns>A vector of floats</returns>
-	static std::vector<float> getQuadTexCoords()
+	static const std::vector<float>& getQuadTexCoords()
 	{
-		std::vector<float> quadTexCoords = {
-			0.0f, 1.0f, // Top left
-			0.0f, 0.0f, // Bottom left
-			1.0f, 1.0f, // Top right
-
-			1.0f, 1.0f, // Top right
-			0.0f, 0.0f, // Bottom left
-			1.0f, 0.0f, // Bottom right
-		};
+		static const std::vector<float> quadTexCoords(std::begin(QUAD_TEX_COORDS), std::end(QUAD_TEX_COORDS));
 		return quadTexCoords;
 	}
 
+	/// <summary>
+	/// Returns an indexed cube with normals and texture coordinates
+	/// </summary>
+	static VertexDataIndices getIndexedCube()
+	{
+		VertexDataIndices cube;
+		cube.vertices.assign(std::begin(INDEXED_CUBE_VERTICES), std::end(INDEXED_CUBE_VERTICES));
+		cube.normals.assign(std::begin(INDEXED_CUBE_NORMALS), std::end(INDEXED_CUBE_NORMALS));
+		cube.texCoords.assign(std::begin(INDEXED_CUBE_TEX_COORDS), std::end(INDEXED_CUBE_TEX_COORDS));
+		cube.indices.assign(std::begin(INDEXED_CUBE_INDICES), std::end(INDEXED_CUBE_INDICES));
+
+		return cube;
+	}
+
+	/// <summary>
+	/// Returns an indexed unit sphere, it has a vertex at each pole and slices vertices on each of the stacks - 1 rings in between
+	/// This is the same mesh as getSphereVertices, generated directly with indices
+	/// </summary>
+	/// <param name="slices">The number of subdivisions around the vertical axis</param>
+	/// <param name="stacks">The number of subdivisions from pole to pole</param>
+	static VertexDataIndices getIndexedSphere(int slices, int stacks)
+	{
+		assert(slices >= 3 && stacks >= 2 && "A sphere needs at least 3 slices and 2 stacks!");
+
+		const auto ringCount = static_cast<unsigned int>(stacks - 1);
+		const auto ringSize = static_cast<unsigned int>(slices);
+		const unsigned int vertexCount = ringCount * ringSize + 2;
+		const unsigned int bottomVertex = vertexCount - 1;
+
+		VertexDataIndices sphere;
+		sphere.vertices.reserve(vertexCount * 3);
+		sphere.indices.reserve((ringSize * 2 + (ringCount - 1) * ringSize * 2) * 3);
+
+		// Top vertex
+		sphere.vertices.insert(sphere.vertices.end(), { 0.0f, 1.0f, 0.0f });
+
+		for (int i = 0; i < stacks - 1; i++)
+		{
+			float phi = glm::pi<float>() * static_cast<float>(i + 1) / static_cast<float>(stacks);
+
+			for (int j = 0; j < slices; j++)
+			{
+				float theta = 2.0f * glm::pi<float>() * static_cast<float>(j) / static_cast<float>(slices);
+				sphere.vertices.insert(sphere.vertices.end(), { std::sin(phi) * std::cos(theta), std::cos(phi), std::sin(phi) * std::sin(theta) });
+			}
+		}
+
+		// Bottom vertex
+		sphere.vertices.insert(sphere.vertices.end(), { 0.0f, -1.0f, 0.0f });
+
+		// On a unit sphere, the normal is the position
+		sphere.normals = sphere.vertices;
+
+		// Top and bottom triangles
+		const unsigned int lastRing = (ringCount - 1) * ringSize + 1;
+
+		for (unsigned int i = 0; i < ringSize; i++)
+		{
+			unsigned int next = (i + 1) % ringSize;
+			sphere.indices.insert(sphere.indices.end(), { 0, next + 1, i + 1 });
+			sphere.indices.insert(sphere.indices.end(), { bottomVertex, lastRing + i, lastRing + next });
+		}
+
+		// Quads between the rings
+		for (unsigned int j = 0; j + 1 < ringCount; j++)
+		{
+			unsigned int j0 = j * ringSize + 1;
+			unsigned int j1 = (j + 1) * ringSize + 1;
+
+			for (unsigned int i = 0; i < ringSize; i++)
+			{
+				unsigned int next = (i + 1) % ringSize;
+				sphere.indices.insert(sphere.indices.end(), { j0 + i, j0 + next, j1 + next });
+				sphere.indices.insert(sphere.indices.end(), { j0 + i, j1 + next, j1 + i });
+			}
+		}
+
+		return sphere;
+	}
+
 	/// <summary>
 	/// 
 	/// </summary>
@@ -260,111 +641,141 @@ public:
 	/// <summary>
 	/// Optimizes a vector of vertices by using indexed drawing to keep only unique vertices
 	/// </summary>
-	/// <param name="vertices"></param>
-	/// <returns></returns>
-	static VertexDataIndices optimizeVertices(const std::vector<float> &vertices)
+	/// <param name="vertices">The vertices of a non indexed triangle list</param>
+	/// <returns>The unique vertices and the indices to draw them</returns>
+	static VertexDataIndices optimizeVertices(const std::vector<float>& vertices)
 	{
 		assert(vertices.size() % 9 == 0 && "Vector contains malformed vertice data!");
 
-		// We can't use std::set with a glm::vec3 since it lacks the "<" operator
-		// Therefore, we use an unordered set to keep track of what vertices are already present
-		// and a vector to keep them in the order of insertion
-		std::vector<glm::vec3> uniqueVertices;
-		std::unordered_set<glm::vec3> existingVertices;
+		size_t uniqueVertexCount = 0;
+		std::vector<unsigned int> remap = Geometry::weldVertices({ WeldAttribute{ &vertices, 3, 0.0f } }, vertices.size() / 3, uniqueVertexCount);
 
-		std::unordered_map<glm::vec3, unsigned int> vertexToIndex;
-
-		int lastIndex = 0;
+		VertexDataIndices vertexData;
+		vertexData.vertices = Geometry::remapVertexAttribute(vertices, remap, 3, uniqueVertexCount);
+		// Every vertex of a non indexed mesh is drawn once in order, so the remap table is the index buffer
+		vertexData.indices = std::move(remap);
 
-		// We start by storing each unique vertex in the vector, and keeping track of it's corresponding index
-		for (int i = 0; i < vertices.size(); i += 3)
-		{
-			glm::vec3 vertex = glm::vec3(vertices[i], vertices[i + 1], vertices[i + 2]);
-			if (existingVertices.count(vertex) == 0)
-			{
-				existingVertices.insert(vertex);
-				uniqueVertices.push_back(vertex);
-				vertexToIndex[vertex] = lastIndex++;
-			}
-		}
+		return vertexData;
+	}
 
-		VertexDataIndices vertexData;
+	/// <summary>
+	/// Optimizes a vector of vertices by using indexed drawing to keep only unique vertices
+	/// Vertices at the same position with different normals are kept apart so hard edges are preserved
+	/// </summary>
+	/// <param name="vertices">The vertices of a non indexed triangle list</param>
+	/// <param name="normals">The normals of each vertex</param>
+	/// <returns>The unique vertices and normals and the indices to draw them</returns>
+	static VertexDataIndices optimizeVertices(const std::vector<float>& vertices, const std::vector<float>& normals)
+	{
+		assert(vertices.size() % 9 == 0 && "Vector contains malformed vertice data!");
+		assert(normals.size() == vertices.size() && "Normals don't match the vertices!");
 
-		// Second pass to generate the list of indices
-		for (int i = 0; i < vertices.size(); i += 3)
-		{
-			glm::vec3 vertex = glm::vec3(vertices[i], vertices[i + 1], vertices[i + 2]);
-			vertexData.indices.push_back(vertexToIndex[vertex]);
-		}
+		size_t uniqueVertexCount = 0;
+		std::vector<unsigned int> remap = Geometry::weldVertices(
+			{ WeldAttribute{ &vertices, 3, 0.0f }, WeldAttribute{ &normals, 3, 0.0f } },
+			vertices.size() / 3,
+			uniqueVertexCount
+		);
 
-		// Add the vertices to the struct
-		for (glm::vec3 uniqueVertex : uniqueVertices)
-		{
-			vertexData.vertices.push_back(uniqueVertex.x);
-			vertexData.vertices.push_back(uniqueVertex.y);
-			vertexData.vertices.push_back(uniqueVertex.z);
-		}
+		VertexDataIndices vertexData;
+		vertexData.vertices = Geometry::remapVertexAttribute(vertices, remap, 3, uniqueVertexCount);
+		vertexData.normals = Geometry::remapVertexAttribute(normals, remap, 3, uniqueVertexCount);
+		vertexData.indices = std::move(remap);
 
 		return vertexData;
 	}
 
 	/// <summary>
-	/// Optimizes a vector of vertices by using indexed drawing to keep only unique vertices
+	/// Finds the vertices that have all their attributes equal and merges them
+	/// Vertices are hashed in parallel, then split in partitions by hash that are each deduplicated with their own open addressing table
+	/// When an attribute has an epsilon, the vertices are instead merged with an earlier vertex that has all its attributes within epsilon of theirs
 	/// </summary>
-	/// <param name="vertices"></param>
-	/// <returns></returns>
-	static VertexDataIndices optimizeVertices(std::vector<float> vertices, std::vector<float> normals)
+	/// <param name="attributes">The attributes to compare, vertices are merged only if all of them match, the first one should be the positions</param>
+	/// <param name="vertexCount">The number of vertices</param>
+	/// <param name="uniqueVertexCount">Receives the number of vertices left after welding</param>
+	/// <returns>A remap table from each vertex to its welded vertex, welded vertices are numbered in order of first occurence</returns>
+	static std::vector<unsigned int> weldVertices(const std::vector<WeldAttribute>& attributes, size_t vertexCount, size_t& uniqueVertexCount)
 	{
-		assert(vertices.size() % 9 == 0 && "Vector contains malformed vertice data!");
+		for (const WeldAttribute& attribute : attributes)
+			assert(attribute.values->size() >= vertexCount * attribute.componentCount && "Attribute contains less values than there are vertices!");
 
-		// We can't use std::set with a glm::vec3 since it lacks the "<" operator
-		// Therefore, we use an unordered set to keep track of what vertices are already present
-		// and a vector to keep them in the order of insertion
-		std::vector<glm::vec3> uniqueVertices;
-		std::vector<glm::vec3> uniqueNormals;
-		std::unordered_set<glm::vec3> existingVertices;
+		bool hasEpsilon = std::any_of(attributes.begin(), attributes.end(), [](const WeldAttribute& attribute) {
+			return attribute.epsilon > 0.0f;
+		});
 
-		std::unordered_map<glm::vec3, unsigned int> vertexToIndex;
+		if (hasEpsilon)
+			return Geometry::numberWeldedVertices(Geometry::findCloseVertices(attributes, vertexCount), uniqueVertexCount);
 
-		int lastIndex = 0;
+		std::vector<uint64_t> hashes(vertexCount);
 
-		// We start by storing each unique vertex in the vector, and keeping track of it's corresponding index
-		for (int i = 0; i < vertices.size(); i += 3)
-		{
-			glm::vec3 vertex = glm::vec3(vertices[i], vertices[i + 1], vertices[i + 2]);
-			if (existingVertices.count(vertex) == 0)
-			{
-				glm::vec3 normal = glm::vec3(normals[i], normals[i + 1], normals[i + 2]);
+		Parallel::forChunks(vertexCount, Geometry::PARALLEL_CHUNK_SIZE, [&](size_t begin, size_t end) {
+			for (size_t vertex = begin; vertex < end; vertex++)
+				hashes[vertex] = Geometry::hashWeldVertex(attributes, vertex);
+		});
 
-				existingVertices.insert(vertex);
-				uniqueVertices.push_back(vertex);
-				uniqueNormals.push_back(normal);
-				vertexToIndex[vertex] = lastIndex++;
-			}
-		}
+		// The high bits of the hash pick a partition, the low bits a slot in the table of the partition
+		// Small meshes are not worth the bucketing and use a single table
+		const unsigned int partitionBits = vertexCount > Geometry::PARALLEL_CHUNK_SIZE ? Geometry::WELD_PARTITION_BITS : 0;
+		const size_t partitionCount = static_cast<size_t>(1) << partitionBits;
 
-		VertexDataIndices vertexData;
+		// Each partition keeps its vertices in ascending order, so the first vertex inserted in a table is always the first occurence
+		std::vector<unsigned int> sortedVertices;
+		std::vector<size_t> partitionOffsets;
+		Geometry::partitionWeldVertices(hashes, partitionBits, sortedVertices, partitionOffsets);
 
-		// Second pass to generate the list of indices
-		for (int i = 0; i < vertices.size(); i += 3)
-		{
-			glm::vec3 vertex = glm::vec3(vertices[i], vertices[i + 1], vertices[i + 2]);
-			vertexData.indices.push_back(vertexToIndex[vertex]);
-		}
+		// Each vertex points to the first vertex that is equal to it, or to itself if it is the first
+		std::vector<unsigned int> firstOccurences(vertexCount);
 
-		// Add the vertices to the struct
-		for (int i = 0; i < uniqueVertices.size(); i++)
-		{
-			vertexData.vertices.push_back(uniqueVertices[i].x);
-			vertexData.vertices.push_back(uniqueVertices[i].y);
-			vertexData.vertices.push_back(uniqueVertices[i].z);
+		Parallel::forChunks(partitionCount, 1, [&](size_t firstPartition, size_t lastPartition) {
+			// A slot packs the high half of the hash with the vertex index, so most mismatches are rejected without touching the vertex data
+			std::vector<uint64_t> table;
 
-			vertexData.normals.push_back(uniqueNormals[i].x);
-			vertexData.normals.push_back(uniqueNormals[i].y);
-			vertexData.normals.push_back(uniqueNormals[i].z);
-		}
+			for (size_t partition = firstPartition; partition < lastPartition; partition++)
+			{
+				size_t begin = partitionOffsets[partition];
+				size_t end = partitionOffsets[partition + 1];
+
+				// Keep the load factor under 0.5 so probe sequences stay short
+				size_t tableSize = 1;
+				while (tableSize < (end - begin) * 2)
+					tableSize <<= 1;
+
+				table.assign(tableSize, UINT64_MAX);
+				const size_t mask = tableSize - 1;
+
+				for (size_t i = begin; i < end; i++)
+				{
+					unsigned int vertex = sortedVertices[i];
+					uint64_t hashTag = hashes[vertex] & 0xFFFFFFFF00000000ull;
+					size_t slot = static_cast<size_t>(hashes[vertex]) & mask;
+
+					// Linear probing until we find either an equal vertex or an empty slot
+					while (true)
+					{
+						uint64_t entry = table[slot];
+
+						if (entry == UINT64_MAX)
+						{
+							table[slot] = hashTag | vertex;
+							firstOccurences[vertex] = vertex;
+							break;
+						}
+
+						auto candidate = static_cast<unsigned int>(entry & 0xFFFFFFFFull);
+
+						if ((entry & 0xFFFFFFFF00000000ull) == hashTag && Geometry::areWeldVerticesEqual(attributes, candidate, vertex))
+						{
+							firstOccurences[vertex] = candidate;
+							break;
+						}
+
+						slot = (slot + 1) & mask;
+					}
+				}
+			}
+		});
 
-		return vertexData;
+		return Geometry::numberWeldedVertices(firstOccurences, uniqueVertexCount);
 	}
 
 	/// <summary>
@@ -376,112 +787,1499 @@ public:
 	{
 		assert(vertices.size() % 9 == 0 && "Vector contains malformed vertice data!");
 
-		std::vector<float> normals;
+		std::vector<float> normals(vertices.size());
 
-		// Iterates over the vector triangle by triangle
-		for (int i = 0; i < vertices.size(); i += 9)
-		{
-			glm::vec3 v1 = glm::vec3(vertices[i], vertices[i + 1], vertices[i + 2]);
-			glm::vec3 v2 = glm::vec3(vertices[i + 3], vertices[i + 4], vertices[i + 5]);
-			glm::vec3 v3 = glm::vec3(vertices[i + 6], vertices[i + 7], vertices[i + 8]);
+		// Each triangle only writes its own vertices, so chunks of triangles don't overlap
+		Parallel::forChunks(vertices.size() / 9, Geometry::PARALLEL_CHUNK_SIZE, [&](size_t begin, size_t end) {
+			for (size_t i = begin * 9; i < end * 9; i += 9)
+			{
+				glm::vec3 v1 = glm::vec3(vertices[i], vertices[i + 1], vertices[i + 2]);
+				glm::vec3 v2 = glm::vec3(vertices[i + 3], vertices[i + 4], vertices[i + 5]);
+				glm::vec3 v3 = glm::vec3(vertices[i + 6], vertices[i + 7], vertices[i + 8]);
+
+				// Each vertice is given the face normal as normal
+				glm::vec3 normal = Geometry::getFaceNormal(v1, v2, v3);
+
+				for (size_t vertex = 0; vertex < 3; vertex++)
+				{
+					normals[i + vertex * 3] = normal.x;
+					normals[i + vertex * 3 + 1] = normal.y;
+					normals[i + vertex * 3 + 2] = normal.z;
+				}
+			}
+		});
 
-			// We calculate two edges so we can get the cross product
-			glm::vec3 edge1 = v2 - v1;
-			glm::vec3 edge2 = v3 - v1;
+		return normals;
+	}
 
-			// Calculate the normal
-			glm::vec3 normal = glm::normalize(glm::cross(edge1, edge2));
+	/// <summary>
+	/// Calculates the per-vertex normals for an array of vertices with indices, each vertex gets the average of the normals of its triangles
+	/// Face normals are computed in parallel into separate x/y/z arrays, then each vertex gathers the normals of its triangles,
+	/// which avoids the write conflicts of scattering face normals to vertices from several threads
+	/// </summary>
+	/// <param name="vertices">The vertices for which normals should be calculated</param>
+	/// <param name="indices">The triangle list indices</param>
+	/// <returns>A vector containing the normals for each vertex</returns>
+	static std::vector<float> calculateVerticesNormals(const std::vector<float>& vertices, const std::vector<unsigned int>& indices)
+	{
+		assert(indices.size() % 3 == 0 && "Vector contains malformed vertice data!");
 
-			// Each vertice is given the face normal as normal
-			normals.push_back(normal.x);
-			normals.push_back(normal.y);
-			normals.push_back(normal.z);
+		const size_t vertexCount = vertices.size() / 3;
+		const size_t triangleCount = indices.size() / 3;
 
-			normals.push_back(normal.x);
-			normals.push_back(normal.y);
-			normals.push_back(normal.z);
+		std::vector<float> faceNormalsX(triangleCount);
+		std::vector<float> faceNormalsY(triangleCount);
+		std::vector<float> faceNormalsZ(triangleCount);
 
-			normals.push_back(normal.x);
-			normals.push_back(normal.y);
-			normals.push_back(normal.z);
-		}
+		Parallel::forChunks(triangleCount, Geometry::PARALLEL_CHUNK_SIZE, [&](size_t begin, size_t end) {
+			for (size_t triangle = begin; triangle < end; triangle++)
+			{
+				glm::vec3 normal = Geometry::getFaceNormal(
+					Geometry::getPosition(vertices, indices[triangle * 3]),
+					Geometry::getPosition(vertices, indices[triangle * 3 + 1]),
+					Geometry::getPosition(vertices, indices[triangle * 3 + 2])
+				);
+
+				faceNormalsX[triangle] = normal.x;
+				faceNormalsY[triangle] = normal.y;
+				faceNormalsZ[triangle] = normal.z;
+			}
+		});
+
+		std::vector<unsigned int> triangleOffsets;
+		std::vector<unsigned int> vertexTriangles;
+		Geometry::buildVertexTriangles(indices, vertexCount, triangleOffsets, vertexTriangles);
+
+		std::vector<float> normals(vertexCount * 3);
+
+		Parallel::forChunks(vertexCount, Geometry::PARALLEL_CHUNK_SIZE, [&](size_t begin, size_t end) {
+			for (size_t vertex = begin; vertex < end; vertex++)
+			{
+				float x = 0.0f;
+				float y = 0.0f;
+				float z = 0.0f;
+
+				for (unsigned int i = triangleOffsets[vertex]; i < triangleOffsets[vertex + 1]; i++)
+				{
+					x += faceNormalsX[vertexTriangles[i]];
+					y += faceNormalsY[vertexTriangles[i]];
+					z += faceNormalsZ[vertexTriangles[i]];
+				}
+
+				// Normalize to keep just the direction, vertices without triangles are left with a null normal
+				float length = std::sqrt(x * x + y * y + z * z);
+				float inverseLength = length > 0.0f ? 1.0f / length : 0.0f;
+
+				normals[vertex * 3] = x * inverseLength;
+				normals[vertex * 3 + 1] = y * inverseLength;
+				normals[vertex * 3 + 2] = z * inverseLength;
+			}
+		});
 
 		return normals;
 	}
 
 	/// <summary>
-	/// Calculates the per-vertex normals for an array of vertices with indices
+	/// Calculates the per-vertex tangents of an indexed mesh for normal mapping, following the MikkTSpace conventions:
+	/// triangle tangents come from the texture coordinates derivatives, they are projected on the tangent plane of each vertex
+	/// and weighted by the angle of the triangle corner, and the bitangent is sign * cross(normal, tangent)
+	/// Unlike MikkTSpace, vertices shared by triangles with mirrored texture coordinates are not split, they keep the orientation of the largest side
 	/// </summary>
-	/// <param name="vertices">The vertices for which normals should be calculated</param>
-	/// <param name="indices"></param>
-	/// <returns></returns>
-	static std::vector<float> calculateVerticesNormals(std::vector<float> vertices, std::vector<unsigned int> indices)
+	/// <param name="vertices">The vertex positions</param>
+	/// <param name="texCoords">The texture coordinates of each vertex</param>
+	/// <param name="normals">The normals of each vertex</param>
+	/// <param name="indices">The triangle list indices</param>
+	/// <param name="tangents">Receives the tangent of each vertex</param>
+	/// <param name="bitangents">Receives the bitangent of each vertex</param>
+	static void calculateVerticesTangents(const std::vector<float>& vertices, const std::vector<float>& texCoords, const std::vector<float>& normals, const std::vector<unsigned int>& indices, std::vector<float>& tangents, std::vector<float>& bitangents)
 	{
 		assert(indices.size() % 3 == 0 && "Vector contains malformed vertice data!");
 
-		std::vector<glm::vec3> normals(vertices.size() / 3, glm::vec3(0.0f));
+		const size_t vertexCount = vertices.size() / 3;
+		const size_t triangleCount = indices.size() / 3;
 
-		for (int i = 0; i < indices.size(); i += 3)
-		{
-			unsigned int i1 = indices[i];
-			unsigned int i2 = indices[i + 1];
-			unsigned int i3 = indices[i + 2];
+		assert(texCoords.size() >= vertexCount * 2 && normals.size() >= vertexCount * 3 && "Tangents need texture coordinates and normals!");
 
-			glm::vec3 v1 = glm::vec3(vertices[i1 * 3], vertices[i1 * 3 + 1], vertices[i1 * 3 + 2]);
-			glm::vec3 v2 = glm::vec3(vertices[i2 * 3], vertices[i2 * 3 + 1], vertices[i2 * 3 + 2]);
-			glm::vec3 v3 = glm::vec3(vertices[i3 * 3], vertices[i3 * 3 + 1], vertices[i3 * 3 + 2]);
+		// The tangent of each triangle, with a null tangent for triangles with degenerate texture coordinates
+		std::vector<float> faceTangentsX(triangleCount);
+		std::vector<float> faceTangentsY(triangleCount);
+		std::vector<float> faceTangentsZ(triangleCount);
+		// Whether the texture coordinates of each triangle preserve its orientation
+		std::vector<uint8_t> faceOrientations(triangleCount);
 
-			// We calculate two edges so we can get the cross product
-			glm::vec3 edge1 = v2 - v1;
-			glm::vec3 edge2 = v3 - v1;
+		Parallel::forChunks(triangleCount, Geometry::PARALLEL_CHUNK_SIZE, [&](size_t begin, size_t end) {
+			for (size_t triangle = begin; triangle < end; triangle++)
+			{
+				unsigned int i0 = indices[triangle * 3];
+				unsigned int i1 = indices[triangle * 3 + 1];
+				unsigned int i2 = indices[triangle * 3 + 2];
+
+				glm::vec3 p0 = Geometry::getPosition(vertices, i0);
+				glm::vec3 edge1 = Geometry::getPosition(vertices, i1) - p0;
+				glm::vec3 edge2 = Geometry::getPosition(vertices, i2) - p0;
+
+				float du1 = texCoords[i1 * 2] - texCoords[i0 * 2];
+				float dv1 = texCoords[i1 * 2 + 1] - texCoords[i0 * 2 + 1];
+				float du2 = texCoords[i2 * 2] - texCoords[i0 * 2];
+				float dv2 = texCoords[i2 * 2 + 1] - texCoords[i0 * 2 + 1];
+
+				float signedArea = du1 * dv2 - du2 * dv1;
+				glm::vec3 tangent = edge1 * dv2 - edge2 * dv1;
+				float length = glm::length(tangent);
+
+				if (signedArea == 0.0f || length <= 0.0f)
+					tangent = glm::vec3(0.0f);
+				else
+					tangent = tangent * ((signedArea > 0.0f ? 1.0f : -1.0f) / length);
+
+				faceTangentsX[triangle] = tangent.x;
+				faceTangentsY[triangle] = tangent.y;
+				faceTangentsZ[triangle] = tangent.z;
+				faceOrientations[triangle] = signedArea > 0.0f ? 1 : 0;
+			}
+		});
 
-			// Calculate the normal
-			glm::vec3 normal = glm::normalize(glm::cross(edge1, edge2));
+		std::vector<unsigned int> triangleOffsets;
+		std::vector<unsigned int> vertexTriangles;
+		Geometry::buildVertexTriangles(indices, vertexCount, triangleOffsets, vertexTriangles);
 
-			// Add the normal to each corresponding vertex as a "weight", which we'll normalize later to keep just the direction
-			normals[i1] += normal;
-			normals[i2] += normal;
-			normals[i3] += normal;
-		}
+		tangents.assign(vertexCount * 3, 0.0f);
+		bitangents.assign(vertexCount * 3, 0.0f);
 
-		std::vector<float> normalsAsFloats;
+		Parallel::forChunks(vertexCount, Geometry::PARALLEL_CHUNK_SIZE, [&](size_t begin, size_t end) {
+			for (size_t vertex = begin; vertex < end; vertex++)
+			{
+				glm::vec3 normal = Geometry::getPosition(normals, static_cast<unsigned int>(vertex));
+				glm::vec3 position = Geometry::getPosition(vertices, static_cast<unsigned int>(vertex));
 
-		// Normalize all normals and them to the vector as floats
-		for (auto normal : normals)
-		{
-			glm::vec3 normalized = glm::normalize(normal);
+				// Tangents are accumulated separately for both orientations
+				glm::vec3 orientedTangents[2] = { glm::vec3(0.0f), glm::vec3(0.0f) };
+				float orientedWeights[2] = { 0.0f, 0.0f };
 
-			normalsAsFloats.push_back(normalized.x);
-			normalsAsFloats.push_back(normalized.y);
-			normalsAsFloats.push_back(normalized.z);
-		}
+				for (unsigned int i = triangleOffsets[vertex]; i < triangleOffsets[vertex + 1]; i++)
+				{
+					unsigned int triangle = vertexTriangles[i];
+					glm::vec3 faceTangent = glm::vec3(faceTangentsX[triangle], faceTangentsY[triangle], faceTangentsZ[triangle]);
 
-		return normalsAsFloats;
-	}
+					if (faceTangent == glm::vec3(0.0f))
+						continue;
 
-	static BoundingBox getMeshBoundingBox(const std::vector<float> &vertices)
-	{
-		assert(vertices.size() % 3 == 0 && "Vector contains malformed vertice data!");
+					// Find the two other corners of the triangle
+					const unsigned int* corners = &indices[triangle * 3];
+					int corner = corners[0] == vertex ? 0 : (corners[1] == vertex ? 1 : 2);
+					glm::vec3 edge1 = Geometry::getPosition(vertices, corners[(corner + 1) % 3]) - position;
+					glm::vec3 edge2 = Geometry::getPosition(vertices, corners[(corner + 2) % 3]) - position;
 
-		float minX = INFINITY;
-		float minY = INFINITY;
-		float minZ = INFINITY;
+					// Project the tangent and edges on the tangent plane of the vertex, the corner angle there is the weight
+					glm::vec3 projectedTangent = faceTangent - normal * glm::dot(normal, faceTangent);
+					edge1 = edge1 - normal * glm::dot(normal, edge1);
+					edge2 = edge2 - normal * glm::dot(normal, edge2);
 
-		float maxX = -INFINITY;
-		float maxY = -INFINITY;
-		float maxZ = -INFINITY;
+					float tangentLength = glm::length(projectedTangent);
+					float edgeLengths = glm::length(edge1) * glm::length(edge2);
 
-		for (int i = 0; i < vertices.size(); i += 3)
-		{
-			if (vertices[i] < minX) minX = vertices[i];
-			if (vertices[i + 1] < minY) minY = vertices[i + 1];
-			if (vertices[i + 2] < minZ) minZ = vertices[i + 2];
+					if (tangentLength <= 0.0f || edgeLengths <= 0.0f)
+						continue;
 
-			if (vertices[i] > maxX) maxX = vertices[i];
-			if (vertices[i + 1] > maxY) maxY = vertices[i + 1];
-			if (vertices[i + 2] > maxZ) maxZ = vertices[i + 2];
+					float angle = std::acos(glm::clamp(glm::dot(edge1, edge2) / edgeLengths, -1.0f, 1.0f));
+					int orientation = faceOrientations[triangle];
+
+					orientedTangents[orientation] += projectedTangent * (angle / tangentLength);
+					orientedWeights[orientation] += angle;
+				}
+
+				int orientation = orientedWeights[1] >= orientedWeights[0] ? 1 : 0;
+				glm::vec3 tangent = orientedTangents[orientation];
+				tangent = tangent - normal * glm::dot(normal, tangent);
+
+				float length = glm::length(tangent);
+
+				// Vertices without usable texture coordinates get any tangent perpendicular to their normal
+				if (length <= 0.0f)
+				{
+					tangent = glm::cross(normal, std::abs(normal.x) < 0.9f ? glm::vec3(1.0f, 0.0f, 0.0f) : glm::vec3(0.0f, 1.0f, 0.0f));
+					length = glm::length(tangent);
+				}
+
+				if (length > 0.0f)
+					tangent = tangent / length;
+
+				glm::vec3 bitangent = glm::cross(normal, tangent) * (orientation == 1 ? 1.0f : -1.0f);
+
+				for (int component = 0; component < 3; component++)
+				{
+					tangents[vertex * 3 + component] = tangent[component];
+					bitangents[vertex * 3 + component] = bitangent[component];
+				}
+			}
+		});
+	}
+
+	/// <summary>
+	/// Simulates a FIFO post-transform vertex cache to measure how efficiently an index buffer reuses vertices
+	/// </summary>
+	/// <param name="indices">The triangle list indices</param>
+	/// <param name="vertexCount">The number of vertices referenced by the indices</param>
+	/// <param name="cacheSize">The number of entries of the simulated cache</param>
+	/// <returns>The number of cache misses along with the triangle and vertex counts</returns>
+	static VertexCacheStatistics analyzeVertexCache(const std::vector<unsigned int>& indices, size_t vertexCount, unsigned int cacheSize = VERTEX_CACHE_SIZE)
+	{
+		assert(indices.size() % 3 == 0 && "Vector contains malformed indices data!");
+
+		VertexCacheStatistics statistics;
+		statistics.triangleCount = indices.size() / 3;
+		statistics.vertexCount = vertexCount;
+
+		// A vertex is in the cache if fewer than cacheSize vertices were transformed since it was
+		std::vector<size_t> cacheTimestamps(vertexCount, 0);
+		size_t timestamp = cacheSize + 1;
+
+		for (unsigned int index : indices)
+		{
+			if (timestamp - cacheTimestamps[index] > cacheSize)
+			{
+				cacheTimestamps[index] = timestamp++;
+				statistics.cacheMisses++;
+			}
+		}
+
+		return statistics;
+	}
+
+	/// <summary>
+	/// Reorders triangles for post-transform vertex cache locality using the Tipsify algorithm (Sander et al. 2007)
+	/// Triangles are emitted as fans around vertices, the next fan is picked among the vertices that are likely still in the cache
+	/// </summary>
+	/// <param name="indices">The triangle list indices</param>
+	/// <param name="vertexCount">The number of vertices referenced by the indices</param>
+	/// <param name="cacheSize">The number of entries of the targeted cache</param>
+	/// <returns>The reordered indices</returns>
+	static std::vector<unsigned int> optimizeVertexCache(const std::vector<unsigned int>& indices, size_t vertexCount, unsigned int cacheSize = VERTEX_CACHE_SIZE)
+	{
+		assert(indices.size() % 3 == 0 && "Vector contains malformed indices data!");
+
+		size_t triangleCount = indices.size() / 3;
+		if (triangleCount == 0)
+			return indices;
+
+		// Vertex to triangles adjacency, stored as ranges into a single array
+		std::vector<size_t> adjacencyOffsets(vertexCount + 1, 0);
+		for (unsigned int index : indices)
+			adjacencyOffsets[index + 1]++;
+
+		for (size_t i = 0; i < vertexCount; i++)
+			adjacencyOffsets[i + 1] += adjacencyOffsets[i];
+
+		std::vector<unsigned int> adjacency(indices.size());
+		std::vector<size_t> fillOffsets(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+
+		for (size_t triangle = 0; triangle < triangleCount; triangle++)
+		{
+			for (size_t corner = 0; corner < 3; corner++)
+				adjacency[fillOffsets[indices[triangle * 3 + corner]]++] = static_cast<unsigned int>(triangle);
+		}
+
+		// The number of triangles not yet emitted for each vertex
+		std::vector<unsigned int> liveTriangles(vertexCount);
+		for (size_t i = 0; i < vertexCount; i++)
+			liveTriangles[i] = static_cast<unsigned int>(adjacencyOffsets[i + 1] - adjacencyOffsets[i]);
+
+		std::vector<size_t> cacheTimestamps(vertexCount, 0);
+		std::vector<bool> emittedTriangles(triangleCount, false);
+		std::vector<unsigned int> deadEndStack;
+		std::vector<unsigned int> candidates;
+
+		std::vector<unsigned int> optimized;
+		optimized.reserve(indices.size());
+
+		size_t timestamp = cacheSize + 1;
+		size_t scanCursor = 0;
+		int64_t fanningVertex = indices[0];
+
+		while (fanningVertex >= 0)
+		{
+			candidates.clear();
+
+			// Emit all the remaining triangles around the fanning vertex
+			for (size_t i = adjacencyOffsets[fanningVertex]; i < adjacencyOffsets[fanningVertex + 1]; i++)
+			{
+				unsigned int triangle = adjacency[i];
+				if (emittedTriangles[triangle])
+					continue;
+
+				for (size_t corner = 0; corner < 3; corner++)
+				{
+					unsigned int vertex = indices[triangle * 3 + corner];
+
+					optimized.push_back(vertex);
+					deadEndStack.push_back(vertex);
+					candidates.push_back(vertex);
+					liveTriangles[vertex]--;
+
+					if (timestamp - cacheTimestamps[vertex] > cacheSize)
+						cacheTimestamps[vertex] = timestamp++;
+				}
+
+				emittedTriangles[triangle] = true;
+			}
+
+			// Pick the next fanning vertex among the candidates that will still be in the cache once all their triangles are emitted
+			int64_t bestVertex = -1;
+			int64_t bestPriority = -1;
+
+			for (unsigned int vertex : candidates)
+			{
+				if (liveTriangles[vertex] == 0)
+					continue;
+
+				int64_t priority = 0;
+				if (timestamp - cacheTimestamps[vertex] + 2 * liveTriangles[vertex] <= cacheSize)
+					priority = static_cast<int64_t>(timestamp - cacheTimestamps[vertex]);
+
+				if (priority > bestPriority)
+				{
+					bestPriority = priority;
+					bestVertex = vertex;
+				}
+			}
+
+			// Dead end, we go back to the most recently used vertex that still has triangles, or the next one in the mesh
+			if (bestVertex == -1)
+			{
+				while (!deadEndStack.empty())
+				{
+					unsigned int vertex = deadEndStack.back();
+					deadEndStack.pop_back();
+
+					if (liveTriangles[vertex] > 0)
+					{
+						bestVertex = vertex;
+						break;
+					}
+				}
+			}
+
+			if (bestVertex == -1)
+			{
+				while (scanCursor < vertexCount && liveTriangles[scanCursor] == 0)
+					scanCursor++;
+
+				if (scanCursor < vertexCount)
+					bestVertex = static_cast<int64_t>(scanCursor);
+			}
+
+			fanningVertex = bestVertex;
+		}
+
+		return optimized;
+	}
+
+	/// <summary>
+	/// Reorders the clusters of a vertex cache optimized index buffer to reduce overdraw
+	/// The index buffer is split where the cache is entirely flushed, then clusters facing away from the center of the mesh
+	/// are drawn first since they are the most likely to occlude the rest of the mesh
+	/// </summary>
+	/// <param name="indices">The triangle list indices, should already be optimized for the vertex cache</param>
+	/// <param name="vertices">The vertex positions, 3 floats per vertex</param>
+	/// <param name="cacheSize">The number of entries of the targeted cache</param>
+	/// <returns>The reordered indices</returns>
+	static std::vector<unsigned int> optimizeOverdraw(const std::vector<unsigned int>& indices, const std::vector<float>& vertices, unsigned int cacheSize = VERTEX_CACHE_SIZE)
+	{
+		assert(indices.size() % 3 == 0 && "Vector contains malformed indices data!");
+		assert(vertices.size() % 3 == 0 && "Vector contains malformed vertice data!");
+
+		size_t triangleCount = indices.size() / 3;
+		size_t vertexCount = vertices.size() / 3;
+
+		if (triangleCount == 0 || vertexCount == 0)
+			return indices;
+
+		struct Cluster
+		{
+			size_t firstTriangle;
+			size_t triangleCount;
+			float sortKey;
+		};
+
+		// Split at the hard boundaries, where a triangle misses the cache for all of its vertices
+		std::vector<Cluster> clusters;
+		std::vector<size_t> cacheTimestamps(vertexCount, 0);
+		size_t timestamp = cacheSize + 1;
+
+		for (size_t triangle = 0; triangle < triangleCount; triangle++)
+		{
+			int misses = 0;
+
+			for (size_t corner = 0; corner < 3; corner++)
+			{
+				unsigned int vertex = indices[triangle * 3 + corner];
+
+				if (timestamp - cacheTimestamps[vertex] > cacheSize)
+				{
+					cacheTimestamps[vertex] = timestamp++;
+					misses++;
+				}
+			}
+
+			if (clusters.empty() || misses == 3)
+				clusters.push_back({ triangle, 0, 0.0f });
+
+			clusters.back().triangleCount++;
+		}
+
+		auto getPosition = [&vertices](unsigned int index) {
+			return glm::vec3(vertices[index * 3], vertices[index * 3 + 1], vertices[index * 3 + 2]);
+		};
+
+		glm::vec3 meshCentroid(0.0f);
+		for (size_t i = 0; i < vertexCount; i++)
+			meshCentroid += getPosition(static_cast<unsigned int>(i));
+		meshCentroid /= static_cast<float>(vertexCount);
+
+		// Sort key is how much the cluster faces away from the center of the mesh
+		for (Cluster& cluster : clusters)
+		{
+			glm::vec3 centroid(0.0f);
+			glm::vec3 normal(0.0f);
+			float totalArea = 0.0f;
+
+			for (size_t triangle = cluster.firstTriangle; triangle < cluster.firstTriangle + cluster.triangleCount; triangle++)
+			{
+				glm::vec3 v1 = getPosition(indices[triangle * 3]);
+				glm::vec3 v2 = getPosition(indices[triangle * 3 + 1]);
+				glm::vec3 v3 = getPosition(indices[triangle * 3 + 2]);
+
+				// The length of the cross product is twice the area of the triangle, so the sum is an area weighted normal
+				glm::vec3 crossProduct = glm::cross(v2 - v1, v3 - v1);
+				float area = glm::length(crossProduct);
+
+				centroid += (v1 + v2 + v3) * (area / 3.0f);
+				normal += crossProduct;
+				totalArea += area;
+			}
+
+			float normalLength = glm::length(normal);
+			if (totalArea > 0.0f && normalLength > 0.0f)
+				cluster.sortKey = glm::dot(centroid / totalArea - meshCentroid, normal / normalLength);
+		}
+
+		std::stable_sort(clusters.begin(), clusters.end(), [](const Cluster& a, const Cluster& b) {
+			return a.sortKey > b.sortKey;
+		});
+
+		std::vector<unsigned int> optimized;
+		optimized.reserve(indices.size());
+
+		for (const Cluster& cluster : clusters)
+		{
+			auto first = indices.begin() + static_cast<std::ptrdiff_t>(cluster.firstTriangle * 3);
+			optimized.insert(optimized.end(), first, first + static_cast<std::ptrdiff_t>(cluster.triangleCount * 3));
+		}
+
+		return optimized;
+	}
+
+	/// <summary>
+	/// Builds a remap table that orders vertices by their first use in the index buffer, for vertex fetch locality
+	/// Vertices that are not referenced by any index are removed
+	/// </summary>
+	/// <param name="indices">The triangle list indices</param>
+	/// <param name="vertexCount">The number of vertices referenced by the indices</param>
+	/// <param name="uniqueVertexCount">Receives the number of vertices after remapping</param>
+	/// <returns>A table giving the new index of each vertex, or UINT32_MAX for removed vertices</returns>
+	static std::vector<unsigned int> optimizeVertexFetchRemap(const std::vector<unsigned int>& indices, size_t vertexCount, size_t& uniqueVertexCount)
+	{
+		std::vector<unsigned int> remap(vertexCount, UINT32_MAX);
+		unsigned int nextVertex = 0;
+
+		for (unsigned int index : indices)
+		{
+			if (remap[index] == UINT32_MAX)
+				remap[index] = nextVertex++;
+		}
+
+		uniqueVertexCount = nextVertex;
+		return remap;
+	}
+
+	/// <summary>
+	/// Applies a remap table to an index buffer in place
+	/// </summary>
+	static void remapIndices(std::vector<unsigned int>& indices, const std::vector<unsigned int>& remap)
+	{
+		for (unsigned int& index : indices)
+			index = remap[index];
+	}
+
+	/// <summary>
+	/// Applies a remap table to a vertex attribute array
+	/// </summary>
+	/// <param name="attribute">The attribute values, componentCount values per vertex</param>
+	/// <param name="remap">The remap table from optimizeVertexFetchRemap</param>
+	/// <param name="componentCount">The number of values per vertex</param>
+	/// <param name="uniqueVertexCount">The number of vertices after remapping</param>
+	/// <returns>The reordered attribute values</returns>
+	static std::vector<float> remapVertexAttribute(const std::vector<float>& attribute, const std::vector<unsigned int>& remap, size_t componentCount, size_t uniqueVertexCount)
+	{
+		std::vector<float> remapped(uniqueVertexCount * componentCount);
+
+		for (size_t vertex = 0; vertex < remap.size() && (vertex + 1) * componentCount <= attribute.size(); vertex++)
+		{
+			if (remap[vertex] == UINT32_MAX)
+				continue;
+
+			std::copy_n(attribute.begin() + static_cast<std::ptrdiff_t>(vertex * componentCount), componentCount, remapped.begin() + static_cast<std::ptrdiff_t>(remap[vertex] * componentCount));
+		}
+
+		return remapped;
+	}
+
+	/// <summary>
+	/// Reduces the triangle count of a mesh with quadric error edge collapses
+	/// Vertices are collapsed onto one of their neighbors rather than moved, so the simplified indices still use the original vertex buffer
+	/// Border vertices and vertices on attribute seams (several vertices at the same position) are never removed to avoid opening holes
+	/// </summary>
+	/// <param name="indices">The triangle list indices</param>
+	/// <param name="vertices">The vertex positions</param>
+	/// <param name="targetIndexCount">The number of indices to reduce the mesh to</param>
+	/// <param name="targetError">The largest error allowed, relative to the size of the mesh</param>
+	/// <param name="resultError">Receives the error of the simplified mesh relative to the size of the mesh, can be null</param>
+	/// <returns>The simplified indices, which can contain more than targetIndexCount indices if the error limit was reached first</returns>
+	static std::vector<unsigned int> simplifyMesh(const std::vector<unsigned int>& indices, const std::vector<float>& vertices, size_t targetIndexCount, float targetError, float* resultError = nullptr)
+	{
+		assert(indices.size() % 3 == 0 && "Vector contains malformed indices data!");
+
+		const size_t vertexCount = vertices.size() / 3;
+
+		// Work in a unit sized space so errors are relative to the size of the mesh
+		BoundingBox boundingBox = Geometry::getMeshBoundingBox(vertices);
+		glm::vec3 size = boundingBox.maxPosition - boundingBox.minPosition;
+		float extent = std::max(size.x, std::max(size.y, size.z));
+		float scale = extent > 0.0f ? 1.0f / extent : 1.0f;
+
+		std::vector<glm::vec3> positions(vertexCount);
+		for (size_t vertex = 0; vertex < vertexCount; vertex++)
+			positions[vertex] = (glm::vec3(vertices[vertex * 3], vertices[vertex * 3 + 1], vertices[vertex * 3 + 2]) - boundingBox.minPosition) * scale;
+
+		// Vertices sharing their position with another vertex are on an attribute seam
+		std::vector<bool> locked(vertexCount, false);
+		size_t uniquePositionCount = 0;
+		std::vector<unsigned int> positionRemap = Geometry::weldVertices({ WeldAttribute{ &vertices, 3, 0.0f } }, vertexCount, uniquePositionCount);
+		std::vector<unsigned int> positionUses(uniquePositionCount, 0);
+
+		for (unsigned int position : positionRemap)
+			positionUses[position]++;
+		for (size_t vertex = 0; vertex < vertexCount; vertex++)
+			locked[vertex] = positionUses[positionRemap[vertex]] > 1;
+
+		// Edges used by a single triangle are on a border, edges used by more than two are non manifold
+		std::vector<uint64_t> edges;
+		edges.reserve(indices.size());
+
+		for (size_t i = 0; i < indices.size(); i += 3)
+		{
+			for (int edge = 0; edge < 3; edge++)
+			{
+				uint64_t a = indices[i + edge];
+				uint64_t b = indices[i + (edge + 1) % 3];
+				edges.push_back(a < b ? (a << 32) | b : (b << 32) | a);
+			}
+		}
+
+		std::sort(edges.begin(), edges.end());
+
+		for (size_t begin = 0; begin < edges.size();)
+		{
+			size_t end = begin;
+			while (end < edges.size() && edges[end] == edges[begin])
+				end++;
+
+			if (end - begin != 2)
+			{
+				locked[static_cast<size_t>(edges[begin] >> 32)] = true;
+				locked[static_cast<size_t>(edges[begin] & 0xFFFFFFFFull)] = true;
+			}
+
+			begin = end;
+		}
+
+		// Each vertex accumulates the planes of its triangles, weighted by their area
+		std::vector<Quadric> quadrics(vertexCount);
+
+		for (size_t i = 0; i < indices.size(); i += 3)
+		{
+			const glm::vec3& p0 = positions[indices[i]];
+			glm::vec3 normal = glm::cross(positions[indices[i + 1]] - p0, positions[indices[i + 2]] - p0);
+			float doubleArea = glm::length(normal);
+
+			if (doubleArea <= 0.0f)
+				continue;
+
+			normal = normal / doubleArea;
+			Quadric quadric = Quadric::fromPlane(normal.x, normal.y, normal.z, -glm::dot(normal, p0), doubleArea * 0.5f);
+
+			for (int corner = 0; corner < 3; corner++)
+				quadrics[indices[i + corner]] += quadric;
+		}
+
+		struct Collapse
+		{
+			unsigned int from;
+			unsigned int to;
+			double error;
+		};
+
+		std::vector<unsigned int> result = indices;
+		const double errorLimit = static_cast<double>(targetError) * static_cast<double>(targetError);
+		double maxError = 0.0;
+
+		std::vector<Collapse> collapses;
+		std::vector<unsigned int> triangleOffsets;
+		std::vector<unsigned int> vertexTriangles;
+		std::vector<unsigned int> remap(vertexCount);
+		std::vector<bool> touched(vertexCount);
+
+		// Each pass collapses the cheapest edges outside the one-rings of the collapses already made in the pass, then rebuilds the mesh
+		while (result.size() > targetIndexCount)
+		{
+			collapses.clear();
+
+			// Interior edges appear once in each direction, so keeping a < b visits them once
+			for (size_t i = 0; i < result.size(); i += 3)
+			{
+				for (int edge = 0; edge < 3; edge++)
+				{
+					unsigned int a = result[i + edge];
+					unsigned int b = result[i + (edge + 1) % 3];
+
+					if (a > b || (locked[a] && locked[b]))
+						continue;
+
+					Quadric quadric = quadrics[a];
+					quadric += quadrics[b];
+
+					double errorAToB = locked[a] ? DBL_MAX : quadric.getError(positions[b]);
+					double errorBToA = locked[b] ? DBL_MAX : quadric.getError(positions[a]);
+
+					if (errorAToB <= errorBToA)
+						collapses.push_back({ a, b, errorAToB });
+					else
+						collapses.push_back({ b, a, errorBToA });
+				}
+			}
+
+			if (collapses.empty())
+				break;
+
+			std::sort(collapses.begin(), collapses.end(), [](const Collapse& first, const Collapse& second) { return first.error < second.error; });
+
+			// Triangles around each vertex, to check that collapses don't flip them
+			Geometry::buildVertexTriangles(result, vertexCount, triangleOffsets, vertexTriangles);
+
+			for (size_t vertex = 0; vertex < vertexCount; vertex++)
+				remap[vertex] = static_cast<unsigned int>(vertex);
+			std::fill(touched.begin(), touched.end(), false);
+
+			const size_t trianglesToRemove = (result.size() - targetIndexCount) / 3;
+			size_t removedTriangles = 0;
+			bool reachedErrorLimit = false;
+
+			for (const Collapse& collapse : collapses)
+			{
+				if (collapse.error > errorLimit)
+				{
+					reachedErrorLimit = true;
+					break;
+				}
+
+				if (touched[collapse.from] || touched[collapse.to])
+					continue;
+
+				size_t collapsedTriangles = 0;
+				bool flips = false;
+
+				for (unsigned int t = triangleOffsets[collapse.from]; t < triangleOffsets[collapse.from + 1] && !flips; t++)
+				{
+					const unsigned int* triangle = &result[vertexTriangles[t] * 3];
+
+					if (triangle[0] == collapse.to || triangle[1] == collapse.to || triangle[2] == collapse.to)
+					{
+						collapsedTriangles++;
+						continue;
+					}
+
+					// Compare the triangle normal before and after moving the vertex
+					glm::vec3 corners[3];
+					glm::vec3 movedCorners[3];
+
+					for (int corner = 0; corner < 3; corner++)
+					{
+						corners[corner] = positions[triangle[corner]];
+						movedCorners[corner] = triangle[corner] == collapse.from ? positions[collapse.to] : corners[corner];
+					}
+
+					glm::vec3 normal = glm::cross(corners[1] - corners[0], corners[2] - corners[0]);
+					glm::vec3 movedNormal = glm::cross(movedCorners[1] - movedCorners[0], movedCorners[2] - movedCorners[0]);
+
+					flips = glm::dot(normal, movedNormal) <= 0.0f;
+				}
+
+				if (flips)
+					continue;
+
+				remap[collapse.from] = collapse.to;
+				quadrics[collapse.to] += quadrics[collapse.from];
+
+				// The flip check used the current positions of the one-ring, so none of it can move again until the next pass
+				for (unsigned int t = triangleOffsets[collapse.from]; t < triangleOffsets[collapse.from + 1]; t++)
+				{
+					const unsigned int* triangle = &result[vertexTriangles[t] * 3];
+					touched[triangle[0]] = true;
+					touched[triangle[1]] = true;
+					touched[triangle[2]] = true;
+				}
+
+				maxError = std::max(maxError, collapse.error);
+				removedTriangles += collapsedTriangles;
+
+				if (removedTriangles >= trianglesToRemove)
+					break;
+			}
+
+			if (removedTriangles == 0)
+				break;
+
+			// Apply the collapses and drop the triangles that became degenerate
+			size_t writeIndex = 0;
+
+			for (size_t i = 0; i < result.size(); i += 3)
+			{
+				unsigned int a = remap[result[i]];
+				unsigned int b = remap[result[i + 1]];
+				unsigned int c = remap[result[i + 2]];
+
+				if (a == b || b == c || a == c)
+					continue;
+
+				result[writeIndex++] = a;
+				result[writeIndex++] = b;
+				result[writeIndex++] = c;
+			}
+
+			result.resize(writeIndex);
+
+			if (reachedErrorLimit)
+				break;
+		}
+
+		if (resultError != nullptr)
+			*resultError = static_cast<float>(std::sqrt(maxError));
+
+		return result;
+	}
+
+	/// <summary>
+	/// Splits a range of an index buffer into meshlets, the triangles are kept in order so each meshlet is a range of the index buffer
+	/// This works best on indices optimized for the vertex cache, where neighboring triangles are close to each other in the buffer
+	/// </summary>
+	/// <param name="indices">The triangle list indices</param>
+	/// <param name="indexOffset">The first index of the range</param>
+	/// <param name="indexCount">The number of indices of the range</param>
+	/// <param name="vertices">The vertex positions</param>
+	/// <param name="meshlets">The vector the meshlets are appended to</param>
+	static void buildMeshlets(const std::vector<unsigned int>& indices, size_t indexOffset, size_t indexCount, const std::vector<float>& vertices, std::vector<Meshlet>& meshlets)
+	{
+		assert(indexCount % 3 == 0 && "Vector contains malformed indices data!");
+
+		// Stamps vertices with the meshlet that last used them, to count the unique vertices of the current meshlet
+		std::vector<unsigned int> vertexMeshlet(vertices.size() / 3, UINT32_MAX);
+		auto currentMeshlet = static_cast<unsigned int>(meshlets.size());
+
+		Meshlet meshlet;
+		meshlet.indexOffset = static_cast<unsigned int>(indexOffset);
+		unsigned int meshletVertexCount = 0;
+
+		for (size_t i = indexOffset; i < indexOffset + indexCount; i += 3)
+		{
+			unsigned int newVertices = 0;
+
+			for (int corner = 0; corner < 3; corner++)
+				newVertices += vertexMeshlet[indices[i + corner]] != currentMeshlet ? 1 : 0;
+
+			if (meshletVertexCount + newVertices > Geometry::MESHLET_MAX_VERTICES || meshlet.indexCount / 3 + 1 > Geometry::MESHLET_MAX_TRIANGLES)
+			{
+				Geometry::computeMeshletBounds(indices, vertices, meshlet);
+				meshlets.push_back(meshlet);
+
+				meshlet = Meshlet();
+				meshlet.indexOffset = static_cast<unsigned int>(i);
+				meshletVertexCount = 0;
+				currentMeshlet++;
+			}
+
+			for (int corner = 0; corner < 3; corner++)
+			{
+				if (vertexMeshlet[indices[i + corner]] != currentMeshlet)
+				{
+					vertexMeshlet[indices[i + corner]] = currentMeshlet;
+					meshletVertexCount++;
+				}
+			}
+
+			meshlet.indexCount += 3;
+		}
+
+		if (meshlet.indexCount > 0)
+		{
+			Geometry::computeMeshletBounds(indices, vertices, meshlet);
+			meshlets.push_back(meshlet);
+		}
+	}
+
+	/// <summary>
+	/// Computes the bounding sphere and normal cone of a meshlet from its triangles
+	/// </summary>
+	static void computeMeshletBounds(const std::vector<unsigned int>& indices, const std::vector<float>& vertices, Meshlet& meshlet)
+	{
+		auto getPosition = [&](unsigned int vertex) {
+			return glm::vec3(vertices[vertex * 3], vertices[vertex * 3 + 1], vertices[vertex * 3 + 2]);
+		};
+
+		const size_t begin = meshlet.indexOffset;
+		const size_t end = begin + meshlet.indexCount;
+
+		glm::vec3 minPosition = glm::vec3(FLT_MAX);
+		glm::vec3 maxPosition = glm::vec3(-FLT_MAX);
+
+		for (size_t i = begin; i < end; i++)
+		{
+			glm::vec3 position = getPosition(indices[i]);
+			minPosition = glm::min(minPosition, position);
+			maxPosition = glm::max(maxPosition, position);
+		}
+
+		meshlet.center = (minPosition + maxPosition) * 0.5f;
+		meshlet.radius = 0.0f;
+
+		for (size_t i = begin; i < end; i++)
+			meshlet.radius = std::max(meshlet.radius, glm::length(getPosition(indices[i]) - meshlet.center));
+
+		// The cone axis is the average of the triangle normals, the cutoff comes from the normal furthest from it
+		std::vector<glm::vec3> normals;
+		normals.reserve(meshlet.indexCount / 3);
+		glm::vec3 axis = glm::vec3(0.0f);
+
+		for (size_t i = begin; i < end; i += 3)
+		{
+			glm::vec3 p0 = getPosition(indices[i]);
+			glm::vec3 normal = glm::cross(getPosition(indices[i + 1]) - p0, getPosition(indices[i + 2]) - p0);
+			float length = glm::length(normal);
+
+			// Degenerate triangles are invisible, they don't constrain the cone
+			if (length <= 0.0f)
+				continue;
+
+			normals.push_back(normal / length);
+			axis += normals.back();
+		}
+
+		meshlet.coneApex = meshlet.center;
+		meshlet.coneAxis = glm::vec3(0.0f);
+		meshlet.coneCutoff = 1.0f;
+
+		float axisLength = glm::length(axis);
+		if (normals.empty() || axisLength <= 0.0f)
+			return;
+
+		axis = axis / axisLength;
+
+		float minDot = 1.0f;
+		for (const glm::vec3& normal : normals)
+			minDot = std::min(minDot, glm::dot(normal, axis));
+
+		// A cone wider than ~85 degrees almost never faces away from the camera, it isn't worth testing
+		if (minDot <= 0.1f)
+			return;
+
+		// Move the apex back along the axis so it is behind every triangle plane, the cone test is then conservative for the whole cluster
+		float maxDistance = 0.0f;
+		size_t normalIndex = 0;
+
+		for (size_t i = begin; i < end; i += 3)
+		{
+			glm::vec3 p0 = getPosition(indices[i]);
+			glm::vec3 normal = glm::cross(getPosition(indices[i + 1]) - p0, getPosition(indices[i + 2]) - p0);
+
+			if (glm::length(normal) <= 0.0f)
+				continue;
+
+			const glm::vec3& unitNormal = normals[normalIndex++];
+			maxDistance = std::max(maxDistance, glm::dot(meshlet.center - p0, unitNormal) / glm::dot(axis, unitNormal));
+		}
+
+		meshlet.coneApex = meshlet.center - axis * maxDistance;
+		meshlet.coneAxis = axis;
+		meshlet.coneCutoff = std::sqrt(1.0f - minDot * minDot);
+	}
+
+	/// <summary>
+	/// Culls meshlets against frustum planes and their normal cone, and writes the index ranges of the visible ones
+	/// Visible meshlets that follow each other in the index buffer are merged into a single range
+	/// </summary>
+	/// <param name="meshlets">The meshlets of the mesh</param>
+	/// <param name="firstMeshlet">The first meshlet to cull</param>
+	/// <param name="meshletCount">The number of meshlets to cull</param>
+	/// <param name="planes">The six frustum planes in world space, facing inwards</param>
+	/// <param name="modelMatrix">The transform from object to world space</param>
+	/// <param name="cameraPosition">The position of the camera in world space</param>
+	/// <param name="visibleRanges">Receives the index ranges to draw, cleared first</param>
+	/// <returns>The number of visible meshlets</returns>
+	static size_t cullMeshlets(const std::vector<Meshlet>& meshlets, size_t firstMeshlet, size_t meshletCount, const Plane* planes, const glm::mat4& modelMatrix, const glm::vec3& cameraPosition, std::vector<IndexRange>& visibleRanges)
+	{
+		visibleRanges.clear();
+
+		glm::vec3 axisX = glm::vec3(modelMatrix[0]);
+		glm::vec3 axisY = glm::vec3(modelMatrix[1]);
+		glm::vec3 axisZ = glm::vec3(modelMatrix[2]);
+		glm::vec3 translation = glm::vec3(modelMatrix[3]);
+
+		float scaleX = glm::length(axisX);
+		float scaleY = glm::length(axisY);
+		float scaleZ = glm::length(axisZ);
+		float maxScale = std::max(scaleX, std::max(scaleY, scaleZ));
+		float minScale = std::min(scaleX, std::min(scaleY, scaleZ));
+
+		// Normal cones are only preserved by rotations and uniform scales
+		bool testCones = minScale > 0.0f && minScale >= maxScale * 0.99f;
+		float inverseScale = maxScale > 0.0f ? 1.0f / maxScale : 0.0f;
+
+		size_t visibleCount = 0;
+
+		for (size_t i = firstMeshlet; i < firstMeshlet + meshletCount; i++)
+		{
+			const Meshlet& meshlet = meshlets[i];
+
+			glm::vec3 center = axisX * meshlet.center.x + axisY * meshlet.center.y + axisZ * meshlet.center.z + translation;
+			float radius = meshlet.radius * maxScale;
+
+			bool visible = true;
+
+			for (int plane = 0; plane < 6 && visible; plane++)
+				visible = planes[plane].getSignedDistanceToPlane(center) >= -radius;
+
+			if (visible && testCones && meshlet.coneCutoff < 1.0f)
+			{
+				glm::vec3 apex = axisX * meshlet.coneApex.x + axisY * meshlet.coneApex.y + axisZ * meshlet.coneApex.z + translation;
+				glm::vec3 axis = (axisX * meshlet.coneAxis.x + axisY * meshlet.coneAxis.y + axisZ * meshlet.coneAxis.z) * inverseScale;
+				glm::vec3 view = apex - cameraPosition;
+				float viewLength = glm::length(view);
+
+				visible = viewLength <= 0.0f || glm::dot(view, axis) < meshlet.coneCutoff * viewLength;
+			}
+
+			if (!visible)
+				continue;
+
+			visibleCount++;
+
+			if (!visibleRanges.empty() && visibleRanges.back().offset + visibleRanges.back().count == meshlet.indexOffset)
+				visibleRanges.back().count += meshlet.indexCount;
+			else
+				visibleRanges.push_back({ meshlet.indexOffset, meshlet.indexCount });
+		}
+
+		return visibleCount;
+	}
+
+	static BoundingBox getMeshBoundingBox(const std::vector<float> &vertices)
+	{
+		assert(vertices.size() % 3 == 0 && "Vector contains malformed vertice data!");
+
+		float minX = INFINITY;
+		float minY = INFINITY;
+		float minZ = INFINITY;
+
+		float maxX = -INFINITY;
+		float maxY = -INFINITY;
+		float maxZ = -INFINITY;
+
+		for (int i = 0; i < vertices.size(); i += 3)
+		{
+			if (vertices[i] < minX) minX = vertices[i];
+			if (vertices[i + 1] < minY) minY = vertices[i + 1];
+			if (vertices[i + 2] < minZ) minZ = vertices[i + 2];
+
+			if (vertices[i] > maxX) maxX = vertices[i];
+			if (vertices[i + 1] > maxY) maxY = vertices[i + 1];
+			if (vertices[i + 2] > maxZ) maxZ = vertices[i + 2];
 		}
 
 		return {glm::vec3(minX, minY, minZ), glm::vec3(maxX, maxY, maxZ)};
 	}
+
+	/// <summary>
+	/// Calculates how many texture coordinates units a unit length of the surface of a mesh covers, averaged over its triangles
+	/// </summary>
+	/// <param name="vertices">The positions of the vertices</param>
+	/// <param name="texCoords">The texture coordinates of the vertices</param>
+	/// <param name="indices">The indices of the triangles, or an empty vector for non indexed meshes</param>
+	/// <param name="indexOffset">The first index of the triangles to measure</param>
+	/// <param name="indexCount">The number of indices of the triangles to measure</param>
+	/// <returns>The density, or 0 if the mesh has no texture coordinates or no area</returns>
+	static float getTexCoordDensity(const std::vector<float>& vertices, const std::vector<float>& texCoords, const std::vector<unsigned int>& indices, size_t indexOffset, size_t indexCount)
+	{
+		size_t vertexCount = vertices.size() / 3;
+
+		if (texCoords.size() < vertexCount * 2)
+			return 0.0f;
+
+		double surfaceArea = 0.0;
+		double texCoordArea = 0.0;
+
+		for (size_t i = indexOffset; i + 2 < indexOffset + indexCount; i += 3)
+		{
+			unsigned int triangle[3];
+
+			for (int j = 0; j < 3; j++)
+				triangle[j] = indices.empty() ? static_cast<unsigned int>(i + j) : indices[i + j];
+
+			if (triangle[0] >= vertexCount || triangle[1] >= vertexCount || triangle[2] >= vertexCount)
+				continue;
+
+			glm::vec3 v1 = getPosition(vertices, triangle[0]);
+			glm::vec3 v2 = getPosition(vertices, triangle[1]);
+			glm::vec3 v3 = getPosition(vertices, triangle[2]);
+
+			glm::vec2 uv1(texCoords[triangle[0] * 2], texCoords[triangle[0] * 2 + 1]);
+			glm::vec2 uv2(texCoords[triangle[1] * 2], texCoords[triangle[1] * 2 + 1]);
+			glm::vec2 uv3(texCoords[triangle[2] * 2], texCoords[triangle[2] * 2 + 1]);
+
+			glm::vec2 uvEdge1 = uv2 - uv1;
+			glm::vec2 uvEdge2 = uv3 - uv1;
+
+			surfaceArea += glm::length(glm::cross(v2 - v1, v3 - v1)) * 0.5;
+			texCoordArea += std::abs(uvEdge1.x * uvEdge2.y - uvEdge1.y * uvEdge2.x) * 0.5;
+		}
+
+		// Areas scale with the square of lengths
+		return surfaceArea > 0.0 ? static_cast<float>(std::sqrt(texCoordArea / surfaceArea)) : 0.0f;
+	}
+
+private:
+	/// <summary>
+	/// The number of vertices or triangles processed per chunk by the multithreaded functions
+	/// </summary>
+	static constexpr size_t PARALLEL_CHUNK_SIZE = 16384;
+
+	/// <summary>
+	/// The number of hash bits used to split vertices in partitions when welding
+	/// </summary>
+	static constexpr unsigned int WELD_PARTITION_BITS = 6;
+
+	/// <summary>
+	/// Returns the position of a vertex from a vector of floats
+	/// </summary>
+	static glm::vec3 getPosition(const std::vector<float>& vertices, unsigned int vertex)
+	{
+		return glm::vec3(vertices[vertex * 3], vertices[vertex * 3 + 1], vertices[vertex * 3 + 2]);
+	}
+
+	/// <summary>
+	/// Returns the unit normal of a triangle, or a null vector if the triangle is degenerate
+	/// </summary>
+	static glm::vec3 getFaceNormal(const glm::vec3& v1, const glm::vec3& v2, const glm::vec3& v3)
+	{
+		glm::vec3 normal = glm::cross(v2 - v1, v3 - v1);
+		float length = glm::length(normal);
+
+		return length > 0.0f ? normal / length : glm::vec3(0.0f);
+	}
+
+	/// <summary>
+	/// Builds the list of triangles using each vertex, the triangles of vertex v are vertexTriangles[triangleOffsets[v]] to vertexTriangles[triangleOffsets[v + 1]]
+	/// </summary>
+	static void buildVertexTriangles(const std::vector<unsigned int>& indices, size_t vertexCount, std::vector<unsigned int>& triangleOffsets, std::vector<unsigned int>& vertexTriangles)
+	{
+		triangleOffsets.assign(vertexCount + 1, 0);
+
+		for (unsigned int index : indices)
+			triangleOffsets[index + 1]++;
+
+		for (size_t vertex = 0; vertex < vertexCount; vertex++)
+			triangleOffsets[vertex + 1] += triangleOffsets[vertex];
+
+		vertexTriangles.resize(indices.size());
+		std::vector<unsigned int> fillOffsets(triangleOffsets.begin(), triangleOffsets.end() - 1);
+
+		for (size_t i = 0; i < indices.size(); i++)
+			vertexTriangles[fillOffsets[indices[i]]++] = static_cast<unsigned int>(i / 3);
+	}
+
+	/// <summary>
+	/// Turns the first occurence of each vertex into a remap table, welded vertices are numbered in order of first occurence
+	/// </summary>
+	static std::vector<unsigned int> numberWeldedVertices(const std::vector<unsigned int>& firstOccurences, size_t& uniqueVertexCount)
+	{
+		// A first occurence always comes before its duplicates, so it is numbered by the time we reach them
+		std::vector<unsigned int> remap(firstOccurences.size());
+		unsigned int nextVertex = 0;
+
+		for (size_t vertex = 0; vertex < firstOccurences.size(); vertex++)
+			remap[vertex] = firstOccurences[vertex] == vertex ? nextVertex++ : remap[firstOccurences[vertex]];
+
+		uniqueVertexCount = nextVertex;
+		return remap;
+	}
+
+	/// <summary>
+	/// Points each vertex to an earlier vertex that has all its attributes within epsilon of its own, or to itself if there is none
+	/// The vertices are put in a grid of epsilon sized cells on their first attribute, the cells are split in partitions by hash
+	/// and each partition merges the vertices of its cells in parallel, like the exact weld
+	/// A second pass merges the vertices left in each cell with the ones of the neighbouring cells, so values close to each other
+	/// on either side of a cell boundary are merged too. A vertex is only ever merged with a vertex within epsilon of its own,
+	/// the rare chains of close vertices across several cells are cut, so the result doesn't depend on the number of threads
+	/// </summary>
+	static std::vector<unsigned int> findCloseVertices(const std::vector<WeldAttribute>& attributes, size_t vertexCount)
+	{
+		const WeldAttribute& gridAttribute = attributes.front();
+		const unsigned int componentCount = gridAttribute.componentCount;
+		assert(componentCount <= 4 && "The first weld attribute has too many components to build a grid on!");
+
+		// The cell of the vertex and its neighbours on every axis, only its own cell when the grid attribute has to match exactly
+		unsigned int neighbourCount = 1;
+		if (gridAttribute.epsilon > 0.0f)
+		{
+			for (unsigned int component = 0; component < componentCount; component++)
+				neighbourCount *= 3;
+		}
+
+		// The neighbour whose base 3 digits are all 1 is the cell itself
+		const unsigned int ownNeighbour = (neighbourCount - 1) / 2;
+
+		auto getCells = [&](size_t vertex, uint64_t* cells) {
+			const float* values = gridAttribute.values->data() + vertex * componentCount;
+			for (unsigned int component = 0; component < componentCount; component++)
+				cells[component] = Geometry::getWeldKey(values[component], gridAttribute.epsilon);
+		};
+
+		auto hashCells = [&](const uint64_t* cells) {
+			uint64_t hash = 0;
+			for (unsigned int component = 0; component < componentCount; component++)
+				hash = Geometry::mixWeldHash(hash, cells[component]);
+			return Geometry::finalizeWeldHash(hash);
+		};
+
+		std::vector<uint64_t> hashes(vertexCount);
+
+		Parallel::forChunks(vertexCount, Geometry::PARALLEL_CHUNK_SIZE, [&](size_t begin, size_t end) {
+			uint64_t cells[4];
+
+			for (size_t vertex = begin; vertex < end; vertex++)
+			{
+				getCells(vertex, cells);
+				hashes[vertex] = hashCells(cells);
+			}
+		});
+
+		// All the vertices of a cell land in the same partition since they share their hash
+		const unsigned int partitionBits = vertexCount > Geometry::PARALLEL_CHUNK_SIZE ? Geometry::WELD_PARTITION_BITS : 0;
+		const size_t partitionCount = static_cast<size_t>(1) << partitionBits;
+
+		std::vector<unsigned int> sortedVertices;
+		std::vector<size_t> partitionOffsets;
+		Geometry::partitionWeldVertices(hashes, partitionBits, sortedVertices, partitionOffsets);
+
+		// The tables of all the partitions share one vector and are kept for the second pass, which probes the cells of other partitions
+		// Only the first occurences of each cell are inserted, under a load factor of 0.5
+		std::vector<size_t> tableOffsets(partitionCount + 1, 0);
+
+		for (size_t partition = 0; partition < partitionCount; partition++)
+		{
+			size_t tableSize = 1;
+			while (tableSize < (partitionOffsets[partition + 1] - partitionOffsets[partition]) * 2)
+				tableSize <<= 1;
+
+			tableOffsets[partition + 1] = tableOffsets[partition] + tableSize;
+		}
+
+		std::vector<uint64_t> tables(tableOffsets[partitionCount], UINT64_MAX);
+
+		// Calls function(candidate) for each vertex of the tables that can be in the cell with this hash
+		auto forEachInCell = [&](uint64_t hash, const auto& function) {
+			size_t partition = Geometry::getWeldPartition(hash, partitionBits);
+			const size_t tableOffset = tableOffsets[partition];
+			const size_t mask = tableOffsets[partition + 1] - tableOffset - 1;
+			const uint64_t hashTag = hash & 0xFFFFFFFF00000000ull;
+
+			for (size_t slot = static_cast<size_t>(hash) & mask; tables[tableOffset + slot] != UINT64_MAX; slot = (slot + 1) & mask)
+			{
+				if ((tables[tableOffset + slot] & 0xFFFFFFFF00000000ull) == hashTag)
+					function(static_cast<unsigned int>(tables[tableOffset + slot] & 0xFFFFFFFFull));
+			}
+		};
+
+		// First pass, each vertex points to the first vertex of its cell within epsilon of its own, the partitions are visited
+		// in ascending vertex order so the earliest close vertex of the cell is always already in the table
+		std::vector<unsigned int> cellOccurences(vertexCount);
+
+		Parallel::forChunks(partitionCount, 1, [&](size_t firstPartition, size_t lastPartition) {
+			for (size_t partition = firstPartition; partition < lastPartition; partition++)
+			{
+				const size_t tableOffset = tableOffsets[partition];
+				const size_t mask = tableOffsets[partition + 1] - tableOffset - 1;
+
+				for (size_t i = partitionOffsets[partition]; i < partitionOffsets[partition + 1]; i++)
+				{
+					unsigned int vertex = sortedVertices[i];
+					unsigned int firstOccurence = vertex;
+
+					forEachInCell(hashes[vertex], [&](unsigned int candidate) {
+						if (candidate < firstOccurence && Geometry::areWeldVerticesClose(attributes, candidate, vertex))
+							firstOccurence = candidate;
+					});
+
+					cellOccurences[vertex] = firstOccurence;
+
+					if (firstOccurence == vertex)
+					{
+						size_t slot = static_cast<size_t>(hashes[vertex]) & mask;
+						while (tables[tableOffset + slot] != UINT64_MAX)
+							slot = (slot + 1) & mask;
+
+						tables[tableOffset + slot] = (hashes[vertex] & 0xFFFFFFFF00000000ull) | vertex;
+					}
+				}
+			}
+		});
+
+		// When the grid attribute matches exactly close vertices always share their cell, there is nothing to merge across cells
+		if (neighbourCount == 1)
+			return cellOccurences;
+
+		// Second pass, the first occurences of each cell point to the first occurence of a neighbouring cell within epsilon of their own
+		// The tables are only read from now on
+		std::vector<unsigned int> neighbourOccurences(vertexCount);
+
+		Parallel::forChunks(vertexCount, Geometry::PARALLEL_CHUNK_SIZE, [&](size_t begin, size_t end) {
+			uint64_t cells[4];
+			uint64_t neighbourCells[4];
+
+			for (size_t vertex = begin; vertex < end; vertex++)
+			{
+				auto firstOccurence = static_cast<unsigned int>(vertex);
+
+				if (cellOccurences[vertex] == vertex)
+				{
+					getCells(vertex, cells);
+
+					for (unsigned int neighbour = 0; neighbour < neighbourCount; neighbour++)
+					{
+						if (neighbour == ownNeighbour)
+							continue;
+
+						// Each base 3 digit of the neighbour is the offset of the cell on one axis, the cells wrap like the int64 they hold
+						unsigned int digits = neighbour;
+						for (unsigned int component = 0; component < componentCount; component++)
+						{
+							neighbourCells[component] = cells[component] + static_cast<uint64_t>(digits % 3) - 1;
+							digits /= 3;
+						}
+
+						forEachInCell(hashCells(neighbourCells), [&](unsigned int candidate) {
+							if (candidate < firstOccurence && Geometry::areWeldVerticesClose(attributes, candidate, vertex))
+								firstOccurence = candidate;
+						});
+					}
+				}
+
+				neighbourOccurences[vertex] = firstOccurence;
+			}
+		});
+
+		// A vertex merged with a vertex that is itself merged further away would end up more than epsilon from where it goes,
+		// it is kept then, and the vertices of its cell follow it only if they are close enough to where it went
+		std::vector<unsigned int> firstOccurences(vertexCount);
+
+		Parallel::forChunks(vertexCount, Geometry::PARALLEL_CHUNK_SIZE, [&](size_t begin, size_t end) {
+			auto resolve = [&](unsigned int vertex) {
+				unsigned int neighbourOccurence = neighbourOccurences[vertex];
+				return neighbourOccurences[neighbourOccurence] == neighbourOccurence ? neighbourOccurence : vertex;
+			};
+
+			for (size_t vertex = begin; vertex < end; vertex++)
+			{
+				unsigned int cellOccurence = cellOccurences[vertex];
+				unsigned int firstOccurence = resolve(cellOccurence);
+
+				if (cellOccurence != vertex && firstOccurence != cellOccurence && !Geometry::areWeldVerticesClose(attributes, firstOccurence, vertex))
+					firstOccurence = static_cast<unsigned int>(vertex);
+
+				firstOccurences[vertex] = firstOccurence;
+			}
+		});
+
+		return firstOccurences;
+	}
+
+	/// <summary>
+	/// Returns the partition of a vertex hash, from its high bits
+	/// </summary>
+	static size_t getWeldPartition(uint64_t hash, unsigned int partitionBits)
+	{
+		return partitionBits == 0 ? 0 : static_cast<size_t>(hash >> (64 - partitionBits));
+	}
+
+	/// <summary>
+	/// Buckets the vertices by partition with a counting sort over chunks of vertices, each partition keeps its vertices in ascending order
+	/// The vertices of partition p are sortedVertices[partitionOffsets[p]] to sortedVertices[partitionOffsets[p + 1]]
+	/// </summary>
+	static void partitionWeldVertices(const std::vector<uint64_t>& hashes, unsigned int partitionBits, std::vector<unsigned int>& sortedVertices,
+		std::vector<size_t>& partitionOffsets)
+	{
+		const size_t vertexCount = hashes.size();
+		const size_t partitionCount = static_cast<size_t>(1) << partitionBits;
+		const size_t chunkCount = (vertexCount + Geometry::PARALLEL_CHUNK_SIZE - 1) / Geometry::PARALLEL_CHUNK_SIZE;
+
+		std::vector<size_t> chunkOffsets(chunkCount * partitionCount, 0);
+
+		Parallel::forChunks(chunkCount, 1, [&](size_t firstChunk, size_t lastChunk) {
+			for (size_t chunk = firstChunk; chunk < lastChunk; chunk++)
+			{
+				size_t end = std::min(vertexCount, (chunk + 1) * Geometry::PARALLEL_CHUNK_SIZE);
+				for (size_t vertex = chunk * Geometry::PARALLEL_CHUNK_SIZE; vertex < end; vertex++)
+					chunkOffsets[chunk * partitionCount + Geometry::getWeldPartition(hashes[vertex], partitionBits)]++;
+			}
+		});
+
+		partitionOffsets.assign(partitionCount + 1, 0);
+		size_t offset = 0;
+
+		for (size_t partition = 0; partition < partitionCount; partition++)
+		{
+			partitionOffsets[partition] = offset;
+
+			for (size_t chunk = 0; chunk < chunkCount; chunk++)
+			{
+				size_t count = chunkOffsets[chunk * partitionCount + partition];
+				chunkOffsets[chunk * partitionCount + partition] = offset;
+				offset += count;
+			}
+		}
+
+		partitionOffsets[partitionCount] = offset;
+		sortedVertices.resize(vertexCount);
+
+		Parallel::forChunks(chunkCount, 1, [&](size_t firstChunk, size_t lastChunk) {
+			for (size_t chunk = firstChunk; chunk < lastChunk; chunk++)
+			{
+				size_t end = std::min(vertexCount, (chunk + 1) * Geometry::PARALLEL_CHUNK_SIZE);
+				for (size_t vertex = chunk * Geometry::PARALLEL_CHUNK_SIZE; vertex < end; vertex++)
+					sortedVertices[chunkOffsets[chunk * partitionCount + Geometry::getWeldPartition(hashes[vertex], partitionBits)]++] = static_cast<unsigned int>(vertex);
+			}
+		});
+	}
+
+	/// <summary>
+	/// Returns the key a value is compared with when welding, the index of its epsilon sized cell or its bits when epsilon is 0
+	/// </summary>
+	static uint64_t getWeldKey(float value, float epsilon)
+	{
+		if (epsilon > 0.0f)
+		{
+			double cell = std::floor(static_cast<double>(value) / static_cast<double>(epsilon));
+			cell = std::min(std::max(cell, -9.0e18), 9.0e18);
+			return static_cast<uint64_t>(static_cast<int64_t>(cell));
+		}
+
+		// Adding zero turns -0 into +0 so they are merged
+		value += 0.0f;
+
+		uint32_t bits = 0;
+		std::memcpy(&bits, &value, sizeof(bits));
+		return bits;
+	}
+
+	/// <summary>
+	/// Hashes the keys of all the attributes of a vertex
+	/// </summary>
+	static uint64_t hashWeldVertex(const std::vector<WeldAttribute>& attributes, size_t vertex)
+	{
+		uint64_t hash = 0;
+
+		for (const WeldAttribute& attribute : attributes)
+		{
+			const float* values = attribute.values->data() + vertex * attribute.componentCount;
+
+			for (unsigned int component = 0; component < attribute.componentCount; component++)
+				hash = Geometry::mixWeldHash(hash, Geometry::getWeldKey(values[component], attribute.epsilon));
+		}
+
+		return Geometry::finalizeWeldHash(hash);
+	}
+
+	/// <summary>
+	/// Combines a weld key into a hash
+	/// </summary>
+	static uint64_t mixWeldHash(uint64_t hash, uint64_t key)
+	{
+		hash ^= key;
+		hash *= 0x9E3779B97F4A7C15ull;
+		hash ^= hash >> 32;
+		return hash;
+	}
+
+	/// <summary>
+	/// Final avalanche so both the low (slot) and high (partition) bits are well distributed
+	/// </summary>
+	static uint64_t finalizeWeldHash(uint64_t hash)
+	{
+		hash ^= hash >> 33;
+		hash *= 0xFF51AFD7ED558CCDull;
+		hash ^= hash >> 33;
+		hash *= 0xC4CEB9FE1A85EC53ull;
+		hash ^= hash >> 33;
+		return hash;
+	}
+
+	/// <summary>
+	/// Returns whether two vertices have the same keys for all the attributes
+	/// </summary>
+	static bool areWeldVerticesEqual(const std::vector<WeldAttribute>& attributes, size_t first, size_t second)
+	{
+		for (const WeldAttribute& attribute : attributes)
+		{
+			const float* firstValues = attribute.values->data() + first * attribute.componentCount;
+			const float* secondValues = attribute.values->data() + second * attribute.componentCount;
+
+			for (unsigned int component = 0; component < attribute.componentCount; component++)
+			{
+				// Duplicated vertices usually have identical values, which skips computing the keys
+				if (firstValues[component] != secondValues[component]
+					&& Geometry::getWeldKey(firstValues[component], attribute.epsilon) != Geometry::getWeldKey(secondValues[component], attribute.epsilon))
+					return false;
+			}
+		}
+
+		return true;
+	}
+
+	/// <summary>
+	/// Returns whether all the attributes of two vertices are within the epsilon of the attribute of each other
+	/// </summary>
+	static bool areWeldVerticesClose(const std::vector<WeldAttribute>& attributes, size_t first, size_t second)
+	{
+		for (const WeldAttribute& attribute : attributes)
+		{
+			const float* firstValues = attribute.values->data() + first * attribute.componentCount;
+			const float* secondValues = attribute.values->data() + second * attribute.componentCount;
+
+			for (unsigned int component = 0; component < attribute.componentCount; component++)
+			{
+				if (!(std::abs(firstValues[component] - secondValues[component]) <= attribute.epsilon))
+					return false;
+			}
+		}
+
+		return true;
+	}
 };
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+/// <summary>
+/// A utility class to hash the content of buffers, used to key the caches of assets built from them
+/// </summary>
+class Hash
+{
+public:
+	/// <summary>
+	/// The default seed of the hash, chaining calls with the previous hash as the seed hashes several buffers together
+	/// </summary>
+	static constexpr uint64_t DEFAULT_SEED = 0xCBF29CE484222325ull;
+
+	/// <summary>
+	/// Hashes a buffer 8 bytes at a time, this is not a cryptographic hash
+	/// </summary>
+	/// <param name="data">The bytes to hash</param>
+	/// <param name="size">The number of bytes</param>
+	/// <param name="seed">The starting value of the hash</param>
+	static uint64_t hashBytes(const void* data, size_t size, uint64_t seed = DEFAULT_SEED)
+	{
+		const auto* bytes = static_cast<const unsigned char*>(data);
+		uint64_t hash = seed ^ (size * PRIME);
+
+		size_t wordCount = size / sizeof(uint64_t);
+
+		for (size_t i = 0; i < wordCount; i++)
+		{
+			uint64_t word;
+			std::memcpy(&word, bytes + i * sizeof(uint64_t), sizeof(uint64_t));
+			hash = (hash ^ Hash::mix(word)) * PRIME;
+		}
+
+		// The remaining bytes are packed in a last word
+		uint64_t tail = 0;
+		size_t tailSize = size - wordCount * sizeof(uint64_t);
+
+		if (tailSize > 0)
+			std::memcpy(&tail, bytes + wordCount * sizeof(uint64_t), tailSize);
+
+		hash = (hash ^ Hash::mix(tail)) * PRIME;
+
+		return Hash::mix(hash);
+	}
+
+	/// <summary>
+	/// Hashes the content of a vector
+	/// </summary>
+	template<typename T>
+	static uint64_t hashVector(const std::vector<T>& values, uint64_t seed = DEFAULT_SEED)
+	{
+		return Hash::hashBytes(values.data(), values.size() * sizeof(T), seed);
+	}
+
+private:
+	static constexpr uint64_t PRIME = 0x9E3779B97F4A7C15ull;
+
+	/// <summary>
+	/// Spreads the bits of a word so that nearby inputs give unrelated hashes (finalizer of MurmurHash3)
+	/// </summary>
+	static uint64_t mix(uint64_t value)
+	{
+		value ^= value >> 33;
+		value *= 0xFF51AFD7ED558CCDull;
+		value ^= value >> 33;
+		value *= 0xC4CEB93FE53A85EBull;
+		value ^= value >> 33;
+
+		return value;
+	}
+};
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <string>
+#include <system_error>
+
+/// <summary>
+/// A read only memory mapping of a whole file, the pages are only read from disk when they are accessed
+/// </summary>
+class MappedFile
+{
+public:
+	/// <summary>
+	/// Maps a file, isOpen returns false if it couldn't be opened or is empty
+	/// </summary>
+	/// <param name="path">The path of the file</param>
+	explicit MappedFile(const std::string& path);
+	~MappedFile();
+
+	MappedFile(MappedFile const&) = delete;
+	MappedFile& operator=(MappedFile const&) = delete;
+
+	[[nodiscard]] bool isOpen() const;
+
+	/// <summary>
+	/// Returns the content of the file, valid as long as the mapping is alive
+	/// </summary>
+	[[nodiscard]] const unsigned char* getData() const;
+
+	[[nodiscard]] size_t getSize() const;
+
+private:
+	const unsigned char* data = nullptr;
+	size_t size = 0;
+
+#ifdef _WIN32
+	void* fileHandle = nullptr;
+	void* mappingHandle = nullptr;
+#else
+	int fileDescriptor = -1;
+#endif
+};
+
+/// <summary>
+/// The naming and writing of the cache files, which are read back through a MappedFile
+/// </summary>
+class CacheFile
+{
+public:
+	/// <summary>
+	/// Returns the path of a cache file, named after the hexadecimal key of its source
+	/// </summary>
+	/// <param name="directory">The cache directory</param>
+	/// <param name="key">The hash identifying the source of the file</param>
+	/// <param name="extension">The extension of the file, which tells the kind of data it holds</param>
+	[[nodiscard]] static std::string getPath(const std::string& directory, uint64_t key, const std::string& extension);
+
+	/// <summary>
+	/// Writes a cache file through a temporary file, so a crash never leaves a truncated file under the final name
+	/// The directory of the file is created if needed, and the temporary file is removed on failure
+	/// </summary>
+	/// <param name="path">The path of the cache file</param>
+	/// <param name="write">Writes the content of the file to the stream</param>
+	/// <param name="error">Set to the reason of the failure</param>
+	/// <returns>Whether the file was written</returns>
+	static bool write(const std::string& path, const std::function<void(std::ofstream&)>& write, std::error_code& error);
+};
@@ -0,0 +1,287 @@
+#pragma once
+
+#include <vector>
+
+#include <assimp/scene.h>
+#include <assimp/postprocess.h>
+
+#include "utilities/geometry.hpp"
+
+/// <summary>
+/// The steps of importing a mesh with Assimp that don't need an OpenGL context, shared by the ResourceLoader and the import benchmark
+/// </summary>
+class MeshImport
+{
+public:
+	/// <summary>
+	/// The fraction of triangles kept by each level of detail compared to the previous one
+	/// </summary>
+	static constexpr float LOD_REDUCTION = 0.5f;
+
+	/// <summary>
+	/// The largest error allowed when simplifying a level of detail, relative to the size of the mesh
+	/// </summary>
+	static constexpr float LOD_MAX_ERROR = 0.05f;
+
+	/// <summary>
+	/// Returns the post processing steps the models are imported with
+	/// </summary>
+	/// <param name="preserveHierarchy">Whether the node transforms are kept, otherwise they are baked into the vertices</param>
+	static unsigned int getImportFlags(bool preserveHierarchy)
+	{
+		unsigned int importFlags = aiProcess_Triangulate | aiProcess_FlipUVs;
+
+		// Baking the transforms duplicates the meshes referenced by several nodes, keeping the hierarchy lets them share their geometry
+		if (!preserveHierarchy)
+			importFlags |= aiProcess_PreTransformVertices;
+
+		return importFlags;
+	}
+
+	/// <summary>
+	/// Copies the vertex attributes and the indices of an imported mesh into the streams a MeshComponent takes
+	/// The streams are sized once and written in a single pass, meshes without texture coordinates get zeroed ones,
+	/// the normals, tangents and bitangents are left empty when the mesh has none
+	/// </summary>
+	static void extractVertices(const aiMesh* mesh, std::vector<float>& vertices, std::vector<float>& texCoords, std::vector<float>& normals,
+		std::vector<float>& tangents, std::vector<float>& bitangents, std::vector<unsigned int>& indices)
+	{
+		static_assert(sizeof(aiVector3D) == 3 * sizeof(float), "The attributes of Assimp are copied as packed floats");
+
+		size_t vertexCount = mesh->mNumVertices;
+
+		vertices.clear();
+		texCoords.clear();
+		normals.clear();
+		tangents.clear();
+		bitangents.clear();
+		indices.clear();
+
+		if (vertexCount == 0)
+			return;
+
+		// Assimp stores the attributes as contiguous arrays of packed floats, which is already the layout of the streams
+		copyAttribute(mesh->mVertices, vertexCount, vertices);
+
+		if (mesh->HasNormals())
+			copyAttribute(mesh->mNormals, vertexCount, normals);
+
+		if (mesh->HasTangentsAndBitangents())
+		{
+			copyAttribute(mesh->mTangents, vertexCount, tangents);
+			copyAttribute(mesh->mBitangents, vertexCount, bitangents);
+		}
+
+		// Texture coordinates have a third component, only the first two are kept
+		if (mesh->HasTextureCoords(0))
+		{
+			const aiVector3D* meshTexCoords = mesh->mTextureCoords[0];
+			texCoords.reserve(vertexCount * 2);
+
+			for (size_t i = 0; i < vertexCount; i++)
+			{
+				texCoords.push_back(meshTexCoords[i].x);
+				texCoords.push_back(meshTexCoords[i].y);
+			}
+		}
+		else
+			texCoords.assign(vertexCount * 2, 0.0f);
+
+		// Triangulating leaves the point and line faces as they are, the indices are drawn as GL_TRIANGLES so only the triangles are kept,
+		// anything else would shift every following triangle
+		indices.reserve(static_cast<size_t>(mesh->mNumFaces) * 3);
+
+		for (unsigned int i = 0; i < mesh->mNumFaces; i++)
+		{
+			const aiFace& face = mesh->mFaces[i];
+
+			if (face.mNumIndices == 3)
+				indices.insert(indices.end(), face.mIndices, face.mIndices + 3);
+		}
+	}
+
+	/// <summary>
+	/// Merges the vertices that have all their attributes within epsilon of each other
+	/// </summary>
+	/// <param name="attributeRemap">If not null, only the positions and indices are remapped and the attributes are left to optimizeMesh,
+	/// which applies this remap together with its own so they are rebuilt once, receives an empty remap if no vertex was merged</param>
+	static void weldMesh(std::vector<float>& vertices, std::vector<float>& texCoords, std::vector<float>& normals, std::vector<unsigned int>& indices,
+		std::vector<float>& tangents, std::vector<float>& bitangents, float epsilon, std::vector<unsigned int>* attributeRemap = nullptr)
+	{
+		if (attributeRemap != nullptr)
+			attributeRemap->clear();
+
+		if (indices.empty())
+			return;
+
+		size_t vertexCount = vertices.size() / 3;
+		std::vector<WeldAttribute> attributes = { WeldAttribute{ &vertices, 3, epsilon } };
+
+		if (!texCoords.empty())
+			attributes.push_back(WeldAttribute{ &texCoords, 2, epsilon });
+		if (!normals.empty())
+			attributes.push_back(WeldAttribute{ &normals, 3, epsilon });
+		if (!tangents.empty())
+			attributes.push_back(WeldAttribute{ &tangents, 3, epsilon });
+		if (!bitangents.empty())
+			attributes.push_back(WeldAttribute{ &bitangents, 3, epsilon });
+
+		size_t uniqueVertexCount = 0;
+		std::vector<unsigned int> remap = Geometry::weldVertices(attributes, vertexCount, uniqueVertexCount);
+
+		if (uniqueVertexCount == vertexCount)
+			return;
+
+		Geometry::remapIndices(indices, remap);
+
+		if (attributeRemap != nullptr)
+		{
+			vertices = Geometry::remapVertexAttribute(vertices, remap, 3, uniqueVertexCount);
+			*attributeRemap = std::move(remap);
+		}
+		else
+		{
+			MeshImport::remapAttributes(remap, remap, uniqueVertexCount, vertices, texCoords, normals, tangents, bitangents);
+		}
+	}
+
+	/// <summary>
+	/// Reorders the triangles for the vertex cache and overdraw, then the vertices in the order they are fetched
+	/// </summary>
+	/// <param name="statisticsBefore">If not null, receives the vertex cache statistics of the input order</param>
+	/// <param name="statisticsAfter">If not null, receives the vertex cache statistics of the optimized order</param>
+	/// <param name="attributeRemap">If not null or empty, the remap left by weldMesh, which the attributes still have to go through</param>
+	static void optimizeMesh(std::vector<float>& vertices, std::vector<float>& texCoords, std::vector<float>& normals, std::vector<unsigned int>& indices,
+		std::vector<float>& tangents, std::vector<float>& bitangents, VertexCacheStatistics* statisticsBefore = nullptr, VertexCacheStatistics* statisticsAfter = nullptr,
+		const std::vector<unsigned int>* attributeRemap = nullptr)
+	{
+		if (indices.empty())
+			return;
+
+		size_t vertexCount = vertices.size() / 3;
+		VertexCacheStatistics inputStatistics = Geometry::analyzeVertexCache(indices, vertexCount);
+
+		std::vector<unsigned int> optimizedIndices = Geometry::optimizeVertexCache(indices, vertexCount);
+		optimizedIndices = Geometry::optimizeOverdraw(optimizedIndices, vertices);
+
+		// Meshes exported already optimized can come out slightly worse, the overdraw pass trades some cache hits, keep their order then
+		if (Geometry::analyzeVertexCache(optimizedIndices, vertexCount).cacheMisses <= inputStatistics.cacheMisses)
+			indices = std::move(optimizedIndices);
+
+		size_t uniqueVertexCount = 0;
+		std::vector<unsigned int> remap = Geometry::optimizeVertexFetchRemap(indices, vertexCount, uniqueVertexCount);
+		Geometry::remapIndices(indices, remap);
+
+		if (attributeRemap != nullptr && !attributeRemap->empty())
+		{
+			// The attributes go from their extracted order to the fetch order in one step, the vertices dropped by the fetch remap stay dropped
+			std::vector<unsigned int> composedRemap(attributeRemap->size());
+
+			for (size_t vertex = 0; vertex < composedRemap.size(); vertex++)
+				composedRemap[vertex] = remap[(*attributeRemap)[vertex]];
+
+			MeshImport::remapAttributes(remap, composedRemap, uniqueVertexCount, vertices, texCoords, normals, tangents, bitangents);
+		}
+		else
+		{
+			MeshImport::remapAttributes(remap, remap, uniqueVertexCount, vertices, texCoords, normals, tangents, bitangents);
+		}
+
+		if (statisticsBefore != nullptr)
+			*statisticsBefore = inputStatistics;
+
+		if (statisticsAfter != nullptr)
+			*statisticsAfter = Geometry::analyzeVertexCache(indices, uniqueVertexCount);
+	}
+
+	/// <summary>
+	/// Simplifies a mesh into up to lodCount levels of detail that are appended to its indices
+	/// </summary>
+	/// <param name="optimize">Whether the indices of each level are reordered for the vertex cache</param>
+	/// <returns>The index ranges of all the levels, starting with the full mesh</returns>
+	static std::vector<MeshLod> generateLods(const std::vector<float>& vertices, std::vector<unsigned int>& indices, unsigned int lodCount, bool optimize)
+	{
+		std::vector<MeshLod> lods;
+
+		if (indices.empty())
+			return lods;
+
+		lods.push_back({ 0, static_cast<unsigned int>(indices.size()), 0.0f });
+
+		size_t vertexCount = vertices.size() / 3;
+		std::vector<unsigned int> previousIndices = indices;
+
+		for (unsigned int i = 0; i < lodCount; i++)
+		{
+			size_t targetIndexCount = static_cast<size_t>(static_cast<float>(previousIndices.size() / 3) * MeshImport::LOD_REDUCTION) * 3;
+
+			float error = 0.0f;
+			std::vector<unsigned int> lodIndices = Geometry::simplifyMesh(previousIndices, vertices, targetIndexCount, MeshImport::LOD_MAX_ERROR, &error);
+
+			// Stop when the mesh can't be simplified much further, a level barely smaller than the previous one isn't worth the memory
+			if (lodIndices.empty() || lodIndices.size() > previousIndices.size() * 9 / 10)
+				break;
+
+			// Each level is simplified from the previous one, so the errors add up
+			error += lods.back().error;
+
+			if (optimize)
+				lodIndices = Geometry::optimizeVertexCache(lodIndices, vertexCount);
+
+			lods.push_back({ static_cast<unsigned int>(indices.size()), static_cast<unsigned int>(lodIndices.size()), error });
+			indices.insert(indices.end(), lodIndices.begin(), lodIndices.end());
+
+			previousIndices = std::move(lodIndices);
+		}
+
+		return lods;
+	}
+
+	/// <summary>
+	/// Splits the final index buffer in meshlets, each level of detail gets its own
+	/// </summary>
+	static void buildMeshlets(const std::vector<float>& vertices, const std::vector<unsigned int>& indices, std::vector<MeshLod>& lods, std::vector<Meshlet>& meshlets)
+	{
+		if (indices.empty())
+			return;
+
+		if (lods.empty())
+			Geometry::buildMeshlets(indices, 0, indices.size(), vertices, meshlets);
+
+		for (MeshLod& lod : lods)
+		{
+			lod.meshletOffset = static_cast<unsigned int>(meshlets.size());
+			Geometry::buildMeshlets(indices, lod.indexOffset, lod.indexCount, vertices, meshlets);
+			lod.meshletCount = static_cast<unsigned int>(meshlets.size()) - lod.meshletOffset;
+		}
+	}
+
+private:
+	/// <summary>
+	/// Applies a vertex remap to all the streams of a mesh, the empty ones are left empty
+	/// The positions can be one remap ahead of the other attributes after a deferred weld, so they get their own table
+	/// </summary>
+	static void remapAttributes(const std::vector<unsigned int>& positionRemap, const std::vector<unsigned int>& attributeRemap, size_t uniqueVertexCount,
+		std::vector<float>& vertices, std::vector<float>& texCoords, std::vector<float>& normals, std::vector<float>& tangents, std::vector<float>& bitangents)
+	{
+		vertices = Geometry::remapVertexAttribute(vertices, positionRemap, 3, uniqueVertexCount);
+
+		if (!texCoords.empty())
+			texCoords = Geometry::remapVertexAttribute(texCoords, attributeRemap, 2, uniqueVertexCount);
+		if (!normals.empty())
+			normals = Geometry::remapVertexAttribute(normals, attributeRemap, 3, uniqueVertexCount);
+		if (!tangents.empty())
+			tangents = Geometry::remapVertexAttribute(tangents, attributeRemap, 3, uniqueVertexCount);
+		if (!bitangents.empty())
+			bitangents = Geometry::remapVertexAttribute(bitangents, attributeRemap, 3, uniqueVertexCount);
+	}
+
+	/// <summary>
+	/// Copies an attribute of 3 floats per vertex, the stream is allocated at its exact size and written once
+	/// </summary>
+	static void copyAttribute(const aiVector3D* attribute, size_t vertexCount, std::vector<float>& stream)
+	{
+		const auto* floats = reinterpret_cast<const float*>(attribute);
+		stream.assign(floats, floats + vertexCount * 3);
+	}
+};
@@ -0,0 +1,149 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "texture.hpp"
+#include "components/meshComponent.hpp"
+#include "utilities/geometry.hpp"
+
+/// <summary>
+/// Where the pixels of a cached texture come from
+/// </summary>
+enum class CachedTextureKind : uint32_t
+{
+	FILE, // An image file next to the model, referenced by its path
+	ENCODED, // An embedded compressed image (PNG, JPG...), stored as is
+	RAW, // Embedded raw pixels, stored as is
+};
+
+/// <summary>
+/// A texture used by a cached model
+/// </summary>
+struct CachedTexture
+{
+	CachedTextureKind kind = CachedTextureKind::FILE;
+	TextureType type = TextureType::TEXTURE_2D;
+
+	/// <summary>
+	/// The path of the texture relative to the directory of the model, for embedded textures this is their name in the model
+	/// </summary>
+	std::string path;
+
+	/// <summary>
+	/// The size and format of raw textures, and the number of channels encoded textures are decoded to (0 keeps the channels of the image)
+	/// </summary>
+	int width = 0;
+	int height = 0;
+	int channels = 0;
+	GLenum format = GL_RGBA;
+
+	/// <summary>
+	/// The bytes of embedded textures
+	/// </summary>
+	std::vector<unsigned char> data;
+};
+
+/// <summary>
+/// A mesh of a cached model, with its buffers as they are given to its MeshComponent
+/// </summary>
+struct CachedMesh
+{
+	std::string label;
+
+	/// <summary>
+	/// The positions, kept apart from the vertex data for the bounds, the BVH and the colliders
+	/// </summary>
+	std::vector<float> vertices;
+
+	/// <summary>
+	/// The interleaved (and quantized if enabled) vertices, uploaded without being processed again
+	/// </summary>
+	MeshVertexData vertexData;
+
+	std::vector<unsigned int> indices;
+	std::vector<MeshLod> lods;
+	std::vector<Meshlet> meshlets;
+
+	/// <summary>
+	/// The indices of the textures of the mesh in the textures of the model
+	/// </summary>
+	std::vector<uint32_t> textures;
+
+	glm::vec3 diffuseColor = glm::vec3(1.0f);
+	float metallic = 0.0f;
+	float roughness = 0.5f;
+	float opacity = 1.0f;
+};
+
+/// <summary>
+/// A node of the hierarchy of a cached model
+/// </summary>
+struct CachedNode
+{
+	std::string name;
+
+	/// <summary>
+	/// The transform of the node relative to its parent
+	/// </summary>
+	glm::mat4 transform = glm::mat4(1.0f);
+
+	/// <summary>
+	/// The index of the parent node, parents always come before their children, -1 for the nodes under the model itself
+	/// </summary>
+	int32_t parent = -1;
+
+	/// <summary>
+	/// The indices of the meshes of the node in the meshes of the model, a mesh referenced by several nodes is stored once
+	/// </summary>
+	std::vector<uint32_t> meshes;
+};
+
+/// <summary>
+/// A model as imported and processed by the ResourceLoader, ready to be turned into entities again
+/// </summary>
+struct CachedModel
+{
+	std::string name;
+	std::vector<CachedTexture> textures;
+	std::vector<CachedMesh> meshes;
+
+	/// <summary>
+	/// The node hierarchy of models imported with their hierarchy, empty when the meshes were flattened under the model
+	/// </summary>
+	std::vector<CachedNode> nodes;
+};
+
+/// <summary>
+/// Saves processed models to a binary format and loads them back through a memory mapping, without going through the importer again
+/// </summary>
+class ModelCache
+{
+public:
+	/// <summary>
+	/// Identifies the cache files and their version, the version must change whenever their layout or the processing of the loader does
+	/// </summary>
+	static constexpr char MAGIC[4] = { 'V', 'G', 'L', 'M' };
+	static constexpr uint32_t VERSION = 3;
+
+	/// <summary>
+	/// Loads a model from a cache file
+	/// </summary>
+	/// <param name="path">The path of the cache file</param>
+	/// <param name="sourceHash">The hash of the source model and of the settings it was processed with</param>
+	/// <param name="model">The model, filled if it was loaded</param>
+	/// <returns>True if the file exists and matches the source</returns>
+	static bool load(const std::string& path, uint64_t sourceHash, CachedModel& model);
+
+	/// <summary>
+	/// Saves a model to a cache file, through a temporary file so a crash never leaves a truncated file under the final name
+	/// </summary>
+	/// <param name="path">The path of the cache file</param>
+	/// <param name="sourceHash">The hash of the source model and of the settings it was processed with</param>
+	/// <param name="model">The model to save</param>
+	/// <returns>True if the file was written</returns>
+	static bool save(const std::string& path, uint64_t sourceHash, const CachedModel& model);
+};
@@ -0,0 +1,211 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/// <summary>
+/// A utility class to split data parallel loops over worker threads
+/// </summary>
+class Parallel
+{
+public:
+	/// <summary>
+	/// Returns the number of threads a loop is split over at most, the calling thread and the workers of the pool
+	/// </summary>
+	static unsigned int getWorkerCount()
+	{
+		static const unsigned int workerCount = std::max(1u, std::thread::hardware_concurrency());
+		return workerCount;
+	}
+
+	/// <summary>
+	/// Splits the range [0, count) in contiguous chunks and calls function(begin, end) for each of them on the shared worker pool
+	/// The calling thread processes chunks too and returns once all of them are done, rethrowing the first exception a chunk threw
+	/// Loops started from inside a chunk run on the calling thread only, so nested loops don't oversubscribe the pool
+	/// </summary>
+	/// <param name="count">The number of items to process</param>
+	/// <param name="minChunkSize">The smallest number of items worth a thread, loops smaller than this run on the calling thread only</param>
+	/// <param name="function">The function processing the items in [begin, end)</param>
+	template<typename Function>
+	static void forChunks(size_t count, size_t minChunkSize, const Function& function)
+	{
+		if (count == 0)
+			return;
+
+		minChunkSize = std::max<size_t>(minChunkSize, 1);
+		size_t chunkCount = std::min<size_t>(Parallel::getWorkerCount(), (count + minChunkSize - 1) / minChunkSize);
+
+		if (chunkCount <= 1 || Parallel::isInChunk())
+		{
+			function(static_cast<size_t>(0), count);
+			return;
+		}
+
+		size_t chunkSize = (count + chunkCount - 1) / chunkCount;
+
+		// The workers share the loop state, a worker that starts after the last chunk was claimed only reads the chunk counter
+		auto loop = std::make_shared<Loop>();
+		loop->chunkCount = (count + chunkSize - 1) / chunkSize;
+		loop->runChunk = [&function, chunkSize, count](size_t chunk) {
+			size_t begin = chunk * chunkSize;
+			function(begin, std::min(count, begin + chunkSize));
+		};
+
+		WorkerPool& pool = Parallel::getPool();
+
+		for (size_t worker = 1; worker < loop->chunkCount; worker++)
+			pool.push([loop]() { Parallel::runChunks(*loop); });
+
+		Parallel::runChunks(*loop);
+
+		std::unique_lock<std::mutex> lock(loop->mutex);
+		loop->condition.wait(lock, [&loop]() { return loop->doneChunkCount == loop->chunkCount; });
+
+		if (loop->exception)
+			std::rethrow_exception(loop->exception);
+	}
+
+private:
+	/// <summary>
+	/// The state of a loop, the chunks are claimed in order by the calling thread and the workers
+	/// </summary>
+	struct Loop
+	{
+		std::function<void(size_t)> runChunk;
+		size_t chunkCount = 0;
+		std::atomic<size_t> nextChunk = 0;
+		size_t doneChunkCount = 0;
+
+		/// <summary>
+		/// The first exception thrown by a chunk, rethrown on the calling thread
+		/// </summary>
+		std::exception_ptr exception;
+
+		std::mutex mutex;
+		std::condition_variable condition;
+	};
+
+	/// <summary>
+	/// A fixed set of threads running the tasks pushed to it in order, shared by all the loops
+	/// </summary>
+	class WorkerPool
+	{
+	public:
+		explicit WorkerPool(unsigned int threadCount)
+		{
+			this->threads.reserve(threadCount);
+
+			for (unsigned int i = 0; i < threadCount; i++)
+				this->threads.emplace_back([this]() { this->run(); });
+		}
+
+		~WorkerPool()
+		{
+			{
+				std::lock_guard<std::mutex> lock(this->mutex);
+				this->stop = true;
+			}
+
+			this->condition.notify_all();
+
+			for (std::thread& thread : this->threads)
+				thread.join();
+		}
+
+		void push(std::function<void()> task)
+		{
+			{
+				std::lock_guard<std::mutex> lock(this->mutex);
+				this->tasks.push_back(std::move(task));
+			}
+
+			this->condition.notify_one();
+		}
+
+	private:
+		void run()
+		{
+			while (true)
+			{
+				std::function<void()> task;
+
+				{
+					std::unique_lock<std::mutex> lock(this->mutex);
+					this->condition.wait(lock, [this]() { return this->stop || !this->tasks.empty(); });
+
+					if (this->tasks.empty())
+						return;
+
+					task = std::move(this->tasks.front());
+					this->tasks.pop_front();
+				}
+
+				task();
+			}
+		}
+
+		std::vector<std::thread> threads;
+		std::deque<std::function<void()>> tasks;
+		std::mutex mutex;
+		std::condition_variable condition;
+		bool stop = false;
+	};
+
+	/// <summary>
+	/// Returns the pool, started with the first parallel loop, the calling thread of a loop is the remaining worker
+	/// </summary>
+	static WorkerPool& getPool()
+	{
+		static WorkerPool pool(Parallel::getWorkerCount() - 1);
+		return pool;
+	}
+
+	/// <summary>
+	/// Returns whether the current thread is running a chunk of a loop
+	/// </summary>
+	static bool& isInChunk()
+	{
+		thread_local bool inChunk = false;
+		return inChunk;
+	}
+
+	/// <summary>
+	/// Claims and runs chunks of a loop until none are left
+	/// </summary>
+	static void runChunks(Loop& loop)
+	{
+		for (size_t chunk = loop.nextChunk++; chunk < loop.chunkCount; chunk = loop.nextChunk++)
+		{
+			std::exception_ptr exception;
+			Parallel::isInChunk() = true;
+
+			try
+			{
+				loop.runChunk(chunk);
+			}
+			catch (...)
+			{
+				exception = std::current_exception();
+			}
+
+			Parallel::isInChunk() = false;
+
+			std::lock_guard<std::mutex> lock(loop.mutex);
+
+			if (exception && !loop.exception)
+				loop.exception = exception;
+
+			if (++loop.doneChunkCount == loop.chunkCount)
+				loop.condition.notify_all();
+		}
+	}
+};
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <tuple>
+
+#include "utilities/geometry.hpp"
+#include "physics/meshBvh.hpp"
+
+/// <summary>
+/// The procedural shapes the primitive library can generate
+/// </summary>
+enum class PrimitiveType
+{
+	CUBE,
+	SPHERE,
+};
+
+/// <summary>
+/// A cache of procedurally generated indexed meshes, each shape is generated once per set of parameters and then shared
+/// </summary>
+class PrimitiveLibrary
+{
+public:
+	static PrimitiveLibrary& getInstance();
+
+	/// <summary>
+	/// Returns an indexed unit sphere, generating it on first use
+	/// </summary>
+	/// <param name="slices">The number of subdivisions around the vertical axis</param>
+	/// <param name="stacks">The number of subdivisions from pole to pole</param>
+	std::shared_ptr<const VertexDataIndices> getSphere(int slices, int stacks);
+
+	/// <summary>
+	/// Returns an indexed cube with normals and texture coordinates
+	/// </summary>
+	std::shared_ptr<const VertexDataIndices> getCube();
+
+	/// <summary>
+	/// Returns the BVH of a mesh returned by the library for ray queries, building it on first use
+	/// </summary>
+	/// <param name="primitive">A mesh returned by the library</param>
+	std::shared_ptr<const MeshBvh> getBvh(const std::shared_ptr<const VertexDataIndices>& primitive);
+
+	/// <summary>
+	/// Releases the cached meshes, the ones still used elsewhere stay alive until their last user releases them
+	/// </summary>
+	void clear();
+
+	/// <summary>
+	/// Returns how many meshes are in the cache
+	/// </summary>
+	[[nodiscard]] size_t getCachedCount();
+
+private:
+	/// <summary>
+	/// The parameters identifying a primitive: its type and up to two subdivision counts
+	/// </summary>
+	using PrimitiveKey = std::tuple<PrimitiveType, int, int>;
+
+	static PrimitiveLibrary instance;
+
+	/// <summary>
+	/// The generated meshes, keyed by their parameters
+	/// </summary>
+	std::map<PrimitiveKey, std::shared_ptr<const VertexDataIndices>> primitives;
+
+	/// <summary>
+	/// The BVHs built for the cached meshes
+	/// </summary>
+	std::map<const VertexDataIndices*, std::shared_ptr<const MeshBvh>> bvhs;
+
+	/// <summary>
+	/// Guards the cache, primitives can be requested from loading threads
+	/// </summary>
+	std::mutex primitivesMutex;
+
+	PrimitiveLibrary() = default;
+	PrimitiveLibrary(PrimitiveLibrary const&) = delete;
+	PrimitiveLibrary& operator=(PrimitiveLibrary const&) = delete;
+
+	/// <summary>
+	/// Returns the cached mesh for a key, or generates and caches it
+	/// </summary>
+	/// <param name="key">The parameters of the primitive</param>
+	/// <param name="generate">The function generating the mesh if it isn't cached yet</param>
+	template<typename Generator>
+	std::shared_ptr<const VertexDataIndices> getOrGenerate(const PrimitiveKey& key, const Generator& generate);
+};
@@ -1,32 +1,474 @@
 #pragma once
 
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
 #include <memory>
+#include <mutex>
+#include <thread>
 
 #include <assimp/scene.h>
 
 #include "shader.hpp"
 #include "entity.hpp"
 #include "texture.hpp"
+#include "utilities/geometry.hpp"
+#include "utilities/modelCache.hpp"
+#include "utilities/textureCompression.hpp"
+#include "components/meshComponent.hpp"
+#include "physics/physicsWorld.hpp"
+#include "utilities/uploadQueue.hpp"
+
+class Scene;
+
+/// <summary>
+/// The kinds of colliders generated for the meshes of the loaded models
+/// </summary>
+enum class MeshColliderType
+{
+	NONE,
+	TRIANGLE_MESH, // Exact static collider, for level geometry
+	CONVEX_HULL, // Single reduced convex hull, for dynamic objects that are close to convex
+	CONVEX_DECOMPOSITION, // Several reduced convex hulls approximating the mesh, for dynamic concave objects
+};
+
+/// <summary>
+/// The progress of a model loaded in the background
+/// </summary>
+enum class ModelLoadState
+{
+	PARSING, // The file is parsed and its textures decoded on the loading thread
+	UPLOADING, // The meshes, textures and colliders wait for the upload queue on the main thread
+	READY, // The model was added to the scene
+	FAILED,
+	CANCELLED,
+};
+
+/// <summary>
+/// A handle to a model loaded in the background, shared by the caller and the loader
+/// </summary>
+class ModelLoadHandle
+{
+public:
+	explicit ModelLoadHandle(std::string path);
+
+	[[nodiscard]] ModelLoadState getState() const;
+
+	/// <summary>
+	/// Returns whether the load is over, whether it succeeded or not
+	/// </summary>
+	[[nodiscard]] bool isDone() const;
+
+	/// <summary>
+	/// Returns the entity of the model once it was added to the scene, null before that
+	/// </summary>
+	[[nodiscard]] Entity* getEntity() const;
+
+	[[nodiscard]] const std::string& getPath() const;
+
+	/// <summary>
+	/// Cancels the load, the model won't be added to the scene unless it already is
+	/// </summary>
+	void cancel();
+
+private:
+	friend class ResourceLoader;
+
+	std::string path;
+	std::atomic<ModelLoadState> state = ModelLoadState::PARSING;
+	std::atomic<bool> isCancelled = false;
+	std::atomic<Entity*> entity = nullptr;
+
+	/// <summary>
+	/// The model while its resources are being uploaded, until it is moved to the scene
+	/// </summary>
+	std::unique_ptr<Entity> pendingEntity;
+};
 
 class ResourceLoader
 {
 public:
 	static ResourceLoader& getInstance();
 
-	std::unique_ptr<Entity> loadModelFromFilepath(const std::string& path, Shader* shaderProgram);
+	/// <summary>
+	/// Loads a model and its textures, with one entity per mesh
+	/// </summary>
+	/// <param name="path">The path of the model file</param>
+	/// <param name="shaderProgram">The shader the materials of the model use</param>
+	/// <param name="physicsWorld">The physics world the colliders of the meshes are added to, null to load the model without collisions</param>
+	std::unique_ptr<Entity> loadModelFromFilepath(const std::string& path, Shader* shaderProgram, PhysicsWorld* physicsWorld = nullptr);
+
+	/// <summary>
+	/// Loads a model in the background and adds it to a scene once all its resources are on the GPU
+	/// The file is parsed and its textures decoded on a loading thread, the GPU uploads and colliders go through the UploadQueue
+	/// The scene and physics world must outlive the load, or the load must be cancelled
+	/// </summary>
+	/// <param name="path">The path of the model file</param>
+	/// <param name="shaderProgram">The shader the materials of the model use</param>
+	/// <param name="scene">The scene the model is added to</param>
+	/// <param name="physicsWorld">The physics world the colliders of the meshes are added to, null to load the model without collisions</param>
+	/// <returns>A handle to follow the progress of the load</returns>
+	std::shared_ptr<ModelLoadHandle> loadModelAsync(const std::string& path, Shader* shaderProgram, Scene* scene, PhysicsWorld* physicsWorld = nullptr);
+
+	/// <summary>
+	/// Creates a texture from pixels generated at runtime, or returns the texture already created from the same pixels
+	/// </summary>
+	/// <param name="textureType">The type of the texture</param>
+	/// <param name="width">The width of the texture</param>
+	/// <param name="height">The height of the texture</param>
+	/// <param name="format">The format of the texture</param>
+	/// <param name="textureData">The pixels</param>
+	/// <param name="channels">The number of bytes per pixel</param>
+	std::shared_ptr<Texture> loadTextureFromPixels(TextureType textureType, int width, int height, GLenum format, const unsigned char* textureData, int channels);
+
+	/// <summary>
+	/// Whether the vertices of the loaded models are quantized (16 bit positions, half float texture coordinates)
+	/// </summary>
+	bool quantizeVertices = true;
+
+	/// <summary>
+	/// Whether the index and vertex buffers of the loaded models are reordered for vertex cache, overdraw and vertex fetch efficiency
+	/// </summary>
+	bool optimizeMeshes = true;
+
+	/// <summary>
+	/// Whether the vertices of the loaded models that share all their attributes are merged
+	/// </summary>
+	bool weldVertices = true;
+
+	/// <summary>
+	/// The tolerance under which vertex attributes are considered equal when welding, 0 only merges identical vertices
+	/// </summary>
+	float weldEpsilon = 1.0e-5f;
+
+	/// <summary>
+	/// The number of simplified levels of detail generated for each loaded mesh, 0 disables them
+	/// </summary>
+	unsigned int lodCount = 3;
+
+	/// <summary>
+	/// Whether the loaded meshes are split in meshlets that are culled individually
+	/// </summary>
+	bool buildMeshlets = true;
+
+	/// <summary>
+	/// Whether the loaded meshes keep their triangles in a BVH for ray queries like editor picking
+	/// </summary>
+	bool raycastableMeshes = true;
+
+	/// <summary>
+	/// The collider the loaded meshes get when a physics world is given
+	/// </summary>
+	MeshColliderType meshColliders = MeshColliderType::TRIANGLE_MESH;
+
+	/// <summary>
+	/// The mass of the convex colliders of the loaded meshes, triangle mesh colliders are always static
+	/// </summary>
+	float colliderMass = 1.0f;
+
+	/// <summary>
+	/// The limits of the convex hulls of the loaded meshes
+	/// </summary>
+	ConvexDecompositionSettings convexDecomposition;
+
+	/// <summary>
+	/// Whether the processed models are saved to and loaded from the model cache, which skips the importer and mesh processing
+	/// </summary>
+	bool useModelCache = true;
+
+	/// <summary>
+	/// The directory where the processed models are cached, one file per model named after the hash of its file and of the processing settings
+	/// </summary>
+	std::string modelCacheDirectory = "cache/models";
+
+	/// <summary>
+	/// Whether the textures of the loaded models are block compressed, in the format that suits their type, when the driver supports it
+	/// </summary>
+	bool compressTextures = true;
+
+	/// <summary>
+	/// The directory where the compressed textures are cached as DDS files, named after the hash of the source image and of its type
+	/// </summary>
+	std::string textureCacheDirectory = "cache/textures";
+
+	/// <summary>
+	/// Whether compressed textures only upload their small mip levels, the finer ones being streamed in by the TextureStreamer as meshes get close to the camera
+	/// </summary>
+	bool streamTextures = true;
+
+	/// <summary>
+	/// Whether the models keep their node hierarchy and transforms, with the meshes referenced by several nodes drawn as instances of one shared geometry
+	/// Otherwise the transforms are baked into the vertices, and every reference of a mesh becomes a mesh of its own under the model
+	/// </summary>
+	bool preserveHierarchy = false;
 	
 private:
 	static ResourceLoader instance;
 	static std::map<aiTextureType, TextureType> aiMatToTextureType;
 
+	/// <summary>
+	/// Frees the pixels decoded by stb_image
+	/// </summary>
+	struct ImageDeleter
+	{
+		void operator()(unsigned char* pixels) const;
+	};
+
+	/// <summary>
+	/// A texture of the model being loaded, decoded but not created yet
+	/// </summary>
+	struct DecodedImage
+	{
+		int width = 0;
+		int height = 0;
+		int channels = 0;
+		GLenum format = GL_RGBA;
+		std::unique_ptr<unsigned char, ImageDeleter> pixels = nullptr;
+
+		/// <summary>
+		/// The image once compressed, the pixels are freed then
+		/// </summary>
+		CompressedImage compressed;
+
+		/// <summary>
+		/// The compressed image mapped from its cache file when textures are streamed, set instead of compressed
+		/// </summary>
+		std::shared_ptr<const MappedImage> mapped;
+	};
+
+	/// <summary>
+	/// A texture to decode, either a file or an embedded compressed image
+	/// </summary>
+	struct TextureSource
+	{
+		std::string path;
+		TextureType type = TextureType::TEXTURE_2D;
+		const unsigned char* encodedData = nullptr;
+		size_t encodedSize = 0;
+
+		/// <summary>
+		/// The number of channels the image is decoded to, 0 keeps the channels of the image
+		/// </summary>
+		int channels = 0;
+	};
+
 	std::string directory;
-	std::map<std::string, std::weak_ptr<Texture>> loadedTextures;
+
+	/// <summary>
+	/// The keys of the textures of the model being loaded, keyed by their path
+	/// </summary>
+	std::map<std::string, uint64_t> textureKeys;
+
+	/// <summary>
+	/// The textures of the model being loaded decoded ahead of time, keyed like the textures of the ResourceManager
+	/// </summary>
+	std::map<uint64_t, DecodedImage> decodedImages;
+
+	/// <summary>
+	/// The physics world the colliders of the model being loaded are added to, if any
+	/// </summary>
+	PhysicsWorld* physicsWorld = nullptr;
+
+	/// <summary>
+	/// Where the main thread work of the model being loaded goes when it is loaded in the background, null for immediate loads
+	/// </summary>
+	std::vector<UploadTask>* deferredUploads = nullptr;
+
+	/// <summary>
+	/// Where the processed meshes and textures of the model being imported are recorded for the model cache, null when it isn't cached
+	/// </summary>
+	CachedModel* modelCacheRecord = nullptr;
+
+	/// <summary>
+	/// The indices of the textures recorded for the model cache, keyed by their name in the model
+	/// </summary>
+	std::map<std::string, uint32_t> recordedTextureIndices;
+
+	/// <summary>
+	/// The indices of the recorded textures of the mesh being processed
+	/// </summary>
+	std::vector<uint32_t> recordedMeshTextures;
+
+	/// <summary>
+	/// A mesh of the model being imported with its hierarchy, kept so the other nodes referencing it become instances of it
+	/// </summary>
+	struct SharedMesh
+	{
+		/// <summary>
+		/// The component of the first reference of the mesh, which uploads the geometry
+		/// </summary>
+		const MeshComponent* component = nullptr;
+
+		/// <summary>
+		/// The label and material of the mesh
+		/// </summary>
+		CachedMesh mesh;
+
+		std::vector<std::shared_ptr<Texture>> textures;
+
+		/// <summary>
+		/// The index of the mesh in the meshes recorded for the model cache
+		/// </summary>
+		uint32_t cachedIndex = 0;
+	};
+
+	/// <summary>
+	/// The meshes of the model being imported with its hierarchy, keyed by their index in the scene
+	/// </summary>
+	std::map<unsigned int, SharedMesh> sharedMeshes;
+
+	/// <summary>
+	/// Serializes the loads, the state of the model being loaded is shared by the loading thread and the main thread
+	/// </summary>
+	std::mutex loadMutex;
+
+	/// <summary>
+	/// The thread running the background loads one after the other, started with the first one
+	/// </summary>
+	std::thread loadingThread;
+	std::deque<std::function<void()>> loadJobs;
+	std::mutex loadJobsMutex;
+	std::condition_variable loadJobsCondition;
+	bool stopLoadingThread = false;
+
+	/// <summary>
+	/// The vertex cache statistics of the model being loaded, before and after mesh optimization
+	/// </summary>
+	VertexCacheStatistics cacheStatisticsBefore;
+	VertexCacheStatistics cacheStatisticsAfter;
+
+	/// <summary>
+	/// The vertex count of the model being loaded, before and after welding
+	/// </summary>
+	size_t vertexCountBeforeWeld = 0;
+	size_t vertexCountAfterWeld = 0;
 
 	ResourceLoader();
+	~ResourceLoader();
 	ResourceLoader(ResourceLoader const&) = delete;
 	ResourceLoader& operator=(ResourceLoader const&) = delete;
 
-	void processNode(const aiNode* node, const aiScene* scene, Shader* shaderProgram, Entity* parent);
-	Entity* processMesh(aiMesh* mesh, const aiScene* scene, Shader* shaderProgram, Entity* parent);
+	/// <summary>
+	/// Loads a model, the work that needs the main thread is deferred if deferredUploads is set
+	/// </summary>
+	std::unique_ptr<Entity> loadModel(const std::string& path, Shader* shaderProgram, PhysicsWorld* physicsWorld);
+
+	/// <summary>
+	/// Resets the state of the model that was being loaded and forgets the textures that were freed
+	/// </summary>
+	void clearLoadState();
+
+	/// <summary>
+	/// Runs the background loads until the loader is destroyed
+	/// </summary>
+	void runLoadingThread();
+
+	/// <summary>
+	/// Creates the entities of a model from the model cache
+	/// </summary>
+	std::unique_ptr<Entity> createModelFromCache(CachedModel model, Shader* shaderProgram);
+
+	/// <summary>
+	/// Computes the key of a model in the model cache from its path, size, modification time and the processing settings
+	/// </summary>
+	/// <returns>False if the file doesn't exist</returns>
+	bool getModelCacheKey(const std::string& path, uint64_t& key) const;
+
+	std::string getModelCachePath(uint64_t key) const;
+
+	/// <summary>
+	/// Creates the entities of a node and of its children
+	/// </summary>
+	/// <param name="parentNode">The index of the parent node in the nodes recorded for the model cache, -1 for the root</param>
+	/// <param name="parentTransform">The transform of the parent node relative to the model</param>
+	void processNode(const aiNode* node, const aiScene* scene, Shader* shaderProgram, Entity* parent, int32_t parentNode = -1, const glm::mat4& parentTransform = glm::mat4(1.0f));
+	Entity* processMesh(unsigned int meshIndex, const aiScene* scene, Shader* shaderProgram, const std::string& label, const glm::mat4& nodeTransform);
+
+	/// <summary>
+	/// Creates the entity of a processed mesh with its components and collider, whether it was just imported or loaded from the model cache
+	/// The buffers of the mesh are moved to its component, callers that still need them pass a copy
+	/// </summary>
+	/// <param name="geometrySource">The mesh an instance shares the geometry of, which is started before it, null to upload the vertices of the mesh</param>
+	/// <param name="nodeTransform">The transform of the node of the mesh relative to the model, where the body of its collider is placed</param>
+	Entity* createMeshEntity(CachedMesh mesh, const std::vector<std::shared_ptr<Texture>>& textures, Shader* shaderProgram, const MeshComponent* geometrySource = nullptr,
+		const glm::mat4& nodeTransform = glm::mat4(1.0f));
+
+	/// <summary>
+	/// Returns what the instances of a mesh need from it, its label and material, the geometry and collision shape come from its component
+	/// </summary>
+	static CachedMesh getInstanceMesh(const CachedMesh& mesh);
+
 	std::vector<std::shared_ptr<Texture>> loadMaterialTextures(const aiScene* scene, const aiMaterial* mat, aiTextureType type, const std::string& typeName);
+
+	/// <summary>
+	/// Returns the textures used by the materials of a model that need decoding
+	/// </summary>
+	std::vector<TextureSource> gatherTextures(const aiScene* scene);
+
+	/// <summary>
+	/// Hashes textures and decodes in parallel into decodedImages the ones that aren't loaded yet, ahead of processing the meshes of a model
+	/// </summary>
+	void decodeTextures(const std::vector<TextureSource>& sources);
+
+	/// <summary>
+	/// Decodes a texture, and compresses it or loads it from the texture cache if textures are compressed
+	/// </summary>
+	/// <param name="source">The texture</param>
+	/// <param name="encodedData">The bytes of the image file</param>
+	/// <param name="encodedSize">The number of bytes</param>
+	/// <param name="key">The key of the texture in the ResourceManager</param>
+	/// <param name="image">The decoded image</param>
+	void decodeTexture(const TextureSource& source, const unsigned char* encodedData, size_t encodedSize, uint64_t key, DecodedImage& image) const;
+
+	/// <summary>
+	/// Maps a texture from the texture cache when textures are streamed, so its levels are read from the file as they are uploaded
+	/// </summary>
+	/// <returns>True if the cache file was mapped and the image set from it</returns>
+	bool mapCachedTexture(const std::string& cachePath, TextureType textureType, DecodedImage& image) const;
+
+	std::string getTextureCachePath(uint64_t key) const;
+
+	/// <summary>
+	/// Creates a texture from its decoded image, textures from files are shared with the later uses
+	/// </summary>
+	/// <param name="path">The path of the texture, used to find its key</param>
+	/// <param name="name">The name of the texture in the model</param>
+	/// <param name="isFile">Whether the texture comes from a file rather than being embedded in the model</param>
+	std::shared_ptr<Texture> getDecodedTexture(const std::string& path, const std::string& name, TextureType textureType, bool isFile);
+
+	/// <summary>
+	/// Creates a texture from raw pixels, or returns the texture already created from the same pixels
+	/// </summary>
+	std::shared_ptr<Texture> getPixelTexture(TextureType textureType, int width, int height, GLenum format, const unsigned char* textureData, int channels);
+
+	/// <summary>
+	/// Returns the texture with a key from the ResourceManager, null if there is none or it was evicted
+	/// </summary>
+	std::shared_ptr<Texture> findLoadedTexture(uint64_t key);
+
+	/// <summary>
+	/// Adds a texture of the model being imported to its cache record if it isn't there yet
+	/// </summary>
+	/// <returns>The index of the texture in the record</returns>
+	uint32_t recordTexture(const std::string& name, TextureType textureType, const aiTexture* embeddedTexture);
+
+	/// <summary>
+	/// Creates a texture now, or an empty texture whose upload is deferred if the model is loaded in the background
+	/// </summary>
+	/// <param name="textureData">The pixels, copied if the upload is deferred</param>
+	/// <param name="channels">The number of bytes per pixel</param>
+	std::shared_ptr<Texture> createTexture(TextureType textureType, int width, int height, GLenum format, const unsigned char* textureData, int channels);
+
+	/// <summary>
+	/// Creates a block compressed texture now, or an empty texture whose upload is deferred if the model is loaded in the background
+	/// </summary>
+	/// <param name="image">The compressed image, moved into the upload if it is deferred</param>
+	std::shared_ptr<Texture> createCompressedTexture(TextureType textureType, CompressedImage image);
+
+	/// <summary>
+	/// Creates a streamed texture now, or an empty texture whose upload is deferred if the model is loaded in the background
+	/// </summary>
+	/// <param name="image">The compressed image mapped from its cache file, shared with the texture</param>
+	std::shared_ptr<Texture> createStreamedTexture(TextureType textureType, std::shared_ptr<const MappedImage> image);
 };
\ No newline at end of file
@@ -0,0 +1,206 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+/// <summary>
+/// The kinds of resources the ResourceManager accounts for, each has its own pool of keys
+/// </summary>
+enum class ResourceType
+{
+	TEXTURE, // 2D textures of the models and of generated pixels
+	CUBEMAP, // Skies and their IBL maps
+	SHADER, // Linked shader programs
+	MESH, // Vertex and index buffers
+	COUNT,
+};
+
+/// <summary>
+/// A typed reference to a resource of the ResourceManager, the resource can't be evicted while a handle to it exists
+/// </summary>
+template<typename T>
+class ResourceHandle
+{
+public:
+	ResourceHandle() = default;
+	ResourceHandle(uint64_t key, std::shared_ptr<T> resource) : key(key), resource(std::move(resource)) {}
+
+	T* get() const { return this->resource.get(); }
+	T* operator->() const { return this->resource.get(); }
+	T& operator*() const { return *this->resource; }
+	explicit operator bool() const { return this->resource != nullptr; }
+
+	/// <summary>
+	/// Returns the key of the resource in the pool of its type
+	/// </summary>
+	[[nodiscard]] uint64_t getKey() const { return this->key; }
+
+	/// <summary>
+	/// Returns the resource as a shared pointer, for the code that keeps resources in shared pointers (materials, meshes)
+	/// </summary>
+	[[nodiscard]] const std::shared_ptr<T>& getShared() const { return this->resource; }
+
+private:
+	uint64_t key = 0;
+	std::shared_ptr<T> resource;
+};
+
+/// <summary>
+/// Owns the shared resources of the engine and keeps count of the memory they use per type
+/// Resources that nothing references anymore stay cached so they can be reused, until the memory budget is exceeded and the least recently used ones are evicted
+/// </summary>
+class ResourceManager
+{
+public:
+	static ResourceManager& getInstance();
+
+	/// <summary>
+	/// The number of bytes the resources can use before the unreferenced ones are evicted
+	/// </summary>
+	size_t memoryBudget = 1024 * 1024 * 1024;
+
+	/// <summary>
+	/// Returns the resource of a type stored under a key, this can be called from any thread
+	/// </summary>
+	/// <param name="type">The type of the resource</param>
+	/// <param name="key">The key of the resource, usually a hash of what it was created from</param>
+	/// <returns>A handle to the resource, empty if there is none</returns>
+	template<typename T>
+	ResourceHandle<T> find(ResourceType type, uint64_t key)
+	{
+		std::lock_guard<std::mutex> lock(this->resourcesMutex);
+
+		auto entry = this->resources[static_cast<size_t>(type)].find(key);
+
+		if (entry == this->resources[static_cast<size_t>(type)].end())
+			return ResourceHandle<T>();
+
+		entry->second.lastUse = this->frame;
+		return ResourceHandle<T>(key, std::static_pointer_cast<T>(entry->second.resource));
+	}
+
+	/// <summary>
+	/// Stores a resource under a key, this can be called from any thread
+	/// If a resource was stored under the key in the meantime, it is kept and returned instead
+	/// </summary>
+	/// <param name="type">The type of the resource</param>
+	/// <param name="key">The key of the resource</param>
+	/// <param name="resource">The resource, its type must have a getByteSize method</param>
+	/// <returns>A handle to the resource stored under the key</returns>
+	template<typename T>
+	ResourceHandle<T> add(ResourceType type, uint64_t key, std::shared_ptr<T> resource)
+	{
+		std::lock_guard<std::mutex> lock(this->resourcesMutex);
+
+		auto [entry, isNew] = this->resources[static_cast<size_t>(type)].try_emplace(key);
+
+		if (isNew)
+		{
+			entry->second.resource = resource;
+			entry->second.getByteSize = [](const void* resource) { return static_cast<const T*>(resource)->getByteSize(); };
+		}
+
+		entry->second.lastUse = this->frame;
+		return ResourceHandle<T>(key, std::static_pointer_cast<T>(entry->second.resource));
+	}
+
+	/// <summary>
+	/// Returns the resource stored under a key, or creates and stores it if there is none
+	/// The resource is created without holding the lock of the manager, so creating it can take a while
+	/// </summary>
+	/// <param name="type">The type of the resource</param>
+	/// <param name="key">The key of the resource</param>
+	/// <param name="create">A function returning a shared pointer to the new resource</param>
+	template<typename T, typename Factory>
+	ResourceHandle<T> load(ResourceType type, uint64_t key, Factory&& create)
+	{
+		if (ResourceHandle<T> resource = this->find<T>(type, key))
+			return resource;
+
+		return this->add<T>(type, key, create());
+	}
+
+	/// <summary>
+	/// Adds or removes bytes used by resources that are owned outside of the manager, like the buffers of meshes
+	/// </summary>
+	/// <param name="type">The type of the resources</param>
+	/// <param name="byteSize">The number of bytes, negative when they are freed</param>
+	void trackMemory(ResourceType type, int64_t byteSize);
+
+	/// <summary>
+	/// Updates the memory used by each type, and evicts the least recently used resources nothing references when over the budget
+	/// This must be called from the main thread once per frame, so the resources are freed along with the OpenGL context
+	/// </summary>
+	void collect();
+
+	/// <summary>
+	/// Drops every resource of the manager, this must be called before the OpenGL context is destroyed
+	/// Resources that are still referenced elsewhere are freed when their last handle is
+	/// </summary>
+	void clear();
+
+	/// <summary>
+	/// Returns the number of bytes used by the resources of a type after the last collection
+	/// </summary>
+	[[nodiscard]] size_t getMemoryUsage(ResourceType type) const;
+
+	/// <summary>
+	/// Returns the number of bytes used by all the resources after the last collection
+	/// </summary>
+	[[nodiscard]] size_t getTotalMemoryUsage() const;
+
+	/// <summary>
+	/// Returns the number of resources of a type in the manager, referenced or not
+	/// </summary>
+	[[nodiscard]] size_t getResourceCount(ResourceType type);
+
+	/// <summary>
+	/// Returns the number of resources evicted since the start
+	/// </summary>
+	[[nodiscard]] size_t getEvictionCount() const;
+
+private:
+	static ResourceManager instance;
+
+	struct Entry
+	{
+		std::shared_ptr<void> resource;
+
+		/// <summary>
+		/// Returns the current size of the resource, which changes for streamed textures
+		/// </summary>
+		size_t (*getByteSize)(const void* resource) = nullptr;
+
+		size_t byteSize = 0;
+
+		/// <summary>
+		/// The last frame the resource was acquired or seen referenced
+		/// </summary>
+		uint64_t lastUse = 0;
+	};
+
+	std::map<uint64_t, Entry> resources[static_cast<size_t>(ResourceType::COUNT)];
+
+	/// <summary>
+	/// The bytes of the resources that are owned outside of the manager
+	/// </summary>
+	std::atomic<int64_t> trackedBytes[static_cast<size_t>(ResourceType::COUNT)] = {};
+
+	size_t memoryUsage[static_cast<size_t>(ResourceType::COUNT)] = {};
+	size_t evictionCount = 0;
+	uint64_t frame = 0;
+
+	/// <summary>
+	/// Guards the resources, textures are looked up and added by the loading threads
+	/// </summary>
+	std::mutex resourcesMutex;
+
+	ResourceManager() = default;
+	ResourceManager(ResourceManager const&) = delete;
+	ResourceManager& operator=(ResourceManager const&) = delete;
+};
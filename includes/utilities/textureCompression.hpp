@@ -0,0 +1,199 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "texture.hpp"
+#include "utilities/glad.h"
+
+class MappedFile;
+
+// The S3TC and BPTC formats are extensions in OpenGL 4.1, so the loader doesn't define them
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT 0x83F0
+#endif
+
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT5_EXT
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#endif
+
+#ifndef GL_COMPRESSED_RGBA_BPTC_UNORM
+#define GL_COMPRESSED_RGBA_BPTC_UNORM 0x8E8C
+#endif
+
+/// <summary>
+/// The block compression formats textures can be stored in on the GPU
+/// </summary>
+enum class BlockFormat : uint32_t
+{
+	NONE, // Uncompressed
+	BC1, // RGB at 4 bits per pixel, for opaque color textures
+	BC3, // RGBA at 8 bits per pixel, for transparent color textures when BC7 isn't supported
+	BC4, // A single channel at 4 bits per pixel, for roughness, AO and other masks
+	BC5, // Two channels at 8 bits per pixel, for normal maps and packed metallic/roughness
+	BC7, // RGBA at 8 bits per pixel, for transparent color textures
+};
+
+/// <summary>
+/// A level of a block compressed texture
+/// </summary>
+struct CompressedLevel
+{
+	int width = 0;
+	int height = 0;
+	std::vector<unsigned char> data;
+};
+
+/// <summary>
+/// A block compressed texture with all its mip levels
+/// </summary>
+struct CompressedImage
+{
+	BlockFormat format = BlockFormat::NONE;
+
+	/// <summary>
+	/// The channels sampled by the shaders for each channel of the texture, textures with fewer channels are swizzled back to the layout the shaders expect
+	/// </summary>
+	GLint swizzle[4] = { GL_RED, GL_GREEN, GL_BLUE, GL_ALPHA };
+
+	/// <summary>
+	/// The levels from the full size one down to 1x1
+	/// </summary>
+	std::vector<CompressedLevel> levels;
+
+	[[nodiscard]] size_t getByteSize() const;
+};
+
+/// <summary>
+/// A level of a block compressed texture stored in a DDS file
+/// </summary>
+struct MappedLevel
+{
+	int width = 0;
+	int height = 0;
+	size_t offset = 0;
+	size_t size = 0;
+};
+
+/// <summary>
+/// A block compressed texture read in place from its DDS cache file, the levels are only read from the mapping when they are uploaded so no copy of them is kept in memory
+/// </summary>
+struct MappedImage
+{
+	BlockFormat format = BlockFormat::NONE;
+	GLint swizzle[4] = { GL_RED, GL_GREEN, GL_BLUE, GL_ALPHA };
+
+	/// <summary>
+	/// The levels from the full size one down to 1x1
+	/// </summary>
+	std::vector<MappedLevel> levels;
+
+	std::shared_ptr<const MappedFile> file;
+
+	/// <summary>
+	/// Returns the blocks of a level in the mapping
+	/// </summary>
+	[[nodiscard]] const unsigned char* getLevelData(size_t level) const;
+};
+
+/// <summary>
+/// A utility class to compress textures to the BC formats on the CPU and to cache them on disk as DDS files
+/// </summary>
+class TextureCompression
+{
+public:
+	/// <summary>
+	/// Changes whenever the output of the encoders does, so textures cached by an older version are compressed again
+	/// </summary>
+	static constexpr uint32_t ENCODER_VERSION = 1;
+
+	/// <summary>
+	/// Queries the compressed formats the driver supports, this needs the OpenGL context and must run on the main thread before textures are compressed
+	/// Until it runs, only the formats that are core in OpenGL 4.1 (BC4 and BC5) are considered supported
+	/// </summary>
+	static void detectSupport();
+
+	static bool isSupported(BlockFormat format);
+
+	/// <summary>
+	/// Chooses the block format of a texture from how the shaders use its type
+	/// </summary>
+	/// <param name="textureType">The type of the texture</param>
+	/// <param name="hasAlpha">Whether the texture has transparent pixels</param>
+	/// <returns>The format, NONE if the texture should stay uncompressed</returns>
+	static BlockFormat chooseFormat(TextureType textureType, bool hasAlpha);
+
+	/// <summary>
+	/// Generates the mip levels of an image and compresses them in the format chosen for its type
+	/// </summary>
+	/// <param name="pixels">The RGBA pixels of the image</param>
+	/// <param name="width">The width of the image</param>
+	/// <param name="height">The height of the image</param>
+	/// <param name="textureType">The type of the texture, which decides the format and the channels that are kept</param>
+	/// <returns>The compressed image, with the NONE format if the texture should stay uncompressed</returns>
+	static CompressedImage compress(const unsigned char* pixels, int width, int height, TextureType textureType);
+
+	/// <summary>
+	/// Returns the OpenGL internal format of a block format
+	/// </summary>
+	static GLenum getInternalFormat(BlockFormat format);
+
+	/// <summary>
+	/// Returns the uncompressed format with the same channels as a block format, as stored in Texture::format
+	/// </summary>
+	static GLenum getBaseFormat(BlockFormat format);
+
+	/// <summary>
+	/// Loads a compressed texture from a DDS file written by saveDDS
+	/// </summary>
+	/// <param name="path">The path of the file</param>
+	/// <param name="textureType">The type of the texture, which decides how it is swizzled</param>
+	/// <param name="image">The image, filled if it was loaded</param>
+	/// <returns>True if the file exists and is valid</returns>
+	static bool loadDDS(const std::string& path, TextureType textureType, CompressedImage& image);
+
+	/// <summary>
+	/// Maps a DDS file written by saveDDS and validates it like loadDDS, without copying its levels
+	/// </summary>
+	/// <param name="path">The path of the file</param>
+	/// <param name="textureType">The type of the texture, which decides how it is swizzled</param>
+	/// <param name="image">The image, filled if the file was mapped</param>
+	/// <returns>True if the file exists and is valid</returns>
+	static bool mapDDS(const std::string& path, TextureType textureType, MappedImage& image);
+
+	/// <summary>
+	/// Saves a compressed texture to a DDS file with a DX10 header, through a temporary file
+	/// </summary>
+	static bool saveDDS(const std::string& path, const CompressedImage& image);
+
+private:
+	static std::atomic<bool> supportsS3TC;
+	static std::atomic<bool> supportsBPTC;
+
+	/// <summary>
+	/// Returns the size of a block in bytes
+	/// </summary>
+	static size_t getBlockSize(BlockFormat format);
+
+	/// <summary>
+	/// Sets the swizzle of an image from its format and type
+	/// </summary>
+	static void setSwizzle(TextureType textureType, BlockFormat format, GLint swizzle[4]);
+
+	/// <summary>
+	/// Halves an RGBA image with a box filter, normal maps are renormalized
+	/// </summary>
+	static std::vector<unsigned char> downsample(const std::vector<unsigned char>& pixels, int width, int height, bool isNormalMap);
+
+	/// <summary>
+	/// Compresses one level of an image, blocks past its edges repeat the last row and column
+	/// </summary>
+	static CompressedLevel compressLevel(const std::vector<unsigned char>& pixels, int width, int height, BlockFormat format, TextureType textureType);
+
+	static void encodeBC1Block(const unsigned char block[64], unsigned char* output);
+	static void encodeBC4Block(const unsigned char block[64], int channel, unsigned char* output);
+	static void encodeBC7Block(const unsigned char block[64], unsigned char* output);
+};
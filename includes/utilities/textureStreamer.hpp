@@ -0,0 +1,92 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+class Texture;
+struct MappedImage;
+
+/// <summary>
+/// Streams the mip levels of compressed textures in and out of video memory, from the texel density meshes request while the scene is sorted
+/// Textures start with only their small levels resident, finer levels are uploaded when they are seen close enough and evicted, least recently used first, when the memory budget is exceeded
+/// </summary>
+class TextureStreamer
+{
+public:
+	static TextureStreamer& getInstance();
+
+	/// <summary>
+	/// Above this size in pixels, the levels of a texture are only uploaded once they are requested
+	/// </summary>
+	static constexpr int RESIDENT_SIZE = 64;
+
+	/// <summary>
+	/// The number of bytes the levels of the streamed textures can use in video memory
+	/// </summary>
+	size_t memoryBudget = 512 * 1024 * 1024;
+
+	/// <summary>
+	/// The number of bytes of levels uploaded per frame
+	/// </summary>
+	size_t uploadBudget = 8 * 1024 * 1024;
+
+	/// <summary>
+	/// Returns the finest level of an image that is always resident, the first one that fits in RESIDENT_SIZE
+	/// </summary>
+	static int getFloorLevel(const MappedImage& image);
+
+	/// <summary>
+	/// Returns the number of bytes of the levels of an image from a level down to 1x1
+	/// </summary>
+	static size_t getLevelsByteSize(const MappedImage& image, int firstLevel);
+
+	/// <summary>
+	/// Adds a texture to the streamed textures, this is done by the texture once its first levels are uploaded
+	/// </summary>
+	void registerTexture(Texture* texture);
+
+	/// <summary>
+	/// Removes a texture from the streamed textures, this is done by the texture when it is destroyed
+	/// </summary>
+	void unregisterTexture(Texture* texture);
+
+	/// <summary>
+	/// Uploads the levels requested since the last update within the upload budget, and evicts levels when over the memory budget
+	/// This must be called from the main thread once per frame
+	/// </summary>
+	void update();
+
+	/// <summary>
+	/// Returns the number of the current frame, requests made with the same number are merged
+	/// </summary>
+	[[nodiscard]] uint64_t getFrame() const;
+
+	/// <summary>
+	/// Returns how many textures are streamed
+	/// </summary>
+	[[nodiscard]] size_t getTextureCount();
+
+	/// <summary>
+	/// Returns how many bytes the resident levels of the streamed textures used after the last update
+	/// </summary>
+	[[nodiscard]] size_t getResidentBytes() const;
+
+private:
+	static TextureStreamer instance;
+
+	std::vector<Texture*> textures;
+
+	uint64_t frame = 1;
+	size_t residentBytes = 0;
+
+	/// <summary>
+	/// Guards the textures, they can be released by the loading threads
+	/// </summary>
+	std::mutex texturesMutex;
+
+	TextureStreamer() = default;
+	TextureStreamer(TextureStreamer const&) = delete;
+	TextureStreamer& operator=(TextureStreamer const&) = delete;
+};
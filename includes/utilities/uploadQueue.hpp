@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+/// <summary>
+/// A piece of work that has to run on the main thread, because it uses the OpenGL context or the physics world
+/// </summary>
+struct UploadTask
+{
+	std::function<void()> function;
+
+	/// <summary>
+	/// The approximate number of bytes the task sends to the GPU, counted against the per frame budget
+	/// </summary>
+	size_t byteSize = 0;
+};
+
+/// <summary>
+/// A queue of main thread work produced by loading threads, processed a little every frame so loading never stalls the frame loop
+/// </summary>
+class UploadQueue
+{
+public:
+	static UploadQueue& getInstance();
+
+	/// <summary>
+	/// The time spent running tasks per frame, in milliseconds
+	/// </summary>
+	double timeBudget = 2.0;
+
+	/// <summary>
+	/// The number of bytes uploaded per frame
+	/// </summary>
+	size_t byteBudget = 16 * 1024 * 1024;
+
+	/// <summary>
+	/// Appends tasks at the end of the queue, they are run in order. This can be called from any thread
+	/// </summary>
+	/// <param name="tasks">The tasks to run</param>
+	void push(std::vector<UploadTask> tasks);
+
+	/// <summary>
+	/// Runs queued tasks until the time or byte budget of the frame is spent, this must be called from the main thread once per frame
+	/// At least one task is run per call, so tasks larger than the budget still make progress
+	/// </summary>
+	void process();
+
+	/// <summary>
+	/// Returns how many tasks are waiting
+	/// </summary>
+	[[nodiscard]] size_t getPendingCount();
+
+	/// <summary>
+	/// Returns how many bytes the tasks waiting will upload
+	/// </summary>
+	[[nodiscard]] size_t getPendingBytes();
+
+private:
+	static UploadQueue instance;
+
+	std::deque<UploadTask> tasks;
+	size_t pendingBytes = 0;
+
+	/// <summary>
+	/// Guards the tasks, they are pushed from the loading threads
+	/// </summary>
+	std::mutex tasksMutex;
+
+	UploadQueue() = default;
+	UploadQueue(UploadQueue const&) = delete;
+	UploadQueue& operator=(UploadQueue const&) = delete;
+};
@@ -0,0 +1,531 @@
+#pragma once
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include <utilities/glad.h>
+#include <glm/glm.hpp>
+
+#include "utilities/geometry.hpp"
+
+/// <summary>
+/// Describes a single attribute of an interleaved vertex
+/// </summary>
+struct VertexAttribute
+{
+	/// <summary>
+	/// The location of the attribute in the vertex shader
+	/// </summary>
+	GLuint location;
+
+	/// <summary>
+	/// The number of components of the attribute
+	/// </summary>
+	GLint size;
+
+	/// <summary>
+	/// The OpenGL type of the components
+	/// </summary>
+	GLenum type;
+
+	/// <summary>
+	/// Whether integer components are converted to normalized floats when fetched
+	/// </summary>
+	GLboolean normalized;
+
+	/// <summary>
+	/// The offset of the attribute from the start of the vertex in bytes
+	/// </summary>
+	size_t offset;
+};
+
+/// <summary>
+/// The vertex used by meshes, all attributes are interleaved in a single buffer (28 bytes per vertex)
+/// Normals and tangents are octahedral encoded in the xy components of signed normalized 10:10:10:2 integers,
+/// the w component of the tangent holds the sign of the bitangent, which is rebuilt in the shader with cross(normal, tangent) * sign
+/// </summary>
+struct MeshVertex
+{
+	glm::vec3 position;
+	glm::vec2 texCoord;
+	uint32_t normal;
+	uint32_t tangent;
+};
+
+/// <summary>
+/// A quantized mesh vertex (20 bytes per vertex)
+/// Positions are 16 bit normalized integers inside of the bounding box of the mesh, they are brought back to
+/// object space in the shader using the VertexDequantization of the mesh, texture coordinates are half floats
+/// Normals and tangents use the same encoding as MeshVertex
+/// </summary>
+struct QuantizedMeshVertex
+{
+	uint16_t position[3];
+	uint16_t padding;
+	uint16_t texCoord[2];
+	uint32_t normal;
+	uint32_t tangent;
+};
+
+/// <summary>
+/// The transform that brings quantized positions back to object space: position = offset + quantized * scale
+/// The default values leave unquantized positions untouched
+/// </summary>
+struct VertexDequantization
+{
+	glm::vec3 offset = glm::vec3(0.0f);
+	glm::vec3 scale = glm::vec3(1.0f);
+};
+
+/// <summary>
+/// The error introduced by encoding the vertices of a mesh
+/// </summary>
+struct QuantizationError
+{
+	/// <summary>
+	/// The largest distance between an original and a decoded position, in object space units
+	/// </summary>
+	float maxPositionError = 0.0f;
+
+	/// <summary>
+	/// The largest distance between original and decoded texture coordinates, in UV units
+	/// </summary>
+	float maxTexCoordError = 0.0f;
+
+	/// <summary>
+	/// The largest angle between an original and a decoded normal, in degrees
+	/// </summary>
+	float maxNormalError = 0.0f;
+
+	/// <summary>
+	/// The largest angle between an original and a decoded tangent, in degrees
+	/// </summary>
+	float maxTangentError = 0.0f;
+};
+
+/// <summary>
+/// Gives the attribute layout of a vertex type, it must be specialized for every vertex type that is uploaded to the GPU
+/// </summary>
+template<typename Vertex>
+struct VertexLayout;
+
+template<>
+struct VertexLayout<MeshVertex>
+{
+	static constexpr std::array<VertexAttribute, 4> ATTRIBUTES = { {
+		{ 0, 3, GL_FLOAT, GL_FALSE, offsetof(MeshVertex, position) },
+		{ 1, 2, GL_FLOAT, GL_FALSE, offsetof(MeshVertex, texCoord) },
+		{ 2, 4, GL_INT_2_10_10_10_REV, GL_TRUE, offsetof(MeshVertex, normal) },
+		{ 3, 4, GL_INT_2_10_10_10_REV, GL_TRUE, offsetof(MeshVertex, tangent) },
+	} };
+};
+
+template<>
+struct VertexLayout<QuantizedMeshVertex>
+{
+	static constexpr std::array<VertexAttribute, 4> ATTRIBUTES = { {
+		{ 0, 3, GL_UNSIGNED_SHORT, GL_TRUE, offsetof(QuantizedMeshVertex, position) },
+		{ 1, 2, GL_HALF_FLOAT, GL_FALSE, offsetof(QuantizedMeshVertex, texCoord) },
+		{ 2, 4, GL_INT_2_10_10_10_REV, GL_TRUE, offsetof(QuantizedMeshVertex, normal) },
+		{ 3, 4, GL_INT_2_10_10_10_REV, GL_TRUE, offsetof(QuantizedMeshVertex, tangent) },
+	} };
+};
+
+/// <summary>
+/// The vertices of a mesh in the layout they are uploaded with, along with what was measured while building them
+/// Built once from the attribute streams, so meshes loaded from the model cache are uploaded without being interleaved again
+/// </summary>
+struct MeshVertexData
+{
+	/// <summary>
+	/// The interleaved vertices, QuantizedMeshVertex if the mesh is quantized and MeshVertex otherwise
+	/// </summary>
+	std::vector<unsigned char> bytes;
+
+	unsigned int vertexCount = 0;
+	bool quantized = false;
+
+	/// <summary>
+	/// Whether the streams had texture coordinates, zeroed ones are stored otherwise
+	/// </summary>
+	bool hasTexCoords = false;
+
+	VertexDequantization dequantization;
+	QuantizationError quantizationError;
+
+	/// <summary>
+	/// How many texture coordinates units a unit length of the most detailed level covers, 0 without texture coordinates
+	/// </summary>
+	float texCoordDensity = 0.0f;
+
+	/// <summary>
+	/// Returns the size of a vertex of the layout
+	/// </summary>
+	[[nodiscard]] size_t getVertexSize() const
+	{
+		return this->quantized ? sizeof(QuantizedMeshVertex) : sizeof(MeshVertex);
+	}
+};
+
+/// <summary>
+/// A utility class for building interleaved vertex buffers and describing them to OpenGL
+/// </summary>
+class VertexFormat
+{
+public:
+	/// <summary>
+	/// Sets up the attribute pointers of the currently bound VAO for the buffer bound to GL_ARRAY_BUFFER
+	/// </summary>
+	template<typename Vertex>
+	static void setupAttributes()
+	{
+		for (const VertexAttribute& attribute : VertexLayout<Vertex>::ATTRIBUTES)
+		{
+			glVertexAttribPointer(
+				attribute.location,
+				attribute.size,
+				attribute.type,
+				attribute.normalized,
+				sizeof(Vertex),
+				reinterpret_cast<const void*>(attribute.offset)
+			);
+			glEnableVertexAttribArray(attribute.location);
+		}
+	}
+
+	/// <summary>
+	/// Packs a vector with components in the [-1, 1] range to a signed normalized 10:10:10:2 integer (GL_INT_2_10_10_10_REV)
+	/// The w component only keeps its sign: it is stored as +1 or -2, which decode to +1 and -1 with both the pre and post OpenGL 4.2 conversion rules,
+	/// the old rule maps the 2 bit values to (2c + 1) / 3 so -1 would decode to -1/3 and 0 to 1/3
+	/// </summary>
+	static uint32_t packSnorm1010102(const glm::vec4& value)
+	{
+		auto x = static_cast<int32_t>(std::round(glm::clamp(value.x, -1.0f, 1.0f) * 511.0f));
+		auto y = static_cast<int32_t>(std::round(glm::clamp(value.y, -1.0f, 1.0f) * 511.0f));
+		auto z = static_cast<int32_t>(std::round(glm::clamp(value.z, -1.0f, 1.0f) * 511.0f));
+		int32_t w = value.w < 0.0f ? -2 : 1;
+
+		return (static_cast<uint32_t>(x) & 0x3FFu)
+			| ((static_cast<uint32_t>(y) & 0x3FFu) << 10)
+			| ((static_cast<uint32_t>(z) & 0x3FFu) << 20)
+			| ((static_cast<uint32_t>(w) & 0x3u) << 30);
+	}
+
+	/// <summary>
+	/// Unpacks a signed normalized 10:10:10:2 integer, the inverse of packSnorm1010102
+	/// The w component is decoded to its sign like the shaders do, so the result doesn't depend on the conversion rule of the driver
+	/// </summary>
+	static glm::vec4 unpackSnorm1010102(uint32_t packed)
+	{
+		// Sign extend each component
+		auto x = static_cast<int32_t>(packed << 22) >> 22;
+		auto y = static_cast<int32_t>(packed << 12) >> 22;
+		auto z = static_cast<int32_t>(packed << 2) >> 22;
+		auto w = static_cast<int32_t>(packed) >> 30;
+
+		return glm::vec4(
+			glm::max(static_cast<float>(x) / 511.0f, -1.0f),
+			glm::max(static_cast<float>(y) / 511.0f, -1.0f),
+			glm::max(static_cast<float>(z) / 511.0f, -1.0f),
+			w < 0 ? -1.0f : 1.0f
+		);
+	}
+
+	/// <summary>
+	/// Maps a unit vector to the [-1, 1] square using an octahedral projection
+	/// </summary>
+	static glm::vec2 octahedralEncode(const glm::vec3& vector)
+	{
+		float l1Norm = std::abs(vector.x) + std::abs(vector.y) + std::abs(vector.z);
+		if (l1Norm == 0.0f)
+			return glm::vec2(0.0f);
+
+		glm::vec2 encoded = glm::vec2(vector.x, vector.y) / l1Norm;
+
+		// Fold the lower hemisphere over the diagonals
+		if (vector.z < 0.0f)
+		{
+			encoded = glm::vec2(
+				(1.0f - std::abs(encoded.y)) * (encoded.x >= 0.0f ? 1.0f : -1.0f),
+				(1.0f - std::abs(encoded.x)) * (encoded.y >= 0.0f ? 1.0f : -1.0f)
+			);
+		}
+
+		return encoded;
+	}
+
+	/// <summary>
+	/// Returns the unit vector for a point of the octahedral projection, the inverse of octahedralEncode
+	/// </summary>
+	static glm::vec3 octahedralDecode(const glm::vec2& encoded)
+	{
+		glm::vec3 vector(encoded.x, encoded.y, 1.0f - std::abs(encoded.x) - std::abs(encoded.y));
+
+		if (vector.z < 0.0f)
+		{
+			vector.x = (1.0f - std::abs(encoded.y)) * (encoded.x >= 0.0f ? 1.0f : -1.0f);
+			vector.y = (1.0f - std::abs(encoded.x)) * (encoded.y >= 0.0f ? 1.0f : -1.0f);
+		}
+
+		return VertexFormat::safeNormalize(vector);
+	}
+
+	/// <summary>
+	/// Converts a float to a half float, values too small to be represented are flushed to zero
+	/// </summary>
+	static uint16_t floatToHalf(float value)
+	{
+		uint32_t bits;
+		std::memcpy(&bits, &value, sizeof(float));
+
+		auto sign = static_cast<uint16_t>((bits >> 16) & 0x8000u);
+		int32_t exponent = static_cast<int32_t>((bits >> 23) & 0xFFu) - 127 + 15;
+		uint32_t mantissa = bits & 0x7FFFFFu;
+
+		if (exponent <= 0)
+			return sign;
+		if (exponent >= 31)
+			return static_cast<uint16_t>(sign | 0x7C00u);
+
+		uint32_t half = sign | (static_cast<uint32_t>(exponent) << 10) | (mantissa >> 13);
+
+		// Round to nearest, a carry into the exponent is still a correctly rounded value
+		if (mantissa & 0x1000u)
+			half++;
+
+		return static_cast<uint16_t>(half);
+	}
+
+	/// <summary>
+	/// Converts a half float back to a float
+	/// </summary>
+	static float halfToFloat(uint16_t half)
+	{
+		uint32_t sign = static_cast<uint32_t>(half & 0x8000u) << 16;
+		uint32_t exponent = (half >> 10) & 0x1Fu;
+		uint32_t mantissa = half & 0x3FFu;
+
+		uint32_t bits = sign;
+		if (exponent == 31)
+			bits |= 0x7F800000u | (mantissa << 13);
+		else if (exponent != 0)
+			bits |= ((exponent - 15 + 127) << 23) | (mantissa << 13);
+
+		float value;
+		std::memcpy(&value, &bits, sizeof(float));
+		return value;
+	}
+
+	/// <summary>
+	/// Builds an interleaved vertex buffer from separate attribute arrays
+	/// Missing texture coordinates, normals or tangents are filled with zeros
+	/// If bitangents are given, they are only used to find the handedness of the tangent space
+	/// </summary>
+	/// <param name="vertices">The positions, 3 floats per vertex</param>
+	/// <param name="texCoords">The texture coordinates, 2 floats per vertex</param>
+	/// <param name="normals">The normals, 3 floats per vertex</param>
+	/// <param name="tangents">The tangents, 3 floats per vertex</param>
+	/// <param name="bitangents">The bitangents, 3 floats per vertex</param>
+	/// <param name="error">If not null, receives the angular error of the normal and tangent encoding</param>
+	/// <returns>A vector of interleaved vertices</returns>
+	static std::vector<MeshVertex> interleave(
+		const std::vector<float>& vertices,
+		const std::vector<float>& texCoords,
+		const std::vector<float>& normals,
+		const std::vector<float>& tangents,
+		const std::vector<float>& bitangents,
+		QuantizationError* error = nullptr)
+	{
+		size_t vertexCount = vertices.size() / 3;
+
+		bool hasTexCoords = texCoords.size() >= vertexCount * 2;
+		bool hasNormals = normals.size() >= vertexCount * 3;
+		bool hasTangents = tangents.size() >= vertexCount * 3;
+		bool hasBitangents = bitangents.size() >= vertexCount * 3;
+
+		std::vector<MeshVertex> interleaved(vertexCount);
+
+		// Smallest cosine between an original and a decoded direction
+		float minNormalCos = 1.0f;
+		float minTangentCos = 1.0f;
+
+		for (size_t i = 0; i < vertexCount; i++)
+		{
+			MeshVertex& vertex = interleaved[i];
+
+			vertex.position = glm::vec3(vertices[i * 3], vertices[i * 3 + 1], vertices[i * 3 + 2]);
+			vertex.texCoord = hasTexCoords ? glm::vec2(texCoords[i * 2], texCoords[i * 2 + 1]) : glm::vec2(0.0f);
+
+			glm::vec3 normal = hasNormals ? glm::vec3(normals[i * 3], normals[i * 3 + 1], normals[i * 3 + 2]) : glm::vec3(0.0f);
+			glm::vec3 tangent = hasTangents ? glm::vec3(tangents[i * 3], tangents[i * 3 + 1], tangents[i * 3 + 2]) : glm::vec3(0.0f);
+
+			float bitangentSign = 1.0f;
+			if (hasBitangents)
+			{
+				glm::vec3 bitangent(bitangents[i * 3], bitangents[i * 3 + 1], bitangents[i * 3 + 2]);
+
+				if (glm::dot(glm::cross(normal, tangent), bitangent) < 0.0f)
+					bitangentSign = -1.0f;
+			}
+
+			normal = VertexFormat::safeNormalize(normal);
+			tangent = VertexFormat::safeNormalize(tangent);
+
+			glm::vec2 encodedNormal = VertexFormat::octahedralEncode(normal);
+			glm::vec2 encodedTangent = VertexFormat::octahedralEncode(tangent);
+
+			vertex.normal = VertexFormat::packSnorm1010102(glm::vec4(encodedNormal, 0.0f, 1.0f));
+			vertex.tangent = VertexFormat::packSnorm1010102(glm::vec4(encodedTangent, 0.0f, bitangentSign));
+
+			if (error != nullptr)
+			{
+				if (hasNormals)
+					minNormalCos = glm::min(minNormalCos, glm::dot(normal, VertexFormat::decodeDirection(vertex.normal)));
+
+				if (hasTangents)
+					minTangentCos = glm::min(minTangentCos, glm::dot(tangent, VertexFormat::decodeDirection(vertex.tangent)));
+			}
+		}
+
+		if (error != nullptr)
+		{
+			error->maxNormalError = glm::degrees(std::acos(glm::clamp(minNormalCos, -1.0f, 1.0f)));
+			error->maxTangentError = glm::degrees(std::acos(glm::clamp(minTangentCos, -1.0f, 1.0f)));
+		}
+
+		return interleaved;
+	}
+
+	/// <summary>
+	/// Quantizes interleaved vertices, positions are stored relative to the bounding box of the mesh
+	/// </summary>
+	/// <param name="vertices">The vertices to quantize</param>
+	/// <param name="dequantization">Receives the transform that brings the positions back to object space</param>
+	/// <param name="error">Receives the position and texture coordinates quantization error</param>
+	/// <returns>A vector of quantized vertices</returns>
+	static std::vector<QuantizedMeshVertex> quantize(const std::vector<MeshVertex>& vertices, VertexDequantization& dequantization, QuantizationError& error)
+	{
+		std::vector<QuantizedMeshVertex> quantized(vertices.size());
+
+		if (vertices.empty())
+		{
+			dequantization = VertexDequantization();
+			return quantized;
+		}
+
+		glm::vec3 minPosition = vertices[0].position;
+		glm::vec3 maxPosition = vertices[0].position;
+
+		for (const MeshVertex& vertex : vertices)
+		{
+			minPosition = glm::min(minPosition, vertex.position);
+			maxPosition = glm::max(maxPosition, vertex.position);
+		}
+
+		dequantization.offset = minPosition;
+		dequantization.scale = maxPosition - minPosition;
+
+		error.maxPositionError = 0.0f;
+		error.maxTexCoordError = 0.0f;
+
+		for (size_t i = 0; i < vertices.size(); i++)
+		{
+			const MeshVertex& vertex = vertices[i];
+			QuantizedMeshVertex& quantizedVertex = quantized[i];
+
+			glm::vec3 decodedPosition{};
+			for (int axis = 0; axis < 3; axis++)
+			{
+				// Flat axes keep a scale of 0 and always decode to the offset
+				float extent = dequantization.scale[axis];
+				float normalized = extent > 0.0f ? (vertex.position[axis] - minPosition[axis]) / extent : 0.0f;
+
+				auto value = static_cast<uint16_t>(std::round(glm::clamp(normalized, 0.0f, 1.0f) * 65535.0f));
+				quantizedVertex.position[axis] = value;
+				decodedPosition[axis] = dequantization.offset[axis] + (static_cast<float>(value) / 65535.0f) * extent;
+			}
+			quantizedVertex.padding = 0;
+
+			quantizedVertex.texCoord[0] = VertexFormat::floatToHalf(vertex.texCoord.x);
+			quantizedVertex.texCoord[1] = VertexFormat::floatToHalf(vertex.texCoord.y);
+			glm::vec2 decodedTexCoord(VertexFormat::halfToFloat(quantizedVertex.texCoord[0]), VertexFormat::halfToFloat(quantizedVertex.texCoord[1]));
+
+			quantizedVertex.normal = vertex.normal;
+			quantizedVertex.tangent = vertex.tangent;
+
+			error.maxPositionError = glm::max(error.maxPositionError, glm::length(decodedPosition - vertex.position));
+			error.maxTexCoordError = glm::max(error.maxTexCoordError, glm::length(decodedTexCoord - vertex.texCoord));
+		}
+
+		return quantized;
+	}
+
+	/// <summary>
+	/// Interleaves the attribute streams of a mesh, and quantizes them if asked to, normals are calculated if there are none
+	/// </summary>
+	/// <param name="lods">The levels of detail of the mesh, the texture coordinates density is measured on the first one</param>
+	/// <param name="quantize">Whether to use the quantized vertex layout</param>
+	static MeshVertexData buildVertexData(const std::vector<float>& vertices, const std::vector<float>& texCoords, const std::vector<float>& normals,
+		const std::vector<float>& tangents, const std::vector<float>& bitangents, const std::vector<unsigned int>& indices, const std::vector<MeshLod>& lods, bool quantize)
+	{
+		MeshVertexData vertexData;
+		vertexData.vertexCount = static_cast<unsigned int>(vertices.size() / 3);
+		vertexData.quantized = quantize;
+		vertexData.hasTexCoords = !texCoords.empty();
+
+		// We calculate the normals if none are provided
+		std::vector<float> calculatedNormals;
+
+		if (normals.empty())
+		{
+			if (!indices.empty())
+				calculatedNormals = Geometry::calculateVerticesNormals(vertices, indices);
+			else
+				calculatedNormals = Geometry::calculateVerticesNormals(vertices);
+		}
+
+		// Interleave all the attributes into a single buffer
+		std::vector<MeshVertex> interleavedVertices = VertexFormat::interleave(vertices, texCoords, normals.empty() ? calculatedNormals : normals, tangents, bitangents, &vertexData.quantizationError);
+
+		auto copyBytes = [&vertexData](const auto& typedVertices)
+		{
+			const auto* bytes = reinterpret_cast<const unsigned char*>(typedVertices.data());
+			vertexData.bytes.assign(bytes, bytes + typedVertices.size() * sizeof(typedVertices[0]));
+		};
+
+		if (quantize)
+			copyBytes(VertexFormat::quantize(interleavedVertices, vertexData.dequantization, vertexData.quantizationError));
+		else
+			copyBytes(interleavedVertices);
+
+		// The density of the most detailed level decides which mip levels of the textures are streamed in
+		if (vertexData.hasTexCoords)
+		{
+			size_t indexCount = indices.empty() ? vertices.size() / 3 : indices.size();
+
+			if (!lods.empty() && static_cast<size_t>(lods[0].indexOffset) + lods[0].indexCount <= indexCount)
+				vertexData.texCoordDensity = Geometry::getTexCoordDensity(vertices, texCoords, indices, lods[0].indexOffset, lods[0].indexCount);
+			else
+				vertexData.texCoordDensity = Geometry::getTexCoordDensity(vertices, texCoords, indices, 0, indexCount);
+		}
+
+		return vertexData;
+	}
+
+private:
+	static glm::vec3 safeNormalize(const glm::vec3& vector)
+	{
+		float length = glm::length(vector);
+		return length > 0.0f ? vector / length : vector;
+	}
+
+	static glm::vec3 decodeDirection(uint32_t packed)
+	{
+		glm::vec4 unpacked = VertexFormat::unpackSnorm1010102(packed);
+		return VertexFormat::octahedralDecode(glm::vec2(unpacked.x, unpacked.y));
+	}
+};
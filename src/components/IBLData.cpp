@@ -1,3 +1,8 @@
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <vector>
+
 #include <glm/glm/ext/matrix_clip_space.hpp>
 #include <glm/glm/ext/matrix_transform.hpp>
 
@@ -6,6 +11,112 @@
 #include "renderTarget.hpp"
 #include "utilities/geometry.hpp"
 #include "materials/pbrMaterial.hpp"
+#include "utilities/mappedFile.hpp"
+#include "logger.hpp"
+
+namespace
+{
+	/// <summary>
+	/// The header of an IBL cache file, followed by the faces of each map level by level and by the BRDF lookup texture
+	/// </summary>
+	struct IBLCacheHeader
+	{
+		char magic[4];
+		uint32_t version;
+		uint64_t sourceHash;
+		uint32_t environmentSize;
+		uint32_t irradianceSize;
+		uint32_t prefilterSize;
+		uint32_t prefilterLevels;
+		uint32_t brdfLutSize;
+		uint32_t padding;
+		uint64_t payloadSize;
+	};
+
+	/// <summary>
+	/// A map of a sky in the order it is stored, with the size of its faces and its number of levels
+	/// </summary>
+	struct CachedMap
+	{
+		const Cubemap* cubemap;
+		int size;
+		int levels;
+	};
+
+	// The cubemaps store three half floats per pixel, the BRDF lookup texture two
+	constexpr size_t CUBEMAP_PIXEL_SIZE = 6;
+	constexpr size_t BRDF_LUT_PIXEL_SIZE = 4;
+
+	size_t getFaceByteSize(int size, int level)
+	{
+		size_t levelSize = std::max(size >> level, 1);
+		return levelSize * levelSize * CUBEMAP_PIXEL_SIZE;
+	}
+
+	/// <summary>
+	/// Sets the pixel pack and unpack alignment to 1 for its lifetime, the RGB half float rows are 6 bytes per pixel
+	/// and faces or levels of odd size would otherwise be padded to 4 bytes per row, unlike the tightly packed payload
+	/// </summary>
+	class TightPixelAlignment
+	{
+	public:
+		TightPixelAlignment()
+		{
+			glGetIntegerv(GL_PACK_ALIGNMENT, &this->packAlignment);
+			glGetIntegerv(GL_UNPACK_ALIGNMENT, &this->unpackAlignment);
+
+			glPixelStorei(GL_PACK_ALIGNMENT, 1);
+			glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+		}
+
+		~TightPixelAlignment()
+		{
+			glPixelStorei(GL_PACK_ALIGNMENT, this->packAlignment);
+			glPixelStorei(GL_UNPACK_ALIGNMENT, this->unpackAlignment);
+		}
+
+		TightPixelAlignment(TightPixelAlignment const&) = delete;
+		TightPixelAlignment& operator=(TightPixelAlignment const&) = delete;
+
+	private:
+		GLint packAlignment = 4;
+		GLint unpackAlignment = 4;
+	};
+
+	/// <summary>
+	/// The largest face size accepted from a cache file, so a corrupted header can't overflow the payload size
+	/// </summary>
+	constexpr uint32_t MAX_CUBEMAP_SIZE = 16384;
+
+	/// <summary>
+	/// Returns the size of the faces of a cubemap as allocated on the GPU, a cubemap created from images keeps the size of the images
+	/// </summary>
+	int getCubemapSize(const Cubemap* cubemap)
+	{
+		GLint size = 0;
+
+		cubemap->bind();
+		glGetTexLevelParameteriv(GL_TEXTURE_CUBE_MAP_POSITIVE_X, 0, GL_TEXTURE_WIDTH, &size);
+
+		return size;
+	}
+
+	/// <summary>
+	/// Returns the size of the payload of a cache file for maps of the given sizes
+	/// </summary>
+	size_t getPayloadSize(const CachedMap* maps, size_t mapCount)
+	{
+		size_t payloadSize = static_cast<size_t>(IBLData::BRDF_LUT_SIZE) * IBLData::BRDF_LUT_SIZE * BRDF_LUT_PIXEL_SIZE;
+
+		for (size_t i = 0; i < mapCount; i++)
+		{
+			for (int level = 0; level < maps[i].levels; level++)
+				payloadSize += getFaceByteSize(maps[i].size, level) * 6;
+		}
+
+		return payloadSize;
+	}
+}
 
 IBLData::IBLData(Renderer& renderer, const std::shared_ptr<Texture>& hdrMap)
 {
@@ -15,7 +126,7 @@ IBLData::IBLData(Renderer& renderer, const std::shared_ptr<Texture>& hdrMap)
 	Shader* prefilterShader = renderer.shaderManager.getShader(ShaderType::PREFILTER);
 	Shader* brdfShader = renderer.shaderManager.getShader(ShaderType::BRDF);
 
-	std::vector<float> boxVertices = Geometry::getClockwiseCubeVertices();
+	const std::vector<float>& boxVertices = Geometry::getClockwiseCubeVertices();
 
 	// Create an entity that will contain a box mesh to display the HDR map
 	std::unique_ptr<Entity> cubemapEntity = std::make_unique<Entity>("HDR Cubemap");
@@ -45,8 +156,8 @@ IBLData::IBLData(Renderer& renderer, const std::shared_ptr<Texture>& hdrMap)
 	};
 
 	hdrToCubemapShader->use()
-		->setInt("equirectangularMap", 0)
-		->setMat4("projection", captureProjection);
+		->setInt(IBLData::EQUIRECTANGULAR_MAP, 0)
+		->setMat4(IBLData::PROJECTION, captureProjection);
 
 	glActiveTexture(GL_TEXTURE0);
 	hdrMap->bindTexture();
@@ -55,7 +166,7 @@ IBLData::IBLData(Renderer& renderer, const std::shared_ptr<Texture>& hdrMap)
 	captureRT.bind();
 	for (unsigned int i = 0; i < 6; ++i)
 	{
-		hdrToCubemapShader->setMat4("view", captureViews[i]);
+		hdrToCubemapShader->setMat4(IBLData::VIEW, captureViews[i]);
 		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, this->environmentMap->texID, 0);
 		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 		cubemapEntity->update(0);
@@ -67,15 +178,15 @@ IBLData::IBLData(Renderer& renderer, const std::shared_ptr<Texture>& hdrMap)
 
 	// Create irradiance map
 	irradianceShader->use();
-	irradianceShader->setInt("environmentMap", 0);
-	irradianceShader->setMat4("projection", captureProjection);
+	irradianceShader->setInt(IBLData::ENVIRONMENT_MAP, 0);
+	irradianceShader->setMat4(IBLData::PROJECTION, captureProjection);
 	glActiveTexture(GL_TEXTURE0);
 	this->environmentMap->bind();
 
 	captureRT.bind();
 	for (unsigned int i = 0; i < 6; i++)
 	{
-		irradianceShader->setMat4("view", captureViews[i]);
+		irradianceShader->setMat4(IBLData::VIEW, captureViews[i]);
 		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, this->irradianceMap->texID, 0);
 		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 		lightMesh->setMaterial(std::make_unique<PBRMaterial>(irradianceShader))
@@ -90,14 +201,14 @@ IBLData::IBLData(Renderer& renderer, const std::shared_ptr<Texture>& hdrMap)
 	this->prefilterMap->generateMipMaps();
 
 	prefilterShader->use();
-	prefilterShader->setInt("environmentMap", 0);
-	prefilterShader->setMat4("projection", captureProjection);
+	prefilterShader->setInt(IBLData::ENVIRONMENT_MAP, 0);
+	prefilterShader->setMat4(IBLData::PROJECTION, captureProjection);
 	glActiveTexture(GL_TEXTURE0);
 	this->environmentMap->bind();
 
 	// We bind the framebuffer and start capturing each face of the cube for each mip level
 	captureRT.bind();
-	unsigned int maxMipLevels = 5;
+	unsigned int maxMipLevels = IBLData::PREFILTER_LEVELS;
 
 	for (int mip = 0; mip < maxMipLevels; ++mip)
 	{
@@ -107,11 +218,11 @@ IBLData::IBLData(Renderer& renderer, const std::shared_ptr<Texture>& hdrMap)
 		captureRT.resize(glm::vec2(mipWidth, mipHeight));
 
 		float roughness = static_cast<float>(mip) / static_cast<float>(maxMipLevels - 1);
-		prefilterShader->setFloat("roughness", roughness);
+		prefilterShader->setFloat(IBLData::ROUGHNESS, roughness);
 
 		for (unsigned int i = 0; i < 6; ++i)
 		{
-			prefilterShader->setMat4("view", captureViews[i]);
+			prefilterShader->setMat4(IBLData::VIEW, captureViews[i]);
 			glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, this->prefilterMap->texID, mip);
 			glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 			lightMesh->setMaterial(std::make_unique<PBRMaterial>(prefilterShader))
@@ -123,8 +234,8 @@ IBLData::IBLData(Renderer& renderer, const std::shared_ptr<Texture>& hdrMap)
 	captureRT.unbind();
 
 	// Create BRDF map
-	std::vector<float> quadVertices = Geometry::getQuadVertices();
-	std::vector<float> quadTexCoords = Geometry::getQuadTexCoords();
+	const std::vector<float>& quadVertices = Geometry::getQuadVertices();
+	const std::vector<float>& quadTexCoords = Geometry::getQuadTexCoords();
 
 	std::unique_ptr<Entity> quadEntity = std::make_unique<Entity>("Quad");
 	auto* quadMesh = quadEntity->addComponent<MeshComponent>();
@@ -154,7 +265,7 @@ IBLData::IBLData(Renderer& renderer, const std::shared_ptr<Texture>& hdrMap)
 	quadEntity->update(0);
 	captureRT.unbind();
 
-	this->brdfLut = std::make_unique<Texture>(brdfLUTTexture, TextureType::TEXTURE_ALBEDO);
+	this->brdfLut = std::make_shared<Texture>(brdfLUTTexture, TextureType::TEXTURE_ALBEDO);
 
 	cubemapEntity.reset();
 }
@@ -166,7 +277,7 @@ IBLData::IBLData(Renderer& renderer, std::unique_ptr<Cubemap> cubemap) : environ
 	Shader* prefilterShader = renderer.shaderManager.getShader(ShaderType::PREFILTER);
 	Shader* brdfShader = renderer.shaderManager.getShader(ShaderType::BRDF);
 
-	std::vector<float> boxVertices = Geometry::getClockwiseCubeVertices();
+	const std::vector<float>& boxVertices = Geometry::getClockwiseCubeVertices();
 
 	// Create an entity that will contain a box mesh to display the HDR map
 	std::unique_ptr<Entity> cubemapEntity = std::make_unique<Entity>("HDR Cubemap");
@@ -194,15 +305,15 @@ IBLData::IBLData(Renderer& renderer, std::unique_ptr<Cubemap> cubemap) : environ
 
 	// Create irradiance map
 	irradianceShader->use();
-	irradianceShader->setInt("environmentMap", 0);
-	irradianceShader->setMat4("projection", captureProjection);
+	irradianceShader->setInt(IBLData::ENVIRONMENT_MAP, 0);
+	irradianceShader->setMat4(IBLData::PROJECTION, captureProjection);
 	glActiveTexture(GL_TEXTURE0);
 	this->environmentMap->bind();
 
 	captureRT.bind();
 	for (unsigned int i = 0; i < 6; i++)
 	{
-		irradianceShader->setMat4("view", captureViews[i]);
+		irradianceShader->setMat4(IBLData::VIEW, captureViews[i]);
 		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, this->irradianceMap->texID, 0);
 		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 		cubemapEntity->update(0);
@@ -214,14 +325,14 @@ IBLData::IBLData(Renderer& renderer, std::unique_ptr<Cubemap> cubemap) : environ
 	this->prefilterMap->generateMipMaps();
 
 	prefilterShader->use();
-	prefilterShader->setInt("environmentMap", 0);
-	prefilterShader->setMat4("projection", captureProjection);
+	prefilterShader->setInt(IBLData::ENVIRONMENT_MAP, 0);
+	prefilterShader->setMat4(IBLData::PROJECTION, captureProjection);
 	glActiveTexture(GL_TEXTURE0);
 	this->environmentMap->bind();
 
 	// We bind the framebuffer and start capturing each face of the cube for each mip level
 	captureRT.bind();
-	unsigned int maxMipLevels = 5;
+	unsigned int maxMipLevels = IBLData::PREFILTER_LEVELS;
 
 	for (int mip = 0; mip < maxMipLevels; ++mip)
 	{
@@ -231,11 +342,11 @@ IBLData::IBLData(Renderer& renderer, std::unique_ptr<Cubemap> cubemap) : environ
 		captureRT.resize(glm::vec2(mipWidth, mipHeight));
 
 		float roughness = static_cast<float>(mip) / static_cast<float>(maxMipLevels - 1);
-		prefilterShader->setFloat("roughness", roughness);
+		prefilterShader->setFloat(IBLData::ROUGHNESS, roughness);
 
 		for (unsigned int i = 0; i < 6; ++i)
 		{
-			prefilterShader->setMat4("view", captureViews[i]);
+			prefilterShader->setMat4(IBLData::VIEW, captureViews[i]);
 			glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, this->prefilterMap->texID, mip);
 			glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 			lightMesh->setMaterial(std::make_unique<PBRMaterial>(prefilterShader))
@@ -247,8 +358,8 @@ IBLData::IBLData(Renderer& renderer, std::unique_ptr<Cubemap> cubemap) : environ
 	captureRT.unbind();
 
 	// Create BRDF map
-	std::vector<float> quadVertices = Geometry::getQuadVertices();
-	std::vector<float> quadTexCoords = Geometry::getQuadTexCoords();
+	const std::vector<float>& quadVertices = Geometry::getQuadVertices();
+	const std::vector<float>& quadTexCoords = Geometry::getQuadTexCoords();
 
 	std::unique_ptr<Entity> quadEntity = std::make_unique<Entity>("Quad");
 	auto* quadMesh = quadEntity->addComponent<MeshComponent>();
@@ -277,5 +388,175 @@ IBLData::IBLData(Renderer& renderer, std::unique_ptr<Cubemap> cubemap) : environ
 	quadEntity->update(0);
 	captureRT.unbind();
 
-	this->brdfLut = std::make_unique<Texture>(brdfLUTTexture, TextureType::TEXTURE_ALBEDO);
+	this->brdfLut = std::make_shared<Texture>(brdfLUTTexture, TextureType::TEXTURE_ALBEDO);
+}
+
+IBLData::IBLData(int environmentSize) : environmentMap(std::make_shared<Cubemap>(GL_RGB16F, environmentSize, environmentSize))
+{
+
+}
+
+std::shared_ptr<IBLData> IBLData::load(const std::string& path, uint64_t sourceHash)
+{
+	MappedFile file(path);
+
+	if (!file.isOpen())
+		return nullptr;
+
+	IBLCacheHeader header = {};
+
+	if (file.getSize() < sizeof(header))
+	{
+		Logger::logWarning("Truncated IBL cache file " + path, "IBLData.cpp");
+		return nullptr;
+	}
+
+	std::memcpy(&header, file.getData(), sizeof(header));
+
+	// The environment map has the size of the images of the sky, the convolved maps the sizes they are rendered at
+	bool isValid = std::memcmp(header.magic, IBLData::MAGIC, sizeof(header.magic)) == 0
+		&& header.version == IBLData::VERSION
+		&& header.sourceHash == sourceHash
+		&& header.environmentSize > 0 && header.environmentSize <= MAX_CUBEMAP_SIZE
+		&& header.irradianceSize == IBLData::IRRADIANCE_SIZE
+		&& header.prefilterSize == IBLData::PREFILTER_SIZE
+		&& header.prefilterLevels == IBLData::PREFILTER_LEVELS
+		&& header.brdfLutSize == IBLData::BRDF_LUT_SIZE;
+
+	// The sizes are checked against the file before any texture is allocated
+	CachedMap maps[] = {
+		{ nullptr, static_cast<int>(std::min(header.environmentSize, MAX_CUBEMAP_SIZE)), 1 },
+		{ nullptr, IBLData::IRRADIANCE_SIZE, 1 },
+		{ nullptr, IBLData::PREFILTER_SIZE, IBLData::PREFILTER_LEVELS },
+	};
+
+	isValid = isValid
+		&& header.payloadSize == getPayloadSize(maps, std::size(maps))
+		&& header.payloadSize == file.getSize() - sizeof(header);
+
+	if (!isValid)
+	{
+		Logger::logWarning("Ignoring outdated IBL cache file " + path, "IBLData.cpp");
+		return nullptr;
+	}
+
+	std::shared_ptr<IBLData> iblData(new IBLData(static_cast<int>(header.environmentSize)));
+	maps[0].cubemap = iblData->environmentMap.get();
+	maps[1].cubemap = iblData->irradianceMap.get();
+	maps[2].cubemap = iblData->prefilterMap.get();
+
+	const unsigned char* data = file.getData() + sizeof(header);
+	TightPixelAlignment alignment;
+
+	for (const CachedMap& map : maps)
+	{
+		map.cubemap->bind();
+
+		for (int level = 0; level < map.levels; level++)
+		{
+			int levelSize = std::max(map.size >> level, 1);
+
+			for (unsigned int i = 0; i < 6; i++)
+			{
+				glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, level, GL_RGB16F, levelSize, levelSize, 0, GL_RGB, GL_HALF_FLOAT, data);
+				data += getFaceByteSize(map.size, level);
+			}
+		}
+
+		// Only the levels that were rendered are stored, the sampler must not expect the rest of the mip chain
+		glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAX_LEVEL, map.levels - 1);
+	}
+
+	unsigned int brdfLUTTexture;
+	glGenTextures(1, &brdfLUTTexture);
+
+	glBindTexture(GL_TEXTURE_2D, brdfLUTTexture);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RG16F, IBLData::BRDF_LUT_SIZE, IBLData::BRDF_LUT_SIZE, 0, GL_RG, GL_HALF_FLOAT, data);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+	iblData->brdfLut = std::make_shared<Texture>(brdfLUTTexture, TextureType::TEXTURE_ALBEDO);
+
+	return iblData;
+}
+
+bool IBLData::save(const std::string& path, uint64_t sourceHash) const
+{
+	if (this->brdfLut == nullptr)
+		return false;
+
+	// The sizes are read from the textures, an environment map created from the images of a skybox has their size rather than ENVIRONMENT_SIZE
+	const CachedMap maps[] = {
+		{ this->environmentMap.get(), getCubemapSize(this->environmentMap.get()), 1 },
+		{ this->irradianceMap.get(), getCubemapSize(this->irradianceMap.get()), 1 },
+		{ this->prefilterMap.get(), getCubemapSize(this->prefilterMap.get()), IBLData::PREFILTER_LEVELS },
+	};
+
+	for (const CachedMap& map : maps)
+	{
+		if (map.size <= 0 || static_cast<uint32_t>(map.size) > MAX_CUBEMAP_SIZE)
+			return false;
+	}
+
+	// The maps are read back from the GPU as they were rendered
+	std::vector<char> payload(getPayloadSize(maps, std::size(maps)));
+	size_t offset = 0;
+
+	{
+		TightPixelAlignment alignment;
+
+		for (const CachedMap& map : maps)
+		{
+			map.cubemap->bind();
+
+			for (int level = 0; level < map.levels; level++)
+			{
+				for (unsigned int i = 0; i < 6; i++)
+				{
+					glGetTexImage(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, level, GL_RGB, GL_HALF_FLOAT, payload.data() + offset);
+					offset += getFaceByteSize(map.size, level);
+				}
+			}
+		}
+
+		this->brdfLut->bindTexture();
+		glGetTexImage(GL_TEXTURE_2D, 0, GL_RG, GL_HALF_FLOAT, payload.data() + offset);
+	}
+
+	IBLCacheHeader header = {};
+	std::memcpy(header.magic, IBLData::MAGIC, sizeof(header.magic));
+	header.version = IBLData::VERSION;
+	header.sourceHash = sourceHash;
+	header.environmentSize = static_cast<uint32_t>(maps[0].size);
+	header.irradianceSize = static_cast<uint32_t>(maps[1].size);
+	header.prefilterSize = static_cast<uint32_t>(maps[2].size);
+	header.prefilterLevels = IBLData::PREFILTER_LEVELS;
+	header.brdfLutSize = IBLData::BRDF_LUT_SIZE;
+	header.payloadSize = payload.size();
+
+	std::error_code error;
+
+	bool isWritten = CacheFile::write(path, [&](std::ofstream& file)
+	{
+		file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		file.write(payload.data(), static_cast<std::streamsize>(payload.size()));
+	}, error);
+
+	if (!isWritten)
+	{
+		Logger::logWarning("Couldn't write the IBL cache file " + path + " - " + error.message(), "IBLData.cpp");
+		return false;
+	}
+
+	return true;
+}
+
+size_t IBLData::getByteSize() const
+{
+	// The BRDF lookup texture is created from its handle, so its size is counted here
+	size_t brdfLutSize = this->brdfLut != nullptr ? static_cast<size_t>(IBLData::BRDF_LUT_SIZE) * IBLData::BRDF_LUT_SIZE * BRDF_LUT_PIXEL_SIZE : 0;
+
+	return this->environmentMap->getByteSize() + this->irradianceMap->getByteSize() + this->prefilterMap->getByteSize() + brdfLutSize;
 }
@@ -16,16 +16,13 @@ DirectionalLightComponent::DirectionalLightComponent(Entity* parent) : LightComp
 
 void DirectionalLightComponent::sendToShader(Shader* shaderProgram, unsigned int index)
 {
-	std::string lightLocation = "dirLights[" + std::to_string(index) + "]";
+	Uniform light = DirectionalLightComponent::DIR_LIGHTS.at(index);
 
-	std::string ambientLoc = lightLocation + ".ambientColor";
-	std::string diffuseLoc = lightLocation + ".diffuseColor";
-	std::string specularLoc = lightLocation + ".specularColor";
-	std::string directionLoc = lightLocation + ".direction";
-
-	glUniform3fv(glGetUniformLocation(shaderProgram->getID(), ambientLoc.c_str()), 1, &this->ambientColor[0]);
-	glUniform3fv(glGetUniformLocation(shaderProgram->getID(), diffuseLoc.c_str()), 1, &this->diffuseColor[0]);
-	glUniform3fv(glGetUniformLocation(shaderProgram->getID(), specularLoc.c_str()), 1, &this->specularColor[0]);
 	this->direction = glm::normalize(this->parent->getTransform()->getPosition());
-	glUniform3fv(glGetUniformLocation(shaderProgram->getID(), directionLoc.c_str()), 1, &this->direction[0]);
+
+	shaderProgram
+		->setVec3(light.member("ambientColor"), this->ambientColor)
+		->setVec3(light.member("diffuseColor"), this->diffuseColor)
+		->setVec3(light.member("specularColor"), this->specularColor)
+		->setVec3(light.member("direction"), this->direction);
 }
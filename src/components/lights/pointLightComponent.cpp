@@ -1,5 +1,3 @@
-#include <string>
-
 #include <utilities/glad.h>
 
 #include "components/lights/pointLightComponent.hpp"
@@ -18,22 +16,14 @@ PointLightComponent::PointLightComponent(Entity* parent) : Component(parent), Li
 
 void PointLightComponent::sendToShader(Shader* shaderProgram, unsigned int index)
 {
-	glUseProgram(shaderProgram->getID());
-
-	std::string lightLocation = "pointLights[" + std::to_string(index) + "]";
-	std::string ambientLoc = lightLocation + ".ambientColor";
-	std::string diffuseLoc = lightLocation + ".diffuseColor";
-	std::string specularLoc = lightLocation + ".specularColor";
-	std::string positionLoc = lightLocation + ".position";
-	std::string constantLoc = lightLocation + ".constant";
-	std::string linearLoc = lightLocation + ".linear";
-	std::string quadraticLoc = lightLocation + ".quadratic";
-
-	glUniform3fv(glGetUniformLocation(shaderProgram->getID(), ambientLoc.c_str()), 1, &this->ambientColor[0]);
-	glUniform3fv(glGetUniformLocation(shaderProgram->getID(), diffuseLoc.c_str()), 1, &this->diffuseColor[0]);
-	glUniform3fv(glGetUniformLocation(shaderProgram->getID(), specularLoc.c_str()), 1, &this->specularColor[0]);
-	glUniform3fv(glGetUniformLocation(shaderProgram->getID(), positionLoc.c_str()), 1, &this->parent->getTransform()->getPosition()[0]);
-	glUniform1f(glGetUniformLocation(shaderProgram->getID(), constantLoc.c_str()), this->constant);
-	glUniform1f(glGetUniformLocation(shaderProgram->getID(), linearLoc.c_str()), this->linear);
-	glUniform1f(glGetUniformLocation(shaderProgram->getID(), quadraticLoc.c_str()), this->quadratic);
+	Uniform light = PointLightComponent::POINT_LIGHTS.at(index);
+
+	shaderProgram->use()
+		->setVec3(light.member("ambientColor"), this->ambientColor)
+		->setVec3(light.member("diffuseColor"), this->diffuseColor)
+		->setVec3(light.member("specularColor"), this->specularColor)
+		->setVec3(light.member("position"), this->parent->getTransform()->getPosition())
+		->setFloat(light.member("constant"), this->constant)
+		->setFloat(light.member("linear"), this->linear)
+		->setFloat(light.member("quadratic"), this->quadratic);
 }
\ No newline at end of file
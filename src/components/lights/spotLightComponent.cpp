@@ -21,21 +21,8 @@ SpotLightComponent::SpotLightComponent(Entity* parent) : Component(parent), Ligh
 
 void SpotLightComponent::sendToShader(Shader* shaderProgram, unsigned int index)
 {
-	glUseProgram(shaderProgram->getID());
-
-	std::string lightLocation = "spotLights[" + std::to_string(index) + "]";
-
-	std::string ambientLoc = lightLocation + ".ambientColor";
-	std::string diffuseLoc = lightLocation + ".diffuseColor";
-	std::string specularLoc = lightLocation + ".specularColor";
-	std::string positionLoc = lightLocation + ".position";
-	std::string directionLoc = lightLocation + ".direction";
-	std::string constantLoc = lightLocation + ".constant";
-	std::string linearLoc = lightLocation + ".linear";
-	std::string quadraticLoc = lightLocation + ".quadratic";
-	std::string cutOffLoc = lightLocation + ".cutOff";
-	std::string outerCutOffLoc = lightLocation + ".outerCutOff";
-	
+	Uniform light = SpotLightComponent::SPOT_LIGHTS.at(index);
+
 	glm::vec3 rotation = this->parent->getTransform()->getRotation();
 
 	// Calculate the new front vector
@@ -45,14 +32,15 @@ void SpotLightComponent::sendToShader(Shader* shaderProgram, unsigned int index)
 	newDirection.z = static_cast<float>(sin(glm::radians(rotation.x)) * cos(glm::radians(rotation.y)));
 	newDirection = glm::normalize(newDirection);
 
-	glUniform3fv(glGetUniformLocation(shaderProgram->getID(), ambientLoc.c_str()), 1, &this->ambientColor[0]);
-	glUniform3fv(glGetUniformLocation(shaderProgram->getID(), diffuseLoc.c_str()), 1, &this->diffuseColor[0]);
-	glUniform3fv(glGetUniformLocation(shaderProgram->getID(), specularLoc.c_str()), 1, &this->specularColor[0]);
-	glUniform3fv(glGetUniformLocation(shaderProgram->getID(), positionLoc.c_str()), 1, &this->parent->getTransform()->getPosition()[0]);
-	glUniform3fv(glGetUniformLocation(shaderProgram->getID(), directionLoc.c_str()), 1, &newDirection[0]);
-	glUniform1f(glGetUniformLocation(shaderProgram->getID(), constantLoc.c_str()), this->constant);
-	glUniform1f(glGetUniformLocation(shaderProgram->getID(), linearLoc.c_str()), this->linear);
-	glUniform1f(glGetUniformLocation(shaderProgram->getID(), quadraticLoc.c_str()), this->quadratic);
-	glUniform1f(glGetUniformLocation(shaderProgram->getID(), cutOffLoc.c_str()), this->cutOff);
-	glUniform1f(glGetUniformLocation(shaderProgram->getID(), outerCutOffLoc.c_str()), this->outerCutOff);
+	shaderProgram->use()
+		->setVec3(light.member("ambientColor"), this->ambientColor)
+		->setVec3(light.member("diffuseColor"), this->diffuseColor)
+		->setVec3(light.member("specularColor"), this->specularColor)
+		->setVec3(light.member("position"), this->parent->getTransform()->getPosition())
+		->setVec3(light.member("direction"), newDirection)
+		->setFloat(light.member("constant"), this->constant)
+		->setFloat(light.member("linear"), this->linear)
+		->setFloat(light.member("quadratic"), this->quadratic)
+		->setFloat(light.member("cutOff"), this->cutOff)
+		->setFloat(light.member("outerCutOff"), this->outerCutOff);
 }
\ No newline at end of file
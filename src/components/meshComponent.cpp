@@ -10,9 +10,19 @@
 #include "materials/pbrMaterial.hpp"
 #include "materials/material.hpp"
 #include "utilities/geometry.hpp"
+#include "components/cameraComponent.hpp"
+#include "physics/frustum.hpp"
+#include "utilities/resourceManager.hpp"
 
-const std::string MeshComponent::MODEL = "model";
-const std::string MeshComponent::NORMAL_MATRIX = "normalMatrix";
+MeshBuffers::~MeshBuffers()
+{
+	glDeleteBuffers(1, &this->VBO);
+	glDeleteBuffers(1, &this->indicesBO);
+
+	glDeleteVertexArrays(1, &this->VAO);
+
+	ResourceManager::getInstance().trackMemory(ResourceType::MESH, -static_cast<int64_t>(this->byteSize));
+}
 
 MeshComponent::MeshComponent(Entity* parent) : Component(parent)
 {
@@ -21,118 +31,157 @@ MeshComponent::MeshComponent(Entity* parent) : Component(parent)
 
 MeshComponent::~MeshComponent()
 {
-	glDeleteBuffers(1, &this->VBO);
-	glDeleteBuffers(1, &this->texCoordBO);
-	glDeleteBuffers(1, &this->normalBO);
-	glDeleteBuffers(1, &this->indicesBO);
-	glDeleteBuffers(1, &this->tangentsBO);
-	glDeleteBuffers(1, &this->bitangentsBO);
-
-	glDeleteVertexArrays(1, &this->VAO);
-
 	this->material.reset();
 }
 
 void MeshComponent::start()
 {
-	// We calculate the normals if none are provided
-	if (normals.empty())
+	// Instances draw the buffers of the mesh they share the geometry of, they have no vertices of their own to upload
+	if (this->geometrySource != nullptr)
 	{
-		if (!indices.empty())
-			this->normals = Geometry::calculateVerticesNormals(this->vertices, this->indices);
-		else
-			this->normals = Geometry::calculateVerticesNormals(this->vertices);
+		this->adoptGeometry(*this->geometrySource);
+		this->geometrySource = nullptr;
+
+		if (!textures.empty() && this->material != nullptr)
+			this->material->addTextures(this->textures);
+
+		return;
 	}
 
-	glGenVertexArrays(1, &VAO);
-	glGenBuffers(1, &VBO);
+	// Meshes loaded by the ResourceLoader come with their vertices already built
+	if (this->vertexData.bytes.empty())
+		this->vertexData = VertexFormat::buildVertexData(this->vertices, this->texCoords, this->normals, this->tangents, this->bitangents, this->indices, this->lods, this->quantizeVertices);
 
-	glBindVertexArray(VAO);
+	// A mesh started again gets new buffers, the previous ones are freed once no instance uses them
+	auto buffers = std::make_shared<MeshBuffers>();
+
+	glGenVertexArrays(1, &buffers->VAO);
+	glGenBuffers(1, &buffers->VBO);
+
+	glBindVertexArray(buffers->VAO);
+
+	glBindBuffer(GL_ARRAY_BUFFER, buffers->VBO);
+	glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(this->vertexData.bytes.size()), this->vertexData.bytes.data(), GL_STATIC_DRAW);
+
+	buffers->byteSize = this->vertexData.bytes.size();
 
-	glBindBuffer(GL_ARRAY_BUFFER, VBO);
-	glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), &vertices[0], GL_STATIC_DRAW);
+	this->dequantization = this->vertexData.dequantization;
+	this->quantizationError = this->vertexData.quantizationError;
+	this->texCoordDensity = this->vertexData.texCoordDensity;
+
+	if (this->vertexData.quantized)
+	{
+		VertexFormat::setupAttributes<QuantizedMeshVertex>();
+
+		Logger::logDebug(
+			"Quantized " + std::to_string(this->vertexData.vertexCount) + " vertices ("
+			+ std::to_string(this->vertexData.vertexCount * sizeof(MeshVertex)) + " -> " + std::to_string(this->vertexData.bytes.size()) + " bytes), max error: position "
+			+ std::to_string(this->quantizationError.maxPositionError) + ", uv " + std::to_string(this->quantizationError.maxTexCoordError)
+			+ ", normal " + std::to_string(this->quantizationError.maxNormalError) + " deg, tangent " + std::to_string(this->quantizationError.maxTangentError) + " deg",
+			"meshComponent.cpp"
+		);
+
+		// Half floats lose precision quickly on tiling texture coordinates
+		if (this->quantizationError.maxTexCoordError > MeshComponent::MAX_TEXCOORD_QUANTIZATION_ERROR)
+			Logger::logWarning("Texture coordinates quantization error of " + std::to_string(this->quantizationError.maxTexCoordError) + " might cause visible texture swimming", "meshComponent.cpp");
+	}
+	else
+		VertexFormat::setupAttributes<MeshVertex>();
 
 	// Send the indices
 	if (!indices.empty())
 	{
 		this->hasIndices = true;
 
-		glGenBuffers(1, &indicesBO);
+		glGenBuffers(1, &buffers->indicesBO);
 
-		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indicesBO);
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffers->indicesBO);
 		glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), &indices[0], GL_STATIC_DRAW);
+
+		buffers->byteSize += indices.size() * sizeof(unsigned int);
 	}
 
-	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), nullptr);
-	glEnableVertexAttribArray(0);
+	// The buffers are owned by the meshes but accounted for by the ResourceManager, the count is removed when they are freed
+	ResourceManager::getInstance().trackMemory(ResourceType::MESH, static_cast<int64_t>(buffers->byteSize));
+
+	this->buffers = std::move(buffers);
+	this->VAO = this->buffers->VAO;
 
 	// If the MeshComponent uses textures, send them to the material
 	if (!textures.empty() && this->material != nullptr)
 		this->material->addTextures(this->textures);
 
-	// Send texture coordinates if present
-	if (!texCoords.empty())
-	{
-		// Generates a buffer to store texture coordinates data
-		glGenBuffers(1, &texCoordBO);
+	if (!this->vertexData.hasTexCoords && !textures.empty())
+		Logger::logWarning("MeshComponent has texture but no associated texture coordinates!", "meshComponent.cpp");
 
-		glBindBuffer(GL_ARRAY_BUFFER, texCoordBO);
-		glBufferData(GL_ARRAY_BUFFER, texCoords.size() * sizeof(float), &texCoords[0], GL_STATIC_DRAW);
+	this->localBoundingBox = Geometry::getMeshBoundingBox(this->vertices);
 
-		glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), nullptr);
-		glEnableVertexAttribArray(1);
-	}
-	else if (!textures.empty())
-		Logger::logWarning("MeshComponent has texture but no associated texture coordinates!", "meshComponent.cpp");
+	this->verticesCount = this->vertices.size();
+	this->indicesCount = this->indices.size();
 
-	// Send normals for lighting calculations
-	if (!normals.empty())
+	// Drop the levels of detail that don't fit in the index buffer
+	for (size_t i = 0; i < this->lods.size(); i++)
 	{
-		glGenBuffers(1, &normalBO);
+		if (static_cast<unsigned long>(this->lods[i].indexOffset) + this->lods[i].indexCount > this->indicesCount)
+		{
+			Logger::logWarning("MeshComponent has levels of detail outside of its index buffer, they will be ignored", "meshComponent.cpp");
+			this->lods.resize(i);
+			break;
+		}
+	}
 
-		glBindBuffer(GL_ARRAY_BUFFER, normalBO);
-		glBufferData(GL_ARRAY_BUFFER, normals.size() * sizeof(float), &normals[0], GL_STATIC_DRAW);
+	this->currentLod = 0;
 
-		glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), nullptr);
-		glEnableVertexAttribArray(2);
+	for (const Meshlet& meshlet : this->meshlets)
+	{
+		if (static_cast<unsigned long>(meshlet.indexOffset) + meshlet.indexCount > this->indicesCount)
+		{
+			Logger::logWarning("MeshComponent has meshlets outside of its index buffer, they will be ignored", "meshComponent.cpp");
+			this->meshlets.clear();
+			break;
+		}
 	}
 
-	// Send tangents for normal mapping
-	if (!tangents.empty())
+	for (MeshLod& lod : this->lods)
 	{
-		glGenBuffers(1, &tangentsBO);
-
-		glBindBuffer(GL_ARRAY_BUFFER, tangentsBO);
-		glBufferData(GL_ARRAY_BUFFER, tangents.size() * sizeof(float), &tangents[0], GL_STATIC_DRAW);
-
-		glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), nullptr);
-		glEnableVertexAttribArray(3);
+		if (static_cast<size_t>(lod.meshletOffset) + lod.meshletCount > this->meshlets.size())
+			lod.meshletCount = 0;
 	}
 
-	// Send bitangents for normal mapping
-	if (!bitangents.empty())
+	// Ray queries only need the positions of the most detailed level, which the BVH keeps its own copy of
+	if (this->raycastable && this->raycastBvh == nullptr && !this->vertices.empty())
 	{
-		glGenBuffers(1, &bitangentsBO);
+		if (this->hasIndices)
+		{
+			size_t indexOffset = this->lods.empty() ? 0 : this->lods[0].indexOffset;
+			size_t indexCount = this->lods.empty() ? this->indices.size() : this->lods[0].indexCount;
 
-		glBindBuffer(GL_ARRAY_BUFFER, bitangentsBO);
-		glBufferData(GL_ARRAY_BUFFER, bitangents.size() * sizeof(float), &bitangents[0], GL_STATIC_DRAW);
+			this->raycastBvh = std::make_shared<const MeshBvh>(this->vertices, this->indices, indexOffset, indexCount);
+		}
+		else
+		{
+			std::vector<unsigned int> sequentialIndices(this->vertices.size() / 3);
+			for (size_t i = 0; i < sequentialIndices.size(); i++)
+				sequentialIndices[i] = static_cast<unsigned int>(i);
 
-		glEnableVertexAttribArray(4);
-		glVertexAttribPointer(4, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), nullptr);
+			this->raycastBvh = std::make_shared<const MeshBvh>(this->vertices, sequentialIndices);
+		}
 	}
 
-	this->localBoundingBox = Geometry::getMeshBoundingBox(this->vertices);
-
-	this->verticesCount = this->vertices.size();
-	this->indicesCount = this->indices.size();
-
-	// No need to store the entire buffers in memory once they're on the GPU
-	this->vertices.clear();
-	this->texCoords.clear();
-	this->normals.clear();
-	this->indices.clear();
-	this->tangents.clear();
-	this->bitangents.clear();
+	// The instances draw the same ranges of the index buffer, so the levels of detail and meshlets are shared with the buffers rather than copied
+	this->buffers->lods = std::move(this->lods);
+	this->buffers->meshlets = std::move(this->meshlets);
+	this->lods = std::vector<MeshLod>();
+	this->meshlets = std::vector<Meshlet>();
+
+	// No need to store the entire buffers in memory once they're on the GPU, clearing alone would keep their allocations
+	this->vertexData.bytes = std::vector<unsigned char>();
+	this->vertices = std::vector<float>();
+	this->texCoords = std::vector<float>();
+	this->normals = std::vector<float>();
+	this->indices = std::vector<unsigned int>();
+	this->tangents = std::vector<float>();
+	this->bitangents = std::vector<float>();
 }
 
 void MeshComponent::update(float deltaTime)
@@ -154,17 +203,15 @@ void MeshComponent::update(float deltaTime)
 		// Send the model matrix
 		this->material->shaderProgram
 			->setMat4(MeshComponent::MODEL, this->parent->getTransform()->getModelMatrix())
-			->setMat3(MeshComponent::NORMAL_MATRIX, this->parent->getTransform()->getNormalMatrix());
+			->setMat3(MeshComponent::NORMAL_MATRIX, this->parent->getTransform()->getNormalMatrix())
+			->setVec3(MeshComponent::POSITION_OFFSET, this->dequantization.offset)
+			->setVec3(MeshComponent::POSITION_SCALE, this->dequantization.scale);
 	}
 
-	// Indexed drawing
-	if (this->hasIndices)
-		glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(this->indicesCount), GL_UNSIGNED_INT, nullptr);
-	else // Normal drawing
-		glDrawArrays(GL_TRIANGLES, 0, static_cast<GLsizei>(this->verticesCount));
+	this->draw(true);
 }
 
-void MeshComponent::drawGeometry(Shader* shaderProgram) const
+void MeshComponent::drawGeometry(Shader* shaderProgram, bool visibleMeshletsOnly) const
 {
 	// Make sure the object's VAO is bound
 	glBindVertexArray(VAO);
@@ -173,11 +220,48 @@ void MeshComponent::drawGeometry(Shader* shaderProgram) const
 	// Send the model & normal matrices
 	shaderProgram
 		->setMat4(MeshComponent::MODEL, this->parent->getTransform()->getModelMatrix())
-		->setMat3(MeshComponent::NORMAL_MATRIX, this->parent->getTransform()->getNormalMatrix());
+		->setMat3(MeshComponent::NORMAL_MATRIX, this->parent->getTransform()->getNormalMatrix())
+		->setVec3(MeshComponent::POSITION_OFFSET, this->dequantization.offset)
+		->setVec3(MeshComponent::POSITION_SCALE, this->dequantization.scale);
+
+	this->draw(visibleMeshletsOnly);
+}
+
+void MeshComponent::drawGeometry(Shader* shaderProgram, const glm::mat4& modelMatrix) const
+{
+	glBindVertexArray(VAO);
+
+	shaderProgram
+		->setMat4(MeshComponent::MODEL, modelMatrix)
+		->setVec3(MeshComponent::POSITION_OFFSET, this->dequantization.offset)
+		->setVec3(MeshComponent::POSITION_SCALE, this->dequantization.scale);
+
+	this->draw(false);
+}
+
+void MeshComponent::draw(bool visibleMeshletsOnly) const
+{
+	if (visibleMeshletsOnly && this->meshletsCulled)
+	{
+		if (!this->visibleIndexCounts.empty())
+			glMultiDrawElements(GL_TRIANGLES, this->visibleIndexCounts.data(), GL_UNSIGNED_INT, this->visibleIndexOffsets.data(), static_cast<GLsizei>(this->visibleIndexCounts.size()));
+
+		return;
+	}
 
 	// Indexed drawing
 	if (this->hasIndices)
-		glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(this->indicesCount), GL_UNSIGNED_INT, nullptr);
+	{
+		const std::vector<MeshLod>& lods = this->getLods();
+
+		if (lods.empty())
+			glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(this->indicesCount), GL_UNSIGNED_INT, nullptr);
+		else
+		{
+			const MeshLod& lod = lods[this->currentLod];
+			glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(lod.indexCount), GL_UNSIGNED_INT, reinterpret_cast<const void*>(static_cast<uintptr_t>(lod.indexOffset) * sizeof(unsigned int)));
+		}
+	}
 	else // Normal drawing
 		glDrawArrays(GL_TRIANGLES, 0, static_cast<GLsizei>(this->verticesCount));
 }
@@ -188,6 +272,12 @@ MeshComponent& MeshComponent::addVertices(const std::vector<float> &vertices)
 	return *this;
 }
 
+MeshComponent& MeshComponent::addVertices(std::vector<float>&& vertices)
+{
+	this->vertices = std::move(vertices);
+	return *this;
+}
+
 MeshComponent& MeshComponent::addVertices(float vertices[], unsigned int vertSize)
 {
 	this->vertices.insert(this->vertices.end(), &vertices[0], &vertices[vertSize / sizeof(float)]);
@@ -200,6 +290,12 @@ MeshComponent& MeshComponent::MeshComponent::addTexCoords(const std::vector<floa
 	return *this;
 }
 
+MeshComponent& MeshComponent::addTexCoords(std::vector<float>&& texCoords)
+{
+	this->texCoords = std::move(texCoords);
+	return *this;
+}
+
 MeshComponent& MeshComponent::addTexCoords(float texCoords[], unsigned int texSize)
 {
 	this->texCoords.insert(this->texCoords.end(), &texCoords[0], &texCoords[texSize / sizeof(float)]);
@@ -212,6 +308,12 @@ MeshComponent& MeshComponent::addNormals(const std::vector<float> &normals)
 	return *this;
 }
 
+MeshComponent& MeshComponent::addNormals(std::vector<float>&& normals)
+{
+	this->normals = std::move(normals);
+	return *this;
+}
+
 MeshComponent& MeshComponent::addNormals(float normals[], unsigned int normalSize)
 {
 	this->normals.insert(this->normals.end(), &normals[0], &normals[normalSize / sizeof(float)]);
@@ -224,6 +326,12 @@ MeshComponent& MeshComponent::addIndices(const std::vector<unsigned int> &indice
 	return *this;
 }
 
+MeshComponent& MeshComponent::addIndices(std::vector<unsigned int>&& indices)
+{
+	this->indices = std::move(indices);
+	return *this;
+}
+
 MeshComponent& MeshComponent::addIndices(unsigned int indices[], unsigned int indicesSize)
 {
 	this->indices.insert(this->indices.end(), &indices[0], &indices[indicesSize / sizeof(unsigned int)]);
@@ -236,12 +344,215 @@ MeshComponent& MeshComponent::addTangents(const std::vector<float> &tangents)
 	return *this;
 }
 
+MeshComponent& MeshComponent::addTangents(std::vector<float>&& tangents)
+{
+	this->tangents = std::move(tangents);
+	return *this;
+}
+
 MeshComponent& MeshComponent::addBitangents(const std::vector<float> &bitangents)
 {
 	this->bitangents = bitangents;
 	return *this;
 }
 
+MeshComponent& MeshComponent::addBitangents(std::vector<float>&& bitangents)
+{
+	this->bitangents = std::move(bitangents);
+	return *this;
+}
+
+MeshComponent& MeshComponent::addVertexData(MeshVertexData&& vertexData)
+{
+	this->vertexData = std::move(vertexData);
+	return *this;
+}
+
+MeshComponent& MeshComponent::addLods(const std::vector<MeshLod>& lods)
+{
+	this->lods = lods;
+	return *this;
+}
+
+void MeshComponent::selectLod(const glm::vec3& cameraPosition, float projectionScale)
+{
+	const std::vector<MeshLod>& lods = this->getLods();
+
+	if (lods.size() <= 1)
+		return;
+
+	BoundingBox worldBoundingBox = this->getWorldBoundingBox();
+	glm::vec3 size = worldBoundingBox.maxPosition - worldBoundingBox.minPosition;
+
+	// Lod errors are relative to the size of the mesh, and we measure distance from the closest point of its bounding sphere
+	float extent = std::max(size.x, std::max(size.y, size.z));
+	float distance = std::max(glm::length(cameraPosition - worldBoundingBox.center) - glm::length(size) * 0.5f, CameraComponent::NEAR);
+	float pixelsPerError = extent / distance * projectionScale;
+
+	unsigned int lod = std::min(this->currentLod, static_cast<unsigned int>(lods.size() - 1));
+
+	// Refine while the current level is too coarse, then coarsen while the next level is well under the threshold
+	while (lod > 0 && lods[lod].error * pixelsPerError > MeshComponent::LOD_PIXEL_ERROR)
+		lod--;
+
+	while (lod + 1 < lods.size() && lods[lod + 1].error * pixelsPerError < MeshComponent::LOD_PIXEL_ERROR * MeshComponent::LOD_HYSTERESIS)
+		lod++;
+
+	this->currentLod = lod;
+}
+
+void MeshComponent::requestTextureLevels(const glm::vec3& cameraPosition, float projectionScale)
+{
+	if (this->texCoordDensity <= 0.0f)
+		return;
+
+	BoundingBox worldBoundingBox = this->getWorldBoundingBox();
+	glm::vec3 worldSize = worldBoundingBox.maxPosition - worldBoundingBox.minPosition;
+	glm::vec3 localSize = this->localBoundingBox.maxPosition - this->localBoundingBox.minPosition;
+
+	// The world bounding box of a rotated mesh is larger than its scaled local one, which overestimates the scale and errs on the side of finer levels
+	float scale = glm::length(localSize) > 0.0f ? glm::length(worldSize) / glm::length(localSize) : 1.0f;
+	float distance = std::max(glm::length(cameraPosition - worldBoundingBox.center) - glm::length(worldSize) * 0.5f, CameraComponent::NEAR);
+
+	// The texture coordinates covered by a pixel at the closest point of the mesh
+	float texCoordsPerPixel = this->texCoordDensity * distance / (projectionScale * scale);
+
+	for (const std::shared_ptr<Texture>& texture : this->textures)
+	{
+		if (texture->streamedImage == nullptr)
+			continue;
+
+		// Each level halves the texels, so the level where a texel covers about a pixel is the log of the texels per pixel at full size
+		float texelsPerPixel = texCoordsPerPixel * std::max(texture->width, texture->height);
+		int level = texelsPerPixel > 1.0f ? static_cast<int>(std::floor(std::log2(texelsPerPixel))) : 0;
+
+		texture->requestLevel(level);
+	}
+}
+
+MeshComponent& MeshComponent::addMeshlets(const std::vector<Meshlet>& meshlets)
+{
+	this->meshlets = meshlets;
+	return *this;
+}
+
+MeshComponent& MeshComponent::addMeshlets(std::vector<Meshlet>&& meshlets)
+{
+	this->meshlets = std::move(meshlets);
+	return *this;
+}
+
+void MeshComponent::cullMeshlets(const Frustum& frustum)
+{
+	this->meshletsCulled = false;
+
+	const std::vector<Meshlet>& meshlets = this->getMeshlets();
+	const std::vector<MeshLod>& lods = this->getLods();
+
+	if (meshlets.empty() || !this->hasIndices)
+		return;
+
+	size_t firstMeshlet = 0;
+	size_t meshletCount = meshlets.size();
+
+	if (!lods.empty())
+	{
+		firstMeshlet = lods[this->currentLod].meshletOffset;
+		meshletCount = lods[this->currentLod].meshletCount;
+	}
+
+	if (meshletCount == 0)
+		return;
+
+	std::array<Plane, 6> planes = frustum.getPlanes();
+	this->visibleMeshletCount = Geometry::cullMeshlets(meshlets, firstMeshlet, meshletCount, planes.data(), this->parent->getTransform()->getModelMatrix(), frustum.cameraPosition, this->visibleRanges);
+
+	this->visibleIndexCounts.clear();
+	this->visibleIndexOffsets.clear();
+
+	for (const IndexRange& range : this->visibleRanges)
+	{
+		this->visibleIndexCounts.push_back(static_cast<GLsizei>(range.count));
+		this->visibleIndexOffsets.push_back(reinterpret_cast<const void*>(static_cast<uintptr_t>(range.offset) * sizeof(unsigned int)));
+	}
+
+	this->meshletsCulled = true;
+}
+
+MeshComponent& MeshComponent::setVertexQuantization(bool enabled)
+{
+	this->quantizeVertices = enabled;
+	return *this;
+}
+
+MeshComponent& MeshComponent::setRaycastable(bool enabled)
+{
+	this->raycastable = enabled;
+	return *this;
+}
+
+MeshComponent& MeshComponent::setRaycastBvh(std::shared_ptr<const MeshBvh> bvh)
+{
+	this->raycastBvh = std::move(bvh);
+	this->raycastable = this->raycastBvh != nullptr;
+	return *this;
+}
+
+MeshComponent& MeshComponent::shareGeometry(const MeshComponent* source)
+{
+	this->geometrySource = source;
+	return *this;
+}
+
+void MeshComponent::adoptGeometry(const MeshComponent& source)
+{
+	if (source.buffers == nullptr)
+	{
+		Logger::logWarning("MeshComponent shares the geometry of a mesh that wasn't started, it won't be drawn", "meshComponent.cpp");
+		return;
+	}
+
+	this->buffers = source.buffers;
+	this->VAO = this->buffers->VAO;
+
+	this->verticesCount = source.verticesCount;
+	this->indicesCount = source.indicesCount;
+	this->hasIndices = source.hasIndices;
+	this->quantizeVertices = source.quantizeVertices;
+	this->dequantization = source.dequantization;
+	this->quantizationError = source.quantizationError;
+	this->currentLod = 0;
+	this->texCoordDensity = source.texCoordDensity;
+	this->localBoundingBox = source.localBoundingBox;
+
+	if (this->raycastable && this->raycastBvh == nullptr)
+		this->raycastBvh = source.raycastBvh;
+}
+
+bool MeshComponent::raycast(const Ray& ray, RayHit& hit) const
+{
+	if (this->raycastBvh == nullptr)
+		return false;
+
+	// The ray is moved to object space without normalizing its direction, so distances along it stay the same in both spaces
+	glm::mat4 inverseModelMatrix = glm::inverse(this->parent->getTransform()->getModelMatrix());
+
+	Ray localRay;
+	localRay.origin = glm::vec3(inverseModelMatrix * glm::vec4(ray.origin, 1.0f));
+	localRay.direction = glm::mat3(inverseModelMatrix) * ray.direction;
+	localRay.maxDistance = std::min(ray.maxDistance, hit.distance);
+
+	RayHit localHit;
+	if (!this->raycastBvh->intersect(localRay, localHit))
+		return false;
+
+	hit = localHit;
+	hit.position = ray.origin + ray.direction * localHit.distance;
+	hit.normal = glm::normalize(this->parent->getTransform()->getNormalMatrix() * localHit.normal);
+
+	return true;
+}
+
 MeshComponent& MeshComponent::addTexture(const std::shared_ptr<Texture>& texture)
 {
 	this->textures.insert(textures.end(), texture);
@@ -270,6 +581,41 @@ unsigned long MeshComponent::getIndicesCount() const
 	return this->indicesCount;
 }
 
+const std::vector<MeshLod>& MeshComponent::getLods() const
+{
+	return this->buffers != nullptr ? this->buffers->lods : this->lods;
+}
+
+const std::vector<Meshlet>& MeshComponent::getMeshlets() const
+{
+	return this->buffers != nullptr ? this->buffers->meshlets : this->meshlets;
+}
+
+unsigned int MeshComponent::getCurrentLod() const
+{
+	return this->currentLod;
+}
+
+size_t MeshComponent::getMeshletCount() const
+{
+	return this->getMeshlets().size();
+}
+
+size_t MeshComponent::getVisibleMeshletCount() const
+{
+	return this->meshletsCulled ? this->visibleMeshletCount : 0;
+}
+
+const std::shared_ptr<const MeshBvh>& MeshComponent::getRaycastBvh() const
+{
+	return this->raycastBvh;
+}
+
+QuantizationError MeshComponent::getQuantizationError() const
+{
+	return this->quantizationError;
+}
+
 BoundingBox MeshComponent::getLocalBoundingBox() const
 {
 	return this->localBoundingBox;
@@ -1,16 +1,22 @@
 #include <glm/glm.hpp>
 #include <glm/ext/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
 
 #include "entity.hpp"
 #include "components/physicsComponent.hpp"
+#include "physics/physicsWorld.hpp"
 
 PhysicsComponent::PhysicsComponent(Entity* parent) : Component(parent)
 {
 
 }
 
-// Placeholder since we might need some custom behavior later on
-PhysicsComponent::~PhysicsComponent() = default;
+PhysicsComponent::~PhysicsComponent()
+{
+	// The world would otherwise keep simulating the body and return this component from raycasts
+	if (this->physicsWorld != nullptr)
+		this->physicsWorld->removeColliders(this);
+}
 
 void PhysicsComponent::start()
 {
@@ -22,36 +28,30 @@ void PhysicsComponent::update(float deltaTime)
 	if (this->collider == nullptr || this->collider->rigidBody == nullptr)
 		return;
 
-	// Extract basis (rotation) and origin (translation) from btTransform
-	btTransform trans;
-	this->collider->rigidBody->getMotionState()->getWorldTransform(trans);
-	btMatrix3x3& basis = trans.getBasis();
-	btVector3& origin = trans.getOrigin();
-
-	glm::mat4 glmMat = this->parent->getTransform()->getModelMatrix();
-
-	// Set rotation part
-	glmMat[0][0] = basis[0][0];
-	glmMat[1][0] = basis[0][1];
-	glmMat[2][0] = basis[0][2];
-	glmMat[0][1] = basis[1][0];
-	glmMat[1][1] = basis[1][1];
-	glmMat[2][1] = basis[1][2];
-	glmMat[0][2] = basis[2][0];
-	glmMat[1][2] = basis[2][1];
-	glmMat[2][2] = basis[2][2];
-
-	// Set translation part
-	glmMat[3][0] = origin.getX();
-	glmMat[3][1] = origin.getY();
-	glmMat[3][2] = origin.getZ();
-
-	glmMat = glm::scale(glmMat, this->parent->getTransform()->getScale());
-
-	this->parent->getTransform()->setModelMatrix(glmMat);
+	// The motion state holds the transform of the mesh, which is offset from the one of the body when it was moved to its center of mass
+	btScalar bodyMatrix[16];
+	this->collider->motionState->m_graphicsWorldTrans.getOpenGLMatrix(bodyMatrix);
+
+	// The scale of mesh colliders is carried by their shape, the one of the entity applies on top of it
+	const btVector3& shapeScale = this->collider->rigidBody->getCollisionShape()->getLocalScaling();
+
+	glm::mat4 modelMatrix(glm::make_mat4(bodyMatrix));
+	modelMatrix = glm::scale(modelMatrix, this->parent->getTransform()->getScale() * glm::vec3(shapeScale.x(), shapeScale.y(), shapeScale.z()));
+
+	// The body is placed in the world while the model matrix of the entity is relative to its parent
+	if (this->parent->getParent() != nullptr)
+		modelMatrix = glm::inverse(this->parent->getParent()->getTransform()->getModelMatrix()) * modelMatrix;
+
+	this->parent->getTransform()->setModelMatrix(modelMatrix);
 }
 
-void PhysicsComponent::setCollider(Collider* collider)
+void PhysicsComponent::setCollider(Collider* collider, PhysicsWorld* physicsWorld)
 {
 	this->collider = collider;
-}
\ No newline at end of file
+	this->physicsWorld = physicsWorld;
+}
+
+const Collider* PhysicsComponent::getCollider() const
+{
+	return this->collider;
+}
@@ -4,6 +4,9 @@
 #include "utilities/geometry.hpp"
 #include "components/IBLData.hpp"
 #include "materials/pbrMaterial.hpp"
+#include "utilities/hash.hpp"
+#include "utilities/mappedFile.hpp"
+#include "logger.hpp"
 
 SkyboxComponent::SkyboxComponent(Entity* parent) : Component(parent), MeshComponent(parent)
 {
@@ -16,17 +19,22 @@ SkyboxComponent::~SkyboxComponent()
 	PBRMaterial::prefilterMap = nullptr;
 	PBRMaterial::brdfLut = nullptr;
 
-	for (auto& [type, iblData] : this->skyboxes)
-		iblData.reset();
+	this->skyboxes.clear();
 }
 
 void SkyboxComponent::start()
 {
-	std::vector<float> boxVertices = Geometry::getClockwiseCubeVertices();
+	const std::vector<float>& boxVertices = Geometry::getClockwiseCubeVertices();
 
 	this->setMaterial(std::make_unique<PBRMaterial>(this->shaderProgram))
 		.addVertices(boxVertices);
 	MeshComponent::start();
+
+	this->isStarted = true;
+
+	// The IBL data of the sky is only needed once the skybox is in a scene
+	if (this->useIBL)
+		this->changeSkybox(this->currentSkyType);
 }
 
 void SkyboxComponent::update(float deltaTime)
@@ -55,26 +63,82 @@ void SkyboxComponent::update(float deltaTime)
 void SkyboxComponent::setupSkybox(Shader* shaderProgram, Renderer& renderer)
 {
 	this->shaderProgram = shaderProgram;
-
-	std::unique_ptr<IBLData> grass = std::make_unique<IBLData>(renderer, std::move(std::make_unique<Cubemap>("img/skybox/grass/")));
-	std::unique_ptr<IBLData> night = std::make_unique<IBLData>(renderer, std::move(std::make_unique<Cubemap>("img/skybox/night/")));
-	std::unique_ptr<IBLData> sky = std::make_unique<IBLData>(renderer, std::move(std::make_unique<Cubemap>("img/skybox/sky/")));
-
-	this->skyboxes[SkyboxType::GRASS] = std::move(grass);
-	this->skyboxes[SkyboxType::NIGHT] = std::move(night);
-	this->skyboxes[SkyboxType::SKY] = std::move(sky);
+	this->renderer = &renderer;
 
 	this->changeSkybox(SkyboxComponent::DEFAULT_SKY);
 }
 
 void SkyboxComponent::changeSkybox(SkyboxType sky)
 {
-	this->currentSky = this->skyboxes[sky].get();
+	this->currentSkyType = sky;
 	this->useIBL = true;
 
-	PBRMaterial::irradianceMap = this->currentSky->irradianceMap.get();
-	PBRMaterial::prefilterMap = this->currentSky->prefilterMap.get();
-	PBRMaterial::brdfLut = this->currentSky->brdfLut.get();
+	if (!this->isStarted)
+		return;
+
+	this->currentSky = this->getSky(sky);
+
+	PBRMaterial::irradianceMap = this->currentSky->irradianceMap;
+	PBRMaterial::prefilterMap = this->currentSky->prefilterMap;
+	PBRMaterial::brdfLut = this->currentSky->brdfLut;
+}
+
+IBLData* SkyboxComponent::getSky(SkyboxType sky)
+{
+	auto loadedSky = this->skyboxes.find(sky);
+
+	if (loadedSky != this->skyboxes.end())
+		return loadedSky->second.get();
+
+	std::string facesPath = SkyboxComponent::getSkyPath(sky);
+	std::vector<std::string> faces = Cubemap::getFacePaths(facesPath);
+
+	// The sky is keyed by the content of its faces, so editing an image convolves it again
+	uint64_t key = Hash::hashBytes(&IBLData::VERSION, sizeof(IBLData::VERSION));
+
+	for (const std::string& face : faces)
+	{
+		MappedFile file(face);
+
+		if (file.isOpen())
+			key = Hash::hashBytes(file.getData(), file.getSize(), key);
+		else
+			key = Hash::hashBytes(face.data(), face.size(), key);
+	}
+
+	std::string cachePath = CacheFile::getPath(SkyboxComponent::IBL_CACHE_DIRECTORY, key, ".vgli");
+
+	this->skyboxes[sky] = ResourceManager::getInstance().load<IBLData>(ResourceType::CUBEMAP, key, [&]()
+	{
+		if (std::shared_ptr<IBLData> cachedSky = IBLData::load(cachePath, key))
+		{
+			Logger::logInfo("Loaded the IBL data of " + facesPath + " from the cache", "skyboxComponent.cpp");
+			return cachedSky;
+		}
+
+		auto iblData = std::make_shared<IBLData>(*this->renderer, std::make_unique<Cubemap>(faces));
+		iblData->save(cachePath, key);
+
+		return iblData;
+	});
+
+	return this->skyboxes[sky].get();
+}
+
+std::string SkyboxComponent::getSkyPath(SkyboxType sky)
+{
+	switch (sky)
+	{
+		case SkyboxType::GRASS:
+			return "img/skybox/grass/";
+
+		case SkyboxType::NIGHT:
+			return "img/skybox/night/";
+
+		case SkyboxType::SKY:
+		default:
+			return "img/skybox/sky/";
+	}
 }
 
 void SkyboxComponent::setCubemap(Cubemap* cubemap)
@@ -13,12 +13,7 @@ Cubemap::Cubemap()
 
 Cubemap::Cubemap(const std::string& facesPath)
 {
-	faces.push_back(facesPath + "right.png");
-	faces.push_back(facesPath + "left.png");
-	faces.push_back(facesPath + "top.png");
-	faces.push_back(facesPath + "bottom.png");
-	faces.push_back(facesPath + "front.png");
-	faces.push_back(facesPath + "back.png");
+	this->faces = Cubemap::getFacePaths(facesPath);
 	this->createCubemapFromFaces();
 }
 
@@ -52,6 +47,17 @@ Cubemap::Cubemap(GLenum format, int width, int height, bool mipMapFiltering)
 	else
 		glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
 	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+	size_t bytesPerPixel = 4;
+	if (format == GL_RGB16F)
+		bytesPerPixel = 6;
+	else if (format == GL_RGBA16F)
+		bytesPerPixel = 8;
+
+	// The mip levels add a third to the size of the faces
+	this->byteSize = static_cast<size_t>(width) * height * bytesPerPixel * 6;
+	if (mipMapFiltering)
+		this->byteSize = this->byteSize * 4 / 3;
 }
 
 Cubemap::~Cubemap()
@@ -84,6 +90,7 @@ void Cubemap::createCubemapFromFaces()
 				format = GL_RGBA;
 
 			glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
+			this->byteSize += static_cast<size_t>(width) * height * nrChannels;
 		}
 		else
 		{
@@ -100,7 +107,24 @@ void Cubemap::createCubemapFromFaces()
 	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
 }
 
+std::vector<std::string> Cubemap::getFacePaths(const std::string& facesPath)
+{
+	return {
+		facesPath + "right.png",
+		facesPath + "left.png",
+		facesPath + "top.png",
+		facesPath + "bottom.png",
+		facesPath + "front.png",
+		facesPath + "back.png",
+	};
+}
+
 void Cubemap::generateMipMaps()
 {
 	glGenerateMipmap(GL_TEXTURE_CUBE_MAP);
+}
+
+size_t Cubemap::getByteSize() const
+{
+	return this->byteSize;
 }
\ No newline at end of file
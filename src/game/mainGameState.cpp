@@ -18,6 +18,7 @@
 #include "components/lights/pointLightComponent.hpp"
 #include "components/lights/directionalLightComponent.hpp"
 #include "utilities/geometry.hpp"
+#include "utilities/primitiveLibrary.hpp"
 #include "materials/pbrMaterial.hpp"
 #include "main.hpp"
 #include "logger.hpp"
@@ -29,17 +30,16 @@ void MainGameState::init()
 
 	LightManager::getInstance().shaderProgram = pbrShader;
 
-	VertexData sphere = Geometry::getSphereVertices(100, 30);
-	VertexDataIndices sphereOptimized = Geometry::optimizeVertices(sphere.vertices, sphere.normals);
+	std::shared_ptr<const VertexDataIndices> sphere = PrimitiveLibrary::getInstance().getSphere(100, 30);
 
 	// Create the camera and set it up
 	std::unique_ptr<Entity> cameraEntity = std::make_unique<Entity>("Camera");
 	auto* cameraMesh = cameraEntity->addComponent<MeshComponent>();
 	
 	cameraMesh->setMaterial(std::make_unique<PBRMaterial>(Main::game.renderer.shaderManager.getShader(ShaderType::PBR)))
-		.addVertices(sphereOptimized.vertices)
-		.addIndices(sphereOptimized.indices)
-		.addNormals(sphereOptimized.normals)
+		.addVertices(sphere->vertices)
+		.addIndices(sphere->indices)
+		.addNormals(sphere->normals)
 		.setDiffuseColor(glm::vec3(1.0f, 0.0f, 0.0f));
 	this->scene.currentCamera = cameraEntity->addComponent<CameraComponent>();
 	this->scene.addEntity(std::move(cameraEntity));
@@ -63,9 +63,14 @@ void MainGameState::init()
 	std::unique_ptr<Entity> cubeEntity = std::make_unique<Entity>("Cube");
 
 	auto* cubeMesh = cubeEntity->addComponent<MeshComponent>();
-	std::vector<float> cubeVertices = Geometry::getCubeVertices();
+	std::shared_ptr<const VertexDataIndices> cube = PrimitiveLibrary::getInstance().getCube();
+	std::shared_ptr<const MeshBvh> cubeBvh = PrimitiveLibrary::getInstance().getBvh(cube);
 	cubeMesh->setMaterial(std::make_unique<PBRMaterial>(pbrShader))
-		.addVertices(cubeVertices);
+		.addVertices(cube->vertices)
+		.addIndices(cube->indices)
+		.addNormals(cube->normals)
+		.addTexCoords(cube->texCoords)
+		.setRaycastBvh(cubeBvh);
 
 	auto* cubeCollider = cubeEntity->addComponent<PhysicsComponent>();
 	this->physicsWorld.addBox(cubeCollider, glm::vec3(1.0f), glm::vec3(0.0f));
@@ -76,7 +81,11 @@ void MainGameState::init()
 
 	cubeMesh = cubeEntity->addComponent<MeshComponent>();
 	cubeMesh->setMaterial(std::make_unique<PBRMaterial>(pbrShader))
-		.addVertices(cubeVertices);
+		.addVertices(cube->vertices)
+		.addIndices(cube->indices)
+		.addNormals(cube->normals)
+		.addTexCoords(cube->texCoords)
+		.setRaycastBvh(cubeBvh);
 
 	cubeCollider = cubeEntity->addComponent<PhysicsComponent>();
 	this->physicsWorld.addBox(cubeCollider, glm::vec3(1.0f), glm::vec3(0.0f));
@@ -84,6 +93,8 @@ void MainGameState::init()
 	this->scene.addEntity(std::move(cubeEntity));
 
 	// Sphere grid
+	std::shared_ptr<const MeshBvh> sphereBvh = PrimitiveLibrary::getInstance().getBvh(sphere);
+
 	for (int x = 0; x < 5; x++)
 	{
 		for (int y = 0; y < 5; y++)
@@ -94,9 +105,10 @@ void MainGameState::init()
 
 				auto* sphereMesh = sphereEntity->addComponent<MeshComponent>();
 				sphereMesh->setMaterial(std::make_unique<PBRMaterial>(pbrShader))
-					.addVertices(sphereOptimized.vertices)
-					.addIndices(sphereOptimized.indices)
-					.addNormals(sphereOptimized.normals);
+					.addVertices(sphere->vertices)
+					.addIndices(sphere->indices)
+					.addNormals(sphere->normals)
+					.setRaycastBvh(sphereBvh);
 
 				sphereMesh->setDiffuseColor(glm::vec3(static_cast<float>(x) / 13.0f, static_cast<float>(y) / 13.0f, 1.0f));
 				sphereEntity->getTransform()->setPosition(x * 3, y * 3, z * 3);
@@ -148,7 +160,7 @@ void MainGameState::init()
 	}
 
 	// Plane
-	std::vector<float> quadVertices = Geometry::getQuadVertices();
+	const std::vector<float>& quadVertices = Geometry::getQuadVertices();
 	std::unique_ptr<Entity> planeEntity = std::make_unique<Entity>("Plane");
 
 	auto* planeMesh = planeEntity->addComponent<MeshComponent>();
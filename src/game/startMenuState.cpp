@@ -7,6 +7,7 @@
 #include "game/mainGameState.hpp"
 #include "io/input.hpp"
 #include "utilities/geometry.hpp"
+#include "utilities/primitiveLibrary.hpp"
 #include "main.hpp"
 #include "components/skyboxComponent.hpp"
 #include "components/lights/directionalLightComponent.hpp"
@@ -21,17 +22,16 @@ void StartMenuState::init()
 
 	LightManager::getInstance().shaderProgram = pbrShader;
 
-	VertexData sphere = Geometry::getSphereVertices(100, 30);
-	VertexDataIndices sphereOptimized = Geometry::optimizeVertices(sphere.vertices, sphere.normals);
+	std::shared_ptr<const VertexDataIndices> sphere = PrimitiveLibrary::getInstance().getSphere(100, 30);
 
 	// Create the camera and set it up
 	std::unique_ptr<Entity> cameraEntity = std::make_unique<Entity>("Camera");
 	auto* cameraMesh = cameraEntity->addComponent<MeshComponent>();
 
 	cameraMesh->setMaterial(std::make_unique<PBRMaterial>(Main::game.renderer.shaderManager.getShader(ShaderType::PBR)))
-		.addVertices(sphereOptimized.vertices)
-		.addIndices(sphereOptimized.indices)
-		.addNormals(sphereOptimized.normals)
+		.addVertices(sphere->vertices)
+		.addIndices(sphere->indices)
+		.addNormals(sphere->normals)
 		.setDiffuseColor(glm::vec3(1.0f, 0.0f, 0.0f));
 	this->scene.currentCamera = cameraEntity->addComponent<CameraComponent>();
 	this->scene.addEntity(std::move(cameraEntity));
@@ -57,9 +57,9 @@ void StartMenuState::init()
 
 		auto* sphereMesh = sphereEntity->addComponent<MeshComponent>();
 		sphereMesh->setMaterial(std::make_unique<PBRMaterial>(pbrShader))
-			.addVertices(sphereOptimized.vertices)
-			.addIndices(sphereOptimized.indices)
-			.addNormals(sphereOptimized.normals);
+			.addVertices(sphere->vertices)
+			.addIndices(sphere->indices)
+			.addNormals(sphere->normals);
 
 		auto* sphereCollider = sphereEntity->addComponent<PhysicsComponent>();
 		this->physicsWorld.addSphere(sphereCollider, 1.0f, glm::vec3(0.0f, 25.0f, 0.0f));
@@ -75,7 +75,7 @@ void StartMenuState::init()
 	//this->scene.addEntity(std::move(skyEntity));
 
 	// Plane
-	std::vector<float> quadVertices = Geometry::getQuadVertices();
+	const std::vector<float>& quadVertices = Geometry::getQuadVertices();
 	std::unique_ptr<Entity> planeEntity = std::make_unique<Entity>("Plane");
 
 	auto* planeMesh = planeEntity->addComponent<MeshComponent>();
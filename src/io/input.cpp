@@ -4,6 +4,7 @@
 #include "io/interface.hpp"
 #include "io/input.hpp"
 #include "utilities/resourceLoader.hpp"
+#include "utilities/textureCompression.hpp"
 #include "logger.hpp"
 #include "game/gameEngine.hpp"
 #include "game/gameState.hpp"
@@ -244,12 +245,13 @@ namespace Input
 
 			Logger::logInfo("Drag & drop callback path: " + newPath, "input.cpp");
 
-			std::unique_ptr<Entity> newEntity = ResourceLoader::getInstance().loadModelFromFilepath(newPath, LightManager::getInstance().shaderProgram);
-			if (newEntity != nullptr)
-			{
-				newEntity->start();
-				Main::game.getCurrentState()->getScene().addEntity(std::move(newEntity));
-			}
+			// The model is added to the scene by the upload queue once it is loaded, without stalling the frame loop meanwhile
+			ResourceLoader::getInstance().loadModelAsync(
+				newPath,
+				LightManager::getInstance().shaderProgram,
+				&Main::game.getCurrentState()->getScene(),
+				&Main::game.getCurrentState()->getPhysicsWorld()
+			);
 		}
 	}
 
@@ -289,6 +291,8 @@ namespace Input
 			return -1;
 		}
 
+		TextureCompression::detectSupport();
+
 		return 0;
 	}
 
@@ -278,18 +278,30 @@ namespace Interface
 				glm::vec3 rayEndPosWorld = cameraViewInv * rayEndPosView;
 
 				//defaultRenderer.addLine(rayStartPosWorld, rayEndPosWorld, true);
-				PhysicsComponent* raycastResult = Main::game.getCurrentState()->getPhysicsWorld().raycastLine(rayStartPosWorld, rayEndPosWorld);
+				Ray pickRay;
+				pickRay.origin = rayStartPosWorld;
+				pickRay.direction = rayEndPosWorld - rayStartPosWorld;
+				pickRay.maxDistance = 1.0f;
 
-				if (Main::game.getCurrentState()->getScene().currentActiveEntity != nullptr)
-					Main::game.getCurrentState()->getScene().currentActiveEntity->drawOutline = false;
+				// Raycastable meshes are picked on their triangles, the others through their physics body if they have one
+				RayHit pickHit;
+				Entity* pickedEntity = Main::game.getCurrentState()->getScene().raycast(pickRay, pickHit);
 
-				if (raycastResult != nullptr)
+				if (pickedEntity == nullptr)
 				{
-					Main::game.getCurrentState()->getScene().currentActiveEntity = raycastResult->parent;
-					Main::game.getCurrentState()->getScene().currentActiveEntity->drawOutline = true;
+					PhysicsComponent* raycastResult = Main::game.getCurrentState()->getPhysicsWorld().raycastLine(rayStartPosWorld, rayEndPosWorld);
+
+					if (raycastResult != nullptr)
+						pickedEntity = raycastResult->parent;
 				}
-				else
-					Main::game.getCurrentState()->getScene().currentActiveEntity = nullptr;
+
+				if (Main::game.getCurrentState()->getScene().currentActiveEntity != nullptr)
+					Main::game.getCurrentState()->getScene().currentActiveEntity->drawOutline = false;
+
+				Main::game.getCurrentState()->getScene().currentActiveEntity = pickedEntity;
+
+				if (pickedEntity != nullptr)
+					pickedEntity->drawOutline = true;
 			}
 		}
 
@@ -489,13 +501,13 @@ namespace Interface
 		Shader* pbr = Main::game.renderer.shaderManager.getShader(ShaderType::PBR);
 
 		if (ImGui::DragFloat("Roughness", &shaderSettingsParams.roughness, 0.01f, 0.0f, 1.0f))
-			pbr->use()->setFloat("material.roughness", shaderSettingsParams.roughness);
+			pbr->use()->setFloat(PBRMaterial::ROUGHNESS, shaderSettingsParams.roughness);
 
 		if (ImGui::DragFloat("Metallic", &shaderSettingsParams.metallic, 0.01f, 0.0f, 1.0f))
-			pbr->use()->setFloat("material.metallic", shaderSettingsParams.metallic);
+			pbr->use()->setFloat(PBRMaterial::METALLIC, shaderSettingsParams.metallic);
 
 		if (ImGui::DragFloat("AO", &shaderSettingsParams.ao, 0.01f, 0.0f, 1.0f))
-			pbr->use()->setFloat("material.ao", shaderSettingsParams.ao);
+			pbr->use()->setFloat(PBRMaterial::AO, shaderSettingsParams.ao);
 
 		for (auto& [type, shader] : Main::game.renderer.shaderManager.enumToShader)
 		{
@@ -966,6 +978,21 @@ namespace Interface
 				ImGui::Text("%s", verticesText.c_str());
 				ImGui::Text("%s", indicesText.c_str());
 
+				if (!meshComponent->getLods().empty())
+				{
+					const MeshLod& lod = meshComponent->getLods()[meshComponent->getCurrentLod()];
+					std::string lodText = "LOD: " + std::to_string(meshComponent->getCurrentLod()) + " / " + std::to_string(meshComponent->getLods().size() - 1)
+						+ " (" + std::to_string(lod.indexCount / 3) + " triangles)";
+
+					ImGui::Text("%s", lodText.c_str());
+				}
+
+				if (meshComponent->getMeshletCount() > 0)
+				{
+					std::string meshletsText = "Visible meshlets: " + std::to_string(meshComponent->getVisibleMeshletCount()) + " / " + std::to_string(meshComponent->getMeshletCount());
+					ImGui::Text("%s", meshletsText.c_str());
+				}
+
 				if (ImGui::CollapsingHeader("Bounding box"))
 				{
 					BoundingBox meshBoundingBox = meshComponent->getWorldBoundingBox();
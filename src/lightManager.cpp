@@ -29,9 +29,9 @@ void LightManager::sendToShader() const
 {
 	this->shaderProgram->use();
 
-	this->shaderProgram->setInt("nrDirLights", this->nrDirLights);
-	this->shaderProgram->setInt("nrPointLights", this->nrPointLights);
-	this->shaderProgram->setInt("nrSpotLights", this->nrSpotLights);
+	this->shaderProgram->setInt(LightManager::NR_DIR_LIGHTS, this->nrDirLights);
+	this->shaderProgram->setInt(LightManager::NR_POINT_LIGHTS, this->nrPointLights);
+	this->shaderProgram->setInt(LightManager::NR_SPOT_LIGHTS, this->nrSpotLights);
 }
 
 unsigned int LightManager::addDirLight()
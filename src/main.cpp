@@ -10,6 +10,9 @@
 #include "logger.hpp"
 #include "game/gameEngine.hpp"
 #include "game/startMenuState.hpp"
+#include "utilities/uploadQueue.hpp"
+#include "utilities/textureStreamer.hpp"
+#include "utilities/resourceManager.hpp"
 #include "main.hpp"
 
 using namespace Main;
@@ -58,6 +61,16 @@ int main()
 
 		game.handleEvents(deltaTime);
 		game.update(deltaTime);
+
+		// Uploads the resources of the models loaded in the background, within the budget of a frame
+		UploadQueue::getInstance().process();
+
+		// Uploads the mip levels requested while the scene was sorted and evicts the least recently used ones
+		TextureStreamer::getInstance().update();
+
+		// Evicts the cached resources nothing uses anymore when over the memory budget
+		ResourceManager::getInstance().collect();
+
 		game.draw(deltaTime);
 
 		// Draws the ImGui interface windows
@@ -74,6 +87,9 @@ int main()
 
 	game.cleanup();
 
+	// The cached resources must be freed while the OpenGL context still exists
+	ResourceManager::getInstance().clear();
+
 	glfwTerminate();
 	return 0;
 }
@@ -3,37 +3,9 @@
 #include "logger.hpp"
 #include "textureView.hpp"
 
-const std::string PBRMaterial::USED_MAPS = "material.used_maps";
-
-const std::string PBRMaterial::TEXTURE_ALBEDO = "material.texture_albedo";
-const std::string PBRMaterial::TEXTURE_NORMAL = "material.texture_normal";
-const std::string PBRMaterial::TEXTURE_METALLIC = "material.texture_metallic";
-const std::string PBRMaterial::TEXTURE_ROUGHNESS = "material.texture_roughness";
-const std::string PBRMaterial::TEXTURE_AO = "material.texture_ao";
-const std::string PBRMaterial::TEXTURE_OPACITY = "material.texture_opacity";
-const std::string PBRMaterial::TEXTURE_EMISSIVE = "material.texture_emissive";
-
-const std::string PBRMaterial::ALBEDO = "material.albedo";
-const std::string PBRMaterial::METALLIC = "material.metallic";
-const std::string PBRMaterial::ROUGHNESS = "material.roughness";
-const std::string PBRMaterial::AO = "material.ao";
-const std::string PBRMaterial::OPACITY = "material.opacity";
-
-const std::string PBRMaterial::IRRADIANCE_MAP = "irradianceMap";
-const std::string PBRMaterial::PREFILTER_MAP = "prefilterMap";
-const std::string PBRMaterial::BRDF_LUT = "brdfLUT";
-
-const std::string PBRMaterial::SHADOW_MAP = "shadowMap";
-const std::string PBRMaterial::LIGHT_SPACE_MATRICES[4] = { "lightSpaceMatrices[0]", "lightSpaceMatrices[1]", "lightSpaceMatrices[2]", "lightSpaceMatrices[3]"};
-const std::string PBRMaterial::CASCADE_PLANE_DISTANCES[3] = { "cascadePlaneDistances[0]", "cascadePlaneDistances[1]", "cascadePlaneDistances[2]" };
-const std::string PBRMaterial::CASCADE_COUNT = "cascadeCount";
-const std::string PBRMaterial::FAR_PLANE = "farPlane";
-
-const std::string PBRMaterial::SSAO_MAP = "ssaoMap";
-
-Cubemap* PBRMaterial::irradianceMap = nullptr;
-Cubemap* PBRMaterial::prefilterMap = nullptr;
-Texture* PBRMaterial::brdfLut = nullptr;
+std::shared_ptr<Cubemap> PBRMaterial::irradianceMap = nullptr;
+std::shared_ptr<Cubemap> PBRMaterial::prefilterMap = nullptr;
+std::shared_ptr<Texture> PBRMaterial::brdfLut = nullptr;
 std::shared_ptr<TextureView> PBRMaterial::shadowMap = nullptr;
 std::unique_ptr<TextureView> PBRMaterial::ssaoMap = nullptr;
 glm::mat4 PBRMaterial::lightSpaceMatrices[4]{};
@@ -146,11 +118,8 @@ void PBRMaterial::sendToShader()
 		glActiveTexture(GL_TEXTURE10);
 		PBRMaterial::shadowMap->bindTexture();
 
-		for (int i = 0; i < 4; i++)
-			this->shaderProgram->setMat4(PBRMaterial::LIGHT_SPACE_MATRICES[i], PBRMaterial::lightSpaceMatrices[i]);
-
-		for (int i = 0; i < 3; i++)
-			this->shaderProgram->setFloat(PBRMaterial::CASCADE_PLANE_DISTANCES[i], PBRMaterial::cascadePlaneDistances[i]);
+		this->shaderProgram->setMat4Array(PBRMaterial::LIGHT_SPACE_MATRICES, PBRMaterial::lightSpaceMatrices, 4);
+		this->shaderProgram->setFloatArray(PBRMaterial::CASCADE_PLANE_DISTANCES, PBRMaterial::cascadePlaneDistances, 3);
 
 		this->shaderProgram->setInt(PBRMaterial::CASCADE_COUNT, Renderer::SHADOW_CASCADE_LEVELS);
 		this->shaderProgram->setFloat(PBRMaterial::FAR_PLANE, PBRMaterial::farPlane);
@@ -1,23 +1,6 @@
 #include "materials/phongMaterial.hpp"
 #include "logger.hpp"
 
-const std::string PhongMaterial::AMBIENT_COLOR = "material.ambient";
-const std::string PhongMaterial::DIFFUSE_COLOR = "material.diffuse";
-const std::string PhongMaterial::SPECULAR_COLOR = "material.specular";
-const std::string PhongMaterial::SHININESS = "material.shininess";
-
-const std::string PhongMaterial::USE_DIFFUSE_MAP = "material.use_diffuse_map";
-const std::string PhongMaterial::USE_SPECULAR_MAP = "material.use_specular_map";
-const std::string PhongMaterial::USE_NORMAL_MAP = "material.use_normal_map";
-const std::string PhongMaterial::USE_HEIGHT_MAP = "material.use_height_map";
-const std::string PhongMaterial::USE_EMISSIVE_MAP = "material.use_emissive_map";
-
-const std::string PhongMaterial::TEXTURE_DIFFUSE = "material.texture_diffuse";
-const std::string PhongMaterial::TEXTURE_SPECULAR = "material.texture_specular";
-const std::string PhongMaterial::TEXTURE_NORMAL = "material.texture_normal";
-const std::string PhongMaterial::TEXTURE_HEIGHT = "material.texture_height";
-const std::string PhongMaterial::TEXTURE_EMISSIVE = "material.texture_emissive";
-
 PhongMaterial::PhongMaterial(Shader* shaderProgram) : Material(shaderProgram)
 {
 	this->PhongMaterial::init();
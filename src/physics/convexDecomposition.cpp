@@ -0,0 +1,406 @@
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <unordered_map>
+
+#include <LinearMath/btConvexHullComputer.h>
+
+#include "physics/convexDecomposition.hpp"
+
+namespace
+{
+	/// <summary>
+	/// Returns the i-th of count directions spread evenly on the unit sphere (Fibonacci lattice)
+	/// </summary>
+	glm::vec3 getSphereDirection(unsigned int i, unsigned int count)
+	{
+		constexpr float GOLDEN_ANGLE = 2.39996323f;
+
+		float y = 1.0f - 2.0f * (static_cast<float>(i) + 0.5f) / static_cast<float>(count);
+		float radius = std::sqrt(std::max(0.0f, 1.0f - y * y));
+		float angle = GOLDEN_ANGLE * static_cast<float>(i);
+
+		return glm::vec3(std::cos(angle) * radius, y, std::sin(angle) * radius);
+	}
+
+	glm::vec3 getVertex(const std::vector<float>& vertices, unsigned int index)
+	{
+		return glm::vec3(vertices[index * 3], vertices[index * 3 + 1], vertices[index * 3 + 2]);
+	}
+}
+
+std::vector<glm::vec3> ConvexDecomposition::computeHull(const std::vector<float>& vertices, unsigned int maxVertices)
+{
+	std::vector<glm::vec3> points;
+	points.reserve(vertices.size() / 3);
+
+	for (size_t i = 0; i + 2 < vertices.size(); i += 3)
+		points.emplace_back(vertices[i], vertices[i + 1], vertices[i + 2]);
+
+	HullData hull = ConvexDecomposition::computeHullData(points);
+
+	return ConvexDecomposition::reduceHull(hull.vertices.empty() ? points : hull.vertices, maxVertices);
+}
+
+std::vector<std::vector<glm::vec3>> ConvexDecomposition::decompose(const std::vector<float>& vertices, const std::vector<unsigned int>& indices, const ConvexDecompositionSettings& settings)
+{
+	std::vector<std::vector<glm::vec3>> hulls;
+
+	const auto triangleCount = static_cast<unsigned int>(indices.size() / 3);
+
+	if (triangleCount == 0)
+		return hulls;
+
+	glm::vec3 minPosition(FLT_MAX);
+	glm::vec3 maxPosition(-FLT_MAX);
+
+	for (size_t i = 0; i + 2 < vertices.size(); i += 3)
+	{
+		glm::vec3 position(vertices[i], vertices[i + 1], vertices[i + 2]);
+		minPosition = glm::min(minPosition, position);
+		maxPosition = glm::max(maxPosition, position);
+	}
+
+	// The concavity threshold is relative to the size of the mesh so the same settings work for any scale
+	float maxDepth = settings.maxConcavity * glm::length(maxPosition - minPosition);
+	unsigned int maxHulls = std::max(1u, settings.maxHulls);
+	unsigned int maxHullVertices = std::max(4u, settings.maxHullVertices);
+
+	std::vector<Part> parts(1);
+	parts[0].triangles.resize(triangleCount);
+
+	for (unsigned int i = 0; i < triangleCount; i++)
+		parts[0].triangles[i] = i;
+
+	ConvexDecomposition::evaluatePart(vertices, indices, maxHullVertices, parts[0]);
+
+	// Parts that can't be split any further are kept aside so they aren't picked again
+	std::vector<bool> isFinal(1, false);
+
+	while (parts.size() < maxHulls)
+	{
+		size_t worst = parts.size();
+
+		for (size_t i = 0; i < parts.size(); i++)
+		{
+			if (!isFinal[i] && parts[i].concavity > maxDepth && (worst == parts.size() || parts[i].concavity > parts[worst].concavity))
+				worst = i;
+		}
+
+		if (worst == parts.size())
+			break;
+
+		Part& part = parts[worst];
+
+		if (part.triangles.size() < ConvexDecomposition::MIN_PART_TRIANGLES)
+		{
+			isFinal[worst] = true;
+			continue;
+		}
+
+		std::vector<glm::vec3> centroids(part.triangles.size());
+		glm::vec3 partMin(FLT_MAX);
+		glm::vec3 partMax(-FLT_MAX);
+
+		for (size_t i = 0; i < part.triangles.size(); i++)
+		{
+			unsigned int triangle = part.triangles[i];
+			centroids[i] = (getVertex(vertices, indices[triangle * 3])
+				+ getVertex(vertices, indices[triangle * 3 + 1])
+				+ getVertex(vertices, indices[triangle * 3 + 2])) / 3.0f;
+
+			partMin = glm::min(partMin, centroids[i]);
+			partMax = glm::max(partMax, centroids[i]);
+		}
+
+		// Planes through the deepest point cut right where the part is the most concave, the others are spread over the part
+		float bestCost = FLT_MAX;
+		std::vector<unsigned int> bestLeft;
+		std::vector<unsigned int> bestRight;
+
+		for (int axis = 0; axis < 3; axis++)
+		{
+			if (partMax[axis] - partMin[axis] <= 0.0f)
+				continue;
+
+			for (int candidate = 0; candidate <= ConvexDecomposition::SPLIT_CANDIDATES_PER_AXIS; candidate++)
+			{
+				float splitPosition = candidate == ConvexDecomposition::SPLIT_CANDIDATES_PER_AXIS
+					? part.deepestPoint[axis]
+					: partMin[axis] + (partMax[axis] - partMin[axis]) * static_cast<float>(candidate + 1) / static_cast<float>(ConvexDecomposition::SPLIT_CANDIDATES_PER_AXIS + 1);
+
+				std::vector<unsigned int> left;
+				std::vector<unsigned int> right;
+
+				for (size_t i = 0; i < part.triangles.size(); i++)
+					(centroids[i][axis] < splitPosition ? left : right).push_back(part.triangles[i]);
+
+				if (left.empty() || right.empty())
+					continue;
+
+				float cost = ConvexDecomposition::computeHullData(ConvexDecomposition::getPartPoints(vertices, indices, left)).volume
+					+ ConvexDecomposition::computeHullData(ConvexDecomposition::getPartPoints(vertices, indices, right)).volume;
+
+				if (cost < bestCost)
+				{
+					bestCost = cost;
+					bestLeft = std::move(left);
+					bestRight = std::move(right);
+				}
+			}
+		}
+
+		if (bestLeft.empty())
+		{
+			isFinal[worst] = true;
+			continue;
+		}
+
+		part.triangles = std::move(bestLeft);
+		ConvexDecomposition::evaluatePart(vertices, indices, maxHullVertices, part);
+
+		Part splitPart;
+		splitPart.triangles = std::move(bestRight);
+		ConvexDecomposition::evaluatePart(vertices, indices, maxHullVertices, splitPart);
+
+		parts.push_back(std::move(splitPart));
+		isFinal.push_back(false);
+	}
+
+	hulls.reserve(parts.size());
+
+	for (Part& part : parts)
+	{
+		if (!part.hull.vertices.empty())
+			hulls.push_back(std::move(part.hull.vertices));
+	}
+
+	return hulls;
+}
+
+ConvexDecomposition::HullData ConvexDecomposition::computeHullData(const std::vector<glm::vec3>& points)
+{
+	HullData hull;
+
+	if (points.size() < 4)
+	{
+		hull.vertices = points;
+		return hull;
+	}
+
+	btConvexHullComputer computer;
+	computer.compute(&points[0].x, static_cast<int>(sizeof(glm::vec3)), static_cast<int>(points.size()), 0.0f, 0.0f);
+
+	hull.vertices.reserve(computer.vertices.size());
+
+	for (int i = 0; i < computer.vertices.size(); i++)
+	{
+		const btVector3& vertex = computer.vertices[i];
+		hull.vertices.emplace_back(vertex.x(), vertex.y(), vertex.z());
+	}
+
+	if (hull.vertices.size() < 4 || computer.faces.size() < 4)
+		return hull;
+
+	glm::vec3 center(0.0f);
+
+	for (const glm::vec3& vertex : hull.vertices)
+		center += vertex;
+
+	center /= static_cast<float>(hull.vertices.size());
+
+	hull.planes.reserve(computer.faces.size());
+	std::vector<int> faceVertices;
+
+	for (int i = 0; i < computer.faces.size(); i++)
+	{
+		faceVertices.clear();
+
+		const btConvexHullComputer::Edge* firstEdge = &computer.edges[computer.faces[i]];
+		const btConvexHullComputer::Edge* edge = firstEdge;
+
+		do
+		{
+			faceVertices.push_back(edge->getTargetVertex());
+			edge = edge->getNextEdgeOfFace();
+		} while (edge != firstEdge);
+
+		if (faceVertices.size() < 3)
+			continue;
+
+		// Newell's method gives a stable normal for faces with nearly collinear vertices, it is oriented away from the center
+		glm::vec3 normal(0.0f);
+
+		for (size_t j = 0; j < faceVertices.size(); j++)
+		{
+			const glm::vec3& current = hull.vertices[faceVertices[j]];
+			const glm::vec3& next = hull.vertices[faceVertices[(j + 1) % faceVertices.size()]];
+			normal += glm::vec3(
+				(current.y - next.y) * (current.z + next.z),
+				(current.z - next.z) * (current.x + next.x),
+				(current.x - next.x) * (current.y + next.y)
+			);
+		}
+
+		float length = glm::length(normal);
+
+		if (length <= FLT_EPSILON)
+			continue;
+
+		normal /= length;
+		float distance = glm::dot(normal, hull.vertices[faceVertices[0]]);
+
+		if (glm::dot(normal, center) > distance)
+		{
+			normal = -normal;
+			distance = -distance;
+		}
+
+		hull.planes.emplace_back(normal, distance);
+
+		const glm::vec3& origin = hull.vertices[faceVertices[0]];
+
+		// The faces are fanned into tetrahedra with the center, their centroids weighted by their volumes give the one of the hull
+		for (size_t j = 1; j + 1 < faceVertices.size(); j++)
+		{
+			glm::vec3 a = origin - center;
+			glm::vec3 b = hull.vertices[faceVertices[j]] - center;
+			glm::vec3 c = hull.vertices[faceVertices[j + 1]] - center;
+			float volume = std::abs(glm::dot(a, glm::cross(b, c))) / 6.0f;
+
+			hull.volume += volume;
+			hull.centroid += volume * (a + b + c) * 0.25f;
+		}
+	}
+
+	hull.centroid = hull.volume > 0.0f ? center + hull.centroid / hull.volume : center;
+
+	return hull;
+}
+
+glm::vec3 ConvexDecomposition::computeCenterOfMass(const std::vector<std::vector<glm::vec3>>& hulls)
+{
+	glm::vec3 weightedCentroids(0.0f);
+	glm::vec3 pointSum(0.0f);
+	float volume = 0.0f;
+	size_t pointCount = 0;
+
+	for (const std::vector<glm::vec3>& points : hulls)
+	{
+		HullData hull = ConvexDecomposition::computeHullData(points);
+
+		weightedCentroids += hull.volume * hull.centroid;
+		volume += hull.volume;
+
+		for (const glm::vec3& point : points)
+			pointSum += point;
+
+		pointCount += points.size();
+	}
+
+	if (volume > 0.0f)
+		return weightedCentroids / volume;
+
+	return pointCount > 0 ? pointSum / static_cast<float>(pointCount) : glm::vec3(0.0f);
+}
+
+std::vector<glm::vec3> ConvexDecomposition::getPartPoints(const std::vector<float>& vertices, const std::vector<unsigned int>& indices, const std::vector<unsigned int>& triangles)
+{
+	std::vector<glm::vec3> points;
+	points.reserve(triangles.size());
+
+	std::unordered_map<unsigned int, bool> isAdded;
+	isAdded.reserve(triangles.size() * 2);
+
+	for (unsigned int triangle : triangles)
+	{
+		for (unsigned int corner = 0; corner < 3; corner++)
+		{
+			unsigned int index = indices[triangle * 3 + corner];
+
+			if (isAdded.emplace(index, true).second)
+				points.push_back(getVertex(vertices, index));
+		}
+	}
+
+	return points;
+}
+
+void ConvexDecomposition::evaluatePart(const std::vector<float>& vertices, const std::vector<unsigned int>& indices, unsigned int maxHullVertices, Part& part)
+{
+	std::vector<glm::vec3> points = ConvexDecomposition::getPartPoints(vertices, indices, part.triangles);
+	HullData fullHull = ConvexDecomposition::computeHullData(points);
+
+	// The concavity is measured against the reduced hull that becomes the collider, as that is what objects collide with
+	part.hull = ConvexDecomposition::computeHullData(ConvexDecomposition::reduceHull(fullHull.vertices.empty() ? points : fullHull.vertices, maxHullVertices));
+	part.concavity = 0.0f;
+	part.deepestPoint = glm::vec3(0.0f);
+
+	if (part.hull.planes.empty())
+		return;
+
+	// The corners of a mesh can all lie on its hull even when its faces don't (two separate boxes), so the centers of the faces are measured too
+	for (unsigned int triangle : part.triangles)
+	{
+		glm::vec3 a = getVertex(vertices, indices[triangle * 3]);
+		glm::vec3 b = getVertex(vertices, indices[triangle * 3 + 1]);
+		glm::vec3 c = getVertex(vertices, indices[triangle * 3 + 2]);
+		glm::vec3 samples[4] = { a, b, c, (a + b + c) / 3.0f };
+
+		for (const glm::vec3& point : samples)
+		{
+			float depth = FLT_MAX;
+
+			for (const glm::vec4& plane : part.hull.planes)
+				depth = std::min(depth, plane.w - glm::dot(glm::vec3(plane), point));
+
+			if (depth > part.concavity)
+			{
+				part.concavity = depth;
+				part.deepestPoint = point;
+			}
+		}
+	}
+}
+
+std::vector<glm::vec3> ConvexDecomposition::reduceHull(const std::vector<glm::vec3>& points, unsigned int maxVertices)
+{
+	if (points.size() <= maxVertices)
+		return points;
+
+	std::vector<glm::vec3> result;
+	result.reserve(maxVertices);
+
+	std::vector<bool> isSelected(points.size(), false);
+
+	// Several directions can share the same extreme point, more directions are tried until enough distinct points are found
+	for (unsigned int directionCount = maxVertices; result.size() < maxVertices && directionCount <= maxVertices * 16; directionCount *= 2)
+	{
+		for (unsigned int i = 0; i < directionCount && result.size() < maxVertices; i++)
+		{
+			glm::vec3 direction = getSphereDirection(i, directionCount);
+
+			size_t extreme = 0;
+			float extremeDistance = -FLT_MAX;
+
+			for (size_t j = 0; j < points.size(); j++)
+			{
+				float distance = glm::dot(points[j], direction);
+
+				if (distance > extremeDistance)
+				{
+					extremeDistance = distance;
+					extreme = j;
+				}
+			}
+
+			if (!isSelected[extreme])
+			{
+				isSelected[extreme] = true;
+				result.push_back(points[extreme]);
+			}
+		}
+	}
+
+	return result;
+}
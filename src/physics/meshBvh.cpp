@@ -0,0 +1,662 @@
+#include <algorithm>
+#include <cmath>
+#include <string>
+
+#include "physics/meshBvh.hpp"
+#include "logger.hpp"
+
+namespace
+{
+	/// <summary>
+	/// The bounds of a triangle or a set of triangles while building the BVH
+	/// </summary>
+	struct BuildBounds
+	{
+		glm::vec3 minPosition = glm::vec3(FLT_MAX);
+		glm::vec3 maxPosition = glm::vec3(-FLT_MAX);
+
+		void grow(const glm::vec3& position)
+		{
+			this->minPosition = glm::min(this->minPosition, position);
+			this->maxPosition = glm::max(this->maxPosition, position);
+		}
+
+		void grow(const BuildBounds& bounds)
+		{
+			this->minPosition = glm::min(this->minPosition, bounds.minPosition);
+			this->maxPosition = glm::max(this->maxPosition, bounds.maxPosition);
+		}
+
+		/// <summary>
+		/// Returns half the surface area of the bounds, only the ratios between areas matter for the heuristic
+		/// </summary>
+		[[nodiscard]] float getHalfArea() const
+		{
+			glm::vec3 extent = glm::max(this->maxPosition - this->minPosition, glm::vec3(0.0f));
+			return extent.x * extent.y + extent.y * extent.z + extent.z * extent.x;
+		}
+	};
+
+	struct BuildTask
+	{
+		unsigned int node;
+		unsigned int first;
+		unsigned int count;
+		unsigned int depth;
+	};
+
+	/// <summary>
+	/// The cost of testing a set of triangles, they are tested a block at a time
+	/// </summary>
+	float getBlockCost(unsigned int triangleCount)
+	{
+		return static_cast<float>((triangleCount + TriangleBlock::WIDTH - 1) / TriangleBlock::WIDTH);
+	}
+
+	/// <summary>
+	/// The cost of traversing a node relative to testing a block of triangles
+	/// </summary>
+	constexpr float TRAVERSAL_COST = 1.0f;
+}
+
+MeshBvh::MeshBvh(const std::vector<float>& vertices, const std::vector<unsigned int>& indices)
+{
+	this->build(vertices, indices, 0, indices.size());
+}
+
+MeshBvh::MeshBvh(const std::vector<float>& vertices, const std::vector<unsigned int>& indices, size_t indexOffset, size_t indexCount)
+{
+	if (indexOffset + indexCount > indices.size())
+	{
+		Logger::logError("BVH index range is outside of the index buffer", "meshBvh.cpp");
+		indexCount = indexOffset < indices.size() ? indices.size() - indexOffset : 0;
+	}
+
+	this->build(vertices, indices, indexOffset, indexCount);
+}
+
+void MeshBvh::build(const std::vector<float>& vertices, const std::vector<unsigned int>& indices, size_t indexOffset, size_t indexCount)
+{
+	const auto triangleCount = static_cast<unsigned int>(indexCount / 3);
+	const size_t vertexCount = vertices.size() / 3;
+
+	auto getVertex = [&vertices](unsigned int index) {
+		return glm::vec3(vertices[index * 3], vertices[index * 3 + 1], vertices[index * 3 + 2]);
+	};
+
+	// Triangles referencing missing vertices are skipped
+	std::vector<unsigned int> triangleOrder;
+	triangleOrder.reserve(triangleCount);
+
+	std::vector<BuildBounds> triangleBounds(triangleCount);
+	std::vector<glm::vec3> centroids(triangleCount);
+
+	for (unsigned int i = 0; i < triangleCount; i++)
+	{
+		const unsigned int* triangle = &indices[indexOffset + i * 3];
+
+		if (triangle[0] >= vertexCount || triangle[1] >= vertexCount || triangle[2] >= vertexCount)
+			continue;
+
+		for (int j = 0; j < 3; j++)
+			triangleBounds[i].grow(getVertex(triangle[j]));
+
+		centroids[i] = (triangleBounds[i].minPosition + triangleBounds[i].maxPosition) * 0.5f;
+		triangleOrder.push_back(i);
+	}
+
+	if (triangleOrder.size() != triangleCount)
+		Logger::logWarning("BVH skipped " + std::to_string(triangleCount - triangleOrder.size()) + " triangles with invalid indices", "meshBvh.cpp");
+
+	this->triangleCount = triangleOrder.size();
+	this->nodes.clear();
+	this->blocks.clear();
+
+	// A binary tree with at least one triangle per leaf has at most 2n - 1 nodes
+	this->nodes.reserve(std::max<size_t>(1, this->triangleCount * 2));
+	this->nodes.emplace_back();
+
+	std::vector<BuildTask> tasks;
+	tasks.push_back({ 0, 0, static_cast<unsigned int>(this->triangleCount), 0 });
+
+	// Leaves reference their triangles in triangleOrder while building, and are converted to block ranges afterwards
+	while (!tasks.empty())
+	{
+		BuildTask task = tasks.back();
+		tasks.pop_back();
+
+		BuildBounds bounds;
+		BuildBounds centroidBounds;
+
+		for (unsigned int i = task.first; i < task.first + task.count; i++)
+		{
+			bounds.grow(triangleBounds[triangleOrder[i]]);
+			centroidBounds.grow(centroids[triangleOrder[i]]);
+		}
+
+		BvhNode& node = this->nodes[task.node];
+		node.minPosition = task.count > 0 ? bounds.minPosition : glm::vec3(0.0f);
+		node.maxPosition = task.count > 0 ? bounds.maxPosition : glm::vec3(0.0f);
+		node.leftOrFirst = task.first;
+		node.blockCount = task.count;
+
+		if (task.count <= 1)
+			continue;
+
+		// Find the cheapest split plane among the bin boundaries of every axis
+		float bestCost = FLT_MAX;
+		int bestAxis = -1;
+		unsigned int bestBin = 0;
+
+		glm::vec3 centroidExtent = centroidBounds.maxPosition - centroidBounds.minPosition;
+
+		if (task.depth < MeshBvh::MAX_SAH_DEPTH)
+		{
+			for (int axis = 0; axis < 3; axis++)
+			{
+				if (centroidExtent[axis] <= 0.0f)
+					continue;
+
+				BuildBounds binBounds[MeshBvh::SAH_BIN_COUNT];
+				unsigned int binCounts[MeshBvh::SAH_BIN_COUNT] = {};
+				float binScale = static_cast<float>(MeshBvh::SAH_BIN_COUNT) / centroidExtent[axis];
+
+				for (unsigned int i = task.first; i < task.first + task.count; i++)
+				{
+					unsigned int triangle = triangleOrder[i];
+					auto bin = std::min(MeshBvh::SAH_BIN_COUNT - 1, static_cast<unsigned int>((centroids[triangle][axis] - centroidBounds.minPosition[axis]) * binScale));
+
+					binCounts[bin]++;
+					binBounds[bin].grow(triangleBounds[triangle]);
+				}
+
+				// Sweep from the right to get the cost of everything past each boundary, then from the left
+				float rightAreas[MeshBvh::SAH_BIN_COUNT];
+				unsigned int rightCounts[MeshBvh::SAH_BIN_COUNT];
+				BuildBounds rightBounds;
+				unsigned int rightCount = 0;
+
+				for (unsigned int bin = MeshBvh::SAH_BIN_COUNT - 1; bin > 0; bin--)
+				{
+					rightBounds.grow(binBounds[bin]);
+					rightCount += binCounts[bin];
+					rightAreas[bin] = rightBounds.getHalfArea();
+					rightCounts[bin] = rightCount;
+				}
+
+				BuildBounds leftBounds;
+				unsigned int leftCount = 0;
+
+				for (unsigned int bin = 1; bin < MeshBvh::SAH_BIN_COUNT; bin++)
+				{
+					leftBounds.grow(binBounds[bin - 1]);
+					leftCount += binCounts[bin - 1];
+
+					if (leftCount == 0 || rightCounts[bin] == 0)
+						continue;
+
+					float cost = leftBounds.getHalfArea() * getBlockCost(leftCount) + rightAreas[bin] * getBlockCost(rightCounts[bin]);
+
+					if (cost < bestCost)
+					{
+						bestCost = cost;
+						bestAxis = axis;
+						bestBin = bin;
+					}
+				}
+			}
+		}
+
+		unsigned int leftCount = 0;
+
+		if (bestAxis >= 0)
+		{
+			float parentArea = bounds.getHalfArea();
+			float splitCost = TRAVERSAL_COST * parentArea + bestCost;
+			float leafCost = getBlockCost(task.count) * parentArea;
+
+			if (splitCost >= leafCost && task.count <= MeshBvh::MAX_LEAF_TRIANGLES)
+				continue;
+
+			float binScale = static_cast<float>(MeshBvh::SAH_BIN_COUNT) / centroidExtent[bestAxis];
+			float minCentroid = centroidBounds.minPosition[bestAxis];
+
+			auto middle = std::partition(triangleOrder.begin() + task.first, triangleOrder.begin() + task.first + task.count, [&](unsigned int triangle) {
+				auto bin = std::min(MeshBvh::SAH_BIN_COUNT - 1, static_cast<unsigned int>((centroids[triangle][bestAxis] - minCentroid) * binScale));
+				return bin < bestBin;
+			});
+
+			leftCount = static_cast<unsigned int>(middle - (triangleOrder.begin() + task.first));
+		}
+		else
+		{
+			if (task.count <= MeshBvh::MAX_LEAF_TRIANGLES)
+				continue;
+
+			// Too deep or all the centroids are at the same place, split the triangles in halves along the largest axis
+			int axis = 0;
+			if (centroidExtent.y > centroidExtent[axis]) axis = 1;
+			if (centroidExtent.z > centroidExtent[axis]) axis = 2;
+
+			leftCount = task.count / 2;
+
+			std::nth_element(triangleOrder.begin() + task.first, triangleOrder.begin() + task.first + leftCount, triangleOrder.begin() + task.first + task.count, [&](unsigned int a, unsigned int b) {
+				return centroids[a][axis] < centroids[b][axis];
+			});
+		}
+
+		auto leftChild = static_cast<unsigned int>(this->nodes.size());
+		this->nodes.emplace_back();
+		this->nodes.emplace_back();
+
+		// The reference to the node may have been invalidated by the new children
+		this->nodes[task.node].leftOrFirst = leftChild;
+		this->nodes[task.node].blockCount = 0;
+
+		tasks.push_back({ leftChild + 1, task.first + leftCount, task.count - leftCount, task.depth + 1 });
+		tasks.push_back({ leftChild, task.first, leftCount, task.depth + 1 });
+	}
+
+	// Pack the triangles of each leaf in blocks, in the order of the leaves
+	this->blocks.reserve((this->triangleCount + TriangleBlock::WIDTH - 1) / TriangleBlock::WIDTH + this->nodes.size() / 2);
+
+	for (BvhNode& node : this->nodes)
+	{
+		if (node.blockCount == 0)
+			continue;
+
+		unsigned int firstTriangle = node.leftOrFirst;
+		unsigned int nodeTriangleCount = node.blockCount;
+
+		node.leftOrFirst = static_cast<unsigned int>(this->blocks.size());
+		node.blockCount = (nodeTriangleCount + TriangleBlock::WIDTH - 1) / TriangleBlock::WIDTH;
+
+		for (unsigned int i = 0; i < nodeTriangleCount; i += TriangleBlock::WIDTH)
+		{
+			TriangleBlock block = {};
+
+			for (unsigned int lane = 0; lane < TriangleBlock::WIDTH; lane++)
+			{
+				if (i + lane >= nodeTriangleCount)
+				{
+					block.triangles[lane] = RayHit::NO_HIT;
+					continue;
+				}
+
+				unsigned int triangle = triangleOrder[firstTriangle + i + lane];
+				const unsigned int* triangleIndices = &indices[indexOffset + triangle * 3];
+
+				glm::vec3 v0 = getVertex(triangleIndices[0]);
+				glm::vec3 e1 = getVertex(triangleIndices[1]) - v0;
+				glm::vec3 e2 = getVertex(triangleIndices[2]) - v0;
+
+				block.v0x[lane] = v0.x; block.v0y[lane] = v0.y; block.v0z[lane] = v0.z;
+				block.e1x[lane] = e1.x; block.e1y[lane] = e1.y; block.e1z[lane] = e1.z;
+				block.e2x[lane] = e2.x; block.e2y[lane] = e2.y; block.e2z[lane] = e2.z;
+				block.triangles[lane] = triangle;
+			}
+
+			this->blocks.push_back(block);
+		}
+	}
+}
+
+bool MeshBvh::intersect(const Ray& ray, RayHit& hit) const
+{
+	if (this->blocks.empty())
+		return false;
+
+	glm::vec3 inverseDirection = 1.0f / ray.direction;
+	bool hasHit = false;
+
+	// Nodes are pushed with the distance at which the ray enters them, so the ones behind a closer hit are skipped
+	unsigned int stack[MeshBvh::MAX_DEPTH];
+	float stackDistances[MeshBvh::MAX_DEPTH];
+	unsigned int stackSize = 0;
+
+	float rootDistance = MeshBvh::intersectNode(this->nodes[0], ray.origin, inverseDirection, std::min(ray.maxDistance, hit.distance));
+	if (rootDistance == FLT_MAX)
+		return false;
+
+	stack[stackSize] = 0;
+	stackDistances[stackSize++] = rootDistance;
+
+	while (stackSize > 0)
+	{
+		stackSize--;
+		const BvhNode& node = this->nodes[stack[stackSize]];
+		float maxDistance = std::min(ray.maxDistance, hit.distance);
+
+		if (stackDistances[stackSize] >= maxDistance)
+			continue;
+
+		if (node.blockCount > 0)
+		{
+			for (unsigned int i = node.leftOrFirst; i < node.leftOrFirst + node.blockCount; i++)
+				hasHit |= MeshBvh::intersectBlock(this->blocks[i], ray.origin, ray.direction, maxDistance, hit);
+
+			continue;
+		}
+
+		unsigned int nearChild = node.leftOrFirst;
+		unsigned int farChild = node.leftOrFirst + 1;
+		float nearDistance = MeshBvh::intersectNode(this->nodes[nearChild], ray.origin, inverseDirection, maxDistance);
+		float farDistance = MeshBvh::intersectNode(this->nodes[farChild], ray.origin, inverseDirection, maxDistance);
+
+		if (farDistance < nearDistance)
+		{
+			std::swap(nearChild, farChild);
+			std::swap(nearDistance, farDistance);
+		}
+
+		// The near child is pushed last so it is visited first
+		if (farDistance != FLT_MAX)
+		{
+			stack[stackSize] = farChild;
+			stackDistances[stackSize++] = farDistance;
+		}
+
+		if (nearDistance != FLT_MAX)
+		{
+			stack[stackSize] = nearChild;
+			stackDistances[stackSize++] = nearDistance;
+		}
+	}
+
+	if (hasHit)
+		MeshBvh::finalizeHit(ray, hit);
+
+	return hasHit;
+}
+
+void MeshBvh::intersect(const RayPacket& packet, RayHit hits[RayPacket::SIZE]) const
+{
+	if (this->blocks.empty() || packet.count == 0)
+		return;
+
+	const unsigned int rayCount = std::min(packet.count, RayPacket::SIZE);
+	constexpr unsigned int WIDTH = RayPacket::SIZE;
+
+	// The rays are stored in lanes so a node is tested against the whole packet at once
+	float originX[WIDTH], originY[WIDTH], originZ[WIDTH];
+	float inverseX[WIDTH], inverseY[WIDTH], inverseZ[WIDTH];
+	float maxDistances[WIDTH];
+	bool hasHit[WIDTH] = {};
+
+	for (unsigned int i = 0; i < WIDTH; i++)
+	{
+		const Ray& ray = packet.rays[std::min(i, rayCount - 1)];
+
+		originX[i] = ray.origin.x; originY[i] = ray.origin.y; originZ[i] = ray.origin.z;
+		inverseX[i] = 1.0f / ray.direction.x; inverseY[i] = 1.0f / ray.direction.y; inverseZ[i] = 1.0f / ray.direction.z;
+
+		// Unused lanes never enter any node
+		maxDistances[i] = i < rayCount ? std::min(ray.maxDistance, hits[i].distance) : -1.0f;
+	}
+
+	// Computes the distance at which each ray of the packet enters a node before its current closest hit, and returns the closest one
+	float entries[WIDTH];
+
+	auto intersectPacket = [&](const BvhNode& node) {
+		for (unsigned int i = 0; i < WIDTH; i++)
+		{
+			float tx1 = (node.minPosition.x - originX[i]) * inverseX[i];
+			float tx2 = (node.maxPosition.x - originX[i]) * inverseX[i];
+			float ty1 = (node.minPosition.y - originY[i]) * inverseY[i];
+			float ty2 = (node.maxPosition.y - originY[i]) * inverseY[i];
+			float tz1 = (node.minPosition.z - originZ[i]) * inverseZ[i];
+			float tz2 = (node.maxPosition.z - originZ[i]) * inverseZ[i];
+
+			float entry = std::max(std::max(std::min(tx1, tx2), std::min(ty1, ty2)), std::max(std::min(tz1, tz2), 0.0f));
+			float exit = std::min(std::min(std::max(tx1, tx2), std::max(ty1, ty2)), std::max(tz1, tz2));
+
+			entries[i] = exit >= entry && entry < maxDistances[i] ? entry : FLT_MAX;
+		}
+
+		return std::min(std::min(entries[0], entries[1]), std::min(entries[2], entries[3]));
+	};
+
+	unsigned int stack[MeshBvh::MAX_DEPTH];
+	float stackDistances[MeshBvh::MAX_DEPTH];
+	unsigned int stackSize = 0;
+
+	float rootDistance = intersectPacket(this->nodes[0]);
+	if (rootDistance == FLT_MAX)
+		return;
+
+	stack[stackSize] = 0;
+	stackDistances[stackSize++] = rootDistance;
+
+	while (stackSize > 0)
+	{
+		stackSize--;
+		const BvhNode& node = this->nodes[stack[stackSize]];
+
+		// The farthest closest hit of the packet is a conservative bound for all of its rays
+		float maxDistance = std::max(std::max(maxDistances[0], maxDistances[1]), std::max(maxDistances[2], maxDistances[3]));
+
+		if (stackDistances[stackSize] >= maxDistance)
+			continue;
+
+		if (node.blockCount > 0)
+		{
+			if (intersectPacket(node) == FLT_MAX)
+				continue;
+
+			for (unsigned int i = node.leftOrFirst; i < node.leftOrFirst + node.blockCount; i++)
+			{
+				for (unsigned int j = 0; j < rayCount; j++)
+				{
+					// Rays that miss the leaf skip its triangles
+					if (entries[j] == FLT_MAX)
+						continue;
+
+					if (MeshBvh::intersectBlock(this->blocks[i], packet.rays[j].origin, packet.rays[j].direction, maxDistances[j], hits[j]))
+					{
+						hasHit[j] = true;
+						maxDistances[j] = hits[j].distance;
+					}
+				}
+			}
+
+			continue;
+		}
+
+		unsigned int nearChild = node.leftOrFirst;
+		unsigned int farChild = node.leftOrFirst + 1;
+		float nearDistance = intersectPacket(this->nodes[nearChild]);
+		float farDistance = intersectPacket(this->nodes[farChild]);
+
+		if (farDistance < nearDistance)
+		{
+			std::swap(nearChild, farChild);
+			std::swap(nearDistance, farDistance);
+		}
+
+		if (farDistance != FLT_MAX)
+		{
+			stack[stackSize] = farChild;
+			stackDistances[stackSize++] = farDistance;
+		}
+
+		if (nearDistance != FLT_MAX)
+		{
+			stack[stackSize] = nearChild;
+			stackDistances[stackSize++] = nearDistance;
+		}
+	}
+
+	for (unsigned int i = 0; i < rayCount; i++)
+	{
+		if (hasHit[i])
+			MeshBvh::finalizeHit(packet.rays[i], hits[i]);
+	}
+}
+
+void MeshBvh::intersect(const std::vector<Ray>& rays, std::vector<RayHit>& hits) const
+{
+	hits.assign(rays.size(), RayHit());
+
+	RayPacket packet;
+
+	for (size_t first = 0; first < rays.size(); first += RayPacket::SIZE)
+	{
+		packet.count = static_cast<unsigned int>(std::min<size_t>(RayPacket::SIZE, rays.size() - first));
+
+		for (unsigned int i = 0; i < packet.count; i++)
+			packet.rays[i] = rays[first + i];
+
+		this->intersect(packet, &hits[first]);
+	}
+}
+
+bool MeshBvh::isOccluded(const Ray& ray) const
+{
+	if (this->blocks.empty())
+		return false;
+
+	glm::vec3 inverseDirection = 1.0f / ray.direction;
+	RayHit hit;
+
+	unsigned int stack[MeshBvh::MAX_DEPTH];
+	unsigned int stackSize = 0;
+	stack[stackSize++] = 0;
+
+	// Any hit will do, so the nodes are visited in whatever order
+	while (stackSize > 0)
+	{
+		const BvhNode& node = this->nodes[stack[--stackSize]];
+
+		if (MeshBvh::intersectNode(node, ray.origin, inverseDirection, ray.maxDistance) == FLT_MAX)
+			continue;
+
+		if (node.blockCount > 0)
+		{
+			for (unsigned int i = node.leftOrFirst; i < node.leftOrFirst + node.blockCount; i++)
+			{
+				if (MeshBvh::intersectBlock(this->blocks[i], ray.origin, ray.direction, ray.maxDistance, hit))
+					return true;
+			}
+
+			continue;
+		}
+
+		stack[stackSize++] = node.leftOrFirst + 1;
+		stack[stackSize++] = node.leftOrFirst;
+	}
+
+	return false;
+}
+
+BoundingBox MeshBvh::getBoundingBox() const
+{
+	return { this->nodes[0].minPosition, this->nodes[0].maxPosition };
+}
+
+size_t MeshBvh::getTriangleCount() const
+{
+	return this->triangleCount;
+}
+
+size_t MeshBvh::getNodeCount() const
+{
+	return this->nodes.size();
+}
+
+size_t MeshBvh::getMemoryUsage() const
+{
+	return this->nodes.size() * sizeof(BvhNode) + this->blocks.size() * sizeof(TriangleBlock);
+}
+
+bool MeshBvh::intersectBlock(const TriangleBlock& block, const glm::vec3& origin, const glm::vec3& direction, float maxDistance, RayHit& hit)
+{
+	constexpr unsigned int WIDTH = TriangleBlock::WIDTH;
+
+	// Moller-Trumbore on every lane at once, written without branches so the compiler can vectorize the lanes
+	float distances[WIDTH];
+	float us[WIDTH];
+	float vs[WIDTH];
+
+	for (unsigned int lane = 0; lane < WIDTH; lane++)
+	{
+		float px = direction.y * block.e2z[lane] - direction.z * block.e2y[lane];
+		float py = direction.z * block.e2x[lane] - direction.x * block.e2z[lane];
+		float pz = direction.x * block.e2y[lane] - direction.y * block.e2x[lane];
+
+		float determinant = block.e1x[lane] * px + block.e1y[lane] * py + block.e1z[lane] * pz;
+		float inverseDeterminant = 1.0f / determinant;
+
+		float tx = origin.x - block.v0x[lane];
+		float ty = origin.y - block.v0y[lane];
+		float tz = origin.z - block.v0z[lane];
+
+		float u = (tx * px + ty * py + tz * pz) * inverseDeterminant;
+
+		float qx = ty * block.e1z[lane] - tz * block.e1y[lane];
+		float qy = tz * block.e1x[lane] - tx * block.e1z[lane];
+		float qz = tx * block.e1y[lane] - ty * block.e1x[lane];
+
+		float v = (direction.x * qx + direction.y * qy + direction.z * qz) * inverseDeterminant;
+		float distance = (block.e2x[lane] * qx + block.e2y[lane] * qy + block.e2z[lane] * qz) * inverseDeterminant;
+
+		// Comparisons with the NaNs of null determinants are false, so unused lanes and degenerate triangles are rejected
+		bool isHit = u >= 0.0f && v >= 0.0f && u + v <= 1.0f && distance >= 0.0f;
+
+		distances[lane] = isHit ? distance : FLT_MAX;
+		us[lane] = u;
+		vs[lane] = v;
+	}
+
+	float closestDistance = std::min(maxDistance, hit.distance);
+	int closestLane = -1;
+
+	for (unsigned int lane = 0; lane < WIDTH; lane++)
+	{
+		if (distances[lane] < closestDistance)
+		{
+			closestDistance = distances[lane];
+			closestLane = static_cast<int>(lane);
+		}
+	}
+
+	if (closestLane < 0)
+		return false;
+
+	hit.distance = closestDistance;
+	hit.triangle = block.triangles[closestLane];
+	hit.u = us[closestLane];
+	hit.v = vs[closestLane];
+	hit.normal = glm::cross(
+		glm::vec3(block.e1x[closestLane], block.e1y[closestLane], block.e1z[closestLane]),
+		glm::vec3(block.e2x[closestLane], block.e2y[closestLane], block.e2z[closestLane])
+	);
+
+	return true;
+}
+
+float MeshBvh::intersectNode(const BvhNode& node, const glm::vec3& origin, const glm::vec3& inverseDirection, float maxDistance)
+{
+	float tx1 = (node.minPosition.x - origin.x) * inverseDirection.x;
+	float tx2 = (node.maxPosition.x - origin.x) * inverseDirection.x;
+	float ty1 = (node.minPosition.y - origin.y) * inverseDirection.y;
+	float ty2 = (node.maxPosition.y - origin.y) * inverseDirection.y;
+	float tz1 = (node.minPosition.z - origin.z) * inverseDirection.z;
+	float tz2 = (node.maxPosition.z - origin.z) * inverseDirection.z;
+
+	float entry = std::max(std::max(std::min(tx1, tx2), std::min(ty1, ty2)), std::max(std::min(tz1, tz2), 0.0f));
+	float exit = std::min(std::min(std::max(tx1, tx2), std::max(ty1, ty2)), std::max(tz1, tz2));
+
+	if (exit < entry || entry >= maxDistance)
+		return FLT_MAX;
+
+	return entry;
+}
+
+void MeshBvh::finalizeHit(const Ray& ray, RayHit& hit)
+{
+	hit.position = ray.origin + ray.direction * hit.distance;
+
+	float length = glm::length(hit.normal);
+	if (length > 0.0f)
+		hit.normal /= length;
+}
@@ -1,4 +1,15 @@
+#include <algorithm>
+#include <cfloat>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <limits>
+
 #include "physics/physicsWorld.hpp"
+#include "utilities/hash.hpp"
+#include "utilities/mappedFile.hpp"
+#include "logger.hpp"
 
 PhysicsWorld::PhysicsWorld()
 {
@@ -17,6 +28,10 @@ PhysicsWorld::PhysicsWorld()
 
 PhysicsWorld::~PhysicsWorld()
 {
+	// The components can outlive the world, they must not remove their colliders from it afterwards
+	for (auto& [rigidBody, component] : this->rigidBodyToComponent)
+		component->setCollider(nullptr, nullptr);
+
 	this->debugDrawer.reset();
 	this->world.reset();
 	this->solver.reset();
@@ -29,6 +44,30 @@ PhysicsWorld::~PhysicsWorld()
 		collider.reset();
 }
 
+void PhysicsWorld::removeColliders(PhysicsComponent* component)
+{
+	auto isComponentCollider = [this, component](const std::unique_ptr<Collider>& collider) {
+		auto iterator = this->rigidBodyToComponent.find(collider->rigidBody.get());
+		return iterator != this->rigidBodyToComponent.end() && iterator->second == component;
+	};
+
+	for (auto& collider : this->rigidBodies)
+	{
+		if (isComponentCollider(collider))
+			this->world->removeRigidBody(collider->rigidBody.get());
+	}
+
+	auto removed = std::remove_if(this->rigidBodies.begin(), this->rigidBodies.end(), [&](const std::unique_ptr<Collider>& collider) {
+		if (!isComponentCollider(collider))
+			return false;
+
+		this->rigidBodyToComponent.erase(collider->rigidBody.get());
+		return true;
+	});
+
+	this->rigidBodies.erase(removed, this->rigidBodies.end());
+}
+
 void PhysicsWorld::update(float deltaTime) const
 {
 	this->world->stepSimulation(deltaTime, 10);
@@ -57,11 +96,14 @@ PhysicsComponent* PhysicsWorld::raycastLine(glm::vec3 from, glm::vec3 to)
 	return nullptr;
 }
 
-std::vector<float> PhysicsWorld::getDebugLines() const
+const std::vector<glm::vec3>& PhysicsWorld::getDebugLines() const
+{
+	return this->debugDrawer->debugLines;
+}
+
+void PhysicsWorld::clearDebugLines()
 {
-	std::vector<float> lines = this->debugDrawer->debugLines;
 	this->debugDrawer->debugLines.clear();
-	return lines;
 }
 
 void PhysicsWorld::addPlane(glm::vec3 normal, glm::vec3 position)
@@ -108,7 +150,7 @@ void PhysicsWorld::addBox(PhysicsComponent* component, glm::vec3 halfExtents, gl
 	);
 
 	this->world->addRigidBody(boxRigidBody);
-	component->setCollider(collider.get());
+	component->setCollider(collider.get(), this);
 
 	this->rigidBodies.push_back(std::move(collider));
 	this->rigidBodyToComponent[boxRigidBody] = component;
@@ -137,7 +179,7 @@ void PhysicsWorld::addSphere(PhysicsComponent* component, float radius, glm::vec
 	);
 
 	this->world->addRigidBody(sphereRigidBody);
-	component->setCollider(collider.get());
+	component->setCollider(collider.get(), this);
 
 	this->rigidBodies.push_back(std::move(collider));
 	this->rigidBodyToComponent[sphereRigidBody] = component;
@@ -166,8 +208,465 @@ void PhysicsWorld::addCapsule(PhysicsComponent* component, float radius, float h
 		);
 
 	this->world->addRigidBody(capsuleRigidBody);
-	component->setCollider(collider.get());
+	component->setCollider(collider.get(), this);
 
 	this->rigidBodies.push_back(std::move(collider));
 	this->rigidBodyToComponent[capsuleRigidBody] = component;
 }
+
+void PhysicsWorld::addTriangleMesh(PhysicsComponent* component, const std::vector<float>& vertices, const std::vector<unsigned int>& indices, const glm::mat4& transform)
+{
+	std::shared_ptr<ColliderShape> meshShape = this->createTriangleMeshShape(vertices, indices);
+
+	if (meshShape == nullptr)
+	{
+		Logger::logWarning("Can't create a triangle mesh collider without triangles", "physicsWorld.cpp");
+		return;
+	}
+
+	this->addMeshBody(component, std::move(meshShape), transform, 0.0f);
+}
+
+void PhysicsWorld::addConvexHull(PhysicsComponent* component, const std::vector<float>& vertices, const glm::mat4& transform, float mass, unsigned int maxVertices)
+{
+	std::vector<glm::vec3> hull = ConvexDecomposition::computeHull(vertices, std::max(4u, maxVertices));
+
+	if (hull.empty())
+	{
+		Logger::logWarning("Can't create a convex hull collider without vertices", "physicsWorld.cpp");
+		return;
+	}
+
+	this->addMeshBody(component, PhysicsWorld::createConvexShape({ hull }), transform, mass);
+}
+
+void PhysicsWorld::addConvexDecomposition(PhysicsComponent* component, const std::vector<float>& vertices, const std::vector<unsigned int>& indices, const glm::mat4& transform, float mass, const ConvexDecompositionSettings& settings)
+{
+	if (vertices.empty() || indices.size() < 3)
+	{
+		Logger::logWarning("Can't create a convex decomposition collider without triangles", "physicsWorld.cpp");
+		return;
+	}
+
+	// The settings are part of the key, so changing them decomposes the mesh again instead of loading stale hulls
+	uint32_t parameters[3] = { settings.maxHulls, settings.maxHullVertices, 0 };
+	std::memcpy(&parameters[2], &settings.maxConcavity, sizeof(float));
+
+	uint64_t meshHash = Hash::hashVector(indices, Hash::hashVector(vertices));
+	meshHash = Hash::hashBytes(parameters, sizeof(parameters), meshHash);
+
+	std::vector<std::vector<glm::vec3>> hulls;
+
+	if (!this->useCollisionCache || !this->loadCachedHulls(meshHash, hulls))
+	{
+		auto decompositionStart = std::chrono::steady_clock::now();
+		hulls = ConvexDecomposition::decompose(vertices, indices, settings);
+		double decompositionTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - decompositionStart).count();
+
+		Logger::logDebug("Decomposed " + std::to_string(indices.size() / 3) + " triangles in " + std::to_string(hulls.size()) + " convex hulls in " + std::to_string(decompositionTime) + " ms", "physicsWorld.cpp");
+
+		if (this->useCollisionCache && !hulls.empty())
+			this->saveCachedHulls(meshHash, hulls);
+	}
+
+	if (hulls.empty())
+	{
+		Logger::logWarning("Convex decomposition produced no hulls", "physicsWorld.cpp");
+		return;
+	}
+
+	this->addMeshBody(component, PhysicsWorld::createConvexShape(hulls), transform, mass);
+}
+
+void PhysicsWorld::addColliderInstance(PhysicsComponent* component, const PhysicsComponent* source, const glm::mat4& transform, float mass)
+{
+	const Collider* sourceCollider = source != nullptr ? source->getCollider() : nullptr;
+
+	if (sourceCollider == nullptr || sourceCollider->meshShape == nullptr)
+	{
+		Logger::logWarning("Can't create a collider instance from a component without a mesh collider", "physicsWorld.cpp");
+		return;
+	}
+
+	this->addMeshBody(component, sourceCollider->meshShape, transform, mass);
+}
+
+std::shared_ptr<ColliderShape> PhysicsWorld::createTriangleMeshShape(const std::vector<float>& vertices, const std::vector<unsigned int>& indices) const
+{
+	if (vertices.empty() || indices.size() < 3)
+		return nullptr;
+
+	auto meshShape = std::make_shared<ColliderShape>();
+	meshShape->mesh = std::make_unique<ColliderMesh>();
+
+	ColliderMesh& mesh = *meshShape->mesh;
+	mesh.vertices.assign(vertices.begin(), vertices.end());
+	mesh.indices.assign(indices.begin(), indices.begin() + static_cast<std::ptrdiff_t>(indices.size() / 3 * 3));
+
+	mesh.meshInterface = std::make_unique<btTriangleIndexVertexArray>(
+		static_cast<int>(mesh.indices.size() / 3),
+		mesh.indices.data(),
+		static_cast<int>(3 * sizeof(int)),
+		static_cast<int>(mesh.vertices.size() / 3),
+		mesh.vertices.data(),
+		static_cast<int>(3 * sizeof(btScalar))
+	);
+
+	uint64_t meshHash = Hash::hashVector(mesh.indices, Hash::hashVector(mesh.vertices));
+
+	if (this->useCollisionCache)
+		mesh.cachedBvh = this->loadCachedBvh(meshHash, mesh);
+
+	// Quantized nodes take a quarter of the memory of the regular ones, which matters for large levels
+	if (mesh.cachedBvh != nullptr)
+	{
+		auto meshShapeWithBvh = std::make_unique<btBvhTriangleMeshShape>(mesh.meshInterface.get(), true, false);
+		meshShapeWithBvh->setOptimizedBvh(mesh.cachedBvh.get());
+		meshShape->shape = std::move(meshShapeWithBvh);
+	}
+	else
+	{
+		auto buildStart = std::chrono::steady_clock::now();
+		auto builtShape = std::make_unique<btBvhTriangleMeshShape>(mesh.meshInterface.get(), true);
+		double buildTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - buildStart).count();
+
+		Logger::logDebug("Built collision BVH of " + std::to_string(mesh.indices.size() / 3) + " triangles in " + std::to_string(buildTime) + " ms", "physicsWorld.cpp");
+
+		if (this->useCollisionCache)
+			this->saveCachedBvh(meshHash, mesh, builtShape->getOptimizedBvh());
+
+		meshShape->shape = std::move(builtShape);
+	}
+
+	return meshShape;
+}
+
+std::shared_ptr<ColliderShape> PhysicsWorld::createConvexShape(const std::vector<std::vector<glm::vec3>>& hulls)
+{
+	auto meshShape = std::make_shared<ColliderShape>();
+
+	// Bullet rotates a body around the origin of its shape, so the hulls are moved for the center of mass to be at the origin
+	meshShape->centerOfMass = ConvexDecomposition::computeCenterOfMass(hulls);
+	meshShape->hulls = hulls;
+
+	for (std::vector<glm::vec3>& hull : meshShape->hulls)
+	{
+		for (glm::vec3& point : hull)
+			point -= meshShape->centerOfMass;
+	}
+
+	PhysicsWorld::buildConvexShape(*meshShape);
+	return meshShape;
+}
+
+void PhysicsWorld::buildConvexShape(ColliderShape& meshShape)
+{
+	for (const std::vector<glm::vec3>& hull : meshShape.hulls)
+	{
+		auto hullShape = std::make_unique<btConvexHullShape>();
+
+		for (const glm::vec3& point : hull)
+			hullShape->addPoint(btVector3(point.x, point.y, point.z), false);
+
+		hullShape->recalcLocalAabb();
+		meshShape.childShapes.push_back(std::move(hullShape));
+	}
+
+	// A single hull is used directly, the compound shape would only add a level of indirection
+	if (meshShape.childShapes.size() == 1)
+	{
+		meshShape.shape = std::move(meshShape.childShapes[0]);
+		meshShape.childShapes.clear();
+	}
+	else
+	{
+		auto compoundShape = std::make_unique<btCompoundShape>(true, static_cast<int>(meshShape.childShapes.size()));
+		btTransform identity;
+		identity.setIdentity();
+
+		for (const auto& childShape : meshShape.childShapes)
+			compoundShape->addChildShape(identity, childShape.get());
+
+		meshShape.shape = std::move(compoundShape);
+	}
+}
+
+void PhysicsWorld::addMeshBody(PhysicsComponent* component, std::shared_ptr<ColliderShape> meshShape, const glm::mat4& transform, float mass)
+{
+	btVector3 scale;
+	btTransform rigidTransform = PhysicsWorld::getRigidTransform(transform, scale);
+
+	// Triangle meshes are level geometry, Bullet doesn't support them on dynamic bodies
+	if (meshShape->mesh != nullptr)
+		mass = 0.0f;
+
+	std::unique_ptr<btCollisionShape> scaledShape;
+
+	if (scale != btVector3(1.0f, 1.0f, 1.0f))
+	{
+		// The scaled shape reads the BVH of the shared one rather than rebuilding it for the scale,
+		// convex shapes hold their scale so a scaled instance gets its own, built from the few points of the hulls
+		if (meshShape->mesh != nullptr)
+			scaledShape = std::make_unique<btScaledBvhTriangleMeshShape>(static_cast<btBvhTriangleMeshShape*>(meshShape->shape.get()), scale);
+		else
+		{
+			auto scaledMeshShape = std::make_shared<ColliderShape>();
+			scaledMeshShape->hulls = meshShape->hulls;
+			scaledMeshShape->centerOfMass = meshShape->centerOfMass;
+
+			PhysicsWorld::buildConvexShape(*scaledMeshShape);
+			scaledMeshShape->shape->setLocalScaling(scale);
+
+			meshShape = std::move(scaledMeshShape);
+		}
+	}
+
+	btCollisionShape* shape = scaledShape != nullptr ? scaledShape.get() : meshShape->shape.get();
+	btVector3 localInertia(0.0f, 0.0f, 0.0f);
+
+	if (mass > 0.0f)
+		shape->calculateLocalInertia(mass, localInertia);
+
+	// The motion state keeps the transform of the mesh and places the body at the scaled center of mass from it,
+	// the mesh follows the body through that transform so both stay together when the body rotates
+	btVector3 scaledCenterOfMass = btVector3(meshShape->centerOfMass.x, meshShape->centerOfMass.y, meshShape->centerOfMass.z) * scale;
+	btTransform centerOfMassOffset(btQuaternion::getIdentity(), -scaledCenterOfMass);
+
+	auto* motionState = new btDefaultMotionState(rigidTransform, centerOfMassOffset);
+	btRigidBody::btRigidBodyConstructionInfo rigidBodyCI(mass, motionState, shape, localInertia);
+	auto* meshRigidBody = new btRigidBody(rigidBodyCI);
+
+	std::unique_ptr<Collider> collider = std::make_unique<Collider>(
+		this->world.get(),
+		std::move(scaledShape),
+		std::unique_ptr<btDefaultMotionState>(motionState),
+		std::unique_ptr<btRigidBody>(meshRigidBody)
+	);
+	collider->meshShape = std::move(meshShape);
+
+	this->world->addRigidBody(meshRigidBody);
+	component->setCollider(collider.get(), this);
+
+	this->rigidBodies.push_back(std::move(collider));
+	this->rigidBodyToComponent[meshRigidBody] = component;
+}
+
+btTransform PhysicsWorld::getRigidTransform(const glm::mat4& transform, btVector3& scale)
+{
+	glm::vec3 axes[3] = { glm::vec3(transform[0]), glm::vec3(transform[1]), glm::vec3(transform[2]) };
+	float lengths[3] = { glm::length(axes[0]), glm::length(axes[1]), glm::length(axes[2]) };
+
+	if (glm::dot(glm::cross(axes[0], axes[1]), axes[2]) < 0.0f)
+		lengths[0] = -lengths[0];
+
+	for (int axis = 0; axis < 3; axis++)
+	{
+		if (std::abs(lengths[axis]) > FLT_EPSILON)
+			axes[axis] /= lengths[axis];
+	}
+
+	// The basis is given row by row, the axes are its columns
+	btMatrix3x3 basis(
+		axes[0].x, axes[1].x, axes[2].x,
+		axes[0].y, axes[1].y, axes[2].y,
+		axes[0].z, axes[1].z, axes[2].z
+	);
+
+	scale = btVector3(lengths[0], lengths[1], lengths[2]);
+	return btTransform(basis, btVector3(transform[3].x, transform[3].y, transform[3].z));
+}
+
+namespace
+{
+	/// <summary>
+	/// The header of a collision cache file, followed by the serialized BVH
+	/// The Bullet version and scalar size are stored since the serialized layout depends on them
+	/// </summary>
+	struct CollisionCacheHeader
+	{
+		char magic[4];
+		uint32_t version;
+		uint32_t bulletVersion;
+		uint32_t scalarSize;
+		uint64_t meshHash;
+		uint32_t triangleCount;
+		uint32_t vertexCount;
+		uint64_t bvhSize;
+	};
+
+	/// <summary>
+	/// The header of a hull cache file, followed by each hull as its point count and its points
+	/// </summary>
+	struct HullCacheHeader
+	{
+		char magic[4];
+		uint32_t version;
+		uint64_t meshHash;
+		uint32_t hullCount;
+		uint32_t padding;
+	};
+}
+
+std::unique_ptr<btOptimizedBvh, BvhBufferDeleter> PhysicsWorld::loadCachedBvh(uint64_t meshHash, const ColliderMesh& mesh) const
+{
+	std::ifstream file(this->getCachePath(meshHash, ".bvh"), std::ios::binary);
+
+	if (!file.is_open())
+		return nullptr;
+
+	CollisionCacheHeader header = {};
+	file.read(reinterpret_cast<char*>(&header), sizeof(header));
+
+	bool isValid = file.good()
+		&& std::memcmp(header.magic, PhysicsWorld::COLLISION_CACHE_MAGIC, sizeof(header.magic)) == 0
+		&& header.version == PhysicsWorld::COLLISION_CACHE_VERSION
+		&& header.bulletVersion == BT_BULLET_VERSION
+		&& header.scalarSize == sizeof(btScalar)
+		&& header.meshHash == meshHash
+		&& header.triangleCount == mesh.indices.size() / 3
+		&& header.vertexCount == mesh.vertices.size() / 3
+		&& header.bvhSize > 0 && header.bvhSize <= std::numeric_limits<unsigned int>::max();
+
+	if (!isValid)
+	{
+		Logger::logWarning("Ignoring outdated collision cache file " + this->getCachePath(meshHash, ".bvh"), "physicsWorld.cpp");
+		return nullptr;
+	}
+
+	// The BVH is deserialized in place, its nodes point into the buffer which must be 16 bytes aligned
+	void* buffer = btAlignedAlloc(static_cast<size_t>(header.bvhSize), 16);
+	file.read(static_cast<char*>(buffer), static_cast<std::streamsize>(header.bvhSize));
+
+	if (!file.good())
+	{
+		Logger::logWarning("Truncated collision cache file " + this->getCachePath(meshHash, ".bvh"), "physicsWorld.cpp");
+		btAlignedFree(buffer);
+		return nullptr;
+	}
+
+	btOptimizedBvh* bvh = btOptimizedBvh::deSerializeInPlace(buffer, static_cast<unsigned int>(header.bvhSize), false);
+
+	if (bvh == nullptr)
+	{
+		btAlignedFree(buffer);
+		return nullptr;
+	}
+
+	return std::unique_ptr<btOptimizedBvh, BvhBufferDeleter>(bvh);
+}
+
+void PhysicsWorld::saveCachedBvh(uint64_t meshHash, const ColliderMesh& mesh, btOptimizedBvh* bvh) const
+{
+	if (bvh == nullptr)
+		return;
+
+	unsigned int bvhSize = bvh->calculateSerializeBufferSize();
+	void* buffer = btAlignedAlloc(bvhSize, 16);
+
+	if (!bvh->serializeInPlace(buffer, bvhSize, false))
+	{
+		Logger::logWarning("Failed to serialize a collision BVH", "physicsWorld.cpp");
+		btAlignedFree(buffer);
+		return;
+	}
+
+	CollisionCacheHeader header = {};
+	std::memcpy(header.magic, PhysicsWorld::COLLISION_CACHE_MAGIC, sizeof(header.magic));
+	header.version = PhysicsWorld::COLLISION_CACHE_VERSION;
+	header.bulletVersion = BT_BULLET_VERSION;
+	header.scalarSize = sizeof(btScalar);
+	header.meshHash = meshHash;
+	header.triangleCount = static_cast<uint32_t>(mesh.indices.size() / 3);
+	header.vertexCount = static_cast<uint32_t>(mesh.vertices.size() / 3);
+	header.bvhSize = bvhSize;
+
+	this->writeCacheFile(this->getCachePath(meshHash, ".bvh"), [&](std::ofstream& file)
+	{
+		file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		file.write(static_cast<const char*>(buffer), bvhSize);
+	});
+
+	btAlignedFree(buffer);
+}
+
+bool PhysicsWorld::loadCachedHulls(uint64_t meshHash, std::vector<std::vector<glm::vec3>>& hulls) const
+{
+	std::string path = this->getCachePath(meshHash, ".hull");
+	std::ifstream file(path, std::ios::binary);
+
+	if (!file.is_open())
+		return false;
+
+	HullCacheHeader header = {};
+	file.read(reinterpret_cast<char*>(&header), sizeof(header));
+
+	bool isValid = file.good()
+		&& std::memcmp(header.magic, PhysicsWorld::HULL_CACHE_MAGIC, sizeof(header.magic)) == 0
+		&& header.version == PhysicsWorld::HULL_CACHE_VERSION
+		&& header.meshHash == meshHash
+		&& header.hullCount > 0;
+
+	if (!isValid)
+	{
+		Logger::logWarning("Ignoring outdated collision cache file " + path, "physicsWorld.cpp");
+		return false;
+	}
+
+	std::vector<std::vector<glm::vec3>> loadedHulls(header.hullCount);
+
+	for (std::vector<glm::vec3>& hull : loadedHulls)
+	{
+		uint32_t pointCount = 0;
+		file.read(reinterpret_cast<char*>(&pointCount), sizeof(pointCount));
+
+		if (!file.good() || pointCount > PhysicsWorld::MAX_CACHED_HULL_POINTS)
+			break;
+
+		hull.resize(pointCount);
+		file.read(reinterpret_cast<char*>(hull.data()), static_cast<std::streamsize>(pointCount * sizeof(glm::vec3)));
+	}
+
+	if (!file.good())
+	{
+		Logger::logWarning("Truncated collision cache file " + path, "physicsWorld.cpp");
+		return false;
+	}
+
+	hulls = std::move(loadedHulls);
+
+	return true;
+}
+
+void PhysicsWorld::saveCachedHulls(uint64_t meshHash, const std::vector<std::vector<glm::vec3>>& hulls) const
+{
+	HullCacheHeader header = {};
+	std::memcpy(header.magic, PhysicsWorld::HULL_CACHE_MAGIC, sizeof(header.magic));
+	header.version = PhysicsWorld::HULL_CACHE_VERSION;
+	header.meshHash = meshHash;
+	header.hullCount = static_cast<uint32_t>(hulls.size());
+
+	this->writeCacheFile(this->getCachePath(meshHash, ".hull"), [&](std::ofstream& file)
+	{
+		file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+		for (const std::vector<glm::vec3>& hull : hulls)
+		{
+			auto pointCount = static_cast<uint32_t>(hull.size());
+			file.write(reinterpret_cast<const char*>(&pointCount), sizeof(pointCount));
+			file.write(reinterpret_cast<const char*>(hull.data()), static_cast<std::streamsize>(hull.size() * sizeof(glm::vec3)));
+		}
+	});
+}
+
+void PhysicsWorld::writeCacheFile(const std::string& path, const std::function<void(std::ofstream&)>& write) const
+{
+	std::error_code error;
+
+	if (!CacheFile::write(path, write, error))
+		Logger::logWarning("Couldn't write the collision cache file " + path + " - " + error.message(), "physicsWorld.cpp");
+}
+
+std::string PhysicsWorld::getCachePath(uint64_t meshHash, const std::string& extension) const
+{
+	return CacheFile::getPath(this->collisionCacheDirectory, meshHash, extension);
+}
@@ -216,8 +216,8 @@ void Renderer::init(glm::vec2 lastWindowSize)
 
 	this->ssaoNoiseTexture = std::make_unique<Texture>(noiseTexture, TextureType::TEXTURE_2D);
 
-	std::vector<float> quadVertices = Geometry::getQuadVertices();
-	std::vector<float> quadTexCoords = Geometry::getQuadTexCoords();
+	const std::vector<float>& quadVertices = Geometry::getQuadVertices();
+	const std::vector<float>& quadTexCoords = Geometry::getQuadTexCoords();
 
 	this->ssaoQuad = std::make_unique<Entity>("SSAO_Quad");
 	auto* ssaoQuadMesh = ssaoQuad->addComponent<MeshComponent>();
@@ -235,6 +235,8 @@ void Renderer::init(glm::vec2 lastWindowSize)
 
 	ssaoBlurQuadMesh->start();
 
+	this->debugLinesBuffer = std::make_unique<TransientBuffer>(Renderer::DEBUG_LINES_INITIAL_CAPACITY);
+
 	this->createFramebuffers(lastWindowSize);
 }
 
@@ -242,20 +244,12 @@ void Renderer::addLine(glm::vec3 startPos, glm::vec3 endPos, bool store)
 {
 	if (store)
 	{
-		this->storedLineVerts.push_back(startPos.x);
-		this->storedLineVerts.push_back(startPos.y);
-		this->storedLineVerts.push_back(startPos.z);
-		this->storedLineVerts.push_back(endPos.x);
-		this->storedLineVerts.push_back(endPos.y);
-		this->storedLineVerts.push_back(endPos.z);
+		this->storedLineVerts.push_back(startPos);
+		this->storedLineVerts.push_back(endPos);
 	}
 
-	this->lineVerts.push_back(startPos.x);
-	this->lineVerts.push_back(startPos.y);
-	this->lineVerts.push_back(startPos.z);
-	this->lineVerts.push_back(endPos.x);
-	this->lineVerts.push_back(endPos.y);
-	this->lineVerts.push_back(endPos.z);
+	this->lineVerts.push_back(startPos);
+	this->lineVerts.push_back(endPos);
 }
 
 void Renderer::render(Scene& scene, PhysicsWorld& physicsWorld, float deltaTime)
@@ -286,8 +280,8 @@ void Renderer::render(Scene& scene, PhysicsWorld& physicsWorld, float deltaTime)
 	// Update camera info
 	glm::vec2 lastWindowSize = this->multiSampledTarget->size;
 	this->shaderManager.updateUniformBuffer(scene.currentCamera->getViewMatrix(), scene.currentCamera->getProjectionMatrix(lastWindowSize.x, lastWindowSize.y));
-	this->shaderManager.getShader(ShaderType::PHONG)->use()->setVec3("viewPos", scene.currentCamera->getPosition());
-	this->shaderManager.getShader(ShaderType::PBR)->use()->setVec3("camPos", scene.currentCamera->getPosition());
+	this->shaderManager.getShader(ShaderType::PHONG)->use()->setVec3(Renderer::VIEW_POS, scene.currentCamera->getPosition());
+	this->shaderManager.getShader(ShaderType::PBR)->use()->setVec3(Renderer::CAM_POS, scene.currentCamera->getPosition());
 	// Send light data to shader
 	LightManager::getInstance().sendToShader();
 	this->shadowPass(scene.sortedSceneData.allMeshes, scene);
@@ -475,10 +469,7 @@ void Renderer::shadowPass(const std::vector<MeshComponent*>& meshes, const Scene
 	Shader* depthShader = this->shaderManager.getShader(ShaderType::DEPTH_CASCADED);
 
 	depthShader->use()
-		->setMat4("lightSpaceMatrices[0]", lightSpaceMatrices[0])
-		->setMat4("lightSpaceMatrices[1]", lightSpaceMatrices[1])
-		->setMat4("lightSpaceMatrices[2]", lightSpaceMatrices[2])
-		->setMat4("lightSpaceMatrices[3]", lightSpaceMatrices[3]);
+		->setMat4Array(Renderer::LIGHT_SPACE_MATRICES, lightSpaceMatrices.data(), static_cast<int>(lightSpaceMatrices.size()));
 
 	this->depthMap->bind();
 	this->depthMap->clear();
@@ -501,7 +492,7 @@ void Renderer::gBufferPass(const std::vector<MeshComponent*>& meshes)
 	gBufferShader->use();
 
 	for (MeshComponent* mesh : meshes)
-		mesh->drawGeometry(gBufferShader);
+		mesh->drawGeometry(gBufferShader, true);
 
 	this->gBuffer->unbind();
 }
@@ -514,13 +505,12 @@ void Renderer::ssaoPass(std::vector<MeshComponent*>& meshes)
 	Shader* ssaoShader = this->shaderManager.getShader(ShaderType::SSAO);
 	// Setup required uniforms
 	ssaoShader->use()
-		->setInt("gPosition", 0)
-		->setInt("gNormal", 1)
-		->setInt("texNoise", 2)
-		->setVec2("noiseScale", glm::vec2(this->ssaoTarget->size.x / 4.0f, this->ssaoTarget->size.y / 4.0f));
+		->setInt(Renderer::G_POSITION, 0)
+		->setInt(Renderer::G_NORMAL, 1)
+		->setInt(Renderer::TEX_NOISE, 2)
+		->setVec2(Renderer::NOISE_SCALE, glm::vec2(this->ssaoTarget->size.x / 4.0f, this->ssaoTarget->size.y / 4.0f));
 
-	for (unsigned int i = 0; i < 64; i++)
-		ssaoShader->setVec3("samples[" + std::to_string(i) + "]", this->ssaoKernel[i]);
+	ssaoShader->setVec3Array(Renderer::SAMPLES, this->ssaoKernel.data(), static_cast<int>(this->ssaoKernel.size()));
 
 	// Bind the G buffer textures
 	glActiveTexture(GL_TEXTURE0);
@@ -543,7 +533,7 @@ void Renderer::ssaoPass(std::vector<MeshComponent*>& meshes)
 
 	Shader* ssaoBlurShader = this->shaderManager.getShader(ShaderType::SSAOBLUR);
 	ssaoBlurShader->use()
-		->setInt("ssaoInput", 0);
+		->setInt(Renderer::SSAO_INPUT, 0);
 
 	glActiveTexture(GL_TEXTURE0);
 	glBindTexture(GL_TEXTURE_2D, this->ssaoTarget->renderTexture);
@@ -559,7 +549,7 @@ void Renderer::renderPass(float deltaTime, PhysicsWorld& physicsWorld, SortedSce
 
 	this->shaderManager.getShader(ShaderType::PBR)
 		->use()
-		->setVec2("windowSize", this->ssaoTarget->size);
+		->setVec2(Renderer::WINDOW_SIZE, this->ssaoTarget->size);
 
 	// We can simply update all entities that won't be rendered
 	for (Entity* nonRenderable : sceneData.logicEntities)
@@ -608,93 +598,65 @@ void Renderer::renderPass(float deltaTime, PhysicsWorld& physicsWorld, SortedSce
 
 	if (this->enableDebugDraw)
 	{
-		// Line drawing for debugging raycasts etc.
-		std::vector<float> debugLines = physicsWorld.getDebugLines();
-		lineVerts.insert(lineVerts.end(), debugLines.begin(), debugLines.end());
-		lineVerts.insert(lineVerts.end(), storedLineVerts.begin(), storedLineVerts.end());
+		this->debugLinesBuffer->begin();
 
-		// Debug bounding boxes
+		// Line drawing for debugging raycasts etc.
+		const std::vector<glm::vec3>& physicsLines = physicsWorld.getDebugLines();
+		this->debugLinesBuffer->write(physicsLines.data(), physicsLines.size());
+		this->debugLinesBuffer->write(this->lineVerts.data(), this->lineVerts.size());
+		this->debugLinesBuffer->write(this->storedLineVerts.data(), this->storedLineVerts.size());
+		physicsWorld.clearDebugLines();
+
+		// The indices for creating lines that links all the 8 points of a bounding box
+		static constexpr int BOX_EDGES[12][2] = {
+			{0, 1}, {0, 2}, {1, 3}, {2, 3}, // Left side edges
+			{4, 5}, {4, 6}, {5, 7}, {6, 7}, // Right side edges
+			{0, 4}, {2, 6}, {1, 5}, {3, 7}, // Connect the two sides
+		};
+
+		// Debug bounding boxes, written straight into the mapped buffer
 		for (MeshComponent* mesh : sceneData.meshes)
 		{
-			std::vector<float> vertices;
+			glm::vec3* boxVertices = this->debugLinesBuffer->allocate(24);
+
+			// The buffer is full for this frame, it will grow before the next one
+			if (boxVertices == nullptr)
+				continue;
 
-			// Querying the bounding boxes like that every frame is super slow, could probably be improved
 			BoundingBox meshBB = mesh->getWorldBoundingBox();
 			glm::vec3 minPos = meshBB.minPosition;
 			glm::vec3 maxPos = meshBB.maxPosition;
 
-			// Create the vertices for the 8 points of the bounding box
-			// Left bottom back
-			vertices.push_back(minPos[0]); vertices.push_back(minPos[1]); vertices.push_back(minPos[2]); // (x_min, y_min, z_min)
-			// Left bottom front
-			vertices.push_back(minPos[0]); vertices.push_back(minPos[1]); vertices.push_back(maxPos[2]); // (x_min, y_min, z_max)
-			// Left top back
-			vertices.push_back(minPos[0]); vertices.push_back(maxPos[1]); vertices.push_back(minPos[2]); // (x_min, y_max, z_min)
-			// Left top front
-			vertices.push_back(minPos[0]); vertices.push_back(maxPos[1]); vertices.push_back(maxPos[2]); // (x_min, y_max, z_max)
-			// Right bottom back
-			vertices.push_back(maxPos[0]); vertices.push_back(minPos[1]); vertices.push_back(minPos[2]); // (x_max, y_min, z_min)
-			// Right bottom front
-			vertices.push_back(maxPos[0]); vertices.push_back(minPos[1]); vertices.push_back(maxPos[2]); // (x_max, y_min, z_max)
-			// Right top back
-			vertices.push_back(maxPos[0]); vertices.push_back(maxPos[1]); vertices.push_back(minPos[2]); // (x_max, y_max, z_min)
-			// Right top front
-			vertices.push_back(maxPos[0]); vertices.push_back(maxPos[1]); vertices.push_back(maxPos[2]); // (x_max, y_max, z_max)
-
-			// The indices for creating lines that links all the points of the bounding box using the 8 previous vertices
-
-			// Add the vertices to draw each line of the bounding box
-			for (int i = 0; i < 12; ++i)
+			const glm::vec3 corners[8] = {
+				glm::vec3(minPos.x, minPos.y, minPos.z), // Left bottom back
+				glm::vec3(minPos.x, minPos.y, maxPos.z), // Left bottom front
+				glm::vec3(minPos.x, maxPos.y, minPos.z), // Left top back
+				glm::vec3(minPos.x, maxPos.y, maxPos.z), // Left top front
+				glm::vec3(maxPos.x, minPos.y, minPos.z), // Right bottom back
+				glm::vec3(maxPos.x, minPos.y, maxPos.z), // Right bottom front
+				glm::vec3(maxPos.x, maxPos.y, minPos.z), // Right top back
+				glm::vec3(maxPos.x, maxPos.y, maxPos.z), // Right top front
+			};
+
+			for (int i = 0; i < 12; i++)
 			{
-				int edgeIndices[12][2] = {
-					{0, 1}, {0, 2}, {1, 3}, {2, 3}, // Left side edges
-					{4, 5}, {4, 6}, {5, 7}, {6, 7}, // Right side edges
-					{0, 4}, {2, 6}, {1, 5}, {3, 7}, // Connect the two sides
-				};
-
-				int v1 = edgeIndices[i][0];
-				int v2 = edgeIndices[i][1];
-
-				// Add the coordinates of the two vertices for each edge
-				lineVerts.push_back(vertices[v1 * 3 + 0]); // x of v1
-				lineVerts.push_back(vertices[v1 * 3 + 1]); // y of v1
-				lineVerts.push_back(vertices[v1 * 3 + 2]); // z of v1
-
-				lineVerts.push_back(vertices[v2 * 3 + 0]); // x of v2
-				lineVerts.push_back(vertices[v2 * 3 + 1]); // y of v2
-				lineVerts.push_back(vertices[v2 * 3 + 2]); // z of v2
+				boxVertices[i * 2] = corners[BOX_EDGES[i][0]];
+				boxVertices[i * 2 + 1] = corners[BOX_EDGES[i][1]];
 			}
 		}
 
-		if (!lineVerts.empty())
-		{
-			GLuint lineVAO;
-			GLuint lineVBO;
-
-			glGenVertexArrays(1, &lineVAO);
-			glGenBuffers(1, &lineVBO);
-			glBindVertexArray(lineVAO);
-			glBindBuffer(GL_ARRAY_BUFFER, lineVBO);
-			glBufferData(GL_ARRAY_BUFFER, lineVerts.size() * sizeof(float), &lineVerts[0], GL_STATIC_DRAW);
-			glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), nullptr);
-			glEnableVertexAttribArray(0);
-
-			this->shaderManager.getShader(ShaderType::SOLID)->use();
-			glBindVertexArray(lineVAO);
-			glLineWidth(25.0f);
-			glDrawArrays(GL_LINES, 0, lineVerts.size() / 3);
-			lineVerts.clear();
-
-			glDeleteVertexArrays(1, &lineVAO);
-			glDeleteBuffers(1, &lineVBO);
-		}
+		this->shaderManager.getShader(ShaderType::SOLID)->use();
+		glLineWidth(25.0f);
+		this->debugLinesBuffer->draw(GL_LINES);
 	}
 
+	this->lineVerts.clear();
+
 	// Disable stencil writes
 	glStencilMask(0x00);
 }
 
-void Renderer::outlinePass(const std::vector<Entity*>& outlineRenderList)
+void Renderer::outlinePass(const std::vector<MeshComponent*>& outlineRenderList)
 {
 	glStencilFunc(GL_NOTEQUAL, 1, 0xFF);
 	// Disable depth test before drawing outlines
@@ -703,20 +665,12 @@ void Renderer::outlinePass(const std::vector<Entity*>& outlineRenderList)
 	Shader* outlineShader = this->shaderManager.getShader(ShaderType::OUTLINE);
 	outlineShader->use();
 
-	for (Entity* outlinedEntity : outlineRenderList)
-	{
-		auto* mesh = outlinedEntity->getComponent<MeshComponent>();
-		glm::vec3 originalScale = outlinedEntity->getTransform()->getScale();
-		Shader* originalShader = mesh->material->shaderProgram;
-
-		mesh->material->shaderProgram = outlineShader;
+	// The scale is applied last in the model matrix, so scaling the object in local space is the same as changing its scale
+	const glm::mat4 outlineScale = glm::scale(glm::mat4(1.0f), glm::vec3(Renderer::OUTLINE_SCALE));
 
-		outlinedEntity->getTransform()->setScale(originalScale * 1.1f);
-		outlinedEntity->update(0);
-		outlinedEntity->getTransform()->setScale(originalScale);
-
-		mesh->material->shaderProgram = originalShader;
-	}
+	// Only the geometry is drawn, the entities don't need to be updated again
+	for (MeshComponent* mesh : outlineRenderList)
+		mesh->drawGeometry(outlineShader, mesh->parent->getTransform()->getModelMatrix() * outlineScale);
 
 	// Reenable depth test after drawing outlines
 	glStencilFunc(GL_ALWAYS, 1, 0xFF);
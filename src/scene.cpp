@@ -82,6 +82,9 @@ void Scene::getMeshesRecursively(Frustum& cameraFrustum, const std::vector<Entit
 				if (cameraFrustum.isOnFrustum(mesh->getWorldBoundingBox()))
 				{
 					this->sortedSceneData.meshes.push_back(mesh);
+					mesh->selectLod(cameraFrustum.cameraPosition, cameraFrustum.projectionScale);
+					mesh->requestTextureLevels(cameraFrustum.cameraPosition, cameraFrustum.projectionScale);
+					mesh->cullMeshlets(cameraFrustum);
 
 					auto* pbrMat = dynamic_cast<PBRMaterial*>(mesh->material.get());
 					if (pbrMat->getIsTransparent())
@@ -93,7 +96,7 @@ void Scene::getMeshesRecursively(Frustum& cameraFrustum, const std::vector<Entit
 						this->sortedSceneData.renderList[mesh->material->shaderProgram].push_back(entity);
 
 					if (entity->drawOutline)
-						this->sortedSceneData.outlineRenderList.push_back(entity);
+						this->sortedSceneData.outlineRenderList.push_back(mesh);
 				}
 				else // If it is outside the frustum, we still want to update any physics
 				{
@@ -109,3 +112,16 @@ void Scene::getMeshesRecursively(Frustum& cameraFrustum, const std::vector<Entit
 		}
 	}
 }
+
+Entity* Scene::raycast(const Ray& ray, RayHit& hit) const
+{
+	Entity* hitEntity = nullptr;
+
+	for (MeshComponent* mesh : this->sortedSceneData.allMeshes)
+	{
+		if (mesh->raycast(ray, hit))
+			hitEntity = mesh->parent;
+	}
+
+	return hitEntity;
+}
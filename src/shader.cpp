@@ -1,4 +1,5 @@
 #include <string>
+#include <vector>
 #include <fstream>
 #include <sstream>
 
@@ -160,6 +161,7 @@ bool Shader::compileShader()
 
 	// We can replace the new ID if everything succeeded
 	this->ID = newID;
+	this->resolveUniformLocations();
 
 	Logger::logInfo("Successfully compiled shader!", "shader.cpp");
 	this->wasRecompiled = true;
@@ -172,82 +174,168 @@ GLuint Shader::getID() const
 	return this->ID;
 }
 
-Shader* Shader::setBool(const std::string& name, bool value)
+size_t Shader::getByteSize() const
 {
-	glUniform1i(this->getUniformLocation(name), static_cast<int>(value));
+	if (this->ID == 0)
+		return 0;
+
+	GLint binaryLength = 0;
+	glGetProgramiv(this->ID, GL_PROGRAM_BINARY_LENGTH, &binaryLength);
+
+	return static_cast<size_t>(binaryLength);
+}
+
+Shader* Shader::setBool(Uniform uniform, bool value)
+{
+	glUniform1i(this->getUniformLocation(uniform), static_cast<int>(value));
 	return this;
 }
 
-Shader* Shader::setInt(const std::string& name, int value)
+Shader* Shader::setInt(Uniform uniform, int value)
 {
-	glUniform1i(this->getUniformLocation(name), value);
+	glUniform1i(this->getUniformLocation(uniform), value);
 	return this;
 }
 
-Shader* Shader::setFloat(const std::string& name, float value)
+Shader* Shader::setFloat(Uniform uniform, float value)
 {
-	glUniform1f(this->getUniformLocation(name), value);
+	glUniform1f(this->getUniformLocation(uniform), value);
 	return this;
 }
 
-Shader* Shader::setVec2(const std::string& name, const glm::vec2& value)
+Shader* Shader::setFloatArray(Uniform uniform, const float* values, int count)
 {
-	glUniform2fv(this->getUniformLocation(name), 1, &value[0]);
+	glUniform1fv(this->getUniformLocation(uniform), count, values);
 	return this;
 }
 
-Shader* Shader::setVec2(const std::string& name, float x, float y)
+Shader* Shader::setVec2(Uniform uniform, const glm::vec2& value)
 {
-	glUniform2f(this->getUniformLocation(name), x, y);
+	glUniform2fv(this->getUniformLocation(uniform), 1, &value[0]);
 	return this;
 }
 
-Shader* Shader::setVec3(const std::string& name, const glm::vec3& value)
+Shader* Shader::setVec2(Uniform uniform, float x, float y)
 {
-	glUniform3fv(this->getUniformLocation(name), 1, &value[0]);
+	glUniform2f(this->getUniformLocation(uniform), x, y);
 	return this;
 }
 
-Shader* Shader::setVec3(const std::string& name, float x, float y, float z)
+Shader* Shader::setVec3(Uniform uniform, const glm::vec3& value)
 {
-	glUniform3f(this->getUniformLocation(name), x, y, z);
+	glUniform3fv(this->getUniformLocation(uniform), 1, &value[0]);
 	return this;
 }
 
-Shader* Shader::setVec4(const std::string& name, const glm::vec4& value)
+Shader* Shader::setVec3(Uniform uniform, float x, float y, float z)
 {
-	glUniform4fv(this->getUniformLocation(name), 1, &value[0]);
+	glUniform3f(this->getUniformLocation(uniform), x, y, z);
 	return this;
 }
 
-Shader* Shader::setVec4(const std::string& name, float x, float y, float z, float w)
+Shader* Shader::setVec3Array(Uniform uniform, const glm::vec3* values, int count)
 {
-	glUniform4f(this->getUniformLocation(name), x, y, z, w);
+	glUniform3fv(this->getUniformLocation(uniform), count, &values[0][0]);
 	return this;
 }
 
-Shader* Shader::setMat2(const std::string& name, const glm::mat2& value)
+Shader* Shader::setVec4(Uniform uniform, const glm::vec4& value)
 {
-	glUniformMatrix2fv(this->getUniformLocation(name), 1, GL_FALSE, &value[0][0]);
+	glUniform4fv(this->getUniformLocation(uniform), 1, &value[0]);
 	return this;
 }
 
-Shader* Shader::setMat3(const std::string& name, const glm::mat3& value)
+Shader* Shader::setVec4(Uniform uniform, float x, float y, float z, float w)
 {
-	glUniformMatrix3fv(this->getUniformLocation(name), 1, GL_FALSE, &value[0][0]);
+	glUniform4f(this->getUniformLocation(uniform), x, y, z, w);
 	return this;
 }
 
-Shader* Shader::setMat4(const std::string& name, const glm::mat4& value)
+Shader* Shader::setMat2(Uniform uniform, const glm::mat2& value)
 {
-	glUniformMatrix4fv(this->getUniformLocation(name), 1, GL_FALSE, &value[0][0]);
+	glUniformMatrix2fv(this->getUniformLocation(uniform), 1, GL_FALSE, &value[0][0]);
 	return this;
 }
 
-GLuint Shader::getUniformLocation(const std::string& uniformName)
+Shader* Shader::setMat3(Uniform uniform, const glm::mat3& value)
+{
+	glUniformMatrix3fv(this->getUniformLocation(uniform), 1, GL_FALSE, &value[0][0]);
+	return this;
+}
+
+Shader* Shader::setMat4(Uniform uniform, const glm::mat4& value)
+{
+	glUniformMatrix4fv(this->getUniformLocation(uniform), 1, GL_FALSE, &value[0][0]);
+	return this;
+}
+
+Shader* Shader::setMat4Array(Uniform uniform, const glm::mat4* values, int count)
+{
+	glUniformMatrix4fv(this->getUniformLocation(uniform), count, GL_FALSE, &values[0][0][0]);
+	return this;
+}
+
+void Shader::resolveUniformLocations()
+{
+	this->uniformLocations.clear();
+
+	GLint uniformCount = 0;
+	GLint maxNameLength = 0;
+	glGetProgramiv(this->ID, GL_ACTIVE_UNIFORMS, &uniformCount);
+	glGetProgramiv(this->ID, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxNameLength);
+
+	std::vector<char> nameBuffer(maxNameLength + 1);
+
+	for (GLint i = 0; i < uniformCount; i++)
+	{
+		GLsizei nameLength = 0;
+		GLint arraySize = 0;
+		GLenum type = 0;
+		glGetActiveUniform(this->ID, i, static_cast<GLsizei>(nameBuffer.size()), &nameLength, &arraySize, &type, nameBuffer.data());
+
+		std::string uniformName(nameBuffer.data(), nameLength);
+		GLint location = glGetUniformLocation(this->ID, uniformName.c_str());
+
+		// Uniforms that are part of a uniform block don't have a location
+		if (location == -1)
+			continue;
+
+		this->addUniformLocation(uniformName, location);
+
+		// Arrays of basic types are only listed once as "name[0]", so we register the array name and every element
+		const std::string firstElementSuffix = "[0]";
+		if (uniformName.size() > firstElementSuffix.size()
+			&& uniformName.compare(uniformName.size() - firstElementSuffix.size(), firstElementSuffix.size(), firstElementSuffix) == 0)
+		{
+			std::string arrayName = uniformName.substr(0, uniformName.size() - firstElementSuffix.size());
+			this->addUniformLocation(arrayName, location);
+
+			for (GLint element = 1; element < arraySize; element++)
+			{
+				std::string elementName = arrayName + "[" + std::to_string(element) + "]";
+				this->addUniformLocation(elementName, glGetUniformLocation(this->ID, elementName.c_str()));
+			}
+		}
+	}
+}
+
+void Shader::addUniformLocation(const std::string& uniformName, GLint location)
 {
-	if (this->locationCache.count(uniformName) == 0)
-		this->locationCache[uniformName] = glGetUniformLocation(this->ID, uniformName.c_str());
+	Uniform uniform(uniformName);
+
+	auto existing = this->uniformLocations.find(uniform.hash);
+	if (existing != this->uniformLocations.end() && existing->second != location)
+		Logger::logWarning("Uniform name hash collision for " + uniformName + " in shader " + this->vertexPath, "shader.cpp");
+
+	this->uniformLocations[uniform.hash] = location;
+}
 
-	return this->locationCache[uniformName];
-}
\ No newline at end of file
+GLint Shader::getUniformLocation(Uniform uniform) const
+{
+	auto location = this->uniformLocations.find(uniform.hash);
+
+	if (location == this->uniformLocations.end())
+		return -1;
+
+	return location->second;
+}
@@ -4,6 +4,7 @@
 
 #include "shaderManager.hpp"
 #include "logger.hpp"
+#include "utilities/resourceManager.hpp"
 
 ShaderManager::ShaderManager() = default;
 
@@ -13,8 +14,8 @@ void ShaderManager::end()
 {
 	glDeleteBuffers(1, &this->UBO);
 
-	for (auto&& [type, shader] : this->enumToShader)
-		delete shader;
+	// The programs are freed by the ResourceManager once nothing references them
+	this->enumToShader.clear();
 }
 
 void ShaderManager::initUniformBuffer()
@@ -41,68 +42,77 @@ void ShaderManager::updateUniformBuffer(glm::mat4 view, glm::mat4 projection) co
 Shader* ShaderManager::getShader(ShaderType shader)
 {
 	if (enumToShader.count(shader) > 0)
-		return enumToShader[shader];
+		return enumToShader[shader].get();
+
+	// The program might still be cached from an earlier renderer
+	if (ResourceHandle<Shader> cachedProgram = ResourceManager::getInstance().find<Shader>(ResourceType::SHADER, static_cast<uint64_t>(shader)))
+	{
+		enumToShader[shader] = cachedProgram;
+		return cachedProgram.get();
+	}
+
+	std::shared_ptr<Shader> program;
 
 	switch (shader)
 	{
 		case ShaderType::PHONG:
-			enumToShader[shader] = new Shader("shaders/phong.vert", "shaders/phong.frag");
+			program = std::make_shared<Shader>("shaders/phong.vert", "shaders/phong.frag");
 			break;
 
 		case ShaderType::PBR:
-			enumToShader[shader] = new Shader("shaders/pbr.vert", "shaders/pbr.frag");
+			program = std::make_shared<Shader>("shaders/pbr.vert", "shaders/pbr.frag");
 			break;
 
 		case ShaderType::SKYBOX:
-			enumToShader[shader] = new Shader("shaders/skybox.vert", "shaders/skybox.frag");
+			program = std::make_shared<Shader>("shaders/skybox.vert", "shaders/skybox.frag");
 			break;
 
 		case ShaderType::GRID:
-			enumToShader[shader] = new Shader("shaders/grid.vert", "shaders/grid.frag");
+			program = std::make_shared<Shader>("shaders/grid.vert", "shaders/grid.frag");
 			break;
 
 		case ShaderType::HDRTOCUBEMAP:
-			enumToShader[shader] = new Shader("shaders/cubemap.vert", "shaders/equirectangularToCubeMap.frag");
+			program = std::make_shared<Shader>("shaders/cubemap.vert", "shaders/equirectangularToCubeMap.frag");
 			break;
 
 		case ShaderType::IRRADIANCE:
-			enumToShader[shader] = new Shader("shaders/cubemap.vert", "shaders/irradiance.frag");
+			program = std::make_shared<Shader>("shaders/cubemap.vert", "shaders/irradiance.frag");
 			break;
 
 		case ShaderType::PREFILTER:
-			enumToShader[shader] = new Shader("shaders/cubemap.vert", "shaders/prefilter.frag");
+			program = std::make_shared<Shader>("shaders/cubemap.vert", "shaders/prefilter.frag");
 			break;
 
 		case ShaderType::BRDF:
-			enumToShader[shader] = new Shader("shaders/brdf.vert", "shaders/brdf.frag");
+			program = std::make_shared<Shader>("shaders/brdf.vert", "shaders/brdf.frag");
 			break;
 
 		case ShaderType::SOLID:
-			enumToShader[shader] = new Shader("shaders/solid.vert", "shaders/solid.frag");
+			program = std::make_shared<Shader>("shaders/solid.vert", "shaders/solid.frag");
 			break;
 
 		case ShaderType::OUTLINE:
-			enumToShader[shader] = new Shader("shaders/outline.vert", "shaders/outline.frag");
+			program = std::make_shared<Shader>("shaders/outline.vert", "shaders/outline.frag");
 			break;
 
 		case ShaderType::DEPTH:
-			enumToShader[shader] = new Shader("shaders/depth.vert", "shaders/depth.frag");
+			program = std::make_shared<Shader>("shaders/depth.vert", "shaders/depth.frag");
 			break;
 
 		case ShaderType::DEPTH_CASCADED:
-			enumToShader[shader] = new Shader("shaders/depth.vert", "shaders/depth.frag", "shaders/depth.geom");
+			program = std::make_shared<Shader>("shaders/depth.vert", "shaders/depth.frag", "shaders/depth.geom");
 			break;
 
 		case ShaderType::GBUFFER:
-			enumToShader[shader] = new Shader("shaders/gBuffer.vert", "shaders/gBuffer.frag");
+			program = std::make_shared<Shader>("shaders/gBuffer.vert", "shaders/gBuffer.frag");
 			break;
 
 		case ShaderType::SSAO:
-			enumToShader[shader] = new Shader("shaders/ssao.vert", "shaders/ssao.frag");
+			program = std::make_shared<Shader>("shaders/ssao.vert", "shaders/ssao.frag");
 			break;
 
 		case ShaderType::SSAOBLUR:
-			enumToShader[shader] = new Shader("shaders/ssaoBlur.vert", "shaders/ssaoBlur.frag");
+			program = std::make_shared<Shader>("shaders/ssaoBlur.vert", "shaders/ssaoBlur.frag");
 			break;
 
 		default:
@@ -110,12 +120,14 @@ Shader* ShaderManager::getShader(ShaderType shader)
 			return nullptr;
 	}
 
-	unsigned int UBIShader = glGetUniformBlockIndex(enumToShader[shader]->getID(), "Matrices");
+	unsigned int UBIShader = glGetUniformBlockIndex(program->getID(), "Matrices");
 
 	if (UBIShader != GL_INVALID_INDEX)
-		glUniformBlockBinding(enumToShader[shader]->getID(), UBIShader, 0);
+		glUniformBlockBinding(program->getID(), UBIShader, 0);
+
+	enumToShader[shader] = ResourceManager::getInstance().add<Shader>(ResourceType::SHADER, static_cast<uint64_t>(shader), std::move(program));
 
-	return enumToShader[shader];
+	return enumToShader[shader].get();
 }
 
 std::string ShaderManager::getVertexShaderContent(ShaderType shader)
@@ -5,8 +5,11 @@
 layout (location = 0) in vec3 aPos;
 
 uniform mat4 model;
+uniform vec3 positionOffset; // Quantized positions are brought back to object space with positionOffset + aPos * positionScale
+uniform vec3 positionScale;
 
 void main()
 {
-    gl_Position = model * vec4(aPos, 1.0);
+    vec3 position = positionOffset + aPos * positionScale;
+    gl_Position = model * vec4(position, 1.0);
 }
\ No newline at end of file
@@ -2,9 +2,8 @@
 
 layout (location = 0) in vec3 aPos;
 layout (location = 1) in vec2 aTexCoord;
-layout (location = 2) in vec3 aNormal;
-layout (location = 3) in vec3 aTangent;
-layout (location = 4) in vec3 aBitangent;
+layout (location = 2) in vec4 aNormal;
+layout (location = 3) in vec4 aTangent; // w holds the handedness of the tangent space
 
 out vec3 FragPos;
 out vec2 TexCoord;
@@ -12,6 +11,8 @@ out vec3 Normal;
 out mat3 TBN;
 
 uniform mat4 model;
+uniform vec3 positionOffset; // Quantized positions are brought back to object space with positionOffset + aPos * positionScale
+uniform vec3 positionScale;
 uniform mat3 normalMatrix;
 
 layout (std140) uniform Matrices
@@ -20,17 +21,33 @@ layout (std140) uniform Matrices
 	mat4 projection;
 };
 
+// Normals and tangents are octahedral encoded in the xy components
+vec3 octahedralDecode(vec2 encoded)
+{
+	vec3 v = vec3(encoded, 1.0 - abs(encoded.x) - abs(encoded.y));
+	if (v.z < 0.0)
+		v.xy = (1.0 - abs(v.yx)) * vec2(v.x >= 0.0 ? 1.0 : -1.0, v.y >= 0.0 ? 1.0 : -1.0);
+
+	return normalize(v);
+}
+
 void main()
 {
-	vec4 viewPos = view * model * vec4(aPos, 1.0);
+	vec3 position = positionOffset + aPos * positionScale;
+	vec3 normal = octahedralDecode(aNormal.xy);
+	vec3 tangent = octahedralDecode(aTangent.xy);
+	// Only the sign of w is stored, reading it explicitly avoids the -1/3 the pre 4.2 snorm rule decodes -1 to
+	float bitangentSign = aTangent.w < 0.0 ? -1.0 : 1.0;
+
+	vec4 viewPos = view * model * vec4(position, 1.0);
     gl_Position = projection * viewPos;
 
     FragPos = viewPos.xyz;
 	TexCoord = aTexCoord;
-	Normal = vec3(view * model * vec4(normalMatrix * aNormal, 1.0));
+	Normal = vec3(view * model * vec4(normalMatrix * normal, 1.0));
 
-	vec3 T = normalize(vec3(view * model * vec4(aTangent, 0.0)));
-	vec3 B = normalize(vec3(view * model * vec4(aBitangent, 0.0)));
-	vec3 N = normalize(vec3(view * model * vec4(aNormal, 0.0)));
+	vec3 T = normalize(vec3(view * model * vec4(tangent, 0.0)));
+	vec3 N = normalize(vec3(view * model * vec4(normal, 0.0)));
+	vec3 B = cross(N, T) * bitangentSign;
 	TBN = mat3(T, B, N);
 }
\ No newline at end of file
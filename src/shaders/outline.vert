@@ -5,6 +5,8 @@
 layout (location = 0) in vec3 aPos;
 
 uniform mat4 model;
+uniform vec3 positionOffset; // Quantized positions are brought back to object space with positionOffset + aPos * positionScale
+uniform vec3 positionScale;
 
 layout (std140) uniform Matrices
 {
@@ -14,5 +16,6 @@ layout (std140) uniform Matrices
 
 void main()
 {
-	gl_Position = projection * view * model * vec4(aPos, 1.0);
+	vec3 position = positionOffset + aPos * positionScale;
+	gl_Position = projection * view * model * vec4(position, 1.0);
 }
\ No newline at end of file
@@ -190,8 +190,9 @@ void main()
 	vec3 normalVec;
 	if (material.use_normal_map)
 	{
-		normalVec = texture(material.texture_normal, TexCoord).rgb;
-		normalVec = normalVec * 2.0 - 1.0;
+		// Z is rebuilt from X and Y, compressed normal maps only store two channels
+		normalVec.xy = texture(material.texture_normal, TexCoord).rg * 2.0 - 1.0;
+		normalVec.z = sqrt(max(1.0 - dot(normalVec.xy, normalVec.xy), 0.0));
         normalVec = normalize(TBN * normalVec);
 	}
 	else
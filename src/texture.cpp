@@ -1,8 +1,38 @@
+#include <algorithm>
+
 #include <utilities/glad.h>
 #include <utilities/stb_image.h>
 
 #include "texture.hpp"
 #include "logger.hpp"
+#include "utilities/textureCompression.hpp"
+#include "utilities/textureStreamer.hpp"
+
+namespace
+{
+	/// <summary>
+	/// Returns the number of bytes of an uncompressed image with its full mip chain, which adds a third to the base level
+	/// </summary>
+	size_t getMipmappedByteSize(int width, int height, int bytesPerPixel)
+	{
+		return static_cast<size_t>(width) * height * bytesPerPixel * 4 / 3;
+	}
+
+	int getChannelCount(GLenum format)
+	{
+		switch (format)
+		{
+			case GL_RED:
+				return 1;
+			case GL_RG:
+				return 2;
+			case GL_RGB:
+				return 3;
+			default:
+				return 4;
+		}
+	}
+}
 
 Texture::Texture()
 {
@@ -23,8 +53,44 @@ Texture::Texture(const std::string& filename, TextureType textureType, bool isHD
 Texture::Texture(TextureType textureType, int width, int height, GLenum format, const void* textureData)
 {
 	this->type = textureType;
+	this->upload(width, height, format, textureData);
+}
+
+Texture::Texture(GLuint texture, TextureType textureType)
+{
+	this->texID = texture;
+	this->type = textureType;
+}
+
+Texture::Texture(TextureType textureType, const CompressedImage& image)
+{
+	this->type = textureType;
+	this->uploadCompressed(image);
+}
+
+Texture::~Texture()
+{
+	if (this->streamedImage != nullptr && this->texID != 0)
+		TextureStreamer::getInstance().unregisterTexture(this);
+
+	// Textures waiting for their upload were never created
+	if (this->texID != 0)
+		glDeleteTextures(1, &this->texID);
+}
+
+void Texture::bindTexture() const
+{
+	if (this->type == TextureType::TEXTURE_3D)
+		glBindTexture(GL_TEXTURE_2D_ARRAY, this->texID);
+	else
+		glBindTexture(GL_TEXTURE_2D, this->texID);
+}
+
+void Texture::upload(int width, int height, GLenum format, const void* textureData)
+{
 	this->width = width;
 	this->height = height;
+	this->format = format;
 
 	// Create OpenGL texture
 	glGenTextures(1, &texID);
@@ -38,25 +104,139 @@ Texture::Texture(TextureType textureType, int width, int height, GLenum format,
 
 	glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, textureData);
 	glGenerateMipmap(GL_TEXTURE_2D);
+
+	this->byteSize = getMipmappedByteSize(width, height, getChannelCount(format));
 }
 
-Texture::Texture(GLuint texture, TextureType textureType)
+void Texture::uploadCompressed(const CompressedImage& image)
 {
-	this->texID = texture;
-	this->type = textureType;
+	if (image.levels.empty())
+		return;
+
+	this->width = image.levels[0].width;
+	this->height = image.levels[0].height;
+	this->format = TextureCompression::getBaseFormat(image.format);
+	this->byteSize = image.getByteSize();
+
+	GLenum internalFormat = TextureCompression::getInternalFormat(image.format);
+
+	glGenTextures(1, &this->texID);
+	glBindTexture(GL_TEXTURE_2D, this->texID);
+
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, static_cast<GLint>(image.levels.size()) - 1);
+	glTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_RGBA, image.swizzle);
+
+	// The mip levels were generated before compression, the driver can't generate them for compressed textures
+	for (size_t i = 0; i < image.levels.size(); i++)
+	{
+		const CompressedLevel& level = image.levels[i];
+		glCompressedTexImage2D(GL_TEXTURE_2D, static_cast<GLint>(i), internalFormat, level.width, level.height, 0, static_cast<GLsizei>(level.data.size()), level.data.data());
+	}
 }
 
-Texture::~Texture()
+void Texture::uploadStreamed(std::shared_ptr<const MappedImage> image)
 {
-	glDeleteTextures(1, &this->texID);
+	if (image == nullptr || image->levels.empty())
+		return;
+
+	this->streamedImage = std::move(image);
+
+	this->width = this->streamedImage->levels[0].width;
+	this->height = this->streamedImage->levels[0].height;
+	this->format = TextureCompression::getBaseFormat(this->streamedImage->format);
+
+	this->floorLevel = TextureStreamer::getFloorLevel(*this->streamedImage);
+	this->requestedLevel = this->floorLevel;
+
+	// No level is on the GPU yet
+	this->residentLevel = static_cast<int>(this->streamedImage->levels.size());
+
+	glGenTextures(1, &this->texID);
+	glBindTexture(GL_TEXTURE_2D, this->texID);
+
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, static_cast<GLint>(this->streamedImage->levels.size()) - 1);
+	glTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_RGBA, this->streamedImage->swizzle);
+
+	this->setResidentLevel(this->floorLevel);
+
+	TextureStreamer::getInstance().registerTexture(this);
 }
 
-void Texture::bindTexture() const
+void Texture::setResidentLevel(int level)
 {
-	if (this->type == TextureType::TEXTURE_3D)
-		glBindTexture(GL_TEXTURE_2D_ARRAY, this->texID);
+	if (this->streamedImage == nullptr || this->texID == 0)
+		return;
+
+	level = std::clamp(level, 0, this->floorLevel);
+
+	if (level == this->residentLevel)
+		return;
+
+	GLenum internalFormat = TextureCompression::getInternalFormat(this->streamedImage->format);
+
+	glBindTexture(GL_TEXTURE_2D, this->texID);
+
+	if (level < this->residentLevel)
+	{
+		for (int i = level; i < this->residentLevel; i++)
+		{
+			// The driver copies the blocks straight from the mapping, the pages are read from the cache file then
+			const MappedLevel& mappedLevel = this->streamedImage->levels[i];
+			glCompressedTexImage2D(GL_TEXTURE_2D, i, internalFormat, mappedLevel.width, mappedLevel.height, 0, static_cast<GLsizei>(mappedLevel.size), this->streamedImage->getLevelData(i));
+		}
+
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, level);
+	}
 	else
-		glBindTexture(GL_TEXTURE_2D, this->texID);
+	{
+		// The sampler stops using the levels before they are freed, respecifying them as empty releases their memory
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, level);
+
+		for (int i = this->residentLevel; i < level; i++)
+			glCompressedTexImage2D(GL_TEXTURE_2D, i, internalFormat, 0, 0, 0, 0, nullptr);
+	}
+
+	this->residentLevel = level;
+}
+
+void Texture::requestLevel(int level)
+{
+	if (this->streamedImage == nullptr)
+		return;
+
+	uint64_t frame = TextureStreamer::getInstance().getFrame();
+
+	if (this->lastRequestFrame != frame)
+	{
+		this->requestedLevel = level;
+		this->lastRequestFrame = frame;
+	}
+	else
+		this->requestedLevel = std::min(this->requestedLevel, level);
+}
+
+size_t Texture::getResidentByteSize() const
+{
+	if (this->streamedImage == nullptr)
+		return 0;
+
+	return TextureStreamer::getLevelsByteSize(*this->streamedImage, this->residentLevel);
+}
+
+size_t Texture::getByteSize() const
+{
+	if (this->streamedImage != nullptr)
+		return this->getResidentByteSize();
+
+	return this->byteSize;
 }
 
 void Texture::createTexture(const std::string& filename, TextureType textureType, bool stbiFlipOnLoad)
@@ -94,6 +274,8 @@ void Texture::createTexture(const std::string& filename, TextureType textureType
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 
 		stbi_image_free(data);
+
+		this->byteSize = getMipmappedByteSize(width, height, nrChannels);
 	}
 	else
 		Logger::logError(std::string("Failed to load texture: ") + filename, "texture.cpp");
@@ -123,6 +305,9 @@ void Texture::createHDRTexture(const std::string& filename, TextureType textureT
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 
 		stbi_image_free(data);
+
+		// Three half floats per pixel, without mip levels
+		this->byteSize = static_cast<size_t>(width) * height * 6;
 	}
 	else
 		Logger::logError(std::string("Failed to load HDR texture: ") + filename, "texture.cpp");
@@ -0,0 +1,158 @@
+#include <cstring>
+
+#include "transientBuffer.hpp"
+#include "logger.hpp"
+
+TransientBuffer::TransientBuffer(size_t vertexCapacity)
+{
+	glGenVertexArrays(1, &this->VAO);
+	glGenBuffers(1, &this->VBO);
+
+	this->resize(vertexCapacity > 0 ? vertexCapacity : 1);
+
+	glBindVertexArray(this->VAO);
+	glBindBuffer(GL_ARRAY_BUFFER, this->VBO);
+	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), nullptr);
+	glEnableVertexAttribArray(0);
+	glBindVertexArray(0);
+}
+
+TransientBuffer::~TransientBuffer()
+{
+	if (this->mappedVertices != nullptr)
+	{
+		glBindBuffer(GL_ARRAY_BUFFER, this->VBO);
+		glUnmapBuffer(GL_ARRAY_BUFFER);
+	}
+
+	for (GLsync& fence : this->fences)
+	{
+		if (fence != nullptr)
+			glDeleteSync(fence);
+	}
+
+	glDeleteBuffers(1, &this->VBO);
+	glDeleteVertexArrays(1, &this->VAO);
+}
+
+void TransientBuffer::begin()
+{
+	if (this->mappedVertices != nullptr)
+	{
+		Logger::logWarning("TransientBuffer::begin called twice without drawing", "transientBuffer.cpp");
+		return;
+	}
+
+	// Grow to fit what the last frame needed, the vertices that didn't fit were dropped for a single frame
+	if (this->requestedVertices > this->vertexCapacity)
+	{
+		size_t newCapacity = this->vertexCapacity;
+		while (newCapacity < this->requestedVertices)
+			newCapacity *= 2;
+
+		this->resize(newCapacity);
+	}
+
+	this->currentSegment = (this->currentSegment + 1) % TransientBuffer::SEGMENT_COUNT;
+	this->waitForSegment(this->currentSegment);
+
+	this->writtenVertices = 0;
+	this->requestedVertices = 0;
+
+	// The fence guarantees the GPU is done with this range, so the driver doesn't need to synchronize the mapping
+	glBindBuffer(GL_ARRAY_BUFFER, this->VBO);
+	this->mappedVertices = static_cast<glm::vec3*>(glMapBufferRange(
+		GL_ARRAY_BUFFER,
+		static_cast<GLintptr>(this->currentSegment * this->vertexCapacity * sizeof(glm::vec3)),
+		static_cast<GLsizeiptr>(this->vertexCapacity * sizeof(glm::vec3)),
+		GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT
+	));
+
+	if (this->mappedVertices == nullptr)
+		Logger::logError("Failed to map transient buffer segment", "transientBuffer.cpp");
+}
+
+glm::vec3* TransientBuffer::allocate(size_t vertexCount)
+{
+	this->requestedVertices += vertexCount;
+
+	if (this->mappedVertices == nullptr || this->writtenVertices + vertexCount > this->vertexCapacity)
+		return nullptr;
+
+	glm::vec3* vertices = this->mappedVertices + this->writtenVertices;
+	this->writtenVertices += vertexCount;
+
+	return vertices;
+}
+
+void TransientBuffer::write(const glm::vec3* vertices, size_t vertexCount)
+{
+	if (vertexCount == 0)
+		return;
+
+	glm::vec3* destination = this->allocate(vertexCount);
+
+	if (destination != nullptr)
+		std::memcpy(destination, vertices, vertexCount * sizeof(glm::vec3));
+}
+
+void TransientBuffer::draw(GLenum mode)
+{
+	if (this->mappedVertices == nullptr)
+		return;
+
+	glBindBuffer(GL_ARRAY_BUFFER, this->VBO);
+	glUnmapBuffer(GL_ARRAY_BUFFER);
+	this->mappedVertices = nullptr;
+
+	if (this->writtenVertices == 0)
+		return;
+
+	glBindVertexArray(this->VAO);
+	glDrawArrays(mode, static_cast<GLint>(this->currentSegment * this->vertexCapacity), static_cast<GLsizei>(this->writtenVertices));
+
+	this->fences[this->currentSegment] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+size_t TransientBuffer::getVertexCapacity() const
+{
+	return this->vertexCapacity;
+}
+
+void TransientBuffer::resize(size_t newVertexCapacity)
+{
+	// Reallocating the storage orphans the old one, the driver keeps it alive until the GPU is done with it
+	for (GLsync& fence : this->fences)
+	{
+		if (fence != nullptr)
+		{
+			glDeleteSync(fence);
+			fence = nullptr;
+		}
+	}
+
+	this->vertexCapacity = newVertexCapacity;
+
+	glBindBuffer(GL_ARRAY_BUFFER, this->VBO);
+	glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(TransientBuffer::SEGMENT_COUNT * newVertexCapacity * sizeof(glm::vec3)), nullptr, GL_STREAM_DRAW);
+}
+
+void TransientBuffer::waitForSegment(int segment)
+{
+	GLsync& fence = this->fences[segment];
+
+	if (fence == nullptr)
+		return;
+
+	GLenum result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+
+	// 1 ms timeout, in practice the segment is almost always free since it was drawn two frames ago
+	while (result == GL_TIMEOUT_EXPIRED)
+		result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000);
+
+	if (result == GL_WAIT_FAILED)
+		Logger::logError("Failed to wait on transient buffer fence", "transientBuffer.cpp");
+
+	glDeleteSync(fence);
+	fence = nullptr;
+}
@@ -0,0 +1,144 @@
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <cstdio>
+#include <filesystem>
+
+#include "utilities/mappedFile.hpp"
+
+#ifdef _WIN32
+MappedFile::MappedFile(const std::string& path)
+{
+	HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+
+	if (file == INVALID_HANDLE_VALUE)
+		return;
+
+	this->fileHandle = file;
+
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0)
+		return;
+
+	HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+
+	if (mapping == nullptr)
+		return;
+
+	this->mappingHandle = mapping;
+
+	void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+
+	if (view == nullptr)
+		return;
+
+	this->data = static_cast<const unsigned char*>(view);
+	this->size = static_cast<size_t>(fileSize.QuadPart);
+}
+
+MappedFile::~MappedFile()
+{
+	if (this->data != nullptr)
+		UnmapViewOfFile(this->data);
+
+	if (this->mappingHandle != nullptr)
+		CloseHandle(this->mappingHandle);
+
+	if (this->fileHandle != nullptr)
+		CloseHandle(this->fileHandle);
+}
+#else
+MappedFile::MappedFile(const std::string& path)
+{
+	this->fileDescriptor = open(path.c_str(), O_RDONLY);
+
+	if (this->fileDescriptor < 0)
+		return;
+
+	struct stat fileStatus = {};
+	if (fstat(this->fileDescriptor, &fileStatus) != 0 || fileStatus.st_size == 0)
+		return;
+
+	void* mapping = mmap(nullptr, static_cast<size_t>(fileStatus.st_size), PROT_READ, MAP_PRIVATE, this->fileDescriptor, 0);
+
+	if (mapping == MAP_FAILED)
+		return;
+
+	// The file is read from start to end, this lets the kernel read ahead
+	madvise(mapping, static_cast<size_t>(fileStatus.st_size), MADV_SEQUENTIAL);
+
+	this->data = static_cast<const unsigned char*>(mapping);
+	this->size = static_cast<size_t>(fileStatus.st_size);
+}
+
+MappedFile::~MappedFile()
+{
+	if (this->data != nullptr)
+		munmap(const_cast<unsigned char*>(this->data), this->size);
+
+	if (this->fileDescriptor >= 0)
+		close(this->fileDescriptor);
+}
+#endif
+
+bool MappedFile::isOpen() const
+{
+	return this->data != nullptr;
+}
+
+const unsigned char* MappedFile::getData() const
+{
+	return this->data;
+}
+
+size_t MappedFile::getSize() const
+{
+	return this->size;
+}
+
+std::string CacheFile::getPath(const std::string& directory, uint64_t key, const std::string& extension)
+{
+	char name[17];
+	std::snprintf(name, sizeof(name), "%016llx", static_cast<unsigned long long>(key));
+
+	return (std::filesystem::path(directory) / (std::string(name) + extension)).string();
+}
+
+bool CacheFile::write(const std::string& path, const std::function<void(std::ofstream&)>& write, std::error_code& error)
+{
+	error.clear();
+	std::filesystem::create_directories(std::filesystem::path(path).parent_path(), error);
+
+	if (error)
+		return false;
+
+	std::string temporaryPath = path + ".tmp";
+
+	{
+		std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+		write(file);
+
+		if (!file.good())
+			error = std::make_error_code(std::errc::io_error);
+	}
+
+	if (!error)
+		std::filesystem::rename(temporaryPath, path, error);
+
+	if (error)
+	{
+		std::error_code removeError;
+		std::filesystem::remove(temporaryPath, removeError);
+		return false;
+	}
+
+	return true;
+}
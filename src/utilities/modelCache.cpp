@@ -0,0 +1,377 @@
+#include <cstring>
+#include <fstream>
+#include <type_traits>
+
+#include "utilities/modelCache.hpp"
+#include "utilities/mappedFile.hpp"
+#include "logger.hpp"
+
+namespace
+{
+	/// <summary>
+	/// The header of a model cache file, the sizes of the stored structures are checked since their layout is stored as is
+	/// </summary>
+	struct ModelCacheHeader
+	{
+		char magic[4];
+		uint32_t version;
+		uint64_t sourceHash;
+		uint32_t lodSize;
+		uint32_t meshletSize;
+		uint64_t payloadSize;
+	};
+
+	/// <summary>
+	/// Arrays start at a multiple of this in the file, so they can be read from the mapping with aligned copies
+	/// </summary>
+	constexpr size_t ARRAY_ALIGNMENT = 16;
+
+	/// <summary>
+	/// Appends values to the payload of a cache file
+	/// </summary>
+	class CacheWriter
+	{
+	public:
+		std::vector<char> buffer;
+
+		template<typename T>
+		void write(const T& value)
+		{
+			static_assert(std::is_trivially_copyable_v<T>, "Only trivially copyable values can be cached");
+
+			const auto* bytes = reinterpret_cast<const char*>(&value);
+			this->buffer.insert(this->buffer.end(), bytes, bytes + sizeof(T));
+		}
+
+		template<typename T>
+		void writeArray(const std::vector<T>& values)
+		{
+			static_assert(std::is_trivially_copyable_v<T>, "Only trivially copyable values can be cached");
+
+			this->write<uint64_t>(values.size());
+
+			// The payload follows the header, which is itself a multiple of the alignment
+			this->buffer.resize((this->buffer.size() + ARRAY_ALIGNMENT - 1) / ARRAY_ALIGNMENT * ARRAY_ALIGNMENT, 0);
+
+			const auto* bytes = reinterpret_cast<const char*>(values.data());
+			this->buffer.insert(this->buffer.end(), bytes, bytes + values.size() * sizeof(T));
+		}
+
+		void writeString(const std::string& value)
+		{
+			this->write<uint64_t>(value.size());
+			this->buffer.insert(this->buffer.end(), value.begin(), value.end());
+		}
+	};
+
+	/// <summary>
+	/// Reads values from the payload of a mapped cache file, every read is bounds checked and a failed read fails all the following ones
+	/// </summary>
+	class CacheReader
+	{
+	public:
+		bool hasFailed = false;
+
+		CacheReader(const unsigned char* data, size_t size) : data(data), size(size) {}
+
+		template<typename T>
+		T read()
+		{
+			T value = {};
+
+			if (this->canRead(sizeof(T)))
+			{
+				std::memcpy(&value, this->data + this->offset, sizeof(T));
+				this->offset += sizeof(T);
+			}
+
+			return value;
+		}
+
+		template<typename T>
+		void readArray(std::vector<T>& values)
+		{
+			auto count = this->read<uint64_t>();
+			this->offset = (this->offset + ARRAY_ALIGNMENT - 1) / ARRAY_ALIGNMENT * ARRAY_ALIGNMENT;
+
+			if (count > this->size / sizeof(T) || !this->canRead(count * sizeof(T)))
+			{
+				this->hasFailed = true;
+				return;
+			}
+
+			// One copy of the whole stream from the mapping, the data is stored exactly as it is used
+			values.resize(count);
+
+			if (count > 0)
+				std::memcpy(values.data(), this->data + this->offset, count * sizeof(T));
+
+			this->offset += count * sizeof(T);
+		}
+
+		/// <summary>
+		/// Reads the number of elements of a list, every element takes at least a byte so larger counts mean the file is corrupted
+		/// </summary>
+		uint32_t readCount()
+		{
+			auto count = this->read<uint32_t>();
+
+			if (!this->canRead(count))
+				return 0;
+
+			return count;
+		}
+
+		std::string readString()
+		{
+			auto length = this->read<uint64_t>();
+
+			if (!this->canRead(length))
+				return std::string();
+
+			std::string value(reinterpret_cast<const char*>(this->data + this->offset), length);
+			this->offset += length;
+
+			return value;
+		}
+
+	private:
+		const unsigned char* data;
+		size_t size;
+		size_t offset = 0;
+
+		bool canRead(size_t byteCount)
+		{
+			if (this->hasFailed || this->offset > this->size || byteCount > this->size - this->offset)
+				this->hasFailed = true;
+
+			return !this->hasFailed;
+		}
+	};
+}
+
+bool ModelCache::load(const std::string& path, uint64_t sourceHash, CachedModel& model)
+{
+	MappedFile file(path);
+
+	if (!file.isOpen())
+		return false;
+
+	ModelCacheHeader header = {};
+
+	if (file.getSize() < sizeof(header))
+	{
+		Logger::logWarning("Truncated model cache file " + path, "modelCache.cpp");
+		return false;
+	}
+
+	std::memcpy(&header, file.getData(), sizeof(header));
+
+	bool isValid = std::memcmp(header.magic, ModelCache::MAGIC, sizeof(header.magic)) == 0
+		&& header.version == ModelCache::VERSION
+		&& header.sourceHash == sourceHash
+		&& header.lodSize == sizeof(MeshLod)
+		&& header.meshletSize == sizeof(Meshlet)
+		&& header.payloadSize == file.getSize() - sizeof(header);
+
+	if (!isValid)
+	{
+		Logger::logWarning("Ignoring outdated model cache file " + path, "modelCache.cpp");
+		return false;
+	}
+
+	CacheReader reader(file.getData() + sizeof(header), static_cast<size_t>(header.payloadSize));
+	CachedModel loadedModel;
+
+	loadedModel.name = reader.readString();
+	loadedModel.textures.resize(reader.readCount());
+
+	for (CachedTexture& texture : loadedModel.textures)
+	{
+		texture.kind = reader.read<CachedTextureKind>();
+		texture.type = reader.read<TextureType>();
+		texture.path = reader.readString();
+		texture.width = reader.read<int32_t>();
+		texture.height = reader.read<int32_t>();
+		texture.channels = reader.read<int32_t>();
+		texture.format = reader.read<GLenum>();
+		reader.readArray(texture.data);
+
+		if (reader.hasFailed)
+			break;
+	}
+
+	loadedModel.meshes.resize(reader.readCount());
+
+	for (CachedMesh& mesh : loadedModel.meshes)
+	{
+		mesh.label = reader.readString();
+		reader.readArray(mesh.vertices);
+		reader.readArray(mesh.vertexData.bytes);
+		mesh.vertexData.vertexCount = reader.read<uint32_t>();
+		mesh.vertexData.quantized = reader.read<uint32_t>() != 0;
+		mesh.vertexData.hasTexCoords = reader.read<uint32_t>() != 0;
+		mesh.vertexData.dequantization = reader.read<VertexDequantization>();
+		mesh.vertexData.quantizationError = reader.read<QuantizationError>();
+		mesh.vertexData.texCoordDensity = reader.read<float>();
+		reader.readArray(mesh.indices);
+		reader.readArray(mesh.lods);
+		reader.readArray(mesh.meshlets);
+		reader.readArray(mesh.textures);
+		mesh.diffuseColor = reader.read<glm::vec3>();
+		mesh.metallic = reader.read<float>();
+		mesh.roughness = reader.read<float>();
+		mesh.opacity = reader.read<float>();
+
+		if (reader.hasFailed)
+			break;
+
+		// The buffers are uploaded as they are, an index past the vertices would make the GPU read outside of the vertex buffer
+		size_t vertexCount = mesh.vertexData.vertexCount;
+
+		if (mesh.vertexData.bytes.size() != vertexCount * mesh.vertexData.getVertexSize() || mesh.vertices.size() != vertexCount * 3)
+			reader.hasFailed = true;
+
+		for (unsigned int index : mesh.indices)
+		{
+			if (index >= vertexCount)
+			{
+				reader.hasFailed = true;
+				break;
+			}
+		}
+
+		// The levels of detail and meshlets slice the indices before the component checks them, so their ranges must be in bounds too
+		for (const MeshLod& lod : mesh.lods)
+		{
+			if (static_cast<uint64_t>(lod.indexOffset) + lod.indexCount > mesh.indices.size()
+				|| static_cast<uint64_t>(lod.meshletOffset) + lod.meshletCount > mesh.meshlets.size())
+				reader.hasFailed = true;
+		}
+
+		for (const Meshlet& meshlet : mesh.meshlets)
+		{
+			if (static_cast<uint64_t>(meshlet.indexOffset) + meshlet.indexCount > mesh.indices.size())
+			{
+				reader.hasFailed = true;
+				break;
+			}
+		}
+
+		for (uint32_t textureIndex : mesh.textures)
+		{
+			if (textureIndex >= loadedModel.textures.size())
+				reader.hasFailed = true;
+		}
+	}
+
+	loadedModel.nodes.resize(reader.readCount());
+
+	for (size_t i = 0; i < loadedModel.nodes.size() && !reader.hasFailed; i++)
+	{
+		CachedNode& node = loadedModel.nodes[i];
+
+		node.name = reader.readString();
+		node.transform = reader.read<glm::mat4>();
+		node.parent = reader.read<int32_t>();
+		reader.readArray(node.meshes);
+
+		if (node.parent < -1 || node.parent >= static_cast<int32_t>(i))
+			reader.hasFailed = true;
+
+		for (uint32_t meshIndex : node.meshes)
+		{
+			if (meshIndex >= loadedModel.meshes.size())
+				reader.hasFailed = true;
+		}
+	}
+
+	if (reader.hasFailed)
+	{
+		Logger::logWarning("Corrupted model cache file " + path, "modelCache.cpp");
+		return false;
+	}
+
+	model = std::move(loadedModel);
+
+	return true;
+}
+
+bool ModelCache::save(const std::string& path, uint64_t sourceHash, const CachedModel& model)
+{
+	static_assert(sizeof(ModelCacheHeader) % ARRAY_ALIGNMENT == 0, "The payload must start aligned");
+
+	CacheWriter writer;
+
+	writer.writeString(model.name);
+	writer.write<uint32_t>(static_cast<uint32_t>(model.textures.size()));
+
+	for (const CachedTexture& texture : model.textures)
+	{
+		writer.write(texture.kind);
+		writer.write(texture.type);
+		writer.writeString(texture.path);
+		writer.write<int32_t>(texture.width);
+		writer.write<int32_t>(texture.height);
+		writer.write<int32_t>(texture.channels);
+		writer.write(texture.format);
+		writer.writeArray(texture.data);
+	}
+
+	writer.write<uint32_t>(static_cast<uint32_t>(model.meshes.size()));
+
+	for (const CachedMesh& mesh : model.meshes)
+	{
+		writer.writeString(mesh.label);
+		writer.writeArray(mesh.vertices);
+		writer.writeArray(mesh.vertexData.bytes);
+		writer.write<uint32_t>(mesh.vertexData.vertexCount);
+		writer.write<uint32_t>(mesh.vertexData.quantized);
+		writer.write<uint32_t>(mesh.vertexData.hasTexCoords);
+		writer.write(mesh.vertexData.dequantization);
+		writer.write(mesh.vertexData.quantizationError);
+		writer.write(mesh.vertexData.texCoordDensity);
+		writer.writeArray(mesh.indices);
+		writer.writeArray(mesh.lods);
+		writer.writeArray(mesh.meshlets);
+		writer.writeArray(mesh.textures);
+		writer.write(mesh.diffuseColor);
+		writer.write(mesh.metallic);
+		writer.write(mesh.roughness);
+		writer.write(mesh.opacity);
+	}
+
+	writer.write<uint32_t>(static_cast<uint32_t>(model.nodes.size()));
+
+	for (const CachedNode& node : model.nodes)
+	{
+		writer.writeString(node.name);
+		writer.write(node.transform);
+		writer.write<int32_t>(node.parent);
+		writer.writeArray(node.meshes);
+	}
+
+	ModelCacheHeader header = {};
+	std::memcpy(header.magic, ModelCache::MAGIC, sizeof(header.magic));
+	header.version = ModelCache::VERSION;
+	header.sourceHash = sourceHash;
+	header.lodSize = sizeof(MeshLod);
+	header.meshletSize = sizeof(Meshlet);
+	header.payloadSize = writer.buffer.size();
+
+	std::error_code error;
+
+	bool isWritten = CacheFile::write(path, [&](std::ofstream& file)
+	{
+		file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		file.write(writer.buffer.data(), static_cast<std::streamsize>(writer.buffer.size()));
+	}, error);
+
+	if (!isWritten)
+	{
+		Logger::logWarning("Couldn't write the model cache file " + path + " - " + error.message(), "modelCache.cpp");
+		return false;
+	}
+
+	return true;
+}
@@ -0,0 +1,83 @@
+#include <algorithm>
+
+#include "utilities/primitiveLibrary.hpp"
+#include "logger.hpp"
+
+PrimitiveLibrary PrimitiveLibrary::instance;
+
+PrimitiveLibrary& PrimitiveLibrary::getInstance()
+{
+	return PrimitiveLibrary::instance;
+}
+
+std::shared_ptr<const VertexDataIndices> PrimitiveLibrary::getSphere(int slices, int stacks)
+{
+	if (slices < 3 || stacks < 2)
+	{
+		Logger::logError("Invalid sphere subdivisions, a sphere needs at least 3 slices and 2 stacks", "primitiveLibrary.cpp");
+		return nullptr;
+	}
+
+	return this->getOrGenerate({ PrimitiveType::SPHERE, slices, stacks }, [slices, stacks]() {
+		return Geometry::getIndexedSphere(slices, stacks);
+	});
+}
+
+std::shared_ptr<const VertexDataIndices> PrimitiveLibrary::getCube()
+{
+	return this->getOrGenerate({ PrimitiveType::CUBE, 0, 0 }, []() {
+		return Geometry::getIndexedCube();
+	});
+}
+
+std::shared_ptr<const MeshBvh> PrimitiveLibrary::getBvh(const std::shared_ptr<const VertexDataIndices>& primitive)
+{
+	if (primitive == nullptr)
+		return nullptr;
+
+	std::lock_guard<std::mutex> lock(this->primitivesMutex);
+
+	auto it = this->bvhs.find(primitive.get());
+	if (it != this->bvhs.end())
+		return it->second;
+
+	auto bvh = std::make_shared<const MeshBvh>(primitive->vertices, primitive->indices);
+
+	// Meshes that aren't in the cache can't be looked up again safely once released, so only cached meshes keep their BVH
+	bool isCached = std::any_of(this->primitives.begin(), this->primitives.end(), [&primitive](const auto& entry) {
+		return entry.second == primitive;
+	});
+
+	if (isCached)
+		this->bvhs.emplace(primitive.get(), bvh);
+
+	return bvh;
+}
+
+void PrimitiveLibrary::clear()
+{
+	std::lock_guard<std::mutex> lock(this->primitivesMutex);
+	this->primitives.clear();
+	this->bvhs.clear();
+}
+
+size_t PrimitiveLibrary::getCachedCount()
+{
+	std::lock_guard<std::mutex> lock(this->primitivesMutex);
+	return this->primitives.size();
+}
+
+template<typename Generator>
+std::shared_ptr<const VertexDataIndices> PrimitiveLibrary::getOrGenerate(const PrimitiveKey& key, const Generator& generate)
+{
+	std::lock_guard<std::mutex> lock(this->primitivesMutex);
+
+	auto it = this->primitives.find(key);
+	if (it != this->primitives.end())
+		return it->second;
+
+	auto primitive = std::make_shared<const VertexDataIndices>(generate());
+	this->primitives.emplace(key, primitive);
+
+	return primitive;
+}
@@ -1,15 +1,25 @@
-	#include <iostream>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <set>
 
 #include <assimp/Importer.hpp>
-#include <assimp/postprocess.h>
 #include <utilities/stb_image.h>
 
 #include "utilities/resourceLoader.hpp"
 #include "components/meshComponent.hpp"
-//#include "components/physicsComponent.hpp"
+#include "components/physicsComponent.hpp"
 #include "logger.hpp"
 #include "utilities/geometry.hpp"
+#include "utilities/hash.hpp"
+#include "utilities/mappedFile.hpp"
+#include "utilities/meshImport.hpp"
+#include "utilities/parallel.hpp"
+#include "utilities/resourceManager.hpp"
+#include "utilities/textureStreamer.hpp"
 #include "materials/pbrMaterial.hpp"
+#include "scene.hpp"
 
 ResourceLoader ResourceLoader::instance;
 
@@ -25,19 +35,230 @@ std::map<aiTextureType, TextureType> ResourceLoader::aiMatToTextureType = {
 	{ aiTextureType_EMISSIVE, TextureType::TEXTURE_EMISSIVE },
 };
 
+namespace
+{
+	/// <summary>
+	/// Adds the collider of a loaded mesh to the physics world
+	/// </summary>
+	void addMeshCollider(PhysicsWorld* physicsWorld, PhysicsComponent* physicsComponent, MeshColliderType colliderType, float mass, const ConvexDecompositionSettings& settings,
+		const std::vector<float>& vertices, const std::vector<unsigned int>& indices, const glm::mat4& transform)
+	{
+		if (colliderType == MeshColliderType::TRIANGLE_MESH)
+			physicsWorld->addTriangleMesh(physicsComponent, vertices, indices, transform);
+		else if (colliderType == MeshColliderType::CONVEX_HULL)
+			physicsWorld->addConvexHull(physicsComponent, vertices, transform, mass, settings.maxHullVertices);
+		else
+			physicsWorld->addConvexDecomposition(physicsComponent, vertices, indices, transform, mass, settings);
+	}
+
+	/// <summary>
+	/// Converts a transform of the importer, which is row major, to a glm matrix
+	/// </summary>
+	glm::mat4 toMat4(const aiMatrix4x4& matrix)
+	{
+		return glm::mat4(
+			glm::vec4(matrix.a1, matrix.b1, matrix.c1, matrix.d1),
+			glm::vec4(matrix.a2, matrix.b2, matrix.c2, matrix.d2),
+			glm::vec4(matrix.a3, matrix.b3, matrix.c3, matrix.d3),
+			glm::vec4(matrix.a4, matrix.b4, matrix.c4, matrix.d4)
+		);
+	}
+
+	/// <summary>
+	/// Returns the format of an embedded texture made of raw pixels
+	/// </summary>
+	GLenum getRawTextureFormat(const aiTexture* embeddedTexture)
+	{
+		GLenum format = GL_RGB;
+
+		// Check the format hint for a transparency layer
+		for (int j = 0; j < 4; j++)
+			if (embeddedTexture->achFormatHint[j] == 'A' && embeddedTexture->achFormatHint[j] != '0')
+				format = GL_RGBA;
+
+		return format;
+	}
+
+	/// <summary>
+	/// Returns the number of channels an embedded compressed texture is decoded to
+	/// </summary>
+	int getEncodedTextureChannels(const aiTexture* embeddedTexture)
+	{
+		// Handle transparency layer for PNG data
+		if (embeddedTexture->achFormatHint[0] == 'p' && embeddedTexture->achFormatHint[1] == 'n' && embeddedTexture->achFormatHint[2] == 'g')
+			return 4;
+
+		return 3;
+	}
+
+	/// <summary>
+	/// Returns the key of a texture in the cache of loaded textures, from its bytes and its type
+	/// The type is part of the key since it decides how the texture is compressed
+	/// </summary>
+	uint64_t getTextureKey(const void* data, size_t size, TextureType textureType, uint64_t seed = Hash::DEFAULT_SEED)
+	{
+		auto type = static_cast<uint32_t>(textureType);
+		return Hash::hashBytes(&type, sizeof(type), Hash::hashBytes(data, size, seed));
+	}
+}
+
 ResourceLoader& ResourceLoader::getInstance()
 {
 	return ResourceLoader::instance;
 }
 
-std::unique_ptr<Entity> ResourceLoader::loadModelFromFilepath(const std::string& path, Shader* shaderProgram)
+ModelLoadHandle::ModelLoadHandle(std::string path) : path(std::move(path))
 {
+
+}
+
+ModelLoadState ModelLoadHandle::getState() const
+{
+	return this->state;
+}
+
+bool ModelLoadHandle::isDone() const
+{
+	ModelLoadState currentState = this->state;
+	return currentState != ModelLoadState::PARSING && currentState != ModelLoadState::UPLOADING;
+}
+
+Entity* ModelLoadHandle::getEntity() const
+{
+	return this->entity;
+}
+
+const std::string& ModelLoadHandle::getPath() const
+{
+	return this->path;
+}
+
+void ModelLoadHandle::cancel()
+{
+	this->isCancelled = true;
+}
+
+std::unique_ptr<Entity> ResourceLoader::loadModelFromFilepath(const std::string& path, Shader* shaderProgram, PhysicsWorld* physicsWorld)
+{
+	std::lock_guard<std::mutex> lock(this->loadMutex);
+	return this->loadModel(path, shaderProgram, physicsWorld);
+}
+
+std::shared_ptr<Texture> ResourceLoader::loadTextureFromPixels(TextureType textureType, int width, int height, GLenum format, const unsigned char* textureData, int channels)
+{
+	std::lock_guard<std::mutex> lock(this->loadMutex);
+	return this->getPixelTexture(textureType, width, height, format, textureData, channels);
+}
+
+std::shared_ptr<ModelLoadHandle> ResourceLoader::loadModelAsync(const std::string& path, Shader* shaderProgram, Scene* scene, PhysicsWorld* physicsWorld)
+{
+	auto handle = std::make_shared<ModelLoadHandle>(path);
+
+	auto job = [this, handle, shaderProgram, scene, physicsWorld]()
+	{
+		if (handle->isCancelled)
+		{
+			handle->state = ModelLoadState::CANCELLED;
+			return;
+		}
+
+		auto loadStart = std::chrono::steady_clock::now();
+
+		std::vector<UploadTask> uploads;
+		std::unique_ptr<Entity> modelEntity;
+
+		{
+			std::lock_guard<std::mutex> lock(this->loadMutex);
+
+			this->deferredUploads = &uploads;
+			modelEntity = this->loadModel(handle->getPath(), shaderProgram, physicsWorld);
+			this->deferredUploads = nullptr;
+		}
+
+		if (modelEntity == nullptr)
+		{
+			handle->state = ModelLoadState::FAILED;
+			return;
+		}
+
+		double loadTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - loadStart).count();
+		Logger::logInfo("Parsed " + handle->getPath() + " in " + std::to_string(loadTime) + " ms, " + std::to_string(uploads.size()) + " uploads queued", "resourceLoader.cpp");
+
+		Entity* rootEntity = modelEntity.get();
+		handle->pendingEntity = std::move(modelEntity);
+		handle->state = ModelLoadState::UPLOADING;
+
+		// The queue runs tasks in order, so all the meshes and textures of the model are resident when this one runs
+		uploads.push_back(UploadTask{ [handle, rootEntity, scene]()
+		{
+			if (handle->isCancelled)
+			{
+				handle->pendingEntity.reset();
+				handle->state = ModelLoadState::CANCELLED;
+				return;
+			}
+
+			// The meshes were started by their own tasks, only the components of the root are left
+			for (auto& [type, component] : rootEntity->getComponents())
+				component->start();
+
+			scene->addEntity(std::move(handle->pendingEntity));
+			handle->entity = rootEntity;
+			handle->state = ModelLoadState::READY;
+		}, 0 });
+
+		UploadQueue::getInstance().push(std::move(uploads));
+	};
+
+	{
+		std::lock_guard<std::mutex> lock(this->loadJobsMutex);
+
+		if (!this->loadingThread.joinable())
+			this->loadingThread = std::thread(&ResourceLoader::runLoadingThread, this);
+
+		this->loadJobs.push_back(std::move(job));
+	}
+
+	this->loadJobsCondition.notify_one();
+
+	return handle;
+}
+
+std::unique_ptr<Entity> ResourceLoader::loadModel(const std::string& path, Shader* shaderProgram, PhysicsWorld* physicsWorld)
+{
+	this->directory = path.substr(0, path.find_last_of('/'));
+	this->physicsWorld = physicsWorld;
+
+	uint64_t cacheKey = 0;
+	bool isCached = this->useModelCache && this->getModelCacheKey(path, cacheKey);
+	CachedModel cachedModel;
+	auto loadStart = std::chrono::steady_clock::now();
+
+	if (isCached && ModelCache::load(this->getModelCachePath(cacheKey), cacheKey, cachedModel))
+	{
+		std::unique_ptr<Entity> modelEntity = this->createModelFromCache(std::move(cachedModel), shaderProgram);
+		this->clearLoadState();
+
+		double loadTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - loadStart).count();
+		Logger::logInfo("Loaded " + path + " from the model cache in " + std::to_string(loadTime) + " ms", "resourceLoader.cpp");
+
+		return modelEntity;
+	}
+
 	Assimp::Importer import;
-	const aiScene* scene = import.ReadFile(path, aiProcess_Triangulate | aiProcess_FlipUVs | aiProcess_PreTransformVertices | aiProcess_CalcTangentSpace);
+	const aiScene* scene = import.ReadFile(path, MeshImport::getImportFlags(this->preserveHierarchy));
 
 	if (scene == nullptr)
 	{
 		Logger::logError("Error while trying to load file path " + path + " - Extension might be incorrect", "resourceLoader.cpp");
+		this->clearLoadState();
+		return nullptr;
+	}
+
+	if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode)
+	{
+		std::cout << "ERROR::ASSIMP::" << import.GetErrorString() << std::endl;
+		this->clearLoadState();
 		return nullptr;
 	}
 
@@ -46,102 +267,310 @@ std::unique_ptr<Entity> ResourceLoader::loadModelFromFilepath(const std::string&
 	// We create an entity that will contain all the necessary data
 	auto* modelEntity = new Entity(sceneName);
 
-	if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode)
+	this->cacheStatisticsBefore = VertexCacheStatistics();
+	this->cacheStatisticsAfter = VertexCacheStatistics();
+	this->vertexCountBeforeWeld = 0;
+	this->vertexCountAfterWeld = 0;
+
+	// The meshes and textures are recorded as they are processed, so the cache holds exactly what the components were given
+	if (isCached)
 	{
-		std::cout << "ERROR::ASSIMP::" << import.GetErrorString() << std::endl;
-		return nullptr;
+		cachedModel.name = sceneName;
+		this->modelCacheRecord = &cachedModel;
 	}
 
-	this->directory = path.substr(0, path.find_last_of('/'));
-
+	this->decodeTextures(this->gatherTextures(scene));
 	this->processNode(scene->mRootNode, scene, shaderProgram, modelEntity);
+	this->clearLoadState();
+
+	if (isCached)
+		ModelCache::save(this->getModelCachePath(cacheKey), cacheKey, cachedModel);
+
+	if (this->weldVertices && this->vertexCountBeforeWeld > 0)
+	{
+		Logger::logInfo(
+			"Welded vertices of " + path + " - " + std::to_string(this->vertexCountBeforeWeld) + " -> " + std::to_string(this->vertexCountAfterWeld),
+			"resourceLoader.cpp"
+		);
+	}
+
+	if (this->optimizeMeshes && this->cacheStatisticsBefore.triangleCount > 0)
+	{
+		Logger::logInfo(
+			"Optimized meshes of " + path + " - ACMR " + std::to_string(this->cacheStatisticsBefore.getACMR()) + " -> " + std::to_string(this->cacheStatisticsAfter.getACMR())
+			+ ", ATVR " + std::to_string(this->cacheStatisticsBefore.getATVR()) + " -> " + std::to_string(this->cacheStatisticsAfter.getATVR()),
+			"resourceLoader.cpp"
+		);
+	}
 
 	return std::unique_ptr<Entity>(modelEntity);
 }
 
-ResourceLoader::ResourceLoader() = default;
+void ResourceLoader::clearLoadState()
+{
+	this->physicsWorld = nullptr;
+	this->modelCacheRecord = nullptr;
+	this->recordedTextureIndices.clear();
+	this->decodedImages.clear();
+	this->textureKeys.clear();
+	this->sharedMeshes.clear();
+}
 
-void ResourceLoader::processNode(const aiNode* node, const aiScene* scene, Shader* shaderProgram, Entity* parent)
+std::unique_ptr<Entity> ResourceLoader::createModelFromCache(CachedModel model, Shader* shaderProgram)
 {
-	// Process all the node's meshes (if any)
-	for (unsigned int i = 0; i < node->mNumMeshes; i++)
+	std::vector<TextureSource> sources;
+
+	for (const CachedTexture& cachedTexture : model.textures)
 	{
-		aiMesh* mesh = scene->mMeshes[node->mMeshes[i]];
-		Entity* newMesh = processMesh(mesh, scene, shaderProgram, parent);
+		std::string path = this->directory + '/' + cachedTexture.path;
+
+		if (cachedTexture.kind == CachedTextureKind::FILE)
+			sources.push_back(TextureSource{ path, cachedTexture.type, nullptr, 0, 0 });
+		else if (cachedTexture.kind == CachedTextureKind::ENCODED)
+			sources.push_back(TextureSource{ path, cachedTexture.type, cachedTexture.data.data(), cachedTexture.data.size(), cachedTexture.channels });
+	}
+
+	this->decodeTextures(sources);
 
-		std::string nodeName = std::string(node->mName.C_Str());
-		newMesh->setLabel(nodeName);
+	std::vector<std::shared_ptr<Texture>> textures;
+	textures.reserve(model.textures.size());
 
-		newMesh->setParent(parent);
-		parent->addChild(newMesh);
+	for (const CachedTexture& cachedTexture : model.textures)
+	{
+		if (cachedTexture.kind == CachedTextureKind::RAW)
+			textures.push_back(this->getPixelTexture(cachedTexture.type, cachedTexture.width, cachedTexture.height, cachedTexture.format, cachedTexture.data.data(), cachedTexture.channels));
+		else
+			textures.push_back(this->getDecodedTexture(this->directory + '/' + cachedTexture.path, cachedTexture.path, cachedTexture.type, cachedTexture.kind == CachedTextureKind::FILE));
 	}
 
-	for (unsigned int i = 0; i < node->mNumChildren; i++)
+	auto getMeshTextures = [&textures](const CachedMesh& mesh)
 	{
-		processNode(node->mChildren[i], scene, shaderProgram, parent);
+		std::vector<std::shared_ptr<Texture>> meshTextures;
+
+		for (uint32_t textureIndex : mesh.textures)
+			meshTextures.push_back(textures[textureIndex]);
+
+		return meshTextures;
+	};
+
+	auto modelEntity = std::make_unique<Entity>(model.name);
+
+	// The buffers of the meshes are moved to their components, the model is read from the cache file once and not copied again
+	if (model.nodes.empty())
+	{
+		for (CachedMesh& mesh : model.meshes)
+		{
+			std::vector<std::shared_ptr<Texture>> meshTextures = getMeshTextures(mesh);
+
+			Entity* meshEntity = this->createMeshEntity(std::move(mesh), meshTextures, shaderProgram);
+			meshEntity->setParent(modelEntity.get());
+			modelEntity->addChild(meshEntity);
+		}
+
+		return modelEntity;
 	}
+
+	// The nodes are stored in the order they were imported, so the first reference of each mesh is created and started before its instances
+	std::vector<Entity*> nodeEntities;
+	std::vector<glm::mat4> nodeTransforms;
+
+	for (const CachedNode& node : model.nodes)
+	{
+		Entity* parent = node.parent < 0 ? modelEntity.get() : nodeEntities[node.parent];
+		glm::mat4 nodeTransform = node.parent < 0 ? node.transform : nodeTransforms[node.parent] * node.transform;
+
+		auto* nodeEntity = new Entity(node.name);
+		nodeEntity->setParent(parent);
+		parent->addChild(nodeEntity);
+		nodeEntity->getTransform()->setModelMatrix(node.transform);
+
+		nodeEntities.push_back(nodeEntity);
+		nodeTransforms.push_back(nodeTransform);
+
+		for (uint32_t meshIndex : node.meshes)
+		{
+			auto sharedMesh = this->sharedMeshes.find(meshIndex);
+			Entity* meshEntity = nullptr;
+
+			if (sharedMesh != this->sharedMeshes.end())
+				meshEntity = this->createMeshEntity(sharedMesh->second.mesh, sharedMesh->second.textures, shaderProgram, sharedMesh->second.component, nodeTransform);
+			else
+			{
+				CachedMesh& mesh = model.meshes[meshIndex];
+
+				SharedMesh& newSharedMesh = this->sharedMeshes[meshIndex];
+				newSharedMesh.mesh = ResourceLoader::getInstanceMesh(mesh);
+				newSharedMesh.textures = getMeshTextures(mesh);
+
+				meshEntity = this->createMeshEntity(std::move(mesh), newSharedMesh.textures, shaderProgram, nullptr, nodeTransform);
+				newSharedMesh.component = meshEntity->getComponent<MeshComponent>();
+			}
+
+			meshEntity->setParent(nodeEntity);
+			nodeEntity->addChild(meshEntity);
+		}
+	}
+
+	return modelEntity;
 }
 
-Entity* ResourceLoader::processMesh(aiMesh* mesh, const aiScene* scene, Shader* shaderProgram, Entity* parent)
+bool ResourceLoader::getModelCacheKey(const std::string& path, uint64_t& key) const
 {
-	std::vector<float> vertices;
-	std::vector<float> texCoords;
-	std::vector<float> normals;
-	std::vector<unsigned int> indices;
-	std::vector<float> tangents;
-	std::vector<float> bitangents;
+	std::error_code error;
+	uintmax_t fileSize = std::filesystem::file_size(path, error);
 
-	std::vector<std::shared_ptr<Texture>> textures;
+	if (error)
+		return false;
+
+	std::filesystem::file_time_type writeTime = std::filesystem::last_write_time(path, error);
+
+	if (error)
+		return false;
+
+	int64_t fileStamp[2] = { static_cast<int64_t>(fileSize), static_cast<int64_t>(writeTime.time_since_epoch().count()) };
+
+	// The settings are part of the key, so changing them processes the model again instead of loading stale meshes
+	uint32_t settings[10] = {
+		this->weldVertices, this->optimizeMeshes, this->lodCount, this->buildMeshlets,
+		Geometry::MESHLET_MAX_VERTICES, Geometry::MESHLET_MAX_TRIANGLES, 0, 0, this->preserveHierarchy, this->quantizeVertices
+	};
+	std::memcpy(&settings[6], &this->weldEpsilon, sizeof(float));
+	std::memcpy(&settings[7], &MeshImport::LOD_REDUCTION, sizeof(float));
+
+	key = Hash::hashBytes(path.data(), path.size());
+	key = Hash::hashBytes(fileStamp, sizeof(fileStamp), key);
+	key = Hash::hashBytes(settings, sizeof(settings), key);
+	key = Hash::hashBytes(&MeshImport::LOD_MAX_ERROR, sizeof(float), key);
+
+	return true;
+}
+
+std::string ResourceLoader::getModelCachePath(uint64_t key) const
+{
+	return CacheFile::getPath(this->modelCacheDirectory, key, ".vglm");
+}
 
-	for (unsigned int i = 0; i < mesh->mNumVertices; i++)
+ResourceLoader::ResourceLoader() = default;
+
+ResourceLoader::~ResourceLoader()
+{
 	{
-		vertices.push_back(mesh->mVertices[i].x);
-		vertices.push_back(mesh->mVertices[i].y);
-		vertices.push_back(mesh->mVertices[i].z);
+		std::lock_guard<std::mutex> lock(this->loadJobsMutex);
+		this->stopLoadingThread = true;
+		this->loadJobs.clear();
+	}
 
-		if (mesh->HasNormals())
-		{
-			normals.push_back(mesh->mNormals[i].x);
-			normals.push_back(mesh->mNormals[i].y);
-			normals.push_back(mesh->mNormals[i].z);
-		}
+	this->loadJobsCondition.notify_one();
+
+	if (this->loadingThread.joinable())
+		this->loadingThread.join();
+}
+
+void ResourceLoader::runLoadingThread()
+{
+	// The flip setting of stb_image is global, this keeps the loading thread from racing with textures loaded on the main thread
+	stbi_set_flip_vertically_on_load_thread(false);
+
+	while (true)
+	{
+		std::function<void()> job;
 
-		if (mesh->HasTangentsAndBitangents())
 		{
-			tangents.push_back(mesh->mTangents[i].x);
-			tangents.push_back(mesh->mTangents[i].y);
-			tangents.push_back(mesh->mTangents[i].z);
+			std::unique_lock<std::mutex> lock(this->loadJobsMutex);
+			this->loadJobsCondition.wait(lock, [this]() { return this->stopLoadingThread || !this->loadJobs.empty(); });
+
+			if (this->stopLoadingThread)
+				return;
 
-			bitangents.push_back(mesh->mBitangents[i].x);
-			bitangents.push_back(mesh->mBitangents[i].y);
-			bitangents.push_back(mesh->mBitangents[i].z);
+			job = std::move(this->loadJobs.front());
+			this->loadJobs.pop_front();
 		}
 
-		if (mesh->HasTextureCoords(0))
+		job();
+	}
+}
+
+void ResourceLoader::processNode(const aiNode* node, const aiScene* scene, Shader* shaderProgram, Entity* parent, int32_t parentNode, const glm::mat4& parentTransform)
+{
+	std::string nodeName = std::string(node->mName.C_Str());
+
+	// Without the hierarchy the transforms are baked into the vertices, and all the meshes go directly under the model
+	Entity* nodeEntity = parent;
+	int32_t nodeIndex = parentNode;
+	glm::mat4 nodeTransform = parentTransform;
+
+	if (this->preserveHierarchy)
+	{
+		glm::mat4 transform = toMat4(node->mTransformation);
+		nodeTransform = parentTransform * transform;
+
+		nodeEntity = new Entity(nodeName);
+		nodeEntity->setParent(parent);
+		parent->addChild(nodeEntity);
+		nodeEntity->getTransform()->setModelMatrix(transform);
+
+		if (this->modelCacheRecord != nullptr)
 		{
-			texCoords.push_back(mesh->mTextureCoords[0][i].x);
-			texCoords.push_back(mesh->mTextureCoords[0][i].y);
+			nodeIndex = static_cast<int32_t>(this->modelCacheRecord->nodes.size());
+			this->modelCacheRecord->nodes.push_back(CachedNode{ nodeName, transform, parentNode, {} });
 		}
+	}
+
+	// Process all the node's meshes (if any)
+	for (unsigned int i = 0; i < node->mNumMeshes; i++)
+	{
+		unsigned int meshIndex = node->mMeshes[i];
+		auto sharedMesh = this->sharedMeshes.find(meshIndex);
+		Entity* newMesh = nullptr;
+
+		// The entities are started in the order they are created, so the first reference of a mesh uploads its geometry before the instances need it
+		if (sharedMesh != this->sharedMeshes.end())
+			newMesh = this->createMeshEntity(sharedMesh->second.mesh, sharedMesh->second.textures, shaderProgram, sharedMesh->second.component, nodeTransform);
 		else
 		{
-			texCoords.push_back(0.0f);
-			texCoords.push_back(0.0f);
+			std::string label = this->preserveHierarchy && scene->mMeshes[meshIndex]->mName.length > 0 ? std::string(scene->mMeshes[meshIndex]->mName.C_Str()) : nodeName;
+			newMesh = processMesh(meshIndex, scene, shaderProgram, label, nodeTransform);
 		}
+
+		if (this->preserveHierarchy && this->modelCacheRecord != nullptr)
+			this->modelCacheRecord->nodes[nodeIndex].meshes.push_back(this->sharedMeshes[meshIndex].cachedIndex);
+
+		newMesh->setParent(nodeEntity);
+		nodeEntity->addChild(newMesh);
 	}
 
-	for (unsigned int i = 0; i < mesh->mNumFaces; i++)
+	for (unsigned int i = 0; i < node->mNumChildren; i++)
 	{
-		aiFace face = mesh->mFaces[i];
-		for (unsigned int j = 0; j < face.mNumIndices; j++)
-		{
-			indices.push_back(face.mIndices[j]);
-		}
+		processNode(node->mChildren[i], scene, shaderProgram, nodeEntity, nodeIndex, nodeTransform);
 	}
+}
+
+Entity* ResourceLoader::processMesh(unsigned int meshIndex, const aiScene* scene, Shader* shaderProgram, const std::string& label, const glm::mat4& nodeTransform)
+{
+	aiMesh* mesh = scene->mMeshes[meshIndex];
+
+	CachedMesh processedMesh;
+	processedMesh.label = label;
+
+	std::vector<float>& vertices = processedMesh.vertices;
+	std::vector<unsigned int>& indices = processedMesh.indices;
+
+	// The other streams only live until they are interleaved in the vertex data
+	std::vector<float> texCoords;
+	std::vector<float> normals;
+	std::vector<float> tangents;
+	std::vector<float> bitangents;
+
+	std::vector<std::shared_ptr<Texture>> textures;
+	this->recordedMeshTextures.clear();
+
+	MeshImport::extractVertices(mesh, vertices, texCoords, normals, tangents, bitangents, indices);
 
-	auto diffuseColor = glm::vec3(1.0f);
-	float metalness = 0.0f;
-	float roughness = 0.5f;
-	float opacity = 1.0f;
+	glm::vec3& diffuseColor = processedMesh.diffuseColor;
+	float& metalness = processedMesh.metallic;
+	float& roughness = processedMesh.roughness;
+	float& opacity = processedMesh.opacity;
+	bool hasNormalMap = false;
 
 	// Load all the textures needed
 	if (mesh->mMaterialIndex >= 0)
@@ -157,6 +586,7 @@ Entity* ResourceLoader::processMesh(aiMesh* mesh, const aiScene* scene, Shader*
 
 		std::vector<std::shared_ptr<Texture>> normalMaps = loadMaterialTextures(scene, material, aiTextureType_NORMALS, "texture_normal");
 		textures.insert(textures.end(), normalMaps.begin(), normalMaps.end());
+		hasNormalMap = !normalMaps.empty();
 
 		std::vector<std::shared_ptr<Texture>> heightMaps = loadMaterialTextures(scene, material, aiTextureType_HEIGHT, "texture_height");
 		textures.insert(textures.end(), heightMaps.begin(), heightMaps.end());
@@ -199,35 +629,177 @@ Entity* ResourceLoader::processMesh(aiMesh* mesh, const aiScene* scene, Shader*
 			opacity = opacityVec.r;
 	}
 
-	auto* entity = new Entity();
-	auto* meshComponent = entity->addComponent<MeshComponent>();
-	//auto* physicsComponent = entity->addComponent<PhysicsComponent>();
+	// When the mesh is optimized afterwards the weld only remaps the positions, the other attributes are remapped once with both remaps
+	std::vector<unsigned int> weldRemap;
+
+	if (this->weldVertices && !indices.empty())
+	{
+		this->vertexCountBeforeWeld += vertices.size() / 3;
+		MeshImport::weldMesh(vertices, texCoords, normals, indices, tangents, bitangents, this->weldEpsilon, this->optimizeMeshes ? &weldRemap : nullptr);
+		this->vertexCountAfterWeld += vertices.size() / 3;
+	}
+
+	if (this->optimizeMeshes && !indices.empty())
+	{
+		VertexCacheStatistics statisticsBefore;
+		VertexCacheStatistics statisticsAfter;
 
-	//BoundingBox meshBoundingBox = Geometry::getMeshBoundingBox(vertices);
-	//glm::vec3 halfExtents = (meshBoundingBox.maxPosition - meshBoundingBox.minPosition) * 0.5f;
-	//glm::vec3 position = (meshBoundingBox.maxPosition + meshBoundingBox.minPosition) * 0.5f;
-	//defaultRenderer.physicsWorld->addBox(physicsComponent, halfExtents, position, 0.0f, true);
+		MeshImport::optimizeMesh(vertices, texCoords, normals, indices, tangents, bitangents, &statisticsBefore, &statisticsAfter, &weldRemap);
 
+		this->cacheStatisticsBefore += statisticsBefore;
+		this->cacheStatisticsAfter += statisticsAfter;
+	}
+
+	// Generated after the weld so they are smoothed across the merged vertices, and after the optimization so they are never remapped
+	// Only generate what the file doesn't provide, tangents are only needed for normal mapping
 	if (normals.empty())
 		normals = Geometry::calculateVerticesNormals(vertices, indices);
 
+	if (tangents.empty() && hasNormalMap && mesh->HasTextureCoords(0))
+		Geometry::calculateVerticesTangents(vertices, texCoords, normals, indices, tangents, bitangents);
+
+	if (this->lodCount > 0)
+		processedMesh.lods = MeshImport::generateLods(vertices, indices, this->lodCount, this->optimizeMeshes);
+
+	// Meshlets are built after the index buffer is final
+	if (this->buildMeshlets)
+		MeshImport::buildMeshlets(vertices, indices, processedMesh.lods, processedMesh.meshlets);
+
+	// The vertices are built here rather than when the mesh is started, off the main thread for background loads and only once for cached models
+	processedMesh.vertexData = VertexFormat::buildVertexData(vertices, texCoords, normals, tangents, bitangents, indices, processedMesh.lods, this->quantizeVertices);
+
+	SharedMesh* sharedMesh = nullptr;
+
+	if (this->preserveHierarchy)
+	{
+		sharedMesh = &this->sharedMeshes[meshIndex];
+		sharedMesh->mesh = ResourceLoader::getInstanceMesh(processedMesh);
+		sharedMesh->textures = textures;
+		sharedMesh->cachedIndex = this->modelCacheRecord != nullptr ? static_cast<uint32_t>(this->modelCacheRecord->meshes.size()) : 0;
+	}
+
+	// The model cache needs its own copy of the buffers, otherwise they are moved to the component without being copied
+	if (this->modelCacheRecord != nullptr)
+	{
+		processedMesh.textures = std::move(this->recordedMeshTextures);
+		this->modelCacheRecord->meshes.push_back(processedMesh);
+	}
+
+	Entity* entity = this->createMeshEntity(std::move(processedMesh), textures, shaderProgram, nullptr, nodeTransform);
+
+	if (sharedMesh != nullptr)
+		sharedMesh->component = entity->getComponent<MeshComponent>();
+
+	return entity;
+}
+
+CachedMesh ResourceLoader::getInstanceMesh(const CachedMesh& mesh)
+{
+	CachedMesh instanceMesh;
+
+	instanceMesh.label = mesh.label;
+	instanceMesh.diffuseColor = mesh.diffuseColor;
+	instanceMesh.metallic = mesh.metallic;
+	instanceMesh.roughness = mesh.roughness;
+	instanceMesh.opacity = mesh.opacity;
+
+	return instanceMesh;
+}
+
+Entity* ResourceLoader::createMeshEntity(CachedMesh mesh, const std::vector<std::shared_ptr<Texture>>& textures, Shader* shaderProgram, const MeshComponent* geometrySource,
+	const glm::mat4& nodeTransform)
+{
+	const std::vector<float>& vertices = mesh.vertices;
+	const std::vector<unsigned int>& indices = mesh.indices;
+
+	auto* entity = new Entity(mesh.label);
+	auto* meshComponent = entity->addComponent<MeshComponent>();
+
+	// The collider and the BVH use the full detail triangles, the levels of detail are appended after them in the indices
+	size_t indexOffset = mesh.lods.empty() ? 0 : mesh.lods[0].indexOffset;
+	size_t indexCount = mesh.lods.empty() ? indices.size() : mesh.lods[0].indexCount;
+
+	bool hasCollider = this->meshColliders != MeshColliderType::NONE && this->physicsWorld != nullptr;
+	const PhysicsComponent* sourcePhysics = hasCollider && geometrySource != nullptr ? geometrySource->parent->getComponent<PhysicsComponent>() : nullptr;
+
+	if (sourcePhysics != nullptr)
+	{
+		auto* physicsComponent = entity->addComponent<PhysicsComponent>();
+
+		// Instances share the collision shape of their mesh, only their body is created at the transform of their node
+		// Background loads queue it after the collider of the mesh, which is then already added
+		auto addInstance = [world = this->physicsWorld, physicsComponent, sourcePhysics, mass = this->colliderMass, nodeTransform]()
+		{
+			world->addColliderInstance(physicsComponent, sourcePhysics, nodeTransform, mass);
+		};
+
+		if (this->deferredUploads != nullptr)
+			this->deferredUploads->push_back(UploadTask{ addInstance, 0 });
+		else
+			addInstance();
+	}
+	else if (hasCollider && geometrySource == nullptr && indexCount > 0)
+	{
+		auto* physicsComponent = entity->addComponent<PhysicsComponent>();
+		std::vector<unsigned int> colliderIndices(indices.begin() + indexOffset, indices.begin() + indexOffset + indexCount);
+
+		// The vertices are local to the node of the mesh, the body is placed in the world at the transform of the node
+		// The physics world isn't thread safe, background loads add the collider from the main thread with a copy of the triangles
+		if (this->deferredUploads != nullptr)
+		{
+			this->deferredUploads->push_back(UploadTask{ [world = this->physicsWorld, physicsComponent, colliderType = this->meshColliders, mass = this->colliderMass,
+				settings = this->convexDecomposition, colliderVertices = vertices, colliderIndices = std::move(colliderIndices), nodeTransform]()
+			{
+				addMeshCollider(world, physicsComponent, colliderType, mass, settings, colliderVertices, colliderIndices, nodeTransform);
+			}, 0 });
+		}
+		else
+			addMeshCollider(this->physicsWorld, physicsComponent, this->meshColliders, this->colliderMass, this->convexDecomposition, vertices, colliderIndices, nodeTransform);
+	}
+
+	// Background loads build the BVH here rather than when the mesh is started on the main thread, instances share the one of their geometry
+	if (this->deferredUploads != nullptr && this->raycastableMeshes && indexCount > 0 && geometrySource == nullptr)
+		meshComponent->setRaycastBvh(std::make_shared<const MeshBvh>(vertices, indices, indexOffset, indexCount));
+
+	size_t meshByteSize = 0;
+
 	meshComponent->setMaterial(std::make_unique<PBRMaterial>(shaderProgram))
-		.addVertices(vertices)
-		.addTexCoords(texCoords)
-		.addNormals(normals)
-		.addIndices(indices)
 		.addTextures(textures)
-		.addTangents(tangents)
-		.addBitangents(bitangents);
+		.setVertexQuantization(this->quantizeVertices)
+		.setRaycastable(this->raycastableMeshes);
 
-	meshComponent->setDiffuseColor(diffuseColor);
+	if (geometrySource != nullptr)
+		meshComponent->shareGeometry(geometrySource);
+	else
+	{
+		meshByteSize = mesh.vertexData.bytes.size() + indices.size() * sizeof(unsigned int);
+
+		// The vertices are only read again by the component when it is started, which uploads them as is and then frees them
+		meshComponent->addVertices(std::move(mesh.vertices))
+			.addVertexData(std::move(mesh.vertexData))
+			.addIndices(std::move(mesh.indices))
+			.addLods(mesh.lods)
+			.addMeshlets(std::move(mesh.meshlets));
+	}
+
+	meshComponent->setDiffuseColor(mesh.diffuseColor);
 
 	auto* pbrMaterial = dynamic_cast<PBRMaterial*>(meshComponent->material.get());
 	if (pbrMaterial != nullptr)
 	{
-		pbrMaterial->metallic = metalness;
-		pbrMaterial->roughness = roughness;
-		pbrMaterial->opacity = opacity;
+		pbrMaterial->metallic = mesh.metallic;
+		pbrMaterial->roughness = mesh.roughness;
+		pbrMaterial->opacity = mesh.opacity;
+	}
+
+	// The mesh is started once its textures are uploaded, the tasks of the model run in the order they were added
+	if (this->deferredUploads != nullptr)
+	{
+		this->deferredUploads->push_back(UploadTask{ [entity]()
+		{
+			for (auto& [type, component] : entity->getComponents())
+				component->start();
+		}, meshByteSize });
 	}
 
 	return entity;
@@ -243,74 +815,431 @@ std::vector<std::shared_ptr<Texture>> ResourceLoader::loadMaterialTextures(const
 		mat->GetTexture(type, i, &str);
 		std::string path = directory + '/' + std::string(str.C_Str());
 
+		// To map each value to the corresponding TextureType
+		TextureType textureType = ResourceLoader::aiMatToTextureType[type];
+
+		const aiTexture* embeddedTexture = scene->GetEmbeddedTexture(str.C_Str());
+
+		if (this->modelCacheRecord != nullptr)
+			this->recordedMeshTextures.push_back(this->recordTexture(str.C_Str(), textureType, embeddedTexture));
+
 		std::shared_ptr<Texture> texture;
 
-		// Texture is already cached in memory, reuse it
-		if (this->loadedTextures.count(path) != 0 && !this->loadedTextures[path].expired())
+		// Embedded textures with raw image data don't need decoding
+		if (embeddedTexture != nullptr && embeddedTexture->mHeight != 0)
 		{
-			Logger::logInfo(std::string("Reusing texture path " + path), "resourceLoader.cpp");
-			texture = std::shared_ptr<Texture>(this->loadedTextures[path]);
+			Logger::logInfo(std::string("Loading embedded texture path " + path), "resourceLoader.cpp");
+
+			GLenum format = getRawTextureFormat(embeddedTexture);
+			texture = this->getPixelTexture(textureType, embeddedTexture->mWidth, embeddedTexture->mHeight, format, reinterpret_cast<const unsigned char*>(embeddedTexture->pcData), format == GL_RGBA ? 4 : 3);
 		}
-		else // Texture has not been loaded yet or weak_ptr is expired
-		{
-			// To map each value to the corresponding TextureType
-			TextureType textureType = ResourceLoader::aiMatToTextureType[type];
+		else // Compressed embedded textures and files were decoded by decodeTextures
+			texture = this->getDecodedTexture(path, str.C_Str(), textureType, embeddedTexture == nullptr);
+
+		textures.push_back(texture);
+	}
+
+	return textures;
+}
+
+std::shared_ptr<Texture> ResourceLoader::getDecodedTexture(const std::string& path, const std::string& name, TextureType textureType, bool isFile)
+{
+	auto textureKey = this->textureKeys.find(path);
+
+	if (textureKey == this->textureKeys.end())
+	{
+		Logger::logError(std::string("Failed to load texture: ") + path, "resourceLoader.cpp");
+		auto texture = std::make_shared<Texture>();
+		texture->type = textureType;
+
+		return texture;
+	}
+
+	// The same image was already loaded, from this path or another one, by this model or another one
+	if (std::shared_ptr<Texture> loadedTexture = this->findLoadedTexture(textureKey->second))
+	{
+		Logger::logInfo(std::string("Reusing texture path " + path), "resourceLoader.cpp");
+		return loadedTexture;
+	}
+
+	std::shared_ptr<Texture> texture;
+	auto decodedImage = this->decodedImages.find(textureKey->second);
+
+	if (decodedImage != this->decodedImages.end() && decodedImage->second.mapped != nullptr)
+		texture = this->createStreamedTexture(textureType, decodedImage->second.mapped);
+	else if (decodedImage != this->decodedImages.end() && decodedImage->second.compressed.format != BlockFormat::NONE)
+		texture = this->createCompressedTexture(textureType, std::move(decodedImage->second.compressed));
+	else if (decodedImage != this->decodedImages.end() && decodedImage->second.pixels != nullptr)
+	{
+		const DecodedImage& image = decodedImage->second;
+		texture = this->createTexture(textureType, image.width, image.height, image.format, image.pixels.get(), image.channels);
+	}
+	else
+	{
+		Logger::logError(std::string("Failed to load texture: ") + path, "resourceLoader.cpp");
+		texture = std::make_shared<Texture>();
+		texture->type = textureType;
+	}
+
+	if (isFile)
+		texture->path = name;
+
+	// The textures are kept by the ResourceManager, so models loaded later reuse them even once no model uses them anymore
+	texture = ResourceManager::getInstance().add<Texture>(ResourceType::TEXTURE, textureKey->second, texture).getShared();
+
+	// Later uses go through the cache of textures, the pixels aren't needed anymore
+	if (decodedImage != this->decodedImages.end())
+		this->decodedImages.erase(decodedImage);
+
+	return texture;
+}
+
+std::shared_ptr<Texture> ResourceLoader::getPixelTexture(TextureType textureType, int width, int height, GLenum format, const unsigned char* textureData, int channels)
+{
+	int layout[4] = { width, height, static_cast<int>(format), channels };
+	size_t byteSize = static_cast<size_t>(width) * height * channels;
+
+	uint64_t key = getTextureKey(textureData, byteSize, textureType, Hash::hashBytes(layout, sizeof(layout)));
+
+	if (std::shared_ptr<Texture> loadedTexture = this->findLoadedTexture(key))
+		return loadedTexture;
+
+	std::shared_ptr<Texture> texture = this->createTexture(textureType, width, height, format, textureData, channels);
+	return ResourceManager::getInstance().add<Texture>(ResourceType::TEXTURE, key, texture).getShared();
+}
+
+std::shared_ptr<Texture> ResourceLoader::findLoadedTexture(uint64_t key)
+{
+	return ResourceManager::getInstance().find<Texture>(ResourceType::TEXTURE, key).getShared();
+}
+
+uint32_t ResourceLoader::recordTexture(const std::string& name, TextureType textureType, const aiTexture* embeddedTexture)
+{
+	auto recordedTexture = this->recordedTextureIndices.find(name);
+
+	if (recordedTexture != this->recordedTextureIndices.end())
+		return recordedTexture->second;
+
+	CachedTexture cachedTexture;
+	cachedTexture.type = textureType;
+	cachedTexture.path = name;
+
+	if (embeddedTexture == nullptr)
+		cachedTexture.kind = CachedTextureKind::FILE;
+	else if (embeddedTexture->mHeight == 0) // The size of compressed textures is in bytes
+	{
+		const auto* bytes = reinterpret_cast<const unsigned char*>(embeddedTexture->pcData);
+
+		cachedTexture.kind = CachedTextureKind::ENCODED;
+		cachedTexture.channels = getEncodedTextureChannels(embeddedTexture);
+		cachedTexture.data.assign(bytes, bytes + embeddedTexture->mWidth);
+	}
+	else
+	{
+		const auto* bytes = reinterpret_cast<const unsigned char*>(embeddedTexture->pcData);
+
+		cachedTexture.kind = CachedTextureKind::RAW;
+		cachedTexture.width = static_cast<int>(embeddedTexture->mWidth);
+		cachedTexture.height = static_cast<int>(embeddedTexture->mHeight);
+		cachedTexture.format = getRawTextureFormat(embeddedTexture);
+		cachedTexture.channels = cachedTexture.format == GL_RGBA ? 4 : 3;
+		cachedTexture.data.assign(bytes, bytes + static_cast<size_t>(cachedTexture.width) * cachedTexture.height * cachedTexture.channels);
+	}
+
+	auto textureIndex = static_cast<uint32_t>(this->modelCacheRecord->textures.size());
+	this->modelCacheRecord->textures.push_back(std::move(cachedTexture));
+	this->recordedTextureIndices[name] = textureIndex;
+
+	return textureIndex;
+}
 
-			// If this is not null, we have an embedded texture, for example in GLB models
-			if (auto embeddedTexture = scene->GetEmbeddedTexture(str.C_Str()))
+std::vector<ResourceLoader::TextureSource> ResourceLoader::gatherTextures(const aiScene* scene)
+{
+	std::vector<TextureSource> sources;
+	std::set<std::string> gatheredPaths;
+
+	// Gather the textures of every material first so they can all be decoded at once
+	for (unsigned int i = 0; i < scene->mNumMaterials; i++)
+	{
+		const aiMaterial* material = scene->mMaterials[i];
+
+		for (const auto& [type, textureType] : ResourceLoader::aiMatToTextureType)
+		{
+			for (unsigned int j = 0; j < material->GetTextureCount(type); j++)
 			{
-				// This means we have a compressed texture that we need to decompress
-				if (embeddedTexture->mHeight == 0)
-				{
-					Logger::logInfo(std::string("Loading embedded compressed texture path " + path), "resourceLoader.cpp");
-
-					int width = embeddedTexture->mWidth;
-					int height = 1;
-					int len = width * height;
-					int channels = 3;
-
-					GLenum format = GL_RGB;
-
-					// Handle transparency layer for PNG data
-					if (embeddedTexture->achFormatHint[0] == 'p' && embeddedTexture->achFormatHint[1] == 'n' && embeddedTexture->achFormatHint[2] == 'g')
-					{
-						format = GL_RGBA;
-						channels = 4;
-					}
-
-					stbi_set_flip_vertically_on_load(false);
-
-					// Decompress image
-					unsigned char* data = stbi_load_from_memory(reinterpret_cast<const stbi_uc*>(embeddedTexture->pcData), len, &width, &height, &channels, channels);
-					// Create texture using image data
-					texture = std::make_shared<Texture>(textureType, width, height, format, data);
-					stbi_image_free(data);
-				}
-				else // We have raw image data
-				{
-					Logger::logInfo(std::string("Loading embedded texture path " + path), "resourceLoader.cpp");
-
-					GLenum format = GL_RGB;
-
-					// Check the format hint for a transparency layer
-					for (int j = 0; j < 4; j++)
-						if (embeddedTexture->achFormatHint[j] == 'A' && embeddedTexture->achFormatHint[j] != '0')
-							format = GL_RGBA;
-
-					texture = std::make_shared<Texture>(textureType, embeddedTexture->mWidth, embeddedTexture->mHeight, format, embeddedTexture->pcData);
-				}
+				aiString str;
+				material->GetTexture(type, j, &str);
+				std::string path = this->directory + '/' + std::string(str.C_Str());
+
+				if (!gatheredPaths.insert(path).second)
+					continue;
+
+				const aiTexture* embeddedTexture = scene->GetEmbeddedTexture(str.C_Str());
+
+				if (embeddedTexture != nullptr && embeddedTexture->mHeight != 0)
+					continue;
+
+				if (embeddedTexture != nullptr)
+					sources.push_back(TextureSource{ path, textureType, reinterpret_cast<const unsigned char*>(embeddedTexture->pcData), embeddedTexture->mWidth, getEncodedTextureChannels(embeddedTexture) });
+				else
+					sources.push_back(TextureSource{ path, textureType, nullptr, 0, 0 });
 			}
-			else // Not an embedded texture, load it from file system
+		}
+	}
+
+	return sources;
+}
+
+void ResourceLoader::decodeTextures(const std::vector<TextureSource>& sources)
+{
+	if (sources.empty())
+		return;
+
+	auto decodeStart = std::chrono::steady_clock::now();
+
+	// Files are mapped rather than read, the hash and the decoder go through the bytes once each
+	std::vector<std::unique_ptr<MappedFile>> files(sources.size());
+	std::vector<uint64_t> keys(sources.size());
+
+	Parallel::forChunks(sources.size(), 1, [&](size_t begin, size_t end)
+	{
+		for (size_t i = begin; i < end; i++)
+		{
+			const TextureSource& source = sources[i];
+
+			if (source.encodedData == nullptr)
 			{
-				Logger::logInfo(std::string("Loading texture path " + path), "resourceLoader.cpp");
-				texture = std::make_shared<Texture>(path, textureType, false);
-				texture->path = str.C_Str();
-				this->loadedTextures[path] = texture;
+				files[i] = std::make_unique<MappedFile>(source.path);
+
+				// Missing files get a key of their own, they are reported when their texture is created
+				if (files[i]->isOpen())
+					keys[i] = getTextureKey(files[i]->getData(), files[i]->getSize(), source.type);
+				else
+					keys[i] = getTextureKey(source.path.data(), source.path.size(), source.type);
 			}
+			else
+				keys[i] = getTextureKey(source.encodedData, source.encodedSize, source.type);
 		}
+	});
 
-		textures.push_back(texture);
+	// Only decode the images that aren't loaded yet, once each even if several paths lead to them
+	std::vector<size_t> decodedSources;
+
+	for (size_t i = 0; i < sources.size(); i++)
+	{
+		this->textureKeys[sources[i].path] = keys[i];
+
+		if (this->findLoadedTexture(keys[i]) != nullptr || this->decodedImages.count(keys[i]) != 0)
+			continue;
+
+		this->decodedImages[keys[i]] = DecodedImage();
+
+		if (files[i] == nullptr || files[i]->isOpen())
+			decodedSources.push_back(i);
 	}
 
-	return textures;
+	std::vector<DecodedImage> images(decodedSources.size());
+
+	// The thread specific flip setting is only set on the worker threads, setting it on the calling thread would override the global one for good
+	if (this->deferredUploads == nullptr)
+		stbi_set_flip_vertically_on_load(false);
+
+	std::thread::id callingThread = std::this_thread::get_id();
+
+	// Each image is written to its own slot, so the workers don't share anything
+	Parallel::forChunks(decodedSources.size(), 1, [&](size_t begin, size_t end)
+	{
+		if (std::this_thread::get_id() != callingThread)
+			stbi_set_flip_vertically_on_load_thread(false);
+
+		for (size_t i = begin; i < end; i++)
+		{
+			size_t sourceIndex = decodedSources[i];
+			const TextureSource& source = sources[sourceIndex];
+			const MappedFile* file = files[sourceIndex].get();
+
+			if (file != nullptr)
+				this->decodeTexture(source, file->getData(), file->getSize(), keys[sourceIndex], images[i]);
+			else
+				this->decodeTexture(source, source.encodedData, source.encodedSize, keys[sourceIndex], images[i]);
+		}
+	});
+
+	size_t decodedBytes = 0;
+
+	for (size_t i = 0; i < decodedSources.size(); i++)
+	{
+		if (images[i].compressed.format != BlockFormat::NONE)
+			decodedBytes += images[i].compressed.getByteSize();
+		else if (images[i].pixels != nullptr)
+			decodedBytes += static_cast<size_t>(images[i].width) * images[i].height * images[i].channels;
+
+		this->decodedImages[keys[decodedSources[i]]] = std::move(images[i]);
+	}
+
+	double decodeTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - decodeStart).count();
+
+	Logger::logInfo(
+		"Decoded " + std::to_string(decodedSources.size()) + " textures (" + std::to_string(decodedBytes / (1024 * 1024)) + " MB) in " + std::to_string(decodeTime) + " ms, "
+		+ std::to_string(sources.size() - decodedSources.size()) + " shared with already loaded textures",
+		"resourceLoader.cpp"
+	);
+}
+
+void ResourceLoader::decodeTexture(const TextureSource& source, const unsigned char* encodedData, size_t encodedSize, uint64_t key, DecodedImage& image) const
+{
+	std::string cachePath;
+	bool isCompressed = this->compressTextures && source.type != TextureType::TEXTURE_3D;
+
+	if (isCompressed)
+	{
+		// The formats the driver supports change the format chosen for transparent textures
+		uint32_t parameters[3] = {
+			TextureCompression::ENCODER_VERSION, TextureCompression::isSupported(BlockFormat::BC1), TextureCompression::isSupported(BlockFormat::BC7)
+		};
+
+		cachePath = this->getTextureCachePath(Hash::hashBytes(parameters, sizeof(parameters), key));
+
+		if (this->mapCachedTexture(cachePath, source.type, image))
+			return;
+
+		if (!this->streamTextures && TextureCompression::loadDDS(cachePath, source.type, image.compressed))
+		{
+			image.width = image.compressed.levels[0].width;
+			image.height = image.compressed.levels[0].height;
+			image.format = TextureCompression::getBaseFormat(image.compressed.format);
+			return;
+		}
+	}
+
+	// The compressor works on RGBA pixels whatever the image holds
+	int desiredChannels = isCompressed ? 4 : source.channels;
+	int fileChannels = 0;
+
+	image.pixels.reset(stbi_load_from_memory(encodedData, static_cast<int>(encodedSize), &image.width, &image.height, &fileChannels, desiredChannels));
+	image.channels = desiredChannels != 0 ? desiredChannels : fileChannels;
+
+	if (image.channels == 1)
+		image.format = GL_RED;
+	else if (image.channels == 2)
+		image.format = GL_RG;
+	else if (image.channels == 3)
+		image.format = GL_RGB;
+	else
+		image.format = GL_RGBA;
+
+	if (isCompressed && image.pixels != nullptr)
+	{
+		image.compressed = TextureCompression::compress(image.pixels.get(), image.width, image.height, source.type);
+
+		// Textures that stay uncompressed keep their pixels
+		if (image.compressed.format != BlockFormat::NONE)
+		{
+			image.format = TextureCompression::getBaseFormat(image.compressed.format);
+			image.pixels.reset();
+
+			// Streamed textures read their levels back from the file just written, the image is only kept if it couldn't be saved and is then uploaded whole
+			if (TextureCompression::saveDDS(cachePath, image.compressed) && this->mapCachedTexture(cachePath, source.type, image))
+				image.compressed = CompressedImage();
+		}
+	}
+}
+
+bool ResourceLoader::mapCachedTexture(const std::string& cachePath, TextureType textureType, DecodedImage& image) const
+{
+	if (!this->streamTextures)
+		return false;
+
+	MappedImage mappedImage;
+
+	if (!TextureCompression::mapDDS(cachePath, textureType, mappedImage))
+		return false;
+
+	image.width = mappedImage.levels[0].width;
+	image.height = mappedImage.levels[0].height;
+	image.format = TextureCompression::getBaseFormat(mappedImage.format);
+	image.mapped = std::make_shared<const MappedImage>(std::move(mappedImage));
+
+	return true;
+}
+
+std::string ResourceLoader::getTextureCachePath(uint64_t key) const
+{
+	return CacheFile::getPath(this->textureCacheDirectory, key, ".dds");
+}
+
+void ResourceLoader::ImageDeleter::operator()(unsigned char* pixels) const
+{
+	stbi_image_free(pixels);
+}
+
+std::shared_ptr<Texture> ResourceLoader::createTexture(TextureType textureType, int width, int height, GLenum format, const unsigned char* textureData, int channels)
+{
+	if (this->deferredUploads == nullptr)
+		return std::make_shared<Texture>(textureType, width, height, format, textureData);
+
+	auto texture = std::make_shared<Texture>();
+	texture->type = textureType;
+	texture->width = width;
+	texture->height = height;
+	texture->format = format;
+
+	size_t byteSize = static_cast<size_t>(width) * height * channels;
+	std::vector<unsigned char> pixels(textureData, textureData + byteSize);
+
+	// The mipmaps add about a third to the size of the upload
+	this->deferredUploads->push_back(UploadTask{ [texture, width, height, format, pixels = std::move(pixels)]()
+	{
+		texture->upload(width, height, format, pixels.data());
+	}, byteSize + byteSize / 3 });
+
+	return texture;
+}
+
+std::shared_ptr<Texture> ResourceLoader::createStreamedTexture(TextureType textureType, std::shared_ptr<const MappedImage> image)
+{
+	auto texture = std::make_shared<Texture>();
+	texture->type = textureType;
+
+	if (this->deferredUploads == nullptr)
+	{
+		texture->uploadStreamed(image);
+		return texture;
+	}
+
+	texture->width = image->levels[0].width;
+	texture->height = image->levels[0].height;
+	texture->format = TextureCompression::getBaseFormat(image->format);
+
+	// Only the levels under the floor are uploaded at first, they are read from the mapping by the upload
+	size_t byteSize = TextureStreamer::getLevelsByteSize(*image, TextureStreamer::getFloorLevel(*image));
+
+	this->deferredUploads->push_back(UploadTask{ [texture, image]()
+	{
+		texture->uploadStreamed(image);
+	}, byteSize });
+
+	return texture;
+}
+
+std::shared_ptr<Texture> ResourceLoader::createCompressedTexture(TextureType textureType, CompressedImage image)
+{
+	if (this->deferredUploads == nullptr)
+		return std::make_shared<Texture>(textureType, image);
+
+	auto texture = std::make_shared<Texture>();
+	texture->type = textureType;
+	texture->width = image.levels[0].width;
+	texture->height = image.levels[0].height;
+	texture->format = TextureCompression::getBaseFormat(image.format);
+
+	size_t byteSize = image.getByteSize();
+
+	// The mip levels are part of the image, so the upload size is exact
+	this->deferredUploads->push_back(UploadTask{ [texture, image = std::move(image)]()
+	{
+		texture->uploadCompressed(image);
+	}, byteSize });
+
+	return texture;
 }
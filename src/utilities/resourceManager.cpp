@@ -0,0 +1,117 @@
+#include <algorithm>
+#include <vector>
+
+#include "utilities/resourceManager.hpp"
+#include "logger.hpp"
+
+ResourceManager ResourceManager::instance;
+
+ResourceManager& ResourceManager::getInstance()
+{
+	return ResourceManager::instance;
+}
+
+void ResourceManager::trackMemory(ResourceType type, int64_t byteSize)
+{
+	this->trackedBytes[static_cast<size_t>(type)] += byteSize;
+}
+
+void ResourceManager::collect()
+{
+	// The evicted resources are freed once the lock is released, their destructors can take a while
+	std::vector<std::shared_ptr<void>> evictedResources;
+
+	{
+		std::lock_guard<std::mutex> lock(this->resourcesMutex);
+
+		size_t totalUsage = 0;
+		std::vector<std::pair<size_t, std::map<uint64_t, Entry>::iterator>> candidates;
+
+		for (size_t type = 0; type < static_cast<size_t>(ResourceType::COUNT); type++)
+		{
+			this->memoryUsage[type] = static_cast<size_t>(std::max<int64_t>(this->trackedBytes[type], 0));
+
+			for (auto entry = this->resources[type].begin(); entry != this->resources[type].end(); ++entry)
+			{
+				entry->second.byteSize = entry->second.getByteSize(entry->second.resource.get());
+				this->memoryUsage[type] += entry->second.byteSize;
+
+				// Only the manager references the resource, it can be evicted
+				if (entry->second.resource.use_count() == 1)
+					candidates.emplace_back(type, entry);
+				else
+					entry->second.lastUse = this->frame;
+			}
+
+			totalUsage += this->memoryUsage[type];
+		}
+
+		if (totalUsage > this->memoryBudget)
+		{
+			std::sort(candidates.begin(), candidates.end(), [](const auto& a, const auto& b) { return a.second->second.lastUse < b.second->second.lastUse; });
+
+			for (auto& [type, entry] : candidates)
+			{
+				if (totalUsage <= this->memoryBudget)
+					break;
+
+				totalUsage -= entry->second.byteSize;
+				this->memoryUsage[type] -= entry->second.byteSize;
+
+				evictedResources.push_back(std::move(entry->second.resource));
+				this->resources[type].erase(entry);
+			}
+
+			this->evictionCount += evictedResources.size();
+		}
+
+		this->frame++;
+	}
+
+	if (!evictedResources.empty())
+		Logger::logDebug("Evicted " + std::to_string(evictedResources.size()) + " unused resources to stay under the memory budget", "resourceManager.cpp");
+}
+
+void ResourceManager::clear()
+{
+	std::vector<std::shared_ptr<void>> releasedResources;
+
+	{
+		std::lock_guard<std::mutex> lock(this->resourcesMutex);
+
+		for (size_t type = 0; type < static_cast<size_t>(ResourceType::COUNT); type++)
+		{
+			for (auto& [key, entry] : this->resources[type])
+				releasedResources.push_back(std::move(entry.resource));
+
+			this->resources[type].clear();
+			this->memoryUsage[type] = 0;
+		}
+	}
+}
+
+size_t ResourceManager::getMemoryUsage(ResourceType type) const
+{
+	return this->memoryUsage[static_cast<size_t>(type)];
+}
+
+size_t ResourceManager::getTotalMemoryUsage() const
+{
+	size_t totalUsage = 0;
+
+	for (size_t usage : this->memoryUsage)
+		totalUsage += usage;
+
+	return totalUsage;
+}
+
+size_t ResourceManager::getResourceCount(ResourceType type)
+{
+	std::lock_guard<std::mutex> lock(this->resourcesMutex);
+	return this->resources[static_cast<size_t>(type)].size();
+}
+
+size_t ResourceManager::getEvictionCount() const
+{
+	return this->evictionCount;
+}
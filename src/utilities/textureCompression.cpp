@@ -0,0 +1,947 @@
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+
+#include "utilities/textureCompression.hpp"
+#include "utilities/mappedFile.hpp"
+#include "utilities/parallel.hpp"
+#include "logger.hpp"
+
+std::atomic<bool> TextureCompression::supportsS3TC = false;
+std::atomic<bool> TextureCompression::supportsBPTC = false;
+
+namespace
+{
+	/// <summary>
+	/// The headers of a DDS file with the DX10 extension, which is needed for the BC4, BC5 and BC7 formats
+	/// </summary>
+	struct DDSPixelFormat
+	{
+		uint32_t size;
+		uint32_t flags;
+		uint32_t fourCC;
+		uint32_t rgbBitCount;
+		uint32_t bitMasks[4];
+	};
+
+	struct DDSHeader
+	{
+		uint32_t size;
+		uint32_t flags;
+		uint32_t height;
+		uint32_t width;
+		uint32_t pitchOrLinearSize;
+		uint32_t depth;
+		uint32_t mipMapCount;
+		uint32_t reserved1[11];
+		DDSPixelFormat pixelFormat;
+		uint32_t caps[4];
+		uint32_t reserved2;
+	};
+
+	struct DDSHeaderDX10
+	{
+		uint32_t dxgiFormat;
+		uint32_t resourceDimension;
+		uint32_t miscFlag;
+		uint32_t arraySize;
+		uint32_t miscFlags2;
+	};
+
+	constexpr uint32_t DDS_MAGIC = 0x20534444; // "DDS "
+	constexpr uint32_t DDS_FOURCC_DX10 = 0x30315844; // "DX10"
+	constexpr uint32_t DDS_FLAGS = 0x1 | 0x2 | 0x4 | 0x1000 | 0x20000 | 0x80000; // Caps, height, width, pixel format, mip count, linear size
+	constexpr uint32_t DDS_PIXEL_FORMAT_FOURCC = 0x4;
+	constexpr uint32_t DDS_CAPS = 0x1000 | 0x400000 | 0x8; // Texture, mipmap, complex
+	constexpr uint32_t DDS_DIMENSION_TEXTURE2D = 3;
+
+	/// <summary>
+	/// Written in the reserved fields of the header, so files from other tools or older encoders aren't loaded
+	/// </summary>
+	constexpr uint32_t DDS_ENCODER_TAG = 0x54474C56; // "VGLT"
+
+	/// <summary>
+	/// The weights of the 16 colors of a BC7 block with 4 bit indices, out of 64
+	/// </summary>
+	constexpr int BC7_WEIGHTS[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+	uint32_t getDxgiFormat(BlockFormat format)
+	{
+		switch (format)
+		{
+			case BlockFormat::BC1: return 71;
+			case BlockFormat::BC3: return 77;
+			case BlockFormat::BC4: return 80;
+			case BlockFormat::BC5: return 83;
+			case BlockFormat::BC7: return 98;
+			default: return 0;
+		}
+	}
+
+	BlockFormat getBlockFormat(uint32_t dxgiFormat)
+	{
+		switch (dxgiFormat)
+		{
+			case 71: return BlockFormat::BC1;
+			case 77: return BlockFormat::BC3;
+			case 80: return BlockFormat::BC4;
+			case 83: return BlockFormat::BC5;
+			case 98: return BlockFormat::BC7;
+			default: return BlockFormat::NONE;
+		}
+	}
+
+	/// <summary>
+	/// Returns the first channel of the source image kept by BC4 and BC5 textures
+	/// </summary>
+	int getFirstChannel(TextureType textureType)
+	{
+		// Metallic textures pack roughness in green and metalness in blue
+		return textureType == TextureType::TEXTURE_METALLIC ? 1 : 0;
+	}
+
+	/// <summary>
+	/// Finds the segment along the principal axis of a set of points that spans all of them, the endpoints of a block are taken from it
+	/// </summary>
+	void computeEndpoints(const float points[16][4], int dimensions, float start[4], float end[4])
+	{
+		float mean[4] = {};
+
+		for (int i = 0; i < 16; i++)
+			for (int c = 0; c < dimensions; c++)
+				mean[c] += points[i][c] / 16.0f;
+
+		float covariance[4][4] = {};
+
+		for (int i = 0; i < 16; i++)
+		{
+			for (int a = 0; a < dimensions; a++)
+				for (int b = 0; b < dimensions; b++)
+					covariance[a][b] += (points[i][a] - mean[a]) * (points[i][b] - mean[b]);
+		}
+
+		// A few power iterations are enough to find the main direction of 16 points
+		float axis[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+
+		for (int iteration = 0; iteration < 8; iteration++)
+		{
+			float next[4] = {};
+			float length = 0.0f;
+
+			for (int a = 0; a < dimensions; a++)
+			{
+				for (int b = 0; b < dimensions; b++)
+					next[a] += covariance[a][b] * axis[b];
+
+				length = std::max(length, std::abs(next[a]));
+			}
+
+			if (length < 1.0e-6f)
+				break;
+
+			for (int a = 0; a < dimensions; a++)
+				axis[a] = next[a] / length;
+		}
+
+		float axisLength = 0.0f;
+
+		for (int c = 0; c < dimensions; c++)
+			axisLength += axis[c] * axis[c];
+
+		axisLength = std::sqrt(axisLength);
+
+		for (int c = 0; c < dimensions; c++)
+			axis[c] /= axisLength;
+
+		float minProjection = 0.0f;
+		float maxProjection = 0.0f;
+
+		for (int i = 0; i < 16; i++)
+		{
+			float projection = 0.0f;
+
+			for (int c = 0; c < dimensions; c++)
+				projection += (points[i][c] - mean[c]) * axis[c];
+
+			minProjection = std::min(minProjection, projection);
+			maxProjection = std::max(maxProjection, projection);
+		}
+
+		for (int c = 0; c < dimensions; c++)
+		{
+			start[c] = std::clamp(mean[c] + axis[c] * minProjection, 0.0f, 255.0f);
+			end[c] = std::clamp(mean[c] + axis[c] * maxProjection, 0.0f, 255.0f);
+		}
+	}
+
+	uint16_t packColor565(const float color[3])
+	{
+		auto r = static_cast<uint16_t>(std::lround(std::clamp(color[0], 0.0f, 255.0f) * 31.0f / 255.0f));
+		auto g = static_cast<uint16_t>(std::lround(std::clamp(color[1], 0.0f, 255.0f) * 63.0f / 255.0f));
+		auto b = static_cast<uint16_t>(std::lround(std::clamp(color[2], 0.0f, 255.0f) * 31.0f / 255.0f));
+
+		return static_cast<uint16_t>((r << 11) | (g << 5) | b);
+	}
+
+	void unpackColor565(uint16_t color, int output[3])
+	{
+		int r = color >> 11;
+		int g = (color >> 5) & 63;
+		int b = color & 31;
+
+		output[0] = (r << 3) | (r >> 2);
+		output[1] = (g << 2) | (g >> 4);
+		output[2] = (b << 3) | (b >> 2);
+	}
+
+	/// <summary>
+	/// Writes a BC1 block with the given endpoints and the closest palette color for each pixel
+	/// </summary>
+	/// <returns>The squared error of the block</returns>
+	int encodeBC1Colors(const unsigned char block[64], uint16_t color0, uint16_t color1, unsigned char* output, unsigned char indices[16])
+	{
+		// The first endpoint must be the larger one for the four color mode
+		if (color0 < color1)
+			std::swap(color0, color1);
+
+		int palette[4][3];
+		unpackColor565(color0, palette[0]);
+		unpackColor565(color1, palette[1]);
+
+		for (int c = 0; c < 3; c++)
+		{
+			palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+			palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+		}
+
+		int error = 0;
+		uint32_t indexBits = 0;
+
+		for (int i = 0; i < 16; i++)
+		{
+			int bestIndex = 0;
+			int bestError = INT32_MAX;
+
+			// Equal endpoints would select the three color mode, so only the first one is used
+			int paletteSize = color0 == color1 ? 1 : 4;
+
+			for (int p = 0; p < paletteSize; p++)
+			{
+				int pixelError = 0;
+
+				for (int c = 0; c < 3; c++)
+				{
+					int difference = block[i * 4 + c] - palette[p][c];
+					pixelError += difference * difference;
+				}
+
+				if (pixelError < bestError)
+				{
+					bestError = pixelError;
+					bestIndex = p;
+				}
+			}
+
+			error += bestError;
+			indices[i] = static_cast<unsigned char>(bestIndex);
+			indexBits |= static_cast<uint32_t>(bestIndex) << (i * 2);
+		}
+
+		output[0] = static_cast<unsigned char>(color0 & 0xFF);
+		output[1] = static_cast<unsigned char>(color0 >> 8);
+		output[2] = static_cast<unsigned char>(color1 & 0xFF);
+		output[3] = static_cast<unsigned char>(color1 >> 8);
+
+		for (int i = 0; i < 4; i++)
+			output[4 + i] = static_cast<unsigned char>((indexBits >> (i * 8)) & 0xFF);
+
+		return error;
+	}
+
+	/// <summary>
+	/// Packs values in a 128 bit BC7 block, from the lowest bit
+	/// </summary>
+	class BlockBitWriter
+	{
+	public:
+		explicit BlockBitWriter(unsigned char* output) : output(output)
+		{
+			std::memset(output, 0, 16);
+		}
+
+		void write(uint32_t value, int bitCount)
+		{
+			for (int i = 0; i < bitCount; i++)
+			{
+				if ((value >> i) & 1)
+					this->output[this->position / 8] |= static_cast<unsigned char>(1 << (this->position % 8));
+
+				this->position++;
+			}
+		}
+
+	private:
+		unsigned char* output;
+		int position = 0;
+	};
+}
+
+size_t CompressedImage::getByteSize() const
+{
+	size_t byteSize = 0;
+
+	for (const CompressedLevel& level : this->levels)
+		byteSize += level.data.size();
+
+	return byteSize;
+}
+
+const unsigned char* MappedImage::getLevelData(size_t level) const
+{
+	return this->file->getData() + this->levels[level].offset;
+}
+
+void TextureCompression::detectSupport()
+{
+	GLint extensionCount = 0;
+	glGetIntegerv(GL_NUM_EXTENSIONS, &extensionCount);
+
+	for (GLint i = 0; i < extensionCount; i++)
+	{
+		const auto* extension = reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, i));
+
+		if (extension == nullptr)
+			continue;
+
+		if (std::strcmp(extension, "GL_EXT_texture_compression_s3tc") == 0)
+			TextureCompression::supportsS3TC = true;
+		else if (std::strcmp(extension, "GL_ARB_texture_compression_bptc") == 0)
+			TextureCompression::supportsBPTC = true;
+	}
+
+	Logger::logInfo(
+		std::string("Texture compression support - BC1/BC3: ") + (TextureCompression::supportsS3TC ? "yes" : "no") + ", BC7: " + (TextureCompression::supportsBPTC ? "yes" : "no"),
+		"textureCompression.cpp"
+	);
+}
+
+bool TextureCompression::isSupported(BlockFormat format)
+{
+	switch (format)
+	{
+		case BlockFormat::BC1:
+		case BlockFormat::BC3:
+			return TextureCompression::supportsS3TC;
+		case BlockFormat::BC7:
+			return TextureCompression::supportsBPTC;
+		case BlockFormat::BC4:
+		case BlockFormat::BC5:
+			return true;
+		default:
+			return false;
+	}
+}
+
+BlockFormat TextureCompression::chooseFormat(TextureType textureType, bool hasAlpha)
+{
+	BlockFormat format;
+
+	switch (textureType)
+	{
+		case TextureType::TEXTURE_NORMAL:
+		case TextureType::TEXTURE_METALLIC:
+			format = BlockFormat::BC5;
+			break;
+		case TextureType::TEXTURE_ROUGHNESS:
+		case TextureType::TEXTURE_AO:
+		case TextureType::TEXTURE_HEIGHT:
+		case TextureType::TEXTURE_OPACITY:
+			format = BlockFormat::BC4;
+			break;
+		case TextureType::TEXTURE_3D:
+			format = BlockFormat::NONE;
+			break;
+		default:
+			if (!hasAlpha)
+				format = BlockFormat::BC1;
+			else
+				format = TextureCompression::isSupported(BlockFormat::BC7) ? BlockFormat::BC7 : BlockFormat::BC3;
+			break;
+	}
+
+	return TextureCompression::isSupported(format) ? format : BlockFormat::NONE;
+}
+
+CompressedImage TextureCompression::compress(const unsigned char* pixels, int width, int height, TextureType textureType)
+{
+	CompressedImage image;
+
+	if (pixels == nullptr || width <= 0 || height <= 0)
+		return image;
+
+	bool hasAlpha = false;
+	size_t pixelCount = static_cast<size_t>(width) * height;
+
+	for (size_t i = 0; i < pixelCount && !hasAlpha; i++)
+		hasAlpha = pixels[i * 4 + 3] != 255;
+
+	image.format = TextureCompression::chooseFormat(textureType, hasAlpha);
+
+	if (image.format == BlockFormat::NONE)
+		return image;
+
+	TextureCompression::setSwizzle(textureType, image.format, image.swizzle);
+
+	std::vector<unsigned char> level(pixels, pixels + pixelCount * 4);
+	int levelWidth = width;
+	int levelHeight = height;
+
+	// The whole mip chain is precomputed since glGenerateMipmap can't work on compressed textures
+	while (true)
+	{
+		image.levels.push_back(TextureCompression::compressLevel(level, levelWidth, levelHeight, image.format, textureType));
+
+		if (levelWidth == 1 && levelHeight == 1)
+			break;
+
+		level = TextureCompression::downsample(level, levelWidth, levelHeight, textureType == TextureType::TEXTURE_NORMAL);
+		levelWidth = std::max(1, levelWidth / 2);
+		levelHeight = std::max(1, levelHeight / 2);
+	}
+
+	return image;
+}
+
+GLenum TextureCompression::getInternalFormat(BlockFormat format)
+{
+	switch (format)
+	{
+		case BlockFormat::BC1: return GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+		case BlockFormat::BC3: return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+		case BlockFormat::BC4: return GL_COMPRESSED_RED_RGTC1;
+		case BlockFormat::BC5: return GL_COMPRESSED_RG_RGTC2;
+		case BlockFormat::BC7: return GL_COMPRESSED_RGBA_BPTC_UNORM;
+		default: return GL_RGBA;
+	}
+}
+
+GLenum TextureCompression::getBaseFormat(BlockFormat format)
+{
+	switch (format)
+	{
+		case BlockFormat::BC1: return GL_RGB;
+		case BlockFormat::BC4: return GL_RED;
+		case BlockFormat::BC5: return GL_RG;
+		default: return GL_RGBA;
+	}
+}
+
+bool TextureCompression::loadDDS(const std::string& path, TextureType textureType, CompressedImage& image)
+{
+	MappedImage mappedImage;
+
+	if (!TextureCompression::mapDDS(path, textureType, mappedImage))
+		return false;
+
+	CompressedImage loadedImage;
+	loadedImage.format = mappedImage.format;
+	std::memcpy(loadedImage.swizzle, mappedImage.swizzle, sizeof(loadedImage.swizzle));
+
+	for (size_t i = 0; i < mappedImage.levels.size(); i++)
+	{
+		const unsigned char* levelData = mappedImage.getLevelData(i);
+
+		CompressedLevel level;
+		level.width = mappedImage.levels[i].width;
+		level.height = mappedImage.levels[i].height;
+		level.data.assign(levelData, levelData + mappedImage.levels[i].size);
+		loadedImage.levels.push_back(std::move(level));
+	}
+
+	image = std::move(loadedImage);
+
+	return true;
+}
+
+bool TextureCompression::mapDDS(const std::string& path, TextureType textureType, MappedImage& image)
+{
+	auto file = std::make_shared<const MappedFile>(path);
+
+	if (!file->isOpen())
+		return false;
+
+	uint32_t magic = 0;
+	DDSHeader header = {};
+	DDSHeaderDX10 headerDX10 = {};
+	size_t offset = sizeof(magic) + sizeof(header) + sizeof(headerDX10);
+
+	if (file->getSize() < offset)
+	{
+		Logger::logWarning("Truncated texture cache file " + path, "textureCompression.cpp");
+		return false;
+	}
+
+	std::memcpy(&magic, file->getData(), sizeof(magic));
+	std::memcpy(&header, file->getData() + sizeof(magic), sizeof(header));
+	std::memcpy(&headerDX10, file->getData() + sizeof(magic) + sizeof(header), sizeof(headerDX10));
+
+	BlockFormat format = getBlockFormat(headerDX10.dxgiFormat);
+
+	bool isValid = magic == DDS_MAGIC
+		&& header.pixelFormat.fourCC == DDS_FOURCC_DX10
+		&& header.reserved1[0] == DDS_ENCODER_TAG
+		&& header.reserved1[1] == TextureCompression::ENCODER_VERSION
+		&& format != BlockFormat::NONE
+		&& header.width > 0 && header.height > 0
+		&& header.mipMapCount > 0 && header.mipMapCount <= 32;
+
+	if (!isValid)
+	{
+		Logger::logWarning("Ignoring outdated texture cache file " + path, "textureCompression.cpp");
+		return false;
+	}
+
+	MappedImage mappedImage;
+	mappedImage.format = format;
+
+	int width = static_cast<int>(header.width);
+	int height = static_cast<int>(header.height);
+	size_t blockSize = TextureCompression::getBlockSize(format);
+
+	// Only the sizes of the levels are checked, their blocks stay on disk until they are read
+	for (uint32_t i = 0; i < header.mipMapCount; i++)
+	{
+		size_t levelSize = static_cast<size_t>((width + 3) / 4) * ((height + 3) / 4) * blockSize;
+
+		if (levelSize > file->getSize() - offset)
+		{
+			Logger::logWarning("Truncated texture cache file " + path, "textureCompression.cpp");
+			return false;
+		}
+
+		mappedImage.levels.push_back(MappedLevel{ width, height, offset, levelSize });
+
+		offset += levelSize;
+		width = std::max(1, width / 2);
+		height = std::max(1, height / 2);
+	}
+
+	TextureCompression::setSwizzle(textureType, mappedImage.format, mappedImage.swizzle);
+	mappedImage.file = std::move(file);
+	image = std::move(mappedImage);
+
+	return true;
+}
+
+bool TextureCompression::saveDDS(const std::string& path, const CompressedImage& image)
+{
+	if (image.format == BlockFormat::NONE || image.levels.empty())
+		return false;
+
+	DDSHeader header = {};
+	header.size = sizeof(DDSHeader);
+	header.flags = DDS_FLAGS;
+	header.width = static_cast<uint32_t>(image.levels[0].width);
+	header.height = static_cast<uint32_t>(image.levels[0].height);
+	header.pitchOrLinearSize = static_cast<uint32_t>(image.levels[0].data.size());
+	header.mipMapCount = static_cast<uint32_t>(image.levels.size());
+	header.reserved1[0] = DDS_ENCODER_TAG;
+	header.reserved1[1] = TextureCompression::ENCODER_VERSION;
+	header.pixelFormat.size = sizeof(DDSPixelFormat);
+	header.pixelFormat.flags = DDS_PIXEL_FORMAT_FOURCC;
+	header.pixelFormat.fourCC = DDS_FOURCC_DX10;
+	header.caps[0] = DDS_CAPS;
+
+	DDSHeaderDX10 headerDX10 = {};
+	headerDX10.dxgiFormat = getDxgiFormat(image.format);
+	headerDX10.resourceDimension = DDS_DIMENSION_TEXTURE2D;
+	headerDX10.arraySize = 1;
+
+	std::error_code error;
+
+	bool isWritten = CacheFile::write(path, [&](std::ofstream& file)
+	{
+		file.write(reinterpret_cast<const char*>(&DDS_MAGIC), sizeof(DDS_MAGIC));
+		file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		file.write(reinterpret_cast<const char*>(&headerDX10), sizeof(headerDX10));
+
+		for (const CompressedLevel& level : image.levels)
+			file.write(reinterpret_cast<const char*>(level.data.data()), static_cast<std::streamsize>(level.data.size()));
+	}, error);
+
+	if (!isWritten)
+	{
+		Logger::logWarning("Couldn't write the texture cache file " + path + " - " + error.message(), "textureCompression.cpp");
+		return false;
+	}
+
+	return true;
+}
+
+size_t TextureCompression::getBlockSize(BlockFormat format)
+{
+	return format == BlockFormat::BC1 || format == BlockFormat::BC4 ? 8 : 16;
+}
+
+void TextureCompression::setSwizzle(TextureType textureType, BlockFormat format, GLint swizzle[4])
+{
+	swizzle[0] = GL_RED;
+	swizzle[1] = GL_GREEN;
+	swizzle[2] = GL_BLUE;
+	swizzle[3] = GL_ALPHA;
+
+	// The shaders read the channels at the place they have in uncompressed textures
+	if (format == BlockFormat::BC4)
+	{
+		swizzle[1] = GL_RED;
+		swizzle[2] = GL_RED;
+		swizzle[3] = GL_ONE;
+	}
+	else if (format == BlockFormat::BC5 && getFirstChannel(textureType) == 1)
+	{
+		swizzle[0] = GL_ZERO;
+		swizzle[1] = GL_RED;
+		swizzle[2] = GL_GREEN;
+		swizzle[3] = GL_ONE;
+	}
+	else if (format == BlockFormat::BC5) // Normal maps, the shaders rebuild the Z component
+	{
+		swizzle[2] = GL_ONE;
+		swizzle[3] = GL_ONE;
+	}
+}
+
+std::vector<unsigned char> TextureCompression::downsample(const std::vector<unsigned char>& pixels, int width, int height, bool isNormalMap)
+{
+	int halfWidth = std::max(1, width / 2);
+	int halfHeight = std::max(1, height / 2);
+
+	std::vector<unsigned char> halfPixels(static_cast<size_t>(halfWidth) * halfHeight * 4);
+
+	for (int y = 0; y < halfHeight; y++)
+	{
+		// Odd sizes drop the last row or column, 1 pixel sizes reuse it
+		int y0 = std::min(y * 2, height - 1);
+		int y1 = std::min(y * 2 + 1, height - 1);
+
+		for (int x = 0; x < halfWidth; x++)
+		{
+			int x0 = std::min(x * 2, width - 1);
+			int x1 = std::min(x * 2 + 1, width - 1);
+
+			float sum[4];
+
+			for (int c = 0; c < 4; c++)
+			{
+				sum[c] = static_cast<float>(pixels[(static_cast<size_t>(y0) * width + x0) * 4 + c]) + pixels[(static_cast<size_t>(y0) * width + x1) * 4 + c]
+					+ pixels[(static_cast<size_t>(y1) * width + x0) * 4 + c] + pixels[(static_cast<size_t>(y1) * width + x1) * 4 + c];
+				sum[c] /= 4.0f;
+			}
+
+			// Averaged normals get shorter, they are brought back to unit length
+			if (isNormalMap)
+			{
+				float normal[3];
+				float length = 0.0f;
+
+				for (int c = 0; c < 3; c++)
+				{
+					normal[c] = sum[c] / 255.0f * 2.0f - 1.0f;
+					length += normal[c] * normal[c];
+				}
+
+				length = std::sqrt(length);
+
+				if (length > 1.0e-6f)
+				{
+					for (int c = 0; c < 3; c++)
+						sum[c] = (normal[c] / length * 0.5f + 0.5f) * 255.0f;
+				}
+			}
+
+			for (int c = 0; c < 4; c++)
+				halfPixels[(static_cast<size_t>(y) * halfWidth + x) * 4 + c] = static_cast<unsigned char>(std::lround(std::clamp(sum[c], 0.0f, 255.0f)));
+		}
+	}
+
+	return halfPixels;
+}
+
+CompressedLevel TextureCompression::compressLevel(const std::vector<unsigned char>& pixels, int width, int height, BlockFormat format, TextureType textureType)
+{
+	int blocksX = (width + 3) / 4;
+	int blocksY = (height + 3) / 4;
+	size_t blockSize = TextureCompression::getBlockSize(format);
+	int firstChannel = getFirstChannel(textureType);
+
+	CompressedLevel level;
+	level.width = width;
+	level.height = height;
+	level.data.resize(static_cast<size_t>(blocksX) * blocksY * blockSize);
+
+	// Each row of blocks is written to its own part of the output
+	Parallel::forChunks(static_cast<size_t>(blocksY), 16, [&](size_t begin, size_t end)
+	{
+		unsigned char block[64];
+
+		for (size_t blockY = begin; blockY < end; blockY++)
+		{
+			for (int blockX = 0; blockX < blocksX; blockX++)
+			{
+				for (int i = 0; i < 16; i++)
+				{
+					int x = std::min(blockX * 4 + i % 4, width - 1);
+					int y = std::min(static_cast<int>(blockY) * 4 + i / 4, height - 1);
+
+					std::memcpy(block + i * 4, pixels.data() + (static_cast<size_t>(y) * width + x) * 4, 4);
+				}
+
+				unsigned char* output = level.data.data() + (blockY * blocksX + blockX) * blockSize;
+
+				switch (format)
+				{
+					case BlockFormat::BC1:
+						TextureCompression::encodeBC1Block(block, output);
+						break;
+					case BlockFormat::BC3:
+						TextureCompression::encodeBC4Block(block, 3, output);
+						TextureCompression::encodeBC1Block(block, output + 8);
+						break;
+					case BlockFormat::BC4:
+						TextureCompression::encodeBC4Block(block, firstChannel, output);
+						break;
+					case BlockFormat::BC5:
+						TextureCompression::encodeBC4Block(block, firstChannel, output);
+						TextureCompression::encodeBC4Block(block, firstChannel + 1, output + 8);
+						break;
+					case BlockFormat::BC7:
+						TextureCompression::encodeBC7Block(block, output);
+						break;
+					default:
+						break;
+				}
+			}
+		}
+	});
+
+	return level;
+}
+
+void TextureCompression::encodeBC1Block(const unsigned char block[64], unsigned char* output)
+{
+	float points[16][4];
+
+	for (int i = 0; i < 16; i++)
+		for (int c = 0; c < 4; c++)
+			points[i][c] = block[i * 4 + c];
+
+	float start[4];
+	float end[4];
+	computeEndpoints(points, 3, start, end);
+
+	unsigned char indices[16];
+	int error = encodeBC1Colors(block, packColor565(end), packColor565(start), output, indices);
+
+	if (error == 0)
+		return;
+
+	// Refine the endpoints with a least squares fit to the chosen palette entries, and keep the result if it is better
+	constexpr float PALETTE_WEIGHTS[4] = { 1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f };
+
+	float weightSquared0 = 0.0f;
+	float weightSquared1 = 0.0f;
+	float weightCross = 0.0f;
+	float weighted0[3] = {};
+	float weighted1[3] = {};
+
+	for (int i = 0; i < 16; i++)
+	{
+		float weight = PALETTE_WEIGHTS[indices[i]];
+
+		weightSquared0 += weight * weight;
+		weightSquared1 += (1.0f - weight) * (1.0f - weight);
+		weightCross += weight * (1.0f - weight);
+
+		for (int c = 0; c < 3; c++)
+		{
+			weighted0[c] += weight * points[i][c];
+			weighted1[c] += (1.0f - weight) * points[i][c];
+		}
+	}
+
+	float determinant = weightSquared0 * weightSquared1 - weightCross * weightCross;
+
+	if (std::abs(determinant) < 1.0e-6f)
+		return;
+
+	float color0[3];
+	float color1[3];
+
+	for (int c = 0; c < 3; c++)
+	{
+		color0[c] = (weighted0[c] * weightSquared1 - weighted1[c] * weightCross) / determinant;
+		color1[c] = (weighted1[c] * weightSquared0 - weighted0[c] * weightCross) / determinant;
+	}
+
+	unsigned char refinedOutput[8];
+	unsigned char refinedIndices[16];
+
+	if (encodeBC1Colors(block, packColor565(color0), packColor565(color1), refinedOutput, refinedIndices) < error)
+		std::memcpy(output, refinedOutput, sizeof(refinedOutput));
+}
+
+void TextureCompression::encodeBC4Block(const unsigned char block[64], int channel, unsigned char* output)
+{
+	int minValue = 255;
+	int maxValue = 0;
+
+	for (int i = 0; i < 16; i++)
+	{
+		minValue = std::min<int>(minValue, block[i * 4 + channel]);
+		maxValue = std::max<int>(maxValue, block[i * 4 + channel]);
+	}
+
+	// The first endpoint is the larger one for the eight value mode
+	output[0] = static_cast<unsigned char>(maxValue);
+	output[1] = static_cast<unsigned char>(minValue);
+
+	float palette[8];
+	palette[0] = static_cast<float>(maxValue);
+	palette[1] = static_cast<float>(minValue);
+
+	for (int i = 2; i < 8; i++)
+		palette[i] = (static_cast<float>(8 - i) * maxValue + static_cast<float>(i - 1) * minValue) / 7.0f;
+
+	uint64_t indexBits = 0;
+
+	if (maxValue != minValue)
+	{
+		for (int i = 0; i < 16; i++)
+		{
+			int bestIndex = 0;
+			float bestError = 256.0f;
+
+			for (int p = 0; p < 8; p++)
+			{
+				float pixelError = std::abs(palette[p] - block[i * 4 + channel]);
+
+				if (pixelError < bestError)
+				{
+					bestError = pixelError;
+					bestIndex = p;
+				}
+			}
+
+			indexBits |= static_cast<uint64_t>(bestIndex) << (i * 3);
+		}
+	}
+
+	for (int i = 0; i < 6; i++)
+		output[2 + i] = static_cast<unsigned char>((indexBits >> (i * 8)) & 0xFF);
+}
+
+void TextureCompression::encodeBC7Block(const unsigned char block[64], unsigned char* output)
+{
+	// Mode 6 only, a single RGBA segment with 7 bit endpoints, a shared bit per endpoint and 4 bit indices
+	float points[16][4];
+
+	for (int i = 0; i < 16; i++)
+		for (int c = 0; c < 4; c++)
+			points[i][c] = block[i * 4 + c];
+
+	float start[4];
+	float end[4];
+	computeEndpoints(points, 4, start, end);
+
+	int bestError = INT32_MAX;
+	int bestEndpoints[2][4] = {};
+	int bestBits[2] = {};
+	int bestIndices[16] = {};
+
+	// Try every combination of the shared bits, they change the rounding of all the channels of an endpoint
+	for (int bits = 0; bits < 4; bits++)
+	{
+		int shared[2] = { bits & 1, bits >> 1 };
+		int endpoints[2][4];
+		int colors[2][4];
+
+		for (int c = 0; c < 4; c++)
+		{
+			endpoints[0][c] = std::clamp(static_cast<int>(std::lround((start[c] - shared[0]) / 2.0f)), 0, 127);
+			endpoints[1][c] = std::clamp(static_cast<int>(std::lround((end[c] - shared[1]) / 2.0f)), 0, 127);
+			colors[0][c] = (endpoints[0][c] << 1) | shared[0];
+			colors[1][c] = (endpoints[1][c] << 1) | shared[1];
+		}
+
+		int palette[16][4];
+
+		for (int p = 0; p < 16; p++)
+			for (int c = 0; c < 4; c++)
+				palette[p][c] = ((64 - BC7_WEIGHTS[p]) * colors[0][c] + BC7_WEIGHTS[p] * colors[1][c] + 32) >> 6;
+
+		int error = 0;
+		int indices[16];
+
+		for (int i = 0; i < 16 && error < bestError; i++)
+		{
+			int bestPixelError = INT32_MAX;
+
+			for (int p = 0; p < 16; p++)
+			{
+				int pixelError = 0;
+
+				for (int c = 0; c < 4; c++)
+				{
+					int difference = block[i * 4 + c] - palette[p][c];
+					pixelError += difference * difference;
+				}
+
+				if (pixelError < bestPixelError)
+				{
+					bestPixelError = pixelError;
+					indices[i] = p;
+				}
+			}
+
+			error += bestPixelError;
+		}
+
+		if (error < bestError)
+		{
+			bestError = error;
+			std::memcpy(bestEndpoints, endpoints, sizeof(endpoints));
+			std::memcpy(bestBits, shared, sizeof(shared));
+			std::memcpy(bestIndices, indices, sizeof(indices));
+		}
+	}
+
+	// The highest bit of the first index isn't stored, so the endpoints are swapped if it would be set
+	if (bestIndices[0] >= 8)
+	{
+		for (int c = 0; c < 4; c++)
+			std::swap(bestEndpoints[0][c], bestEndpoints[1][c]);
+
+		std::swap(bestBits[0], bestBits[1]);
+
+		for (int& index : bestIndices)
+			index = 15 - index;
+	}
+
+	BlockBitWriter writer(output);
+	writer.write(1 << 6, 7);
+
+	for (int c = 0; c < 4; c++)
+	{
+		writer.write(static_cast<uint32_t>(bestEndpoints[0][c]), 7);
+		writer.write(static_cast<uint32_t>(bestEndpoints[1][c]), 7);
+	}
+
+	writer.write(static_cast<uint32_t>(bestBits[0]), 1);
+	writer.write(static_cast<uint32_t>(bestBits[1]), 1);
+
+	writer.write(static_cast<uint32_t>(bestIndices[0]), 3);
+
+	for (int i = 1; i < 16; i++)
+		writer.write(static_cast<uint32_t>(bestIndices[i]), 4);
+}
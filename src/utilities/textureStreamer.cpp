@@ -0,0 +1,134 @@
+#include <algorithm>
+
+#include "utilities/textureStreamer.hpp"
+#include "utilities/textureCompression.hpp"
+#include "texture.hpp"
+
+TextureStreamer TextureStreamer::instance;
+
+TextureStreamer& TextureStreamer::getInstance()
+{
+	return TextureStreamer::instance;
+}
+
+int TextureStreamer::getFloorLevel(const MappedImage& image)
+{
+	for (size_t i = 0; i < image.levels.size(); i++)
+	{
+		if (std::max(image.levels[i].width, image.levels[i].height) <= TextureStreamer::RESIDENT_SIZE)
+			return static_cast<int>(i);
+	}
+
+	return image.levels.empty() ? 0 : static_cast<int>(image.levels.size()) - 1;
+}
+
+size_t TextureStreamer::getLevelsByteSize(const MappedImage& image, int firstLevel)
+{
+	size_t byteSize = 0;
+
+	for (size_t i = std::max(firstLevel, 0); i < image.levels.size(); i++)
+		byteSize += image.levels[i].size;
+
+	return byteSize;
+}
+
+void TextureStreamer::registerTexture(Texture* texture)
+{
+	std::lock_guard<std::mutex> lock(this->texturesMutex);
+	this->textures.push_back(texture);
+}
+
+void TextureStreamer::unregisterTexture(Texture* texture)
+{
+	std::lock_guard<std::mutex> lock(this->texturesMutex);
+
+	auto registeredTexture = std::find(this->textures.begin(), this->textures.end(), texture);
+
+	if (registeredTexture != this->textures.end())
+	{
+		*registeredTexture = this->textures.back();
+		this->textures.pop_back();
+	}
+}
+
+void TextureStreamer::update()
+{
+	std::lock_guard<std::mutex> lock(this->texturesMutex);
+
+	size_t residentBytes = 0;
+	for (Texture* texture : this->textures)
+		residentBytes += texture->getResidentByteSize();
+
+	// Evict the finest levels of the textures that were requested the longest ago, down to what they were last requested at
+	// Textures that weren't requested this frame are off screen, they can go all the way down to their floor level
+	if (residentBytes > this->memoryBudget)
+	{
+		std::vector<Texture*> candidates = this->textures;
+		std::sort(candidates.begin(), candidates.end(), [](const Texture* a, const Texture* b) { return a->lastRequestFrame < b->lastRequestFrame; });
+
+		for (Texture* texture : candidates)
+		{
+			int targetLevel = texture->lastRequestFrame == this->frame ? std::min(texture->requestedLevel, texture->floorLevel) : texture->floorLevel;
+
+			while (residentBytes > this->memoryBudget && texture->residentLevel < targetLevel)
+			{
+				residentBytes -= texture->streamedImage->levels[texture->residentLevel].size;
+				texture->setResidentLevel(texture->residentLevel + 1);
+			}
+
+			if (residentBytes <= this->memoryBudget)
+				break;
+		}
+	}
+
+	std::vector<Texture*> requests;
+	for (Texture* texture : this->textures)
+	{
+		if (texture->lastRequestFrame == this->frame && texture->requestedLevel < texture->residentLevel)
+			requests.push_back(texture);
+	}
+
+	// The textures that are the furthest from their requested level go first, one level at a time so the upload budget is shared between them
+	std::sort(requests.begin(), requests.end(), [](const Texture* a, const Texture* b)
+	{
+		return a->residentLevel - a->requestedLevel > b->residentLevel - b->requestedLevel;
+	});
+
+	size_t uploadedBytes = 0;
+
+	for (Texture* texture : requests)
+	{
+		size_t levelBytes = texture->streamedImage->levels[texture->residentLevel - 1].size;
+
+		// At least one level is uploaded per frame, so levels larger than the budget still make progress
+		if (uploadedBytes > 0 && uploadedBytes + levelBytes > this->uploadBudget)
+			break;
+
+		if (residentBytes + levelBytes > this->memoryBudget)
+			continue;
+
+		texture->setResidentLevel(texture->residentLevel - 1);
+
+		uploadedBytes += levelBytes;
+		residentBytes += levelBytes;
+	}
+
+	this->residentBytes = residentBytes;
+	this->frame++;
+}
+
+uint64_t TextureStreamer::getFrame() const
+{
+	return this->frame;
+}
+
+size_t TextureStreamer::getTextureCount()
+{
+	std::lock_guard<std::mutex> lock(this->texturesMutex);
+	return this->textures.size();
+}
+
+size_t TextureStreamer::getResidentBytes() const
+{
+	return this->residentBytes;
+}
@@ -0,0 +1,70 @@
+#include <chrono>
+
+#include "utilities/uploadQueue.hpp"
+
+UploadQueue UploadQueue::instance;
+
+UploadQueue& UploadQueue::getInstance()
+{
+	return UploadQueue::instance;
+}
+
+void UploadQueue::push(std::vector<UploadTask> tasks)
+{
+	std::lock_guard<std::mutex> lock(this->tasksMutex);
+
+	for (UploadTask& task : tasks)
+	{
+		this->pendingBytes += task.byteSize;
+		this->tasks.push_back(std::move(task));
+	}
+}
+
+void UploadQueue::process()
+{
+	auto frameStart = std::chrono::steady_clock::now();
+	size_t uploadedBytes = 0;
+	bool isFirstTask = true;
+
+	while (true)
+	{
+		UploadTask task;
+
+		{
+			std::lock_guard<std::mutex> lock(this->tasksMutex);
+
+			if (this->tasks.empty())
+				return;
+
+			if (!isFirstTask)
+			{
+				double elapsedTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - frameStart).count();
+
+				if (elapsedTime >= this->timeBudget || uploadedBytes + this->tasks.front().byteSize > this->byteBudget)
+					return;
+			}
+
+			task = std::move(this->tasks.front());
+			this->tasks.pop_front();
+			this->pendingBytes -= task.byteSize;
+		}
+
+		// The lock is released while the task runs, so loading threads are never blocked by an upload
+		task.function();
+
+		uploadedBytes += task.byteSize;
+		isFirstTask = false;
+	}
+}
+
+size_t UploadQueue::getPendingCount()
+{
+	std::lock_guard<std::mutex> lock(this->tasksMutex);
+	return this->tasks.size();
+}
+
+size_t UploadQueue::getPendingBytes()
+{
+	std::lock_guard<std::mutex> lock(this->tasksMutex);
+	return this->pendingBytes;
+}